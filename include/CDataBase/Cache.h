@@ -1,51 +1,82 @@
-/*!
- * \file Cache.h
- *
- * \author czy
- * \date 2023.07.12
- *
- * 
- */
-#pragma once
-#include <cstdint>
-#include "CDataBase/Slice.h"
-
-namespace CDB{
-
-	class Cache;
-
-
-	Cache* newLRUCache(size_t  capacity);
-
-	class Cache{
-	public:
-
-		Cache() = default;
-
-		Cache& (const Cache&) = delete;
-
-		Cache& operator=(const Cache&) = delete;
-
-		virtual ~Cache();
-
-		struct Handle {};
-
-		virtual Handle* insert(const Slice &key,void *value,size_t charge,void (*deleter)(const Slice &key,void *value)) = 0;
-		
-		virtual Handle* lookUp(const Slice& key) = 0;
-
-		virtual void release(Handle *handle) = 0;
-
-		virtual void* value(Handle* handle) = 0;
-
-		virtual void erase(const Slice& key) = 0;
-
-		virtual uint64_t newId() = 0;
-
-		virtual void prune();
-
-		virtual size_t totalCharge() const = 0;
-
-	};
-}
-
+/*!
+ * \file Cache.h
+ *
+ * \author czy
+ * \date 2023.07.12
+ *
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include "CDataBase/Slice.h"
+
+namespace CDB{
+
+	class Cache;
+	class SecondaryCache;
+
+
+	Cache* newLRUCache(size_t  capacity);
+
+	/// an lru cache that demotes the entries it evicts to secondary and
+	/// looks there on a miss, the caller keeps ownership of secondary.
+	/// the high priority entries are evicted after the others unless they
+	/// take more than highPriPoolRatio of the capacity
+	Cache* newLRUCache(size_t capacity, SecondaryCache* secondary, double highPriPoolRatio = 0.5);
+
+	class Cache{
+	public:
+
+		Cache() = default;
+
+		Cache(const Cache&) = delete;
+
+		Cache& operator=(const Cache&) = delete;
+
+		virtual ~Cache();
+
+		struct Handle {};
+
+		enum Priority {
+			KHighPriority,
+			KLowPriority
+		};
+
+		/// callbacks that move an entry between the cache and a secondary
+		/// cache. saveTo writes the contents a value is rebuilt from, create
+		/// rebuilds a value from them and sets *charge, deleter frees it
+		struct CacheItemHelper {
+			void (*deleter)(const Slice& key, void* value);
+			void (*saveTo)(void* value, std::string* dst);
+			void* (*create)(const Slice& contents, size_t* charge);
+		};
+
+		virtual Handle* insert(const Slice &key,void *value,size_t charge,void (*deleter)(const Slice &key,void *value)) = 0;
+
+		/// insert an entry that can be demoted to the secondary cache when
+		/// it is evicted, helper must outlive the entry. a helper without
+		/// saveTo and create keeps the entry out of the secondary cache
+		virtual Handle* insert(const Slice& key, void* value, size_t charge, const CacheItemHelper* helper,
+			Priority priority = KLowPriority);
+
+		virtual Handle* lookUp(const Slice& key) = 0;
+
+		/// on a miss look the key up in the secondary cache and rebuild the
+		/// entry with helper, the rebuilt entry is inserted into this cache
+		virtual Handle* lookUp(const Slice& key, const CacheItemHelper* helper);
+
+		virtual void release(Handle *handle) = 0;
+
+		virtual void* value(Handle* handle) = 0;
+
+		virtual void erase(const Slice& key) = 0;
+
+		virtual uint64_t newId() = 0;
+
+		virtual void prune();
+
+		virtual size_t totalCharge() const = 0;
+
+	};
+}
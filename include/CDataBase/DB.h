@@ -1,79 +1,90 @@
-/*!
- * \file DB.h
- *
- * \author czy
- * \date 2023.07.12
- *
- * 
- */
-#pragma once
-#include<cstdint>
-#include<cstdio>
-#include "CDataBase/Iterator.h"
-#include "CDataBase/Options.h"
-
-namespace CDB{
-
-	static const int KMajirVersion = 1;
-	static const int KMinorVersion = 23;
-
-	struct Options;
-	struct ReadOptions;
-	struct WriteOptions;
-	struct WriteBatch;
-
-	class Snapshot{
-	protected:
-		virtual ~Snapshot();
-	};
-
-	struct Range {
-		Range() = default;
-		Range(const Slice& s, const Slice& l)
-			:start(s),limit(l)
-		{
-			
-		}
-		Slice start;
-		Slice limit;
-	};
-
-class DB{
-public:
-	static Status open(const Options& options, const std::string& name, DB** dbptr);
-	
-	DB() = default;
-	
-	DB(const DB&) = delete;
-	
-	DB& operator=(const DB&) = delete;
-	
-	virtual ~DB();
-
-	virtual Status put(const WriteOptions& options, const Slice& key, const Slice& value) = 0;
-	
-	virtual Status deleteK(const WriteOptions& opeions, const Slice& key, std::string* value) = 0;
-
-	virtual Status get(const ReadOptions& options, const Slice& key, std::string* value) = 0;
-
-	virtual Iterator* newIterator(const ReadOptions& options) = 0;
-
-	virtual const Snapshot* getSnapshot() = 0;
-
-	virtual void releaseSnapshot(const Snapshot* snapshot) = 0;
-
-	virtual bool getProperty(const Slice& property, std::string* value) = 0;
-
-	virtual void getApproximateSizes(const Range* rrange, int n, uint64_t* size) = 0;
-
-	virtual void compactRange(const Slice* begin, const Slice* end) = 0;
-
-};
-
-Status destoryDB(const std::string& name, const Options& options);
-
-Status repairDB(const std::string& dbname, const Options& options);
-
-
-
-}
+/*!
+ * \file DB.h
+ *
+ * \author czy
+ * \date 2023.07.12
+ *
+ * 
+ */
+#pragma once
+#include<cstdint>
+#include<cstdio>
+#include "CDataBase/Iterator.h"
+#include "CDataBase/Options.h"
+
+namespace CDB{
+
+	static const int KMajirVersion = 1;
+	static const int KMinorVersion = 23;
+
+	struct Options;
+	struct ReadOptions;
+	struct WriteOptions;
+	class WriteBatch;
+
+	class Snapshot{
+	protected:
+		virtual ~Snapshot();
+	};
+
+	struct Range {
+		Range() = default;
+		Range(const Slice& s, const Slice& l)
+			:start(s),limit(l)
+		{
+			
+		}
+		Slice start;
+		Slice limit;
+	};
+
+class DB{
+public:
+	static Status open(const Options& options, const std::string& name, DB** dbptr);
+	
+	DB() = default;
+	
+	DB(const DB&) = delete;
+	
+	DB& operator=(const DB&) = delete;
+	
+	virtual ~DB();
+
+	virtual Status put(const WriteOptions& options, const Slice& key, const Slice& value) = 0;
+	
+	virtual Status deleteK(const WriteOptions& opeions, const Slice& key, std::string* value) = 0;
+
+	// remove every entry in [begin, end) with a single range tombstone,
+	// no matter how many keys the range holds
+	virtual Status deleteRange(const WriteOptions& options, const Slice& begin, const Slice& end) = 0;
+
+	// apply value as an operand of Options::merge_operator to the current
+	// value of key without reading it first
+	virtual Status merge(const WriteOptions& options, const Slice& key, const Slice& value) = 0;
+
+	virtual Status get(const ReadOptions& options, const Slice& key, std::string* value) = 0;
+
+	virtual Iterator* newIterator(const ReadOptions& options) = 0;
+
+	virtual const Snapshot* getSnapshot() = 0;
+
+	virtual void releaseSnapshot(const Snapshot* snapshot) = 0;
+
+	// "cdb.mutex-stats" - contention counters of the db mutex, see Options::use_adaptive_mutex
+	// "cdb.estimate-table-readers-mem" - bytes of index and filter blocks held by the
+	//  open tables outside the block cache, see Options::cache_index_and_filter_blocks
+	virtual bool getProperty(const Slice& property, std::string* value) = 0;
+
+	virtual void getApproximateSizes(const Range* rrange, int n, uint64_t* size) = 0;
+
+	virtual void compactRange(const Slice* begin, const Slice* end) = 0;
+
+};
+
+Status destoryDB(const std::string& name, const Options& options);
+
+Status repairDB(const std::string& dbname, const Options& options);
+
+
+
+}
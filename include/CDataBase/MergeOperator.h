@@ -0,0 +1,77 @@
+/*!
+ * \file MergeOperator.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <string>
+#include <vector>
+#include "CDataBase/Slice.h"
+
+namespace CDB{
+
+	class Logger;
+
+	/*!
+	 * \class MergeOperator
+	 *
+	 * \brief folds the operands written with DB::merge into a value, the
+	 *  operands are kept as they are until a read or a compaction needs the
+	 *  result, so an update does not have to read the old value first
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class MergeOperator{
+	public:
+		virtual ~MergeOperator();
+
+		/// apply operands, oldest first, to existingValue, which is nullptr if
+		/// the key does not exist or was deleted. false marks the operands
+		/// as corrupt and fails the read or compaction
+		virtual bool fullMerge(const Slice& key, const Slice* existingValue,
+			const std::vector<Slice>& operands, std::string* newValue, Logger* logger) const = 0;
+
+		/// combine two neighbouring operands into one, left is the older one,
+		/// return false if they can only be applied to a value one by one
+		virtual bool partialMerge(const Slice& key, const Slice& leftOperand,
+			const Slice& rightOperand, std::string* newValue, Logger* logger) const;
+
+		virtual const char* name() const = 0;
+	};
+
+	/*!
+	 * \class AssociativeMergeOperator
+	 *
+	 * \brief a merge operator whose values and operands have the same type and
+	 *  where merging is associative, e.g. adding to a counter, implementations
+	 *  only provide the merge of two values
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class AssociativeMergeOperator : public MergeOperator{
+	public:
+		~AssociativeMergeOperator() override = default;
+
+		/// existingValue is nullptr if there is none
+		virtual bool merge(const Slice& key, const Slice* existingValue, const Slice& value,
+			std::string* newValue, Logger* logger) const = 0;
+
+		bool fullMerge(const Slice& key, const Slice* existingValue,
+			const std::vector<Slice>& operands, std::string* newValue, Logger* logger) const override;
+
+		bool partialMerge(const Slice& key, const Slice& leftOperand,
+			const Slice& rightOperand, std::string* newValue, Logger* logger) const override;
+	};
+
+	/// values are 8 byte little endian unsigned integers, operands are added to them
+	const MergeOperator* newUInt64AddOperator();
+
+	/// operands are appended to the value, separated by delim
+	const MergeOperator* newStringAppendOperator(char delim);
+
+}
@@ -1,86 +1,248 @@
-/*!
- * \file Options.h
- *
- * \author czy
- * \date 2023.07.11
- *
- * 
- */
-#pragma once
-#include <cstddef>
-namespace CDB
-{
-	class Cache;
-	class Comparator;
-	class Env;
-	class FilterPolicy;
-	class Logger;
-	class Snapshot;
-
-	enum CompressionType {
-		KNoCompression = 0x0,
-		KSnappyCompression = 0x1,
-		KZstdCompression = 0x2
-	};
-
-
-	struct Options {
-		Options();
-
-		const Comparator* comparator;
-
-		bool create_if_missing = false;
-
-		bool error_if_exists = false;
-
-		bool paranoid_checks = false;
-
-		Env* env;
-
-		Logger* infoLog = nullptr;
-
-		size_t write_buffer_size = 4 * 1024 * 1024;
-
-		int max_open_files = 1000;
-
-		Cache* block_cache = nullptr;
-
-		size_t block_size = 4 * 1024;
-
-		int block_restart_interval = 16;
-
-		size_t max_file_size = 2 * 1024 * 1024;
-
-		CompressionType  compression = KSnappyCompression;
-
-		int zstd_compression_level = 1;
-
-		bool reuse_logs = false;
-
-		const FilterPolicy* filter_policy = nullptr;
-
-
-	};
-
-	struct ReadOptions {
-		bool verify_checksums = false;
-		
-		bool fill_cache = true;
-		
-		const Snapshot* snapshot = nullptr;
-	};
-
-
-	struct WriteOptions {
-		WriteOptions() = default;
-
-		bool sync = false;
-	};
-
-
-
-
-
-}
-
-
+/*!
+ * \file Options.h
+ *
+ * \author czy
+ * \date 2023.07.11
+ *
+ * 
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <vector>
+namespace CDB
+{
+	class Cache;
+	class Comparator;
+	class Env;
+	class FilterPolicy;
+	class Logger;
+	class MergeOperator;
+	class Snapshot;
+	class TablePropertiesCollectorFactory;
+
+	enum CompressionType {
+		KNoCompression = 0x0,
+		KSnappyCompression = 0x1,
+		KZstdCompression = 0x2,
+		KLZ4Compression = 0x3,
+		// only for Options::bottommost_compression, not stored in a table
+		KDisableCompressionOption = 0xff
+	};
+
+	enum CompactionStyle {
+		// level based compaction style, every level holds a single sorted run
+		KCompactionStyleLevel = 0x0,
+		// size-tiered compaction style, sorted runs of similar size are merged
+		// together, trading space amplification for lower write amplification
+		KCompactionStyleUniversal = 0x1,
+		// files are never merged, the oldest ones are dropped as a whole
+		// once they expire or the total size is over budget
+		KCompactionStyleFIFO = 0x2
+	};
+
+	struct UniversalCompactionOptions {
+		// Percentage flexibility while comparing sorted run sizes. If the
+		// accumulated size of the candidate runs is within size_ratio percent
+		// of the next (older) run, that run is merged in as well.
+		unsigned int size_ratio = 1;
+
+		// The minimum number of sorted runs merged in a single compaction.
+		unsigned int min_merge_width = 2;
+
+		// The maximum number of sorted runs merged in a single compaction.
+		unsigned int max_merge_width = UINT_MAX;
+
+		// Space amplification is the size of all sorted runs except the oldest
+		// one divided by the size of the oldest run, in percent. Once it reaches
+		// this value every sorted run is merged into a single one.
+		unsigned int max_size_amplification_percent = 200;
+	};
+
+	struct FIFOCompactionOptions {
+		// Once the total size of the table files exceeds this many bytes the
+		// oldest files are deleted until it fits again.
+		uint64_t max_table_files_size = 1024 * 1024 * 1024;
+
+		// Files whose newest entry was written more than ttl seconds ago are
+		// deleted. 0 disables the time based expiry.
+		uint64_t ttl = 0;
+	};
+
+
+	struct Options {
+		Options();
+
+		const Comparator* comparator;
+
+		bool create_if_missing = false;
+
+		bool error_if_exists = false;
+
+		bool paranoid_checks = false;
+
+		Env* env;
+
+		Logger* infoLog = nullptr;
+
+		size_t write_buffer_size = 4 * 1024 * 1024;
+
+		// files the db may keep open, most of them tables held by the table
+		// cache. -1 keeps every table open once it has been read
+		int max_open_files = 1000;
+
+		// cache of the uncompressed data blocks, one built with newLRUCache(capacity,
+		// secondary) keeps the blocks it evicts compressed in the secondary cache
+		Cache* block_cache = nullptr;
+
+		// keep the index and filter blocks of the tables in block_cache,
+		// charged to its capacity, instead of in every open table
+		bool cache_index_and_filter_blocks = false;
+
+		// with cache_index_and_filter_blocks, insert them at high priority so
+		// the data blocks read by a scan do not push them out
+		bool cache_index_and_filter_blocks_with_high_priority = true;
+
+		// with cache_index_and_filter_blocks, the tables of level 0 still hold
+		// theirs, every get searches all of level 0
+		bool pin_l0_filter_and_index_blocks_in_cache = true;
+
+		size_t block_size = 4 * 1024;
+
+		// a table iterator that reads blocks one after another starts reading
+		// ahead of them, 8KB at first and doubling up to this many bytes. 0
+		// turns the readahead off
+		size_t max_auto_readahead_size = 256 * 1024;
+
+		// data blocks every input of a compaction keeps reading in the
+		// background ahead of the merge, 0 reads each when the merge needs it
+		int compaction_prefetch_blocks = 4;
+
+		// bytes of blocks the inputs of a compaction may have read ahead and
+		// not merged yet
+		size_t compaction_prefetch_memory = 16 * 1024 * 1024;
+
+		int block_restart_interval = 16;
+
+		size_t max_file_size = 2 * 1024 * 1024;
+
+		CompressionType  compression = KSnappyCompression;
+
+		int zstd_compression_level = 1;
+
+		// compression of the tables of each level, level i uses entry i and
+		// the levels past the end the last entry, empty uses compression for
+		// every level. the first levels are rewritten often and do best with
+		// a fast compression or none, the last ones with a strong one
+		std::vector<CompressionType> compression_per_level;
+
+		// zstd level of each level by the same rules, empty uses
+		// zstd_compression_level
+		std::vector<int> zstd_compression_level_per_level;
+
+		// compression of the tables written to the bottommost level, which
+		// holds most of the data. KDisableCompressionOption follows
+		// compression_per_level
+		CompressionType bottommost_compression = KDisableCompressionOption;
+
+		// zstd level of the bottommost tables, 0 follows the level
+		int bottommost_zstd_compression_level = 0;
+
+		// threads compressing the data blocks of a table being built, 1
+		// compresses them inline. the blocks are written in order as they
+		// are done, so the table is the same either way
+		int compression_parallel_threads = 1;
+
+		// with KZstdCompression, train a dictionary of at most this many bytes
+		// from the first data blocks of each table and compress its data
+		// blocks with it, small values compress much better with one. the
+		// dictionary is stored in the table. 0 disables it
+		uint32_t zstd_max_dict_bytes = 0;
+
+		// bytes of data blocks sampled for the dictionary, 0 means 100 times
+		// zstd_max_dict_bytes. they are held in memory until it is trained
+		uint64_t zstd_max_train_bytes = 0;
+
+		// keep obsolete logs and write the next logs over them. the files
+		// are already allocated on disk, so a sync does not have to update
+		// the file size as well. their records carry the log number so the
+		// old contents are told apart from the new
+		bool reuse_logs = false;
+
+		// at most this many obsolete logs are kept for reuse_logs
+		size_t recycle_log_file_num = 4;
+
+		// a write group appends to the log as soon as the previous group is
+		// logged, while the writers of the previous group still insert their
+		// batches into the memtable. a write returns once every earlier
+		// write is visible too
+		bool enable_pipelined_write = false;
+
+		// writes with WriteOptions::disable_memtable get a queue of their
+		// own, so they do not wait behind the memtable inserts of the others
+		bool two_write_queues = false;
+
+		// the db mutex spins briefly before it blocks, worth it when the
+		// critical sections are short and there are spare cores
+		bool use_adaptive_mutex = false;
+
+		const FilterPolicy* filter_policy = nullptr;
+
+		// required to use DB::merge, the operands of a key are folded by it
+		// when the key is read or compacted. not owned
+		const MergeOperator* merge_operator = nullptr;
+
+		// how sorted runs are picked for compaction, see CompactionStyle
+		CompactionStyle compaction_style = KCompactionStyleLevel;
+
+		// only used when compaction_style == KCompactionStyleUniversal
+		UniversalCompactionOptions compaction_options_universal;
+
+		// only used when compaction_style == KCompactionStyleFIFO
+		FIFOCompactionOptions compaction_options_fifo;
+
+		// a collector is created from each factory for every table file that is
+		// built, the factories are not owned and must outlive the database
+		std::vector<TablePropertiesCollectorFactory*> table_properties_collector_factories;
+
+
+	};
+
+	struct ReadOptions {
+		bool verify_checksums = false;
+		
+		bool fill_cache = true;
+		
+		const Snapshot* snapshot = nullptr;
+
+		// bytes the table iterators read ahead of the block they need, 0
+		// grows the readahead from 8KB up to max_auto_readahead_size once the
+		// reads are sequential. for long scans and compactions
+		size_t readahead_size = 0;
+	};
+
+
+	struct WriteOptions {
+		WriteOptions() = default;
+
+		bool sync = false;
+
+		// return once the batch is in the log, the memtable insert runs in
+		// the background. the batch is not readable yet when the write
+		// returns, but is recovered from the log after a crash like any
+		// other. for bulk ingest that does not read its own writes
+		bool unordered = false;
+
+		// only log the batch, it is not inserted into the memtable and is
+		// read back by the log replay on the next open
+		bool disable_memtable = false;
+	};
+
+
+
+
+
+}
+
+
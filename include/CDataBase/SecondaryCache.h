@@ -0,0 +1,75 @@
+/*!
+ * \file SecondaryCache.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <string>
+#include "CDataBase/Options.h"
+#include "CDataBase/Slice.h"
+#include "CDataBase/Status.h"
+
+namespace CDB{
+
+	class Env;
+	class SecondaryCache;
+
+	/// a secondary cache that keeps the contents in memory compressed with
+	/// type, KLZ4Compression decompresses in about a microsecond. contents
+	/// that do not compress or a type that is not built in are kept as is
+	SecondaryCache* newCompressedSecondaryCache(size_t capacity,
+		CompressionType type = KLZ4Compression);
+
+	/// a secondary cache kept in files under dir, meant for a local ssd in
+	/// front of slow table storage. the files take at most about capacity
+	/// bytes and the index is checkpointed to dir, so a cache opened again
+	/// on the same dir starts with the entries of the last run. a table
+	/// caches its data blocks under the unique id stored in its file, so an
+	/// entry of the last run is only found by the table it came from
+	Status newPersistentCache(Env* env, const std::string& dir, uint64_t capacity,
+		SecondaryCache** result);
+
+	/*!
+	 * \class SecondaryCache
+	 *
+	 * \brief the tier behind a Cache, it holds the entries the cache evicted
+	 *  as plain bytes so a miss in the cache can be served without reading
+	 *  the file. must be thread safe
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class SecondaryCache{
+	public:
+		SecondaryCache() = default;
+
+		SecondaryCache(const SecondaryCache&) = delete;
+
+		SecondaryCache& operator=(const SecondaryCache&) = delete;
+
+		virtual ~SecondaryCache();
+
+		virtual const char* name() const = 0;
+
+		/// keep a copy of contents under key. the contents of a key are not
+		/// expected to change, a cache may keep the copy it already has
+		virtual void insert(const Slice& key, const Slice& contents) = 0;
+
+		/// on a hit fill *contents and return true
+		virtual bool lookUp(const Slice& key, std::string* contents) = 0;
+
+		virtual void erase(const Slice& key) = 0;
+
+		/// true if an entry stays here when a lookUp moves it into the cache,
+		/// the cache then leaves it in place instead of erasing it
+		virtual bool keepsPromotedEntries() const { return false; }
+
+		/// memory used by the stored contents
+		virtual size_t totalCharge() const = 0;
+	};
+
+}
@@ -1,13 +1,13 @@
-/*!
- * \file Slice.h
- *
- * \author czy
- * \date 2023.07.07
- *
- * 
- */
-#pragma once
-#include<string_view>
-namespace CDB {
-	using Slice = std::string_view;
+/*!
+ * \file Slice.h
+ *
+ * \author czy
+ * \date 2023.07.07
+ *
+ * 
+ */
+#pragma once
+#include<string_view>
+namespace CDB {
+	using Slice = std::string_view;
 }
\ No newline at end of file
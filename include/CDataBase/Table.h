@@ -1,60 +1,136 @@
-/*!
- * \file Table.h
- *
- * \author czy
- * \date 2023.07.12
- *
- * 
- */
-#pragma once
-#include <cstdint>
-#include "CDataBase/Iterator.h"
-
-namespace CDB{
-
-class Block;
-class BlockHandle;
-class Footer;
-struct Options;
-class RandomAccessFile;
-struct ReadOptions;
-class TableCache;
-		
-
-class Table{
-public:
-	static Status open(const Options &options,RandomAccessFile *file,uint64_t fileSize,Table **table);
-	
-	Table(const Table&) = delete;
-
-	Table& operator=(const Table&) = delete;
-
-	~Table();
-
-	Iterator* newIterator(const ReadOptions&) const;
-
-	uint64_t ApproximateOffsetOf(const Slice& key) const;
-
-private:
-	friend class TableCache;
-	
-	struct Rep;
-	
-	struct Iterator* BlockReader(void*, const ReadOptions&, const Slice&);
-	
-	explicit Table(Rep * rep):rep_(rep){}
-	
-	Status InternalGet(const ReadOptions&, const Slice& key, void* arg,
-		void (*handle_result) (void* arg, const Slice& k, const Slice& v));
-
-	void readMeta(const Footer & footer);
-
-	void readFilter(const Slice& filterHandleValue);
-
-private:
-	Rep* const rep_;
-};
-
-
-
-}
+/*!
+ * \file Table.h
+ *
+ * \author czy
+ * \date 2023.07.12
+ *
+ *
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "CDataBase/Cache.h"
+#include "CDataBase/Iterator.h"
+
+namespace CDB{
+
+class Block;
+class BlockHandle;
+class BlockPrefetcher;
+class FilterBlockReader;
+class Footer;
+class FragmentedRangeTombstoneList;
+struct Options;
+class RandomAccessFile;
+struct ReadOptions;
+class TableCache;
+
+
+/*!
+ * \class Table
+ *
+ * \brief a sorted map from strings to strings stored in a file, immutable
+ *  and safe to read from many threads
+ *
+ * \author czy
+ * \date 2026.10.19
+ */
+class Table{
+public:
+	/// open the table stored in bytes [0..fileSize) of file. only the
+	/// footer is read here, the index and the filter block are read the
+	/// first time the table is searched. file must stay live while the
+	/// table is, the caller deletes *table when done
+	static Status open(const Options &options,RandomAccessFile *file,uint64_t fileSize,Table **table);
+
+	Table(const Table&) = delete;
+
+	Table& operator=(const Table&) = delete;
+
+	~Table();
+
+	/// the result is initially invalid, the caller must call one of the seek
+	/// methods on it before using it
+	Iterator* newIterator(const ReadOptions&) const;
+
+	/// approximate offset in the file of the data for key, or of where it
+	/// would be
+	uint64_t approximateOffsetOf(const Slice& key) const;
+
+	/// true once the index and the filter block are in memory
+	bool indexLoaded() const;
+
+	/// bytes of the index and filter blocks held by the table, the ones
+	/// in the block cache are not counted
+	uint64_t pinnedMemoryUsage() const;
+
+	/// the range tombstones of the table, nullptr if it has none or its
+	/// keys are not internal keys. they are read with the meta blocks
+	Status rangeTombstones(std::shared_ptr<const FragmentedRangeTombstoneList>* tombstones) const;
+
+private:
+	friend class TableCache;
+
+	struct Rep;
+
+	// how an iterator from newIterator reads ahead
+	struct IterState;
+
+	static Iterator* blockReader(void*, const ReadOptions&, const Slice&);
+
+	/// blockReader of the iterators from newIterator, arg is their IterState
+	static Iterator* prefetchingBlockReader(void*, const ReadOptions&, const Slice&);
+
+	/// an iterator over the data block of indexValue, read through state
+	/// unless it is null
+	Iterator* readDataBlock(const ReadOptions&, const Slice& indexValue, IterState* state) const;
+
+	/// newIterator with the data blocks read ahead by prefetcher, for the
+	/// inputs of a compaction
+	Iterator* newIterator(const ReadOptions&, BlockPrefetcher* prefetcher) const;
+
+	explicit Table(Rep * rep):rep_(rep){}
+
+	/// call handleResult with the entry found by seeking to key, unless the
+	/// filter rules the key out. an entry older than a range tombstone of
+	/// the table covering key is reported as a deletion at the tombstone's
+	/// sequence number, as is a covered key with no entry
+	Status internalGet(const ReadOptions&, const Slice& key, void* arg,
+		void (*handleResult) (void* arg, const Slice& k, const Slice& v));
+
+	/// read the meta blocks once, and the index and the filter too unless
+	/// they are kept in the block cache
+	Status loadIndex() const;
+
+	/// hold the index and the filter in the table even if they are kept in
+	/// the block cache
+	Status pinIndexAndFilter() const;
+
+	Status pinIndexAndFilterLocked() const;
+
+	/// the index block, *handle is set if it is in the block cache and must
+	/// be released
+	Status indexBlock(Block** block, Cache::Handle** handle) const;
+
+	/// the filter, nullptr if there is none, *handle as for indexBlock
+	FilterBlockReader* filter(Cache::Handle** handle) const;
+
+	/// add the pinned bytes of this table to *counter from now on
+	void setMemoryCounter(std::atomic<uint64_t>* counter);
+
+	/// a filter that cannot be read is done without, the meta index or a
+	/// range tombstone block that cannot be read fails the load since reads
+	/// would miss the deletions
+	Status readMeta(const Footer & footer) const;
+
+	/// read the filter block, *data is set if the caller must delete[] it
+	FilterBlockReader* readFilter(const char** data) const;
+
+private:
+	Rep* const rep_;
+};
+
+
+
+}
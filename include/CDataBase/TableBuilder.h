@@ -1,62 +1,91 @@
-/*!
- * \file TableBuilder.h
- *
- * \author czy
- * \date 2023.07.12
- *
- * 
- * 
- */
-#pragma once
-#include <cstdint>
-#include "CDataBase/Options.h"
-#include "CDataBase/Status.h"
-namespace CDB{
-	class BlockBuilder;
-
-	class BlockHandle;
-
-	class WritableFile;
-
-class TableBuilder {
-
-public:
-	TableBuilder(const Options& options, WritableFile* file);
-
-	TableBuilder(const TableBuilder&) = delete;
-
-	TableBuilder& operator=(const TableBuilder&) = delete;
-
-	~TableBuilder();
-
-	Status changeOptions(const Options& options);
-
-	void add(const Slice& key, const Slice& value);
-
-	void flush();
-
-	Status status() const;
-
-	Status finish();
-
-	void abandon();
-
-	uint64_t numEntires() const;
-
-	uint64_t fileSize() const;
-
-private:
-	
-	bool ok() const { return status().ok(); }
-
-	void writeBlock(BlockBuilder* block, BlockHandle* handle);
-
-	void writeRawBlock(const Slice& data, CompressionType, BlockHandle* handle);
-
-	struct Rep;
-
-	Rep* rep_;
-};
-		
-
-}
+/*!
+ * \file TableBuilder.h
+ *
+ * \author czy
+ * \date 2023.07.12
+ *
+ * 
+ * 
+ */
+#pragma once
+#include <cstdint>
+#include "CDataBase/Options.h"
+#include "CDataBase/Status.h"
+#include "CDataBase/TableProperties.h"
+namespace CDB{
+	class BlockBuilder;
+
+	class BlockHandle;
+
+	class WritableFile;
+
+class TableBuilder {
+
+public:
+	TableBuilder(const Options& options, WritableFile* file);
+
+	TableBuilder(const TableBuilder&) = delete;
+
+	TableBuilder& operator=(const TableBuilder&) = delete;
+
+	~TableBuilder();
+
+	Status changeOptions(const Options& options);
+
+	void add(const Slice& key, const Slice& value);
+
+	// add a range tombstone deleting [begin of key, end), key is the internal
+	// key of the begin key, tombstones are added in key order and stored in
+	// their own meta block
+	void addRangeTombstone(const Slice& key, const Slice& end);
+
+	void flush();
+
+	Status status() const;
+
+	Status finish();
+
+	void abandon();
+
+	uint64_t numEntires() const;
+
+	// an estimate while data blocks are held back for the compression dictionary
+	uint64_t fileSize() const;
+
+	// statistics of the entries added so far, complete once finish() returned
+	const TableProperties& getTableProperties() const;
+
+	// true if a properties collector asked for the file to be compacted
+	bool needCompact() const;
+
+private:
+	
+	bool ok() const { return status().ok(); }
+
+	void writeBlock(BlockBuilder* block, BlockHandle* handle);
+
+	// compress raw with options.compression and write it, data blocks use
+	// the dictionary of the table if there is one
+	void compressAndWrite(const Slice& raw, bool dataBlock, BlockHandle* handle);
+
+	// train the dictionary from the data blocks held back and write them
+	void unbufferBlocks();
+
+	// hand the data block to the compression threads
+	void scheduleCompression(const Slice& raw);
+
+	// write the compressed blocks at the front of the queue that have their
+	// index key, wait selects whether to wait for the ones still compressing
+	void writeCompressedBlocks(bool wait);
+
+	void writeRawBlock(const Slice& data, CompressionType, BlockHandle* handle);
+
+	void collectProperties(const Slice& key, const Slice& value);
+
+	struct Rep;
+
+	Rep* rep_;
+};
+		
+
+}
@@ -0,0 +1,127 @@
+/*!
+ * \file TableProperties.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include "CDataBase/Slice.h"
+#include "CDataBase/Status.h"
+
+namespace CDB{
+
+	class RandomAccessFile;
+
+	// properties added by the collectors, name -> encoded value
+	using UserCollectedProperties = std::map<std::string, std::string>;
+
+	/// statistics of a table file, computed while the table is built and
+	/// stored in its "cdb.properties" meta block
+	struct TableProperties {
+		// number of entries in the table, deletions included
+		uint64_t num_entries = 0;
+		// number of deletion markers
+		uint64_t num_deletions = 0;
+		// number of merge operands
+		uint64_t num_merge_operands = 0;
+		// number of range tombstones, they are not counted in num_entries
+		uint64_t num_range_deletions = 0;
+		// total size of the keys and the values as they were added
+		uint64_t raw_key_size = 0;
+		uint64_t raw_value_size = 0;
+		// on-disk size of the data, index and filter blocks
+		uint64_t data_size = 0;
+		uint64_t index_size = 0;
+		uint64_t filter_size = 0;
+		uint64_t num_data_blocks = 0;
+		// seconds since the epoch when the table was built
+		uint64_t creation_time = 0;
+		// sequence number range of the entries, only set for internal keys
+		uint64_t smallest_seqno = 0;
+		uint64_t largest_seqno = 0;
+		// smallest and largest user keys of the table
+		std::string smallest_key;
+		std::string largest_key;
+		// the compression of the data blocks, see compressionTypeName
+		std::string compression_name;
+		// size of the zstd dictionary the data blocks were compressed with, 0 if none
+		uint64_t compression_dict_size = 0;
+
+		UserCollectedProperties user_collected_properties;
+
+		std::string toString() const;
+	};
+
+	enum EntryType {
+		KEntryPut = 0x0,
+		KEntryDelete = 0x1,
+		KEntryMerge = 0x2,
+		KEntryOther = 0x3
+	};
+
+	/*!
+	 * \class TablePropertiesCollector
+	 *
+	 * \brief sees every entry added to a table and contributes its own
+	 *  properties to the properties block when the table is finished,
+	 *  one collector is created for each table file
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class TablePropertiesCollector{
+	public:
+		virtual ~TablePropertiesCollector() = default;
+
+		/// called for every entry in key order, key is the user key
+		/// and fileSize the current size of the table file
+		virtual Status addUserKey(const Slice& key, const Slice& value, EntryType type,
+			uint64_t seq, uint64_t fileSize) = 0;
+
+		/// called once when the table is finished, the collected properties
+		/// are stored along with the table properties
+		virtual Status finish(UserCollectedProperties* properties) = 0;
+
+		virtual const char* name() const = 0;
+
+		/// true if the entries seen so far ask for the file to be compacted soon
+		virtual bool needCompact() const { return false; }
+	};
+
+	class TablePropertiesCollectorFactory{
+	public:
+		virtual ~TablePropertiesCollectorFactory() = default;
+
+		/// the caller owns the result
+		virtual TablePropertiesCollector* createTablePropertiesCollector() = 0;
+
+		virtual const char* name() const = 0;
+	};
+
+	/// the collectors mark a file for compaction once any window of
+	/// slidingWindowSize consecutive entries holds at least deletionTrigger
+	/// deletions, or, if deletionRatio > 0, once the deletions make up at
+	/// least that fraction of all entries in the file
+	TablePropertiesCollectorFactory* newCompactOnDeletionCollectorFactory(
+		size_t slidingWindowSize, size_t deletionTrigger, double deletionRatio = 0);
+
+	// the user property those collectors store, "1" if the file asked to be
+	// compacted and "0" otherwise
+	static const char KNeedCompactProperty[] = "cdb.compact-on-deletion.need-compact";
+
+	/// true if the table asked to be compacted when it was written, lets a
+	/// file read back on open be marked for compaction again
+	bool tableNeedsCompaction(const TableProperties& properties);
+
+	/// read the properties block of the table stored in file,
+	/// NotFound if the table was written without one
+	Status readTableProperties(RandomAccessFile* file, uint64_t fileSize,
+		TableProperties* properties);
+
+}
@@ -1,58 +1,88 @@
-/*!
- * \file WriteBatch.h
- *
- * \author czy
- * \date 2023.07.12
- *
- * 
- */
-#pragma once
-#include <string>
-#include "CDataBase/Status.h"
-
-namespace CDB{
-	class Slice;
-
-
-	class WriteBatch{
-	public:
-		class Handler{
-		public:
-		
-		virtual ~Handler();
-
-		virtual void put(const Slice& key, const Slice& value) = 0;
-
-		virtual void delete(const Slice& key) = 0;
-
-
-
-		};
-
-		WriteBatch();
-
-		WriteBatch(const WriteBatch&) = default;
-
-		WriteBatch& operator=(const WriteBatch&) = default;
-
-		~WriteBatch();
-
-		void put(const Slice& key, const Slice& value);
-
-		void deleteK(const Slice& key);
-
-		void clear();
-
-		size_t approximateSize() const;
-
-		void append(const WriteBatch& source);
-
-		Status iterate(Handler* handler) const;
-	
-	private:
-		friend class WriteBatchInternal;
-
-		std::string rep_;
-	};
-
-}
+/*!
+ * \file WriteBatch.h
+ *
+ * \author czy
+ * \date 2023.07.12
+ *
+ * 
+ */
+#pragma once
+#include <string>
+#include "CDataBase/Slice.h"
+#include "CDataBase/Status.h"
+
+namespace CDB{
+
+
+	class WriteBatch{
+	public:
+		class Handler{
+		public:
+		
+		virtual ~Handler();
+
+		virtual void put(const Slice& key, const Slice& value) = 0;
+
+		virtual void deleteK(const Slice& key) = 0;
+
+		virtual void deleteRange(const Slice& begin, const Slice& end) = 0;
+
+		virtual void merge(const Slice& key, const Slice& value) = 0;
+
+		};
+
+		WriteBatch();
+
+		/// reserve room for reservedBytes of records up front, a batch whose
+		/// size is known then never reallocates while it is built
+		explicit WriteBatch(size_t reservedBytes);
+
+		/// build the batch in the storage of buffer, whose contents are
+		/// discarded. a buffer taken back with release() can be handed to the
+		/// next batch so its capacity is reused
+		explicit WriteBatch(std::string&& buffer);
+
+		WriteBatch(const WriteBatch&) = default;
+
+		WriteBatch& operator=(const WriteBatch&) = default;
+
+		/// the source is left empty
+		WriteBatch(WriteBatch&& other) noexcept;
+
+		WriteBatch& operator=(WriteBatch&& other) noexcept;
+
+		~WriteBatch();
+
+		void put(const Slice& key, const Slice& value);
+
+		void deleteK(const Slice& key);
+
+		// delete every key in [begin, end), a single range tombstone is
+		// written instead of one tombstone per key
+		void deleteRange(const Slice& begin, const Slice& end);
+
+		// record value as a merge operand of key, see Options::merge_operator
+		void merge(const Slice& key, const Slice& value);
+
+		void clear();
+
+		size_t approximateSize() const;
+
+		void reserve(size_t bytes);
+
+		size_t capacity() const;
+
+		/// give up the encoded batch without copying it, the batch is left empty
+		std::string release();
+
+		void append(const WriteBatch& source);
+
+		Status iterate(Handler* handler) const;
+	
+	private:
+		friend class WriteBatchInternal;
+
+		std::string rep_;
+	};
+
+}
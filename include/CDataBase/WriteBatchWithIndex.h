@@ -0,0 +1,83 @@
+/*!
+ * \file WriteBatchWithIndex.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <string>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Iterator.h"
+#include "CDataBase/Slice.h"
+#include "CDataBase/Status.h"
+
+namespace CDB{
+
+	class DB;
+	class MergeOperator;
+	class WriteBatch;
+	struct ReadOptions;
+
+	/*!
+	 * \class WriteBatchWithIndex
+	 *
+	 * \brief a WriteBatch with a sorted index over its records, so the writes
+	 *  can be read back before the batch is applied. the index is a skiplist
+	 *  of offsets into the batch, allocated from an arena, a key that is
+	 *  written several times keeps every record and reads see the newest.
+	 *  range deletions are not indexed and can not be added
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class WriteBatchWithIndex{
+	public:
+		/// comparator orders the keys like the db the batch is read with,
+		/// mergeOperator folds the merge operands of the batch, not owned
+		explicit WriteBatchWithIndex(const Comparator* comparator = byteWiseComparator(),
+			const MergeOperator* mergeOperator = nullptr);
+
+		WriteBatchWithIndex(const WriteBatchWithIndex&) = delete;
+
+		WriteBatchWithIndex& operator=(const WriteBatchWithIndex&) = delete;
+
+		~WriteBatchWithIndex();
+
+		void put(const Slice& key, const Slice& value);
+
+		void deleteK(const Slice& key);
+
+		void merge(const Slice& key, const Slice& value);
+
+		void clear();
+
+		/// the batch to pass to the db, it must not be modified directly
+		WriteBatch* getWriteBatch();
+
+		/// the value key has in the batch, NotFound if the batch does not set it
+		/// or deletes it, NotSupported if it only holds merge operands for it
+		Status getFromBatch(const Slice& key, std::string* value) const;
+
+		/// the value key has once the batch is applied to db
+		Status getFromBatchAndDB(DB* db, const ReadOptions& options, const Slice& key,
+			std::string* value) const;
+
+		/// iterate over baseIterator, an iterator over the user keys of the db,
+		/// as if the batch was applied to it. takes ownership of baseIterator.
+		/// keys and values returned by the iterator are invalidated by writes
+		/// to the batch
+		Iterator* newIteratorWithBase(Iterator* baseIterator) const;
+
+		/// iterate over the writes of the batch only
+		Iterator* newIterator() const;
+
+		// defined in WriteBatchWithIndex.cc
+		struct Rep;
+
+	private:
+		Rep* rep_;
+	};
+
+}
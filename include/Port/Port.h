@@ -1,159 +1,400 @@
-/*!
- * \file Port.h
- *
- * \author czy
- * \date 2023.08.07
- *
- * 
- */
-#pragma once
-
-#if __has_include("Port/PortConfig.h")
-#include "Port/portConfig.h"
-#endif  // __has_include("port/port_config.h")
-
-
-#if HAVE_CRC32C
-#include <crc32c/crc32c.h>
-#endif  // HAVE_CRC32C
-#if HAVE_SNAPPY
-#include <snappy.h>
-#endif  // HAVE_SNAPPY
-#if HAVE_ZSTD
-#define ZSTD_STATIC_LINKING_ONLY  // For ZSTD_compressionParameters.
-#include <zstd.h>
-#endif  // HAVE_ZSTD
-namespace CDB{
-	namespace port{
-		inline bool Snappy_Compress(const char* input, size_t length,
-			std::string* output) {
-#if HAVE_SNAPPY
-			output->resize(snappy::MaxCompressedLength(length));
-			size_t outlen;
-			snappy::RawCompress(input, length, &(*output)[0], &outlen);
-			output->resize(outlen);
-			return true;
-#else
-			// Silence compiler warnings about unused arguments.
-			(void)input;
-			(void)length;
-			(void)output;
-#endif  // HAVE_SNAPPY
-
-			return false;
-		}
-
-		inline bool Snappy_GetUncompressedLength(const char* input, size_t length,
-			size_t* result) {
-#if HAVE_SNAPPY
-			return snappy::GetUncompressedLength(input, length, result);
-#else
-			// Silence compiler warnings about unused arguments.
-			(void)input;
-			(void)length;
-			(void)result;
-			return false;
-#endif  // HAVE_SNAPPY
-		}
-
-		inline bool Snappy_Uncompress(const char* input, size_t length, char* output) {
-#if HAVE_SNAPPY
-			return snappy::RawUncompress(input, length, output);
-#else
-			// Silence compiler warnings about unused arguments.
-			(void)input;
-			(void)length;
-			(void)output;
-			return false;
-#endif  // HAVE_SNAPPY
-		}
-
-		inline bool Zstd_Compress(int level, const char* input, size_t length,
-			std::string* output) {
-#if HAVE_ZSTD
-			// Get the MaxCompressedLength.
-			size_t outlen = ZSTD_compressBound(length);
-			if (ZSTD_isError(outlen)) {
-				return false;
-			}
-			output->resize(outlen);
-			ZSTD_CCtx* ctx = ZSTD_createCCtx();
-			ZSTD_compressionParameters parameters =
-				ZSTD_getCParams(level, std::max(length, size_t{ 1 }), /*dictSize=*/0);
-			ZSTD_CCtx_setCParams(ctx, parameters);
-			outlen = ZSTD_compress2(ctx, &(*output)[0], output->size(), input, length);
-			ZSTD_freeCCtx(ctx);
-			if (ZSTD_isError(outlen)) {
-				return false;
-			}
-			output->resize(outlen);
-			return true;
-#else
-			// Silence compiler warnings about unused arguments.
-			(void)level;
-			(void)input;
-			(void)length;
-			(void)output;
-			return false;
-#endif  // HAVE_ZSTD
-		}
-
-		inline bool Zstd_GetUncompressedLength(const char* input, size_t length,
-			size_t* result) {
-#if HAVE_ZSTD
-			size_t size = ZSTD_getFrameContentSize(input, length);
-			if (size == 0) return false;
-			*result = size;
-			return true;
-#else
-			// Silence compiler warnings about unused arguments.
-			(void)input;
-			(void)length;
-			(void)result;
-			return false;
-#endif  // HAVE_ZSTD
-		}
-
-		inline bool Zstd_Uncompress(const char* input, size_t length, char* output) {
-#if HAVE_ZSTD
-			size_t outlen;
-			if (!Zstd_GetUncompressedLength(input, length, &outlen)) {
-				return false;
-			}
-			ZSTD_DCtx* ctx = ZSTD_createDCtx();
-			outlen = ZSTD_decompressDCtx(ctx, output, outlen, input, length);
-			ZSTD_freeDCtx(ctx);
-			if (ZSTD_isError(outlen)) {
-				return false;
-			}
-			return true;
-#else
-			// Silence compiler warnings about unused arguments.
-			(void)input;
-			(void)length;
-			(void)output;
-			return false;
-#endif  // HAVE_ZSTD
-		}
-
-		inline bool GetHeapProfile(void (*func)(void*, const char*, int), void* arg) {
-			// Silence compiler warnings about unused arguments.
-			(void)func;
-			(void)arg;
-			return false;
-		}
-
-		inline uint32_t AcceleratedCRC32C(uint32_t crc, const char* buf, size_t size) {
-#if HAVE_CRC32C
-			return ::crc32c::Extend(crc, reinterpret_cast<const uint8_t*>(buf), size);
-#else
-			// Silence compiler warnings about unused arguments.
-			(void)crc;
-			(void)buf;
-			(void)size;
-			return 0;
-#endif  // HAVE_CRC32C
-		}
-
-	}
+/*!
+ * \file Port.h
+ *
+ * \author czy
+ * \date 2023.08.07
+ *
+ * 
+ */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if __has_include("Port/PortConfig.h")
+#include "Port/PortConfig.h"
+#endif  // __has_include("port/port_config.h")
+
+
+#if HAVE_CRC32C
+#include <crc32c/crc32c.h>
+#endif  // HAVE_CRC32C
+#if HAVE_SNAPPY
+#include <snappy.h>
+#endif  // HAVE_SNAPPY
+#if HAVE_LZ4
+#include <lz4.h>
+#endif  // HAVE_LZ4
+#if HAVE_ZSTD
+#define ZSTD_STATIC_LINKING_ONLY  // For ZSTD_compressionParameters.
+#include <zstd.h>
+#include <zdict.h>
+#endif  // HAVE_ZSTD
+namespace CDB{
+	namespace port{
+		inline bool Snappy_Compress(const char* input, size_t length,
+			std::string* output) {
+#if HAVE_SNAPPY
+			output->resize(snappy::MaxCompressedLength(length));
+			size_t outlen;
+			snappy::RawCompress(input, length, &(*output)[0], &outlen);
+			output->resize(outlen);
+			return true;
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)input;
+			(void)length;
+			(void)output;
+#endif  // HAVE_SNAPPY
+
+			return false;
+		}
+
+		inline bool Snappy_GetUncompressedLength(const char* input, size_t length,
+			size_t* result) {
+#if HAVE_SNAPPY
+			return snappy::GetUncompressedLength(input, length, result);
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)input;
+			(void)length;
+			(void)result;
+			return false;
+#endif  // HAVE_SNAPPY
+		}
+
+		inline bool Snappy_Uncompress(const char* input, size_t length, char* output) {
+#if HAVE_SNAPPY
+			return snappy::RawUncompress(input, length, output);
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)input;
+			(void)length;
+			(void)output;
+			return false;
+#endif  // HAVE_SNAPPY
+		}
+
+		// lz4 does not store the uncompressed length, it is put in front as a
+		// little endian fixed32
+		inline bool LZ4_Compress(const char* input, size_t length, std::string* output) {
+#if HAVE_LZ4
+			if (length > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+				return false;
+			}
+			const int bound = LZ4_compressBound(static_cast<int>(length));
+			output->resize(4 + bound);
+			for (int i = 0; i < 4; ++i) {
+				(*output)[i] = static_cast<char>((length >> (8 * i)) & 0xff);
+			}
+			const int outlen = LZ4_compress_default(input, &(*output)[4], static_cast<int>(length), bound);
+			if (outlen <= 0) {
+				return false;
+			}
+			output->resize(4 + outlen);
+			return true;
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)input;
+			(void)length;
+			(void)output;
+			return false;
+#endif  // HAVE_LZ4
+		}
+
+		inline bool LZ4_GetUncompressedLength(const char* input, size_t length, size_t* result) {
+#if HAVE_LZ4
+			if (length < 4) {
+				return false;
+			}
+			const unsigned char* p = reinterpret_cast<const unsigned char*>(input);
+			*result = static_cast<size_t>(p[0]) | (static_cast<size_t>(p[1]) << 8) |
+				(static_cast<size_t>(p[2]) << 16) | (static_cast<size_t>(p[3]) << 24);
+			return true;
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)input;
+			(void)length;
+			(void)result;
+			return false;
+#endif  // HAVE_LZ4
+		}
+
+		inline bool LZ4_Uncompress(const char* input, size_t length, char* output) {
+#if HAVE_LZ4
+			size_t outlen;
+			if (!LZ4_GetUncompressedLength(input, length, &outlen)) {
+				return false;
+			}
+			const int n = LZ4_decompress_safe(input + 4, output, static_cast<int>(length - 4),
+				static_cast<int>(outlen));
+			return n >= 0 && static_cast<size_t>(n) == outlen;
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)input;
+			(void)length;
+			(void)output;
+			return false;
+#endif  // HAVE_LZ4
+		}
+
+		inline bool Zstd_Compress(int level, const char* input, size_t length,
+			std::string* output) {
+#if HAVE_ZSTD
+			// Get the MaxCompressedLength.
+			size_t outlen = ZSTD_compressBound(length);
+			if (ZSTD_isError(outlen)) {
+				return false;
+			}
+			output->resize(outlen);
+			ZSTD_CCtx* ctx = ZSTD_createCCtx();
+			ZSTD_compressionParameters parameters =
+				ZSTD_getCParams(level, std::max(length, size_t{ 1 }), /*dictSize=*/0);
+			ZSTD_CCtx_setCParams(ctx, parameters);
+			outlen = ZSTD_compress2(ctx, &(*output)[0], output->size(), input, length);
+			ZSTD_freeCCtx(ctx);
+			if (ZSTD_isError(outlen)) {
+				return false;
+			}
+			output->resize(outlen);
+			return true;
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)level;
+			(void)input;
+			(void)length;
+			(void)output;
+			return false;
+#endif  // HAVE_ZSTD
+		}
+
+		inline bool Zstd_GetUncompressedLength(const char* input, size_t length,
+			size_t* result) {
+#if HAVE_ZSTD
+			unsigned long long size = ZSTD_getFrameContentSize(input, length);
+			if (size == 0 || size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR) {
+				return false;
+			}
+			*result = size;
+			return true;
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)input;
+			(void)length;
+			(void)result;
+			return false;
+#endif  // HAVE_ZSTD
+		}
+
+		inline bool Zstd_Uncompress(const char* input, size_t length, char* output) {
+#if HAVE_ZSTD
+			size_t outlen;
+			if (!Zstd_GetUncompressedLength(input, length, &outlen)) {
+				return false;
+			}
+			ZSTD_DCtx* ctx = ZSTD_createDCtx();
+			outlen = ZSTD_decompressDCtx(ctx, output, outlen, input, length);
+			ZSTD_freeDCtx(ctx);
+			if (ZSTD_isError(outlen)) {
+				return false;
+			}
+			return true;
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)input;
+			(void)length;
+			(void)output;
+			return false;
+#endif  // HAVE_ZSTD
+		}
+
+		// the dictionary of a table digested once for all its data blocks,
+		// digesting it again for every block costs more than the block. a
+		// dictionary can be shared by threads compressing at the same time
+		class ZstdCompressionDict {
+		public:
+			ZstdCompressionDict(int level, const char* dict, size_t dictSize) {
+#if HAVE_ZSTD
+				dict_ = ZSTD_createCDict(dict, dictSize, level);
+#else
+				// Silence compiler warnings about unused arguments.
+				(void)level;
+				(void)dict;
+				(void)dictSize;
+#endif  // HAVE_ZSTD
+			}
+
+			ZstdCompressionDict(const ZstdCompressionDict&) = delete;
+
+			ZstdCompressionDict& operator=(const ZstdCompressionDict&) = delete;
+
+			~ZstdCompressionDict() {
+#if HAVE_ZSTD
+				ZSTD_freeCDict(dict_);
+#endif  // HAVE_ZSTD
+			}
+
+#if HAVE_ZSTD
+			const ZSTD_CDict* get() const { return dict_; }
+
+		private:
+			ZSTD_CDict* dict_;
+#endif  // HAVE_ZSTD
+		};
+
+		class ZstdUncompressionDict {
+		public:
+			ZstdUncompressionDict(const char* dict, size_t dictSize) {
+#if HAVE_ZSTD
+				dict_ = ZSTD_createDDict(dict, dictSize);
+#else
+				// Silence compiler warnings about unused arguments.
+				(void)dict;
+				(void)dictSize;
+#endif  // HAVE_ZSTD
+			}
+
+			ZstdUncompressionDict(const ZstdUncompressionDict&) = delete;
+
+			ZstdUncompressionDict& operator=(const ZstdUncompressionDict&) = delete;
+
+			~ZstdUncompressionDict() {
+#if HAVE_ZSTD
+				ZSTD_freeDDict(dict_);
+#endif  // HAVE_ZSTD
+			}
+
+#if HAVE_ZSTD
+			const ZSTD_DDict* get() const { return dict_; }
+
+		private:
+			ZSTD_DDict* dict_;
+#endif  // HAVE_ZSTD
+		};
+
+#if HAVE_ZSTD
+		// a context of the calling thread, reused by the blocks it compresses
+		inline ZSTD_CCtx* Zstd_ThreadCCtx() {
+			struct Holder {
+				~Holder() { ZSTD_freeCCtx(ctx); }
+				ZSTD_CCtx* ctx = ZSTD_createCCtx();
+			};
+			static thread_local Holder holder;
+			return holder.ctx;
+		}
+
+		inline ZSTD_DCtx* Zstd_ThreadDCtx() {
+			struct Holder {
+				~Holder() { ZSTD_freeDCtx(ctx); }
+				ZSTD_DCtx* ctx = ZSTD_createDCtx();
+			};
+			static thread_local Holder holder;
+			return holder.ctx;
+		}
+#endif  // HAVE_ZSTD
+
+		// the dictionary variants are used for the data blocks of a table that
+		// stores a dictionary trained from its own blocks
+		inline bool Zstd_CompressWithDict(const ZstdCompressionDict& dict,
+			const char* input, size_t length, std::string* output) {
+#if HAVE_ZSTD
+			size_t outlen = ZSTD_compressBound(length);
+			if (ZSTD_isError(outlen) || dict.get() == nullptr) {
+				return false;
+			}
+			output->resize(outlen);
+			outlen = ZSTD_compress_usingCDict(Zstd_ThreadCCtx(), &(*output)[0], output->size(),
+				input, length, dict.get());
+			if (ZSTD_isError(outlen)) {
+				return false;
+			}
+			output->resize(outlen);
+			return true;
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)dict;
+			(void)input;
+			(void)length;
+			(void)output;
+			return false;
+#endif  // HAVE_ZSTD
+		}
+
+		inline bool Zstd_UncompressWithDict(const ZstdUncompressionDict& dict,
+			const char* input, size_t length, char* output) {
+#if HAVE_ZSTD
+			size_t outlen;
+			if (dict.get() == nullptr || !Zstd_GetUncompressedLength(input, length, &outlen)) {
+				return false;
+			}
+			outlen = ZSTD_decompress_usingDDict(Zstd_ThreadDCtx(), output, outlen, input, length, dict.get());
+			if (ZSTD_isError(outlen)) {
+				return false;
+			}
+			return true;
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)dict;
+			(void)input;
+			(void)length;
+			(void)output;
+			return false;
+#endif  // HAVE_ZSTD
+		}
+
+		// samples holds the sample blocks back to back, sampleSizes their sizes
+		inline bool Zstd_TrainDictionary(const std::string& samples,
+			const std::vector<size_t>& sampleSizes, size_t maxDictBytes, std::string* dict) {
+#if HAVE_ZSTD
+			dict->resize(maxDictBytes);
+			size_t size = ZDICT_trainFromBuffer(&(*dict)[0], maxDictBytes, samples.data(),
+				sampleSizes.data(), static_cast<unsigned>(sampleSizes.size()));
+			if (ZDICT_isError(size)) {
+				dict->clear();
+				return false;
+			}
+			dict->resize(size);
+			return true;
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)samples;
+			(void)sampleSizes;
+			(void)maxDictBytes;
+			(void)dict;
+			return false;
+#endif  // HAVE_ZSTD
+		}
+
+		inline bool GetHeapProfile(void (*func)(void*, const char*, int), void* arg) {
+			// Silence compiler warnings about unused arguments.
+			(void)func;
+			(void)arg;
+			return false;
+		}
+
+		// tell the cpu we are in a spin-wait loop, it saves power and
+		// frees pipeline resources for the sibling hyper-thread
+		inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+			__builtin_ia32_pause();
+#elif defined(__aarch64__)
+			asm volatile("yield" ::: "memory");
+#endif
+		}
+
+		inline uint32_t AcceleratedCRC32C(uint32_t crc, const char* buf, size_t size) {
+#if HAVE_CRC32C
+			return ::crc32c::Extend(crc, reinterpret_cast<const uint8_t*>(buf), size);
+#else
+			// Silence compiler warnings about unused arguments.
+			(void)crc;
+			(void)buf;
+			(void)size;
+			return 0;
+#endif  // HAVE_CRC32C
+		}
+
+	}
 }
\ No newline at end of file
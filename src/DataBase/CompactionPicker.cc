@@ -0,0 +1,611 @@
+#include "DataBase/CompactionPicker.h"
+
+#include <algorithm>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "DataBase/VersionSet.h"
+
+namespace CDB{
+
+	Compaction::Compaction(Version* inputVersion, std::vector<CompactionInputFiles> inputs,
+		int outputLevel, CompactionReason reason)
+		:inputVersion_(inputVersion), inputs_(std::move(inputs)), outputLevel_(outputLevel), reason_(reason)
+	{
+		assert(!inputs_.empty());
+		inputVersion_->ref();
+		markFilesBeingCompacted(true);
+		bottommost_ = computeBottommostLevel();
+	}
+
+	Compaction::~Compaction()
+	{
+		markFilesBeingCompacted(false);
+		inputVersion_->unRef();
+	}
+
+	uint64_t Compaction::totalInputBytes() const
+	{
+		uint64_t sum = 0;
+		for (const CompactionInputFiles& in : inputs_) {
+			for (const FileMetaData* f : in.files) {
+				sum += f->fileSize;
+			}
+		}
+		return sum;
+	}
+
+	Options Compaction::outputTableOptions(const Options& options) const
+	{
+		return tableOptionsForLevel(options, outputLevel_, bottommost_);
+	}
+
+	bool Compaction::computeBottommostLevel() const
+	{
+		for (int level = outputLevel_ + 1; level < Config::kNumLevels; ++level) {
+			if (inputVersion_->numFiles(level) > 0) {
+				return false;
+			}
+		}
+		if (outputLevel_ > 0) {
+			return true;
+		}
+		// every level-0 file is a sorted run, one older than the inputs that
+		// is left out lies below the output
+		SequenceNumber oldestInput = kMaxSequenceNumber;
+		const std::vector<FileMetaData*>* level0Inputs = nullptr;
+		for (const CompactionInputFiles& in : inputs_) {
+			if (in.level == 0) {
+				level0Inputs = &in.files;
+				for (const FileMetaData* f : in.files) {
+					oldestInput = std::min(oldestInput, f->smallestSeqno);
+				}
+			}
+		}
+		for (FileMetaData* f : inputVersion_->files(0)) {
+			const bool input = level0Inputs != nullptr &&
+				std::find(level0Inputs->begin(), level0Inputs->end(), f) != level0Inputs->end();
+			if (!input && f->largestSeqno < oldestInput) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	Options tableOptionsForLevel(const Options& options, int level, bool bottommost)
+	{
+		Options result = options;
+		if (!options.compression_per_level.empty()) {
+			const size_t i = std::min<size_t>(level, options.compression_per_level.size() - 1);
+			result.compression = options.compression_per_level[i];
+		}
+		if (!options.zstd_compression_level_per_level.empty()) {
+			const size_t i = std::min<size_t>(level, options.zstd_compression_level_per_level.size() - 1);
+			result.zstd_compression_level = options.zstd_compression_level_per_level[i];
+		}
+		if (bottommost) {
+			if (options.bottommost_compression != KDisableCompressionOption) {
+				result.compression = options.bottommost_compression;
+			}
+			if (options.bottommost_zstd_compression_level != 0) {
+				result.zstd_compression_level = options.bottommost_zstd_compression_level;
+			}
+		}
+		return result;
+	}
+
+	void Compaction::markFilesBeingCompacted(bool mark)
+	{
+		for (CompactionInputFiles& in : inputs_) {
+			for (FileMetaData* f : in.files) {
+				assert(mark != f->beingCompacted);
+				f->beingCompacted = mark;
+			}
+		}
+	}
+
+	CompactionPicker::~CompactionPicker() = default;
+
+	void CompactionPicker::getOverlappingInputs(const Version* version, int level, const Slice& begin,
+		const Slice& end, std::vector<FileMetaData*>* inputs) const
+	{
+		assert(level >= 0 && level < Config::kNumLevels);
+		inputs->clear();
+		std::string userBegin(begin);
+		std::string userEnd(end);
+		const Comparator* ucmp = icmp_->user_comparator();
+		const std::vector<FileMetaData*>& files = version->files(level);
+		for (size_t i = 0; i < files.size();) {
+			FileMetaData* f = files[i++];
+			const Slice fileStart = f->smallest.user_key();
+			const Slice fileLimit = f->largest.user_key();
+			if (ucmp->compare(fileLimit, userBegin) < 0 || ucmp->compare(fileStart, userEnd) > 0) {
+				continue;
+			}
+			inputs->push_back(f);
+			if (level == 0) {
+				// level-0 files may overlap each other, restart the search
+				// whenever the range grows
+				if (ucmp->compare(fileStart, userBegin) < 0) {
+					userBegin.assign(fileStart.data(), fileStart.size());
+					inputs->clear();
+					i = 0;
+				}
+				else if (ucmp->compare(fileLimit, userEnd) > 0) {
+					userEnd.assign(fileLimit.data(), fileLimit.size());
+					inputs->clear();
+					i = 0;
+				}
+			}
+		}
+	}
+
+	bool CompactionPicker::anyBeingCompacted(const std::vector<FileMetaData*>& files)
+	{
+		for (const FileMetaData* f : files) {
+			if (f->beingCompacted) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	FileMetaData* CompactionPicker::findMarkedFile(const Version* version, int* level)
+	{
+		for (int i = 0; i < Config::kNumLevels; ++i) {
+			for (FileMetaData* f : version->files(i)) {
+				if (f->markedForCompaction && !f->beingCompacted) {
+					*level = i;
+					return f;
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	double LevelCompactionPicker::maxBytesForLevel(int level)
+	{
+		// the result for level zero is not really used since the level-0
+		// compaction threshold is based on the number of files
+		double result = 10. * 1048576.0;
+		while (level > 1) {
+			result *= 10;
+			level--;
+		}
+		return result;
+	}
+
+	double LevelCompactionPicker::levelScore(const Version* version, int level) const
+	{
+		if (level == 0) {
+			// level-0 files are all read on every lookup, so bound their count
+			// instead of their size
+			return version->numFiles(0) / static_cast<double>(Config::kL0_CompactionTrigger);
+		}
+		return static_cast<double>(version->numLevelBytes(level)) / maxBytesForLevel(level);
+	}
+
+	bool LevelCompactionPicker::needsCompaction(const Version* version) const
+	{
+		for (int level = 0; level < Config::kNumLevels - 1; ++level) {
+			if (levelScore(version, level) >= 1) {
+				return true;
+			}
+		}
+		int level;
+		return findMarkedFile(version, &level) != nullptr;
+	}
+
+	Compaction* LevelCompactionPicker::pickCompaction(Version* version)
+	{
+		int level = -1;
+		double bestScore = 1;
+		for (int i = 0; i < Config::kNumLevels - 1; ++i) {
+			const double score = levelScore(version, i);
+			if (score >= bestScore) {
+				bestScore = score;
+				level = i;
+			}
+		}
+		if (level < 0) {
+			// no level is over budget, use the time for files full of tombstones
+			return pickMarkedFile(version);
+		}
+
+		const std::vector<FileMetaData*>& files = version->files(level);
+		std::vector<FileMetaData*> levelInputs;
+		if (level == 0) {
+			// only one level-0 compaction at a time, its inputs overlap anyway
+			if (anyBeingCompacted(files)) {
+				return nullptr;
+			}
+			getOverlappingInputs(version, 0, files[0]->smallest.user_key(),
+				files[0]->largest.user_key(), &levelInputs);
+		}
+		else {
+			FileMetaData* picked = nullptr;
+			for (FileMetaData* f : files) {
+				if (!f->beingCompacted && (compactPointer_[level].empty() ||
+					icmp_->compare(f->largest.Encode(), compactPointer_[level]) > 0)) {
+					picked = f;
+					break;
+				}
+			}
+			if (picked == nullptr) {
+				// wrap around to the beginning of the key space
+				for (FileMetaData* f : files) {
+					if (!f->beingCompacted) {
+						picked = f;
+						break;
+					}
+				}
+			}
+			if (picked == nullptr) {
+				return nullptr;
+			}
+			levelInputs.push_back(picked);
+		}
+		return setupOtherInputs(version, level, std::move(levelInputs),
+			level == 0 ? KLevelL0FilesNum : KLevelMaxLevelSize);
+	}
+
+	Compaction* LevelCompactionPicker::pickMarkedFile(Version* version)
+	{
+		// a marked file whose overlapping files are busy waits, the next
+		// marked one may still be free
+		for (int level = 0; level < Config::kNumLevels; ++level) {
+			for (FileMetaData* f : version->files(level)) {
+				if (f->markedForCompaction && !f->beingCompacted) {
+					Compaction* c = pickMarkedFile(version, level, f);
+					if (c != nullptr) {
+						return c;
+					}
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	Compaction* LevelCompactionPicker::pickMarkedFile(Version* version, int level, FileMetaData* marked)
+	{
+		std::vector<FileMetaData*> levelInputs;
+		if (level == 0) {
+			getOverlappingInputs(version, 0, marked->smallest.user_key(),
+				marked->largest.user_key(), &levelInputs);
+			if (anyBeingCompacted(levelInputs)) {
+				return nullptr;
+			}
+		}
+		else {
+			levelInputs.push_back(marked);
+		}
+		if (level == Config::kNumLevels - 1) {
+			// nothing below to merge with, rewriting the file drops its tombstones
+			std::vector<CompactionInputFiles> inputs(1);
+			inputs[0].level = level;
+			inputs[0].files = std::move(levelInputs);
+			return new Compaction(version, std::move(inputs), level, KFilesMarkedForCompaction);
+		}
+		return setupOtherInputs(version, level, std::move(levelInputs), KFilesMarkedForCompaction);
+	}
+
+	Compaction* LevelCompactionPicker::setupOtherInputs(Version* version, int level,
+		std::vector<FileMetaData*> levelInputs, CompactionReason reason)
+	{
+		assert(!levelInputs.empty());
+
+		InternalKey smallest = levelInputs[0]->smallest;
+		InternalKey largest = levelInputs[0]->largest;
+		for (const FileMetaData* f : levelInputs) {
+			if (icmp_->compare(f->smallest, smallest) < 0) {
+				smallest = f->smallest;
+			}
+			if (icmp_->compare(f->largest, largest) > 0) {
+				largest = f->largest;
+			}
+		}
+
+		std::vector<FileMetaData*> nextInputs;
+		getOverlappingInputs(version, level + 1, smallest.user_key(), largest.user_key(), &nextInputs);
+		if (anyBeingCompacted(nextInputs)) {
+			return nullptr;
+		}
+
+		// the next compaction of this level starts after the largest key picked now
+		compactPointer_[level] = std::string(largest.Encode());
+
+		std::vector<CompactionInputFiles> inputs(1);
+		inputs[0].level = level;
+		inputs[0].files = std::move(levelInputs);
+		if (!nextInputs.empty()) {
+			inputs.emplace_back();
+			inputs[1].level = level + 1;
+			inputs[1].files = std::move(nextInputs);
+		}
+		return new Compaction(version, std::move(inputs), level + 1, reason);
+	}
+
+	std::vector<UniversalCompactionPicker::SortedRun> UniversalCompactionPicker::calculateSortedRuns(const Version* version)
+	{
+		std::vector<SortedRun> runs;
+		// every level-0 file is a run of its own, newest first, merged
+		// outputs get new file numbers so order by sequence instead
+		std::vector<FileMetaData*> level0 = version->files(0);
+		std::sort(level0.begin(), level0.end(), [](const FileMetaData* a, const FileMetaData* b) {
+			if (a->largestSeqno != b->largestSeqno) {
+				return a->largestSeqno > b->largestSeqno;
+			}
+			return a->number > b->number;
+		});
+		for (FileMetaData* f : level0) {
+			SortedRun run;
+			run.level = 0;
+			run.file = f;
+			run.size = f->fileSize;
+			run.beingCompacted = f->beingCompacted;
+			run.markedForCompaction = f->markedForCompaction;
+			runs.push_back(run);
+		}
+		for (int level = 1; level < Config::kNumLevels; ++level) {
+			if (version->numFiles(level) == 0) {
+				continue;
+			}
+			SortedRun run;
+			run.level = level;
+			run.size = version->numLevelBytes(level);
+			run.beingCompacted = anyBeingCompacted(version->files(level));
+			for (const FileMetaData* f : version->files(level)) {
+				run.markedForCompaction |= f->markedForCompaction;
+			}
+			runs.push_back(run);
+		}
+		return runs;
+	}
+
+	bool UniversalCompactionPicker::needsCompaction(const Version* version) const
+	{
+		if (calculateSortedRuns(version).size() >= static_cast<size_t>(Config::kL0_CompactionTrigger)) {
+			return true;
+		}
+		int level;
+		return findMarkedFile(version, &level) != nullptr;
+	}
+
+	Compaction* UniversalCompactionPicker::pickCompaction(Version* version)
+	{
+		const std::vector<SortedRun> runs = calculateSortedRuns(version);
+		const size_t trigger = Config::kL0_CompactionTrigger;
+		if (runs.size() < trigger) {
+			return pickMarkedFile(version, runs);
+		}
+		const UniversalCompactionOptions& uopts = options_->compaction_options_universal;
+
+		Compaction* c = pickSizeAmplification(version, runs);
+		if (c == nullptr) {
+			c = pickSizeRatio(version, runs, uopts.size_ratio, uopts.max_merge_width, KUniversalSizeRatio);
+		}
+		if (c == nullptr) {
+			// no runs of similar size, merge the newest runs regardless of
+			// their size until the count drops below the trigger, merging
+			// width runs into one leaves runs.size() - width + 1
+			unsigned int width = static_cast<unsigned int>(runs.size() - trigger + 2);
+			width = std::max(std::min(width, uopts.max_merge_width), uopts.min_merge_width);
+			c = pickSizeRatio(version, runs, UINT_MAX, width, KUniversalSortedRunNum);
+		}
+		if (c == nullptr) {
+			c = pickMarkedFile(version, runs);
+		}
+		return c;
+	}
+
+	Compaction* UniversalCompactionPicker::pickSizeAmplification(Version* version, const std::vector<SortedRun>& runs)
+	{
+		if (runs.size() < 2) {
+			return nullptr;
+		}
+		// the full merge rewrites every run, it can not run next to any other compaction
+		for (const SortedRun& run : runs) {
+			if (run.beingCompacted) {
+				return nullptr;
+			}
+		}
+		uint64_t candidateSize = 0;
+		for (size_t i = 0; i + 1 < runs.size(); ++i) {
+			candidateSize += runs[i].size;
+		}
+		const uint64_t baseSize = runs.back().size;
+		const unsigned int ratio = options_->compaction_options_universal.max_size_amplification_percent;
+		if (static_cast<double>(candidateSize) * 100 < static_cast<double>(ratio) * baseSize) {
+			return nullptr;
+		}
+		return newCompaction(version, runs, 0, runs.size(), KUniversalSizeAmplification);
+	}
+
+	Compaction* UniversalCompactionPicker::pickSizeRatio(Version* version, const std::vector<SortedRun>& runs,
+		unsigned int ratio, unsigned int maxWidth, CompactionReason reason)
+	{
+		const size_t minWidth = std::max(2u, options_->compaction_options_universal.min_merge_width);
+		for (size_t start = 0; start < runs.size(); ++start) {
+			if (runs[start].beingCompacted) {
+				continue;
+			}
+			// pull older runs in while they are not much larger than
+			// everything picked so far
+			double candidateSize = static_cast<double>(runs[start].size);
+			size_t count = 1;
+			for (size_t i = start + 1; i < runs.size() && count < maxWidth; ++i) {
+				const SortedRun& next = runs[i];
+				if (next.beingCompacted) {
+					break;
+				}
+				if (candidateSize * (100.0 + ratio) / 100.0 < static_cast<double>(next.size)) {
+					break;
+				}
+				candidateSize += next.size;
+				++count;
+			}
+			if (count >= minWidth) {
+				return newCompaction(version, runs, start, count, reason);
+			}
+		}
+		return nullptr;
+	}
+
+	Compaction* UniversalCompactionPicker::pickMarkedFile(Version* version, const std::vector<SortedRun>& runs)
+	{
+		for (size_t start = 0; start < runs.size(); ++start) {
+			if (!runs[start].markedForCompaction || runs[start].beingCompacted) {
+				continue;
+			}
+			// the tombstones only go away once they meet the older data they
+			// cover, so take the next older run along when it is free
+			size_t count = 1;
+			if (start + 1 < runs.size() && !runs[start + 1].beingCompacted) {
+				++count;
+			}
+			return newCompaction(version, runs, start, count, KFilesMarkedForCompaction);
+		}
+		return nullptr;
+	}
+
+	Compaction* UniversalCompactionPicker::newCompaction(Version* version, const std::vector<SortedRun>& runs,
+		size_t start, size_t count, CompactionReason reason)
+	{
+		assert(start + count <= runs.size());
+		std::vector<CompactionInputFiles> inputs;
+		for (size_t i = start; i < start + count; ++i) {
+			const SortedRun& run = runs[i];
+			if (run.level == 0) {
+				if (inputs.empty() || inputs.back().level != 0) {
+					inputs.emplace_back();
+					inputs.back().level = 0;
+				}
+				inputs.back().files.push_back(run.file);
+			}
+			else {
+				inputs.emplace_back();
+				inputs.back().level = run.level;
+				inputs.back().files = version->files(run.level);
+			}
+		}
+
+		// the merged run has to stay newer than every run it did not include,
+		// so it goes right above the next older run, or to the last level
+		// when the oldest run was part of the merge
+		int outputLevel;
+		const size_t after = start + count;
+		if (after == runs.size()) {
+			outputLevel = Config::kNumLevels - 1;
+		}
+		else if (runs[after].level == 0) {
+			outputLevel = 0;
+		}
+		else {
+			outputLevel = runs[after].level - 1;
+		}
+		return new Compaction(version, std::move(inputs), outputLevel, reason);
+	}
+
+	std::vector<FileMetaData*> FIFOCompactionPicker::filesByAge(const Version* version)
+	{
+		std::vector<FileMetaData*> files = version->files(0);
+		std::sort(files.begin(), files.end(), [](const FileMetaData* a, const FileMetaData* b) {
+			if (a->largestSeqno != b->largestSeqno) {
+				return a->largestSeqno < b->largestSeqno;
+			}
+			return a->number < b->number;
+		});
+		return files;
+	}
+
+	uint64_t FIFOCompactionPicker::expireBefore() const
+	{
+		const uint64_t ttl = options_->compaction_options_fifo.ttl;
+		if (ttl == 0) {
+			return 0;
+		}
+		const uint64_t now = options_->env->nowMicros() / 1000000;
+		return now > ttl ? now - ttl : 0;
+	}
+
+	bool FIFOCompactionPicker::needsCompaction(const Version* version) const
+	{
+		if (version->numFiles(0) == 0) {
+			return false;
+		}
+		if (version->numLevelBytes(0) > options_->compaction_options_fifo.max_table_files_size) {
+			return true;
+		}
+		const FileMetaData* oldest = filesByAge(version)[0];
+		return oldest->creationTime != 0 && oldest->creationTime < expireBefore();
+	}
+
+	Compaction* FIFOCompactionPicker::pickCompaction(Version* version)
+	{
+		Compaction* c = pickTTL(version);
+		if (c == nullptr) {
+			c = pickSize(version);
+		}
+		return c;
+	}
+
+	Compaction* FIFOCompactionPicker::pickTTL(Version* version)
+	{
+		const uint64_t expire = expireBefore();
+		if (expire == 0) {
+			return nullptr;
+		}
+		const std::vector<FileMetaData*> files = filesByAge(version);
+		// a deletion is cheap, just wait for the running one
+		if (anyBeingCompacted(files)) {
+			return nullptr;
+		}
+		std::vector<CompactionInputFiles> inputs(1);
+		for (FileMetaData* f : files) {
+			// files are ordered by age, the first live one ends the scan
+			if (f->creationTime == 0 || f->creationTime >= expire) {
+				break;
+			}
+			inputs[0].files.push_back(f);
+		}
+		if (inputs[0].files.empty()) {
+			return nullptr;
+		}
+		return new Compaction(version, std::move(inputs), 0, KFIFOTtl);
+	}
+
+	Compaction* FIFOCompactionPicker::pickSize(Version* version)
+	{
+		const uint64_t budget = options_->compaction_options_fifo.max_table_files_size;
+		uint64_t total = version->numLevelBytes(0);
+		if (total <= budget) {
+			return nullptr;
+		}
+		const std::vector<FileMetaData*> files = filesByAge(version);
+		if (anyBeingCompacted(files)) {
+			return nullptr;
+		}
+		std::vector<CompactionInputFiles> inputs(1);
+		for (FileMetaData* f : files) {
+			if (total <= budget) {
+				break;
+			}
+			inputs[0].files.push_back(f);
+			total -= f->fileSize;
+		}
+		return new Compaction(version, std::move(inputs), 0, KFIFOMaxSize);
+	}
+
+	CompactionPicker* newCompactionPicker(const Options* options, const InternalKeyComparator* icmp)
+	{
+		switch (options->compaction_style) {
+		case KCompactionStyleUniversal:
+			return new UniversalCompactionPicker(options, icmp);
+		case KCompactionStyleFIFO:
+			return new FIFOCompactionPicker(options, icmp);
+		case KCompactionStyleLevel:
+		default:
+			return new LevelCompactionPicker(options, icmp);
+		}
+	}
+
+}
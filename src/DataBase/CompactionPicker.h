@@ -0,0 +1,278 @@
+/*!
+ * \file CompactionPicker.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CDataBase/Options.h"
+#include "DataBase/DBFormat.h"
+#include "DataBase/VersionEdit.h"
+
+namespace CDB{
+
+	class Version;
+
+	enum CompactionReason {
+		KUnknownCompaction = 0,
+		// level style: too many level-0 files
+		KLevelL0FilesNum = 1,
+		// level style: a level exceeds its byte budget
+		KLevelMaxLevelSize = 2,
+		// universal style: space amplification above the configured percent
+		KUniversalSizeAmplification = 3,
+		// universal style: neighbouring sorted runs of similar size
+		KUniversalSizeRatio = 4,
+		// universal style: too many sorted runs
+		KUniversalSortedRunNum = 5,
+		// fifo style: the total file size is over budget
+		KFIFOMaxSize = 6,
+		// fifo style: the oldest files expired
+		KFIFOTtl = 7,
+		// a table properties collector marked the file, e.g. for its tombstone density
+		KFilesMarkedForCompaction = 8
+	};
+
+	struct CompactionInputFiles {
+		int level = 0;
+		std::vector<FileMetaData*> files;
+	};
+
+	/*!
+	 * \class Compaction
+	 *
+	 * \brief description of one picked compaction,
+	 *  holds a reference on the input version and keeps the input
+	 *  files marked as being compacted until it is destroyed
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class Compaction{
+	public:
+		Compaction(Version* inputVersion, std::vector<CompactionInputFiles> inputs,
+			int outputLevel, CompactionReason reason);
+
+		Compaction(const Compaction&) = delete;
+
+		Compaction& operator=(const Compaction&) = delete;
+
+		~Compaction();
+
+		int startLevel() const { return inputs_[0].level; }
+
+		int outputLevel() const { return outputLevel_; }
+
+		CompactionReason reason() const { return reason_; }
+
+		Version* inputVersion() const { return inputVersion_; }
+
+		size_t numInputLevels() const { return inputs_.size(); }
+
+		int level(size_t which) const { return inputs_[which].level; }
+
+		int numInputFiles(size_t which) const { return static_cast<int>(inputs_[which].files.size()); }
+
+		FileMetaData* input(size_t which, int i) const { return inputs_[which].files[i]; }
+
+		uint64_t totalInputBytes() const;
+
+		/// the inputs are dropped from the version as they are,
+		/// nothing is read or written
+		bool isDeletionCompaction() const { return reason_ == KFIFOMaxSize || reason_ == KFIFOTtl; }
+
+		/// no data older than the inputs lies below the output level
+		bool bottommostLevel() const { return bottommost_; }
+
+		/// the options the output tables are built with, passed to
+		/// TableBuilder::changeOptions when an output is opened
+		Options outputTableOptions(const Options& options) const;
+
+	private:
+		void markFilesBeingCompacted(bool mark);
+
+		bool computeBottommostLevel() const;
+
+		Version* const inputVersion_;
+
+		std::vector<CompactionInputFiles> inputs_;
+
+		const int outputLevel_;
+
+		const CompactionReason reason_;
+
+		bool bottommost_;
+	};
+
+	/// options with compression and zstd_compression_level set for the tables
+	/// of level, from compression_per_level and the bottommost settings.
+	/// a flush writes level 0 and is never bottommost
+	Options tableOptionsForLevel(const Options& options, int level, bool bottommost);
+
+	/*!
+	 * \class CompactionPicker
+	 *
+	 * \brief decides which files of a version should be compacted next,
+	 *  one implementation per CompactionStyle
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class CompactionPicker{
+	public:
+		CompactionPicker(const Options* options, const InternalKeyComparator* icmp)
+			:options_(options), icmp_(icmp)
+		{
+		}
+
+		CompactionPicker(const CompactionPicker&) = delete;
+
+		CompactionPicker& operator=(const CompactionPicker&) = delete;
+
+		virtual ~CompactionPicker();
+
+		/// return nullptr if no compaction is needed,
+		/// otherwise the caller owns the result and deletes it when the compaction is done
+		virtual Compaction* pickCompaction(Version* version) = 0;
+
+		virtual bool needsCompaction(const Version* version) const = 0;
+
+	protected:
+		/// store in *inputs all files in level that overlap [begin,end] of user keys,
+		/// level-0 files may overlap each other so the range grows with every hit
+		void getOverlappingInputs(const Version* version, int level, const Slice& begin,
+			const Slice& end, std::vector<FileMetaData*>* inputs) const;
+
+		static bool anyBeingCompacted(const std::vector<FileMetaData*>& files);
+
+		/// the first file marked for compaction that is not compacted yet,
+		/// shallower levels first, nullptr if there is none
+		static FileMetaData* findMarkedFile(const Version* version, int* level);
+
+		const Options* const options_;
+
+		const InternalKeyComparator* const icmp_;
+	};
+
+	/*!
+	 * \class LevelCompactionPicker
+	 *
+	 * \brief the leveled style, merges a file of level n with the
+	 *  overlapping files of level n+1 once a level is over its budget
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class LevelCompactionPicker final : public CompactionPicker{
+	public:
+		using CompactionPicker::CompactionPicker;
+
+		Compaction* pickCompaction(Version* version) override;
+
+		bool needsCompaction(const Version* version) const override;
+
+		static double maxBytesForLevel(int level);
+
+	private:
+		/// score >= 1 means the level needs a compaction
+		double levelScore(const Version* version, int level) const;
+
+		/// the first marked file that can be compacted now, shallower levels first
+		Compaction* pickMarkedFile(Version* version);
+
+		/// merge a marked file with its overlapping files of the next level,
+		/// a file of the last level is rewritten on its own, nullptr if any
+		/// of them is being compacted
+		Compaction* pickMarkedFile(Version* version, int level, FileMetaData* marked);
+
+		/// add the overlapping files of level + 1 to levelInputs
+		Compaction* setupOtherInputs(Version* version, int level,
+			std::vector<FileMetaData*> levelInputs, CompactionReason reason);
+
+		// the largest key compacted last time in each level, the next
+		// compaction of that level starts right after it
+		std::string compactPointer_[Config::kNumLevels];
+	};
+
+	/*!
+	 * \class UniversalCompactionPicker
+	 *
+	 * \brief the size-tiered style, every level-0 file and every non-empty
+	 *  deeper level is a sorted run, runs are ordered from newest to oldest
+	 *  and neighbouring runs are merged on size amplification, size ratio
+	 *  or sorted run count triggers
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class UniversalCompactionPicker final : public CompactionPicker{
+	public:
+		using CompactionPicker::CompactionPicker;
+
+		Compaction* pickCompaction(Version* version) override;
+
+		bool needsCompaction(const Version* version) const override;
+
+		struct SortedRun {
+			int level = 0;
+			// only set for level-0 runs, deeper levels are a run as a whole
+			FileMetaData* file = nullptr;
+			uint64_t size = 0;
+			bool beingCompacted = false;
+			bool markedForCompaction = false;
+		};
+
+		static std::vector<SortedRun> calculateSortedRuns(const Version* version);
+
+	private:
+		Compaction* pickSizeAmplification(Version* version, const std::vector<SortedRun>& runs);
+
+		Compaction* pickSizeRatio(Version* version, const std::vector<SortedRun>& runs,
+			unsigned int ratio, unsigned int maxWidth, CompactionReason reason);
+
+		/// merge the newest run holding a marked file with the next older run
+		Compaction* pickMarkedFile(Version* version, const std::vector<SortedRun>& runs);
+
+		/// merge runs[start, start + count) into one run
+		Compaction* newCompaction(Version* version, const std::vector<SortedRun>& runs,
+			size_t start, size_t count, CompactionReason reason);
+	};
+
+	/*!
+	 * \class FIFOCompactionPicker
+	 *
+	 * \brief the fifo style, all files stay in level-0 and are never merged,
+	 *  the oldest ones are deleted once they are older than the ttl or the
+	 *  total size exceeds the budget
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class FIFOCompactionPicker final : public CompactionPicker{
+	public:
+		using CompactionPicker::CompactionPicker;
+
+		Compaction* pickCompaction(Version* version) override;
+
+		bool needsCompaction(const Version* version) const override;
+
+	private:
+		/// level-0 files ordered from oldest to newest
+		static std::vector<FileMetaData*> filesByAge(const Version* version);
+
+		/// files whose creation time is before this are expired, 0 if there is no ttl
+		uint64_t expireBefore() const;
+
+		Compaction* pickTTL(Version* version);
+
+		Compaction* pickSize(Version* version);
+	};
+
+	CompactionPicker* newCompactionPicker(const Options* options, const InternalKeyComparator* icmp);
+
+}
@@ -0,0 +1,296 @@
+#include <memory>
+#include <gtest/gtest.h>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "CDataBase/Options.h"
+#include "DataBase/CompactionPicker.h"
+#include "DataBase/VersionSet.h"
+
+namespace CDB {
+
+	class CompactionPickerTest : public testing::Test {
+	public:
+		CompactionPickerTest()
+			:icmp_(byteWiseComparator()), version_(new Version)
+		{
+			version_->ref();
+		}
+
+		~CompactionPickerTest()
+		{
+			version_->unRef();
+		}
+
+		void add(int level, uint64_t number, const char* smallest, const char* largest,
+			uint64_t fileSize, SequenceNumber seq)
+		{
+			FileMetaData* f = new FileMetaData;
+			f->number = number;
+			f->fileSize = fileSize;
+			f->smallest = InternalKey(smallest, seq, kTypeValue);
+			f->largest = InternalKey(largest, seq, kTypeValue);
+			f->smallestSeqno = seq;
+			f->largestSeqno = seq;
+			version_->addFile(level, f);
+		}
+
+		Options options_;
+		InternalKeyComparator icmp_;
+		Version* version_;
+	};
+
+	TEST_F(CompactionPickerTest, LevelNeedsL0Trigger) {
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		for (int i = 1; i < Config::kL0_CompactionTrigger; ++i) {
+			add(0, i, "a", "z", 1000, i);
+		}
+		ASSERT_FALSE(picker->needsCompaction(version_));
+		ASSERT_EQ(nullptr, picker->pickCompaction(version_));
+
+		add(0, Config::kL0_CompactionTrigger, "a", "z", 1000, Config::kL0_CompactionTrigger);
+		add(1, 100, "m", "n", 1000, 1);
+		ASSERT_TRUE(picker->needsCompaction(version_));
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_EQ(KLevelL0FilesNum, c->reason());
+		ASSERT_EQ(1, c->outputLevel());
+		ASSERT_EQ(2u, c->numInputLevels());
+		ASSERT_EQ(Config::kL0_CompactionTrigger, c->numInputFiles(0));
+		ASSERT_EQ(1, c->numInputFiles(1));
+
+		// inputs stay reserved until the compaction is gone
+		ASSERT_EQ(nullptr, picker->pickCompaction(version_));
+	}
+
+	TEST_F(CompactionPickerTest, LevelMarkedFile) {
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		add(1, 1, "a", "f", 1000, 1);
+		add(1, 2, "g", "m", 1000, 2);
+		add(2, 3, "a", "h", 1000, 3);
+		add(2, 4, "i", "z", 1000, 4);
+		ASSERT_FALSE(picker->needsCompaction(version_));
+
+		version_->files(1)[1]->markedForCompaction = true;
+		ASSERT_TRUE(picker->needsCompaction(version_));
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_EQ(KFilesMarkedForCompaction, c->reason());
+		ASSERT_EQ(2, c->outputLevel());
+		ASSERT_EQ(1, c->numInputFiles(0));
+		ASSERT_EQ(2u, c->input(0, 0)->number);
+		// "g".."m" overlaps both files of level 2
+		ASSERT_EQ(2, c->numInputFiles(1));
+		ASSERT_FALSE(picker->needsCompaction(version_));
+	}
+
+	TEST_F(CompactionPickerTest, LevelMarkedFileSkipsBusyOverlaps) {
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		add(1, 1, "a", "f", 1000, 1);
+		add(1, 2, "g", "m", 1000, 2);
+		add(2, 3, "a", "f", 1000, 3);
+		add(2, 4, "g", "z", 1000, 4);
+		version_->files(1)[0]->markedForCompaction = true;
+		version_->files(1)[1]->markedForCompaction = true;
+		// the next level under the first marked file is busy
+		version_->files(2)[0]->beingCompacted = true;
+
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_EQ(KFilesMarkedForCompaction, c->reason());
+		ASSERT_EQ(1, c->numInputFiles(0));
+		ASSERT_EQ(2u, c->input(0, 0)->number);
+		ASSERT_EQ(1, c->numInputFiles(1));
+		ASSERT_EQ(4u, c->input(1, 0)->number);
+		ASSERT_EQ(nullptr, picker->pickCompaction(version_));
+	}
+
+	TEST_F(CompactionPickerTest, LevelMarkedFileInLastLevel) {
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		add(Config::kNumLevels - 1, 1, "a", "z", 1000, 1);
+		version_->files(Config::kNumLevels - 1)[0]->markedForCompaction = true;
+
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_EQ(Config::kNumLevels - 1, c->outputLevel());
+		ASSERT_EQ(1u, c->numInputLevels());
+	}
+
+	TEST_F(CompactionPickerTest, UniversalSizeAmplification) {
+		options_.compaction_style = KCompactionStyleUniversal;
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		add(6, 1, "a", "z", 1000, 1);
+		add(0, 2, "a", "z", 900, 2);
+		add(0, 3, "a", "z", 800, 3);
+		add(0, 4, "a", "z", 700, 4);
+		ASSERT_TRUE(picker->needsCompaction(version_));
+
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_EQ(KUniversalSizeAmplification, c->reason());
+		ASSERT_EQ(Config::kNumLevels - 1, c->outputLevel());
+		ASSERT_EQ(3400u, c->totalInputBytes());
+	}
+
+	TEST_F(CompactionPickerTest, UniversalSizeRatio) {
+		options_.compaction_style = KCompactionStyleUniversal;
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		// a large base run keeps space amplification low
+		add(6, 1, "a", "z", 100000, 1);
+		add(0, 2, "a", "z", 5000, 2);
+		add(0, 3, "a", "z", 100, 3);
+		add(0, 4, "a", "z", 100, 4);
+		add(0, 5, "a", "z", 100, 5);
+
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_EQ(KUniversalSizeRatio, c->reason());
+		// the three newest runs are merged, the older 5000 byte run is too large
+		ASSERT_EQ(1u, c->numInputLevels());
+		ASSERT_EQ(3, c->numInputFiles(0));
+		ASSERT_EQ(5u, c->input(0, 0)->number);
+		ASSERT_EQ(0, c->outputLevel());
+	}
+
+	TEST_F(CompactionPickerTest, UniversalSortedRunNum) {
+		options_.compaction_style = KCompactionStyleUniversal;
+		options_.compaction_options_universal.size_ratio = 0;
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		// every run is far larger than the newer ones together
+		add(6, 1, "a", "z", 1000000, 1);
+		add(0, 2, "a", "z", 10000, 2);
+		add(0, 3, "a", "z", 1000, 3);
+		add(0, 4, "a", "z", 100, 4);
+		add(0, 5, "a", "z", 10, 5);
+
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_EQ(KUniversalSortedRunNum, c->reason());
+		// 5 runs less 3 merged into one leaves 3, below the trigger of 4
+		ASSERT_EQ(3, c->numInputFiles(0));
+		ASSERT_EQ(5u, c->input(0, 0)->number);
+		ASSERT_EQ(4u, c->input(0, 1)->number);
+		ASSERT_EQ(3u, c->input(0, 2)->number);
+	}
+
+	TEST_F(CompactionPickerTest, UniversalSortedRunNumAtTrigger) {
+		options_.compaction_style = KCompactionStyleUniversal;
+		options_.compaction_options_universal.size_ratio = 0;
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		add(6, 1, "a", "z", 1000000, 1);
+		uint64_t size = 10000;
+		for (int i = 2; i <= Config::kL0_CompactionTrigger; ++i, size /= 10) {
+			add(0, i, "a", "z", size, i);
+		}
+		ASSERT_TRUE(picker->needsCompaction(version_));
+
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_EQ(KUniversalSortedRunNum, c->reason());
+		const int merged = c->numInputFiles(0);
+		ASSERT_GE(merged, 2);
+		ASSERT_LT(Config::kL0_CompactionTrigger - merged + 1, Config::kL0_CompactionTrigger);
+	}
+
+	TEST_F(CompactionPickerTest, UniversalMarkedFile) {
+		options_.compaction_style = KCompactionStyleUniversal;
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		add(6, 1, "a", "z", 100000, 1);
+		add(0, 2, "a", "z", 1000, 2);
+		ASSERT_FALSE(picker->needsCompaction(version_));
+
+		version_->files(0)[0]->markedForCompaction = true;
+		ASSERT_TRUE(picker->needsCompaction(version_));
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_EQ(KFilesMarkedForCompaction, c->reason());
+		// merged into the older run below it
+		ASSERT_EQ(2u, c->numInputLevels());
+		ASSERT_EQ(Config::kNumLevels - 1, c->outputLevel());
+	}
+
+	TEST_F(CompactionPickerTest, FIFOMaxSize) {
+		options_.compaction_style = KCompactionStyleFIFO;
+		options_.compaction_options_fifo.max_table_files_size = 2500;
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		add(0, 1, "a", "z", 1000, 1);
+		add(0, 2, "a", "z", 1000, 2);
+		ASSERT_FALSE(picker->needsCompaction(version_));
+		add(0, 3, "a", "z", 1000, 3);
+		add(0, 4, "a", "z", 1000, 4);
+		ASSERT_TRUE(picker->needsCompaction(version_));
+
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_TRUE(c->isDeletionCompaction());
+		ASSERT_EQ(KFIFOMaxSize, c->reason());
+		ASSERT_EQ(2, c->numInputFiles(0));
+		ASSERT_EQ(1u, c->input(0, 0)->number);
+		ASSERT_EQ(2u, c->input(0, 1)->number);
+	}
+
+	TEST_F(CompactionPickerTest, FIFOTtl) {
+		options_.compaction_style = KCompactionStyleFIFO;
+		options_.compaction_options_fifo.ttl = 3600;
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		const uint64_t now = options_.env->nowMicros() / 1000000;
+		add(0, 1, "a", "z", 1000, 1);
+		add(0, 2, "a", "z", 1000, 2);
+		add(0, 3, "a", "z", 1000, 3);
+		version_->files(0)[0]->creationTime = now - 7200;
+		version_->files(0)[1]->creationTime = now - 60;
+		version_->files(0)[2]->creationTime = now;
+		ASSERT_TRUE(picker->needsCompaction(version_));
+
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_EQ(KFIFOTtl, c->reason());
+		ASSERT_EQ(1, c->numInputFiles(0));
+		ASSERT_EQ(1u, c->input(0, 0)->number);
+	}
+
+	TEST_F(CompactionPickerTest, BottommostOutput) {
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		add(1, 1, "a", "f", 1000, 1);
+		add(2, 2, "a", "h", 1000, 2);
+		version_->files(1)[0]->markedForCompaction = true;
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_EQ(2, c->outputLevel());
+		ASSERT_TRUE(c->bottommostLevel());
+		c.reset();
+
+		add(4, 3, "x", "z", 1000, 3);
+		c.reset(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_FALSE(c->bottommostLevel());
+	}
+
+	TEST_F(CompactionPickerTest, PerLevelCompression) {
+		options_.compression = KSnappyCompression;
+		options_.zstd_compression_level = 3;
+		ASSERT_EQ(KSnappyCompression, tableOptionsForLevel(options_, 4, false).compression);
+
+		options_.compression_per_level = { KNoCompression, KLZ4Compression, KZstdCompression };
+		options_.zstd_compression_level_per_level = { 1, 1, 6 };
+		ASSERT_EQ(KNoCompression, tableOptionsForLevel(options_, 0, false).compression);
+		ASSERT_EQ(KLZ4Compression, tableOptionsForLevel(options_, 1, false).compression);
+		// levels past the end use the last entry
+		Options deep = tableOptionsForLevel(options_, 5, false);
+		ASSERT_EQ(KZstdCompression, deep.compression);
+		ASSERT_EQ(6, deep.zstd_compression_level);
+
+		options_.bottommost_compression = KZstdCompression;
+		options_.bottommost_zstd_compression_level = 19;
+		Options bottom = tableOptionsForLevel(options_, 1, true);
+		ASSERT_EQ(KZstdCompression, bottom.compression);
+		ASSERT_EQ(19, bottom.zstd_compression_level);
+
+		std::unique_ptr<CompactionPicker> picker(newCompactionPicker(&options_, &icmp_));
+		add(Config::kNumLevels - 1, 1, "a", "z", 1000, 1);
+		version_->files(Config::kNumLevels - 1)[0]->markedForCompaction = true;
+		std::unique_ptr<Compaction> c(picker->pickCompaction(version_));
+		ASSERT_NE(nullptr, c);
+		ASSERT_EQ(19, c->outputTableOptions(options_).zstd_compression_level);
+	}
+
+}
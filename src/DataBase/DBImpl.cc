@@ -0,0 +1,11 @@
+#include "DataBase/DBImpl.h"
+
+#include "CDataBase/DB.h"
+
+namespace CDB{
+
+	Snapshot::~Snapshot() = default;
+
+	DB::~DB() = default;
+
+}
@@ -1,14 +1,14 @@
-/*!
- * \file DBImpl.h
- *
- * \author czy
- * \date 2023.07.13
- *
- * 
- */
-#pragma once
-#include <atomic>
-#include <deque>
-#include <set>
-#include <string>
-
+/*!
+ * \file DBImpl.h
+ *
+ * \author czy
+ * \date 2023.07.13
+ *
+ * 
+ */
+#pragma once
+#include <atomic>
+#include <deque>
+#include <set>
+#include <string>
+
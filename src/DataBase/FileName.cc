@@ -0,0 +1,153 @@
+#include "DataBase/FileName.h"
+
+#include <cassert>
+#include <cstdio>
+#include "CDataBase/Env.h"
+
+namespace CDB{
+
+	static std::string makeFileName(const std::string& dbname, uint64_t number, const char* suffix) {
+		char buf[100];
+		std::snprintf(buf, sizeof(buf), "/%06llu.%s", static_cast<unsigned long long>(number), suffix);
+		return dbname + buf;
+	}
+
+	std::string logFileName(const std::string& dbname, uint64_t number)
+	{
+		assert(number > 0);
+		return makeFileName(dbname, number, "log");
+	}
+
+	std::string tableFileName(const std::string& dbname, uint64_t number)
+	{
+		assert(number > 0);
+		return makeFileName(dbname, number, "ldb");
+	}
+
+	std::string descriptorFileName(const std::string& dbname, uint64_t number)
+	{
+		assert(number > 0);
+		char buf[100];
+		std::snprintf(buf, sizeof(buf), "/MANIFEST-%06llu", static_cast<unsigned long long>(number));
+		return dbname + buf;
+	}
+
+	std::string currentFileName(const std::string& dbname)
+	{
+		return dbname + "/CURRENT";
+	}
+
+	std::string lockFileName(const std::string& dbname)
+	{
+		return dbname + "/LOCK";
+	}
+
+	std::string tempFileName(const std::string& dbname, uint64_t number)
+	{
+		assert(number > 0);
+		return makeFileName(dbname, number, "dbtmp");
+	}
+
+	std::string infoLogFileName(const std::string& dbname)
+	{
+		return dbname + "/LOG";
+	}
+
+	std::string oldInfoLogFileName(const std::string& dbname)
+	{
+		return dbname + "/LOG.old";
+	}
+
+	// consume the decimal number at the front of in
+	static bool consumeDecimalNumber(Slice* in, uint64_t* val) {
+		const uint64_t KMaxUint64 = ~static_cast<uint64_t>(0);
+		uint64_t value = 0;
+		size_t digits = 0;
+		while (digits < in->size()) {
+			const char c = (*in)[digits];
+			if (c < '0' || c > '9') {
+				break;
+			}
+			const uint64_t delta = static_cast<uint64_t>(c - '0');
+			if (value > KMaxUint64 / 10 || (value == KMaxUint64 / 10 && delta > KMaxUint64 % 10)) {
+				return false;
+			}
+			value = value * 10 + delta;
+			++digits;
+		}
+		in->remove_prefix(digits);
+		*val = value;
+		return digits != 0;
+	}
+
+	// owned filenames have the form:
+	//    dbname/CURRENT
+	//    dbname/LOCK
+	//    dbname/LOG
+	//    dbname/LOG.old
+	//    dbname/MANIFEST-[0-9]+
+	//    dbname/[0-9]+.(log|ldb|dbtmp)
+	bool parseFileName(const std::string& filename, uint64_t* number, FileType* type)
+	{
+		Slice rest(filename);
+		if (rest == "CURRENT") {
+			*number = 0;
+			*type = KCurrentFile;
+		}
+		else if (rest == "LOCK") {
+			*number = 0;
+			*type = KDBLockFile;
+		}
+		else if (rest == "LOG" || rest == "LOG.old") {
+			*number = 0;
+			*type = KInfoLogFile;
+		}
+		else if (rest.starts_with("MANIFEST-")) {
+			rest.remove_prefix(sizeof("MANIFEST-") - 1);
+			uint64_t num;
+			if (!consumeDecimalNumber(&rest, &num) || !rest.empty()) {
+				return false;
+			}
+			*type = KDescriptorFile;
+			*number = num;
+		}
+		else {
+			uint64_t num;
+			if (!consumeDecimalNumber(&rest, &num)) {
+				return false;
+			}
+			if (rest == ".log") {
+				*type = KLogFile;
+			}
+			else if (rest == ".ldb") {
+				*type = KTableFile;
+			}
+			else if (rest == ".dbtmp") {
+				*type = KTempFile;
+			}
+			else {
+				return false;
+			}
+			*number = num;
+		}
+		return true;
+	}
+
+	Status setCurrentFile(Env* env, const std::string& dbname, uint64_t descriptorNumber)
+	{
+		std::string manifest = descriptorFileName(dbname, descriptorNumber);
+		Slice contents = manifest;
+		// the current file names the descriptor relative to the db directory
+		contents.remove_prefix(dbname.size() + 1);
+		std::string tmp = tempFileName(dbname, descriptorNumber);
+		Status s = WriteStringToFile(env, std::string(contents) + "\n", tmp);
+		if (s.ok()) {
+			s = env->renameFile(tmp, currentFileName(dbname));
+		}
+		if (!s.ok()) {
+			env->removeFile(tmp);
+		}
+		return s;
+	}
+
+}
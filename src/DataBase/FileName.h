@@ -0,0 +1,56 @@
+/*!
+ * \file FileName.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include "CDataBase/Slice.h"
+#include "CDataBase/Status.h"
+
+namespace CDB{
+
+	class Env;
+
+	enum FileType {
+		KLogFile,
+		KDBLockFile,
+		KTableFile,
+		KDescriptorFile,
+		KCurrentFile,
+		KTempFile,
+		KInfoLogFile
+	};
+
+	/// name of the log with the given number, "dbname/000123.log"
+	std::string logFileName(const std::string& dbname, uint64_t number);
+
+	/// name of the table with the given number, "dbname/000123.ldb"
+	std::string tableFileName(const std::string& dbname, uint64_t number);
+
+	/// name of the descriptor with the given number, "dbname/MANIFEST-000123"
+	std::string descriptorFileName(const std::string& dbname, uint64_t number);
+
+	/// name of the file that holds the name of the current descriptor
+	std::string currentFileName(const std::string& dbname);
+
+	std::string lockFileName(const std::string& dbname);
+
+	std::string tempFileName(const std::string& dbname, uint64_t number);
+
+	std::string infoLogFileName(const std::string& dbname);
+
+	std::string oldInfoLogFileName(const std::string& dbname);
+
+	/// if filename is a file of the db, store its number and type and return true.
+	/// filename is the name without the directory
+	bool parseFileName(const std::string& filename, uint64_t* number, FileType* type);
+
+	/// point the current file at the descriptor with the given number
+	Status setCurrentFile(Env* env, const std::string& dbname, uint64_t descriptorNumber);
+
+}
@@ -0,0 +1,56 @@
+#include "DataBase/LogFilePool.h"
+
+#include <algorithm>
+#include "CDataBase/Env.h"
+#include "DataBase/FileName.h"
+
+namespace CDB{
+
+	LogFilePool::LogFilePool(Env* env, const std::string& dbname, const Options& options)
+		:env_(env), dbname_(dbname), capacity_(options.reuse_logs ? options.recycle_log_file_num : 0),
+		// a memtable is logged in about write_buffer_size bytes, keep some slack
+		// for the record headers
+		preallocateSize_(options.write_buffer_size + options.write_buffer_size / 10)
+	{
+	}
+
+	bool LogFilePool::recycle(uint64_t number)
+	{
+		if (logs_.size() >= capacity_) {
+			return false;
+		}
+		logs_.push_back(number);
+		return true;
+	}
+
+	Status LogFilePool::newLog(uint64_t number, WritableFile** result, bool* reused)
+	{
+		*result = nullptr;
+		if (reused != nullptr) {
+			*reused = false;
+		}
+		const std::string fname = logFileName(dbname_, number);
+		if (!logs_.empty()) {
+			const uint64_t old = logs_.front();
+			logs_.pop_front();
+			Status s = env_->reuseWritableFile(fname, logFileName(dbname_, old), result);
+			if (s.ok() && reused != nullptr) {
+				*reused = true;
+			}
+			return s;
+		}
+
+		Status s = env_->newWritableFile(fname, result);
+		if (s.ok() && enabled()) {
+			// only an optimization, the log is still usable without it
+			(*result)->preallocate(preallocateSize_);
+		}
+		return s;
+	}
+
+	bool LogFilePool::contains(uint64_t number) const
+	{
+		return std::find(logs_.begin(), logs_.end(), number) != logs_.end();
+	}
+
+}
@@ -0,0 +1,68 @@
+/*!
+ * \file LogFilePool.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include "CDataBase/Options.h"
+#include "CDataBase/Status.h"
+
+namespace CDB{
+
+	class Env;
+	class WritableFile;
+
+	/*!
+	 * \class LogFilePool
+	 *
+	 * \brief keeps obsolete write ahead logs to be written over by the next
+	 *  logs when options.reuse_logs is set. a fresh log is preallocated to a
+	 *  little more than a memtable, so appends to it or to a reused log stay
+	 *  inside the allocated extent and a sync does not have to write the file
+	 *  size. the logs must be written with log::Writer in recycle mode so the
+	 *  reader can tell the new records from the old ones. not thread safe,
+	 *  the db mutex guards it
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class LogFilePool{
+	public:
+		LogFilePool(Env* env, const std::string& dbname, const Options& options);
+
+		LogFilePool(const LogFilePool&) = delete;
+
+		LogFilePool& operator=(const LogFilePool&) = delete;
+
+		/// true if the logs are recycled and must be written in recycle mode
+		bool enabled() const { return capacity_ > 0; }
+
+		/// hand over the obsolete log with the given number, false if the pool
+		/// is full and the caller should delete the file
+		bool recycle(uint64_t number);
+
+		/// open the log for number over the oldest pooled log, or create and
+		/// preallocate it if the pool is empty. *reused tells which was done
+		Status newLog(uint64_t number, WritableFile** result, bool* reused = nullptr);
+
+		/// true if the log with the given number is pooled and must be kept
+		bool contains(uint64_t number) const;
+
+		size_t size() const { return logs_.size(); }
+
+	private:
+		Env* const env_;
+		const std::string dbname_;
+		const size_t capacity_;
+		const uint64_t preallocateSize_;
+		// numbers of the pooled logs, oldest first
+		std::deque<uint64_t> logs_;
+	};
+
+}
@@ -0,0 +1,135 @@
+#include "DataBase/LogFilePool.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "CDataBase/Env.h"
+#include "DataBase/FileName.h"
+#include "DataBase/LogReader.h"
+#include "DataBase/LogWriter.h"
+
+namespace CDB {
+
+	class LogFilePoolTest : public testing::Test {
+	public:
+		LogFilePoolTest() :env_(Env::Default())
+		{
+			env_->getTestDir(&dbname_);
+			dbname_ += "/log_file_pool_test";
+			env_->createDir(dbname_);
+			clearDir();
+			options_.reuse_logs = true;
+			options_.recycle_log_file_num = 1;
+			options_.write_buffer_size = 64 * 1024;
+		}
+
+		~LogFilePoolTest()
+		{
+			clearDir();
+			env_->removeDir(dbname_);
+		}
+
+		void clearDir()
+		{
+			std::vector<std::string> children;
+			env_->getChildren(dbname_, &children);
+			for (const auto& child : children) {
+				uint64_t number;
+				FileType type;
+				if (parseFileName(child, &number, &type)) {
+					env_->removeFile(dbname_ + "/" + child);
+				}
+			}
+		}
+
+		void writeLog(LogFilePool* pool, uint64_t number, const std::vector<std::string>& records,
+			bool* reused)
+		{
+			WritableFile* file;
+			ASSERT_TRUE(pool->newLog(number, &file, reused).ok());
+			std::unique_ptr<WritableFile> guard(file);
+			log::Writer writer(file, number, pool->enabled());
+			for (const auto& record : records) {
+				ASSERT_TRUE(writer.addRecord(record).ok());
+			}
+			ASSERT_TRUE(file->sync().ok());
+			ASSERT_TRUE(file->close().ok());
+		}
+
+		std::vector<std::string> readLog(uint64_t number)
+		{
+			SequentialFile* file;
+			std::vector<std::string> result;
+			if (!env_->newSequentialFile(logFileName(dbname_, number), &file).ok()) {
+				return result;
+			}
+			std::unique_ptr<SequentialFile> guard(file);
+			log::Reader reader(file, nullptr, true, 0, number);
+			std::string scratch;
+			Slice record;
+			while (reader.readRecord(&record, &scratch)) {
+				result.emplace_back(record);
+			}
+			return result;
+		}
+
+		Env* env_;
+		std::string dbname_;
+		Options options_;
+	};
+
+	TEST_F(LogFilePoolTest, ReuseObsoleteLog) {
+		LogFilePool pool(env_, dbname_, options_);
+		ASSERT_TRUE(pool.enabled());
+		bool reused = true;
+		writeLog(&pool, 1, { "a1", std::string(20000, 'x'), "a3" }, &reused);
+		ASSERT_FALSE(reused);
+
+		ASSERT_TRUE(pool.recycle(1));
+		ASSERT_TRUE(pool.contains(1));
+		// the pool holds a single log
+		ASSERT_FALSE(pool.recycle(5));
+
+		writeLog(&pool, 2, { "b1" }, &reused);
+		ASSERT_TRUE(reused);
+		ASSERT_EQ(0u, pool.size());
+		ASSERT_FALSE(env_->fileExists(logFileName(dbname_, 1)));
+
+		// the reused file keeps its old size, the old records are skipped
+		uint64_t size = 0;
+		ASSERT_TRUE(env_->getFileSize(logFileName(dbname_, 2), &size).ok());
+		ASSERT_GT(size, 20000u);
+		std::vector<std::string> expected = { "b1" };
+		ASSERT_EQ(expected, readLog(2));
+	}
+
+	TEST_F(LogFilePoolTest, DisabledPoolCreatesLogs) {
+		options_.reuse_logs = false;
+		LogFilePool pool(env_, dbname_, options_);
+		ASSERT_FALSE(pool.enabled());
+		bool reused = true;
+		writeLog(&pool, 3, { "c1", "c2" }, &reused);
+		ASSERT_FALSE(reused);
+		ASSERT_FALSE(pool.recycle(3));
+		std::vector<std::string> expected = { "c1", "c2" };
+		ASSERT_EQ(expected, readLog(3));
+	}
+
+	TEST(FileNameTest, Parse) {
+		uint64_t number;
+		FileType type;
+		ASSERT_TRUE(parseFileName("000123.log", &number, &type));
+		ASSERT_EQ(123u, number);
+		ASSERT_EQ(KLogFile, type);
+		ASSERT_TRUE(parseFileName("MANIFEST-000007", &number, &type));
+		ASSERT_EQ(7u, number);
+		ASSERT_EQ(KDescriptorFile, type);
+		ASSERT_TRUE(parseFileName("CURRENT", &number, &type));
+		ASSERT_EQ(KCurrentFile, type);
+		ASSERT_FALSE(parseFileName("100.foo", &number, &type));
+		ASSERT_FALSE(parseFileName("MANIFEST-", &number, &type));
+		ASSERT_EQ("db/000009.log", logFileName("db", 9));
+	}
+
+}
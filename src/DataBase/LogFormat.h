@@ -1,33 +1,48 @@
-/*!
- * \file LogFormat.h
- *
- * \author czy
- * \date 2023.08.07
- *
- * 
- */
-#pragma once
-namespace CDB{
-	namespace Log{
-		enum RecordType{
-			KZeroType = 0,
-			
-			KFullType = 1,
-			
-			KFirstType =2,
-
-			KMiddleType = 3,
-
-			KLastType = 4
-		};
-
-		static constexpr int KMaxRecordType = KLastType;
-
-		//32KB
-		static constexpr int KBlockSize = 32*1024;
-		
-		static const int KHeaderSize = 4 + 2 + 1;
-
-	}
-
+/*!
+ * \file LogFormat.h
+ *
+ * \author czy
+ * \date 2023.08.07
+ *
+ * 
+ */
+#pragma once
+namespace CDB{
+	namespace log{
+		enum RecordType{
+			KZeroType = 0,
+			
+			KFullType = 1,
+			
+			KFirstType =2,
+
+			KMiddleType = 3,
+
+			KLastType = 4,
+
+			// records of a log that may be written over a recycled file, the
+			// header also holds the low 32 bits of the log number, a record
+			// with another number is left over from the file's previous use
+			KRecyclableFullType = 5,
+
+			KRecyclableFirstType = 6,
+
+			KRecyclableMiddleType = 7,
+
+			KRecyclableLastType = 8
+		};
+
+		static constexpr int KMaxRecordType = KRecyclableLastType;
+
+		//32KB
+		static constexpr int KBlockSize = 32*1024;
+		
+		// crc(4) length(2) type(1)
+		static const int KHeaderSize = 4 + 2 + 1;
+
+		// crc(4) length(2) type(1) log number(4)
+		static const int KRecyclableHeaderSize = KHeaderSize + 4;
+
+	}
+
 }
\ No newline at end of file
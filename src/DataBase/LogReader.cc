@@ -1,173 +1,284 @@
-#include "DataBase/LogReader.h"
-#include <cstdio>
-#include "CDataBase/Env.h"
-#include "Util/Coding.h"
-#include "Util/Crc32.h"
-
-
-using namespace CDB;
-using namespace Log;
-
-CDB::Log::Reader::Reporter::~Reporter() = default;
-
-CDB::Log::Reader::Reader(SequentialFile* file, Reporter* reporter, bool checkSum, uint64_t initOffset)
-	:file_(file),reporter_(reporter),checkSum_(checkSum),backingStore_(new char[KBlockSize]),buffer_(),eof_(false),
-	lastRecordOffset_(0),endOfBufferOffset_(0),initOffset_(initOffset),resyncing_(initOffset > 0)
-{
-}
-
-CDB::Log::Reader::~Reader()
-{
-	delete[]backingStore_;
-}
-
-bool CDB::Log::Reader::readRecord(Slice* record, std::string* sratch)
-{
-	if (lastRecordOffset_ < initOffset_) {
-		if(!skipToInitialBlock()){
-			return false;
-		}
-	}
-
-	sratch->clear();
-	record->clear();
-	bool inFragmentRecord = false;
-	uint64_t prospectiveRecordOffset = 0;
-	Slice fragment;
-	while(true){
-		const unsigned int recordType = readPhysicalRecord(&fragment);
-		uint64_t physicalReadOffset = endOfBufferOffset_ - buffer_.size() - KHeaderSize;
-		if(resyncing_){
-			if(recordType == KMiddleType){
-				continue;
-			}
-			else if(recordType == KLastType){
-				resyncing_ = false;
-				continue;
-			}
-			else{
-				resyncing_ = false;
-			}
-		}
-		switch(recordType){
-		case KFullType:{
-			if(inFragmentRecord){
-				if(!sratch->empty()){
-					reportCorruption(sratch->size(),"partial record without end(1)");
-				}
-			}
-			prospectiveRecordOffset = physicalReadOffset;
-			sratch->clear();
-			*record = fragment;
-			lastRecordOffset_ = prospectiveRecordOffset;
-			return true;
-		}
-		case KFirstType:{
-			if(inFragmentRecord){
-				if(!sratch->empty()){
-					reportCorruption(sratch->size(),"partial record without end(2)");
-				}
-			}
-			prospectiveRecordOffset = physicalReadOffset;
-			sratch->assign(fragment.data());
-			inFragmentRecord = true;
-			break;
-		}
-
-		case KMiddleType:{
-
-
-		}
-		}
-	}
-
-}
-
-bool CDB::Log::Reader::skipToInitialBlock()
-{
-	const size_t offsetInBlock = initOffset_ % KBlockSize;
-	uint64_t blockStartLocation = initOffset_ - offsetInBlock;
-	
-	//Don't seacrch a block if we in trailer 
-	if(offsetInBlock > KBlockSize - 6){
-		blockStartLocation += KBlockSize;
-	}
-	endOfBufferOffset_ = blockStartLocation;
-	if(blockStartLocation > 0){
-		Status skipStatus = file_->skip(blockStartLocation);
-		if(!skipStatus.ok()){
-			reportCorruption(blockStartLocation, skipStatus);
-			return false;
-		}
-	}
-	return true;
-}
-
-unsigned int CDB::Log::Reader::readPhysicalRecord(Slice* result)
-{
-	while(true){
-		if(buffer_.size() < KHeaderSize){
-			if(!eof_){
-				buffer_.clear();
-				Status status = file_->read(KBlockSize,&buffer_,backingStore_);
-				endOfBufferOffset_ += buffer_.size();
-				if(!status.ok()){
-					buffer_.clear();
-					reportCorruption(KBlockSize,status);
-					eof_ = true;
-					return KEof;
-				}
-				else if(buffer_.size() < KBlockSize){
-					eof_ = true;
-				}
-				continue;
-			}
-			else{
-				buffer_.clear();
-				return KEof;
-			}
-		}
-
-		//get the temp header
-		const char* header = buffer_.data();
-		const uint32_t a = static_cast<uint32_t>(header[4]) & 0xff;
-		const uint32_t b = static_cast<uint32_t>(header[5]) & 0xff;
-		const unsigned int type = header[6];
-		const uint32_t len = a | (b << 8);
-
-		if(KHeaderSize + len > buffer_.size()){
-			size_t dropSize = buffer_.size();
-			buffer_.clear();
-			if(!eof_){
-				reportCorruption(dropSize,"bad record length ");
-				return KBadRecord;
-			}
-			return KEof;
-		}
-
-		if(type == KZeroType && len == 0){
-			buffer_.clear();
-			return KBadRecord;
-		}
-
-		if(checkSum_){
-			uint32_t expectedCrc = crc32::Unmask(DecodeFixed32(header));
-			uint32_t actualCrc = crc32::Value(header + 6,1 + len);
-			if(actualCrc != expectedCrc){
-				size_t dropSize = buffer_.size();
-				buffer_.clear();
-				reportCorruption(dropSize, "checksum mismatch");
-				return KBadRecord;
-			}
-		}
-
-		buffer_.remove_prefix(KHeaderSize + len);
-
-		if(endOfBufferOffset_ - buffer_.size() - KHeaderSize - len < initOffset_){
-			result->clear();
-			return KBadRecord;
-		}
-		*result = Slice(header + KHeaderSize,len) ;
-		return type;
-	}
-}
+#include "DataBase/LogReader.h"
+#include <cstdio>
+#include "CDataBase/Env.h"
+#include "Util/Coding.h"
+#include "Util/Crc32.h"
+
+
+using namespace CDB;
+using namespace log;
+
+CDB::log::Reader::Reporter::~Reporter() = default;
+
+CDB::log::Reader::Reader(SequentialFile* file, Reporter* reporter, bool checkSum, uint64_t initOffset,
+	uint64_t logNumber)
+	:file_(file),reporter_(reporter),checkSum_(checkSum),backingStore_(new char[KBlockSize]),buffer_(),eof_(false),
+	lastRecordOffset_(0),endOfBufferOffset_(0),initOffset_(initOffset),resyncing_(initOffset > 0),
+	logNumber_(logNumber),recycled_(false)
+{
+}
+
+CDB::log::Reader::~Reader()
+{
+	delete[]backingStore_;
+}
+
+bool CDB::log::Reader::readRecord(Slice* record, std::string* sratch)
+{
+	if (lastRecordOffset_ < initOffset_) {
+		if(!skipToInitialBlock()){
+			return false;
+		}
+	}
+
+	sratch->clear();
+	*record = Slice();
+	bool inFragmentRecord = false;
+	// offset of the record being assembled
+	uint64_t prospectiveRecordOffset = 0;
+	Slice fragment;
+	while(true){
+		size_t headerSize = KHeaderSize;
+		const unsigned int recordType = readPhysicalRecord(&fragment, &headerSize);
+		// readPhysicalRecord may have only had an empty trailer remaining in
+		// its internal buffer, so the offset is computed after it returns
+		uint64_t physicalReadOffset = endOfBufferOffset_ - buffer_.size() - headerSize - fragment.size();
+		if(resyncing_){
+			if(recordType == KMiddleType || recordType == KRecyclableMiddleType){
+				continue;
+			}
+			else if(recordType == KLastType || recordType == KRecyclableLastType){
+				resyncing_ = false;
+				continue;
+			}
+			else{
+				resyncing_ = false;
+			}
+		}
+		switch(recordType){
+		case KFullType:
+		case KRecyclableFullType:{
+			if(inFragmentRecord){
+				if(!sratch->empty()){
+					reportCorruption(sratch->size(),"partial record without end(1)");
+				}
+			}
+			prospectiveRecordOffset = physicalReadOffset;
+			sratch->clear();
+			*record = fragment;
+			lastRecordOffset_ = prospectiveRecordOffset;
+			return true;
+		}
+		case KFirstType:
+		case KRecyclableFirstType:{
+			if(inFragmentRecord){
+				if(!sratch->empty()){
+					reportCorruption(sratch->size(),"partial record without end(2)");
+				}
+			}
+			prospectiveRecordOffset = physicalReadOffset;
+			sratch->assign(fragment.data(),fragment.size());
+			inFragmentRecord = true;
+			break;
+		}
+		case KMiddleType:
+		case KRecyclableMiddleType:{
+			if(!inFragmentRecord){
+				reportCorruption(fragment.size(),"missing start of fragmented record(1)");
+			}
+			else{
+				sratch->append(fragment.data(),fragment.size());
+			}
+			break;
+		}
+		case KLastType:
+		case KRecyclableLastType:{
+			if(!inFragmentRecord){
+				reportCorruption(fragment.size(),"missing start of fragmented record(2)");
+			}
+			else{
+				sratch->append(fragment.data(),fragment.size());
+				*record = Slice(*sratch);
+				lastRecordOffset_ = prospectiveRecordOffset;
+				return true;
+			}
+			break;
+		}
+		case KEof:{
+			// a writer that died in the middle of a record leaves a
+			// truncated tail, it is not reported as corruption
+			sratch->clear();
+			return false;
+		}
+		case KOldRecord:{
+			// the rest of the file is from its previous use
+			if(inFragmentRecord){
+				reportCorruption(sratch->size(),"partial record without end(3)");
+			}
+			sratch->clear();
+			return false;
+		}
+		case KBadRecord:{
+			if(inFragmentRecord){
+				reportCorruption(sratch->size(),"error in middle of record");
+				inFragmentRecord = false;
+				sratch->clear();
+			}
+			break;
+		}
+		default:{
+			char buf[40];
+			std::snprintf(buf,sizeof(buf),"unknown record type %u",recordType);
+			reportCorruption(fragment.size() + (inFragmentRecord ? sratch->size() : 0),buf);
+			inFragmentRecord = false;
+			sratch->clear();
+			break;
+		}
+		}
+	}
+	return false;
+}
+
+uint64_t CDB::log::Reader::lastRecordOffset()
+{
+	return lastRecordOffset_;
+}
+
+void CDB::log::Reader::reportCorruption(uint64_t bytes, const char* reason)
+{
+	reportDrop(bytes, Status::Corruption(reason));
+}
+
+void CDB::log::Reader::reportDrop(uint64_t bytes, const Status& reason)
+{
+	if(reporter_ != nullptr && endOfBufferOffset_ - buffer_.size() - bytes >= initOffset_){
+		reporter_->corruption(static_cast<size_t>(bytes), reason);
+	}
+}
+
+bool CDB::log::Reader::skipToInitialBlock()
+{
+	const size_t offsetInBlock = initOffset_ % KBlockSize;
+	uint64_t blockStartLocation = initOffset_ - offsetInBlock;
+	
+	//Don't seacrch a block if we in trailer 
+	if(offsetInBlock > KBlockSize - 6){
+		blockStartLocation += KBlockSize;
+	}
+	endOfBufferOffset_ = blockStartLocation;
+	if(blockStartLocation > 0){
+		Status skipStatus = file_->skip(blockStartLocation);
+		if(!skipStatus.ok()){
+			reportDrop(blockStartLocation, skipStatus);
+			return false;
+		}
+	}
+	return true;
+}
+
+unsigned int CDB::log::Reader::readPhysicalRecord(Slice* result, size_t* headerSize)
+{
+	while(true){
+		if(buffer_.size() < KHeaderSize){
+			if(!eof_){
+				buffer_ = Slice();
+				Status status = file_->read(KBlockSize,&buffer_,backingStore_);
+				endOfBufferOffset_ += buffer_.size();
+				if(!status.ok()){
+					buffer_ = Slice();
+					reportDrop(KBlockSize,status);
+					eof_ = true;
+					return KEof;
+				}
+				else if(buffer_.size() < KBlockSize){
+					eof_ = true;
+				}
+				continue;
+			}
+			else{
+				// a truncated header at the end of the file is what a
+				// writer crashing in the middle of it leaves behind
+				buffer_ = Slice();
+				return KEof;
+			}
+		}
+
+		//get the temp header
+		const char* header = buffer_.data();
+		const uint32_t a = static_cast<uint32_t>(header[4]) & 0xff;
+		const uint32_t b = static_cast<uint32_t>(header[5]) & 0xff;
+		const unsigned int type = header[6];
+		const uint32_t len = a | (b << 8);
+
+		*headerSize = KHeaderSize;
+		const bool recyclable = (type >= KRecyclableFullType && type <= KRecyclableLastType);
+		if(recyclable){
+			*headerSize = KRecyclableHeaderSize;
+			if(buffer_.size() < KRecyclableHeaderSize){
+				// the writer never leaves a trailer this long
+				size_t dropSize = buffer_.size();
+				buffer_ = Slice();
+				if(!eof_){
+					reportCorruption(dropSize,"truncated recyclable header");
+					return KBadRecord;
+				}
+				return KEof;
+			}
+		}
+
+		if(*headerSize + len > buffer_.size()){
+			size_t dropSize = buffer_.size();
+			buffer_ = Slice();
+			if(recycled_){
+				// the tail of the previous use of the file
+				return KOldRecord;
+			}
+			if(!eof_){
+				reportCorruption(dropSize,"bad record length ");
+				return KBadRecord;
+			}
+			return KEof;
+		}
+
+		if(type == KZeroType && len == 0){
+			// preallocated space that was never written
+			buffer_ = Slice();
+			return KBadRecord;
+		}
+
+		if(checkSum_){
+			uint32_t expectedCrc = crc32::Unmask(DecodeFixed32(header));
+			uint32_t actualCrc = crc32::Value(header + 6,1 + (*headerSize - KHeaderSize) + len);
+			if(actualCrc != expectedCrc){
+				// the length may itself be corrupt, drop the rest of the block
+				size_t dropSize = buffer_.size();
+				buffer_ = Slice();
+				if(recycled_){
+					// a new record cut short over an old one is the end of the log
+					return KOldRecord;
+				}
+				reportCorruption(dropSize, "checksum mismatch");
+				return KBadRecord;
+			}
+		}
+
+		buffer_.remove_prefix(*headerSize + len);
+
+		if(recyclable){
+			if(DecodeFixed32(header + KHeaderSize) != static_cast<uint32_t>(logNumber_)){
+				return KOldRecord;
+			}
+			recycled_ = true;
+		}
+		else if(recycled_ && type != KZeroType){
+			return KOldRecord;
+		}
+
+		if(endOfBufferOffset_ - buffer_.size() - *headerSize - len < initOffset_){
+			*result = Slice();
+			return KBadRecord;
+		}
+		*result = Slice(header + *headerSize,len) ;
+		return type;
+	}
+}
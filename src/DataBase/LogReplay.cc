@@ -0,0 +1,214 @@
+#include "DataBase/LogReplay.h"
+
+#include <cassert>
+#include <memory>
+#include <string>
+#include "CDataBase/Env.h"
+#include "CDataBase/WriteBatch.h"
+#include "DataBase/LogReader.h"
+#include "DataBase/MemTable.h"
+#include "DataBase/WriteBatchInternal.h"
+#include "Util/Coding.h"
+#include "Util/MutexLock.h"
+#include "Util/ThreadPool.h"
+
+namespace CDB{
+
+	namespace {
+
+		// records read ahead of the inserts are capped at this many bytes
+		const size_t KMaxPendingBytes = 64 << 20;
+
+		const size_t KBatchHeader = 12;
+
+		class LogReporter : public log::Reader::Reporter{
+		public:
+			Logger* infoLog;
+			// nullptr unless paranoid_checks is set
+			Status* status;
+
+			void corruption(size_t bytes, const Status& s) override
+			{
+				Log(infoLog, "%s%s: dropping %d bytes; %s", (status == nullptr ? "(ignoring error) " : ""),
+					"log replay", static_cast<int>(bytes), s.ToString().c_str());
+				if (status != nullptr && status->ok()) {
+					*status = s;
+				}
+			}
+		};
+
+		// a memtable and the batches still being inserted into it
+		struct Slot {
+			MemTable* mem = nullptr;
+			size_t bytes = 0;
+			int pending = 0;
+			bool sealed = false;
+		};
+
+		class ReplayState{
+		public:
+			ReplayState(const LogReplayer::FlushFunction& flush, int threads)
+				:flush_(flush), cv_(&mu_), pool_(threads), pendingBytes_(0)
+			{
+
+			}
+
+			Status error()
+			{
+				MutexLock l(&mu_);
+				return error_;
+			}
+
+			void insert(Slot* slot, std::string record)
+			{
+				const size_t size = record.size();
+				{
+					MutexLock l(&mu_);
+					while (pendingBytes_ > KMaxPendingBytes && error_.ok()) {
+						cv_.wait();
+					}
+					pendingBytes_ += size;
+					slot->pending++;
+				}
+				pool_.schedule([this, slot, size, record = std::move(record)]() mutable {
+					WriteBatch batch;
+					WriteBatchInternal::setContents(&batch, std::move(record));
+					Status s = WriteBatchInternal::insertInto(&batch, slot->mem, true);
+					MutexLock l(&mu_);
+					recordError(s);
+					pendingBytes_ -= size;
+					cv_.signalAll();
+					if (--slot->pending == 0 && slot->sealed) {
+						scheduleFlush(slot);
+					}
+				});
+			}
+
+			/// no more batches go into slot, it is flushed once they are in
+			void seal(Slot* slot)
+			{
+				MutexLock l(&mu_);
+				slot->sealed = true;
+				if (slot->pending == 0) {
+					scheduleFlush(slot);
+				}
+			}
+
+			void waitForIdle() { pool_.waitForIdle(); }
+
+		private:
+			void scheduleFlush(Slot* slot)
+			{
+				pool_.schedule([this, slot]() {
+					Status s = flush_(slot->mem);
+					slot->mem->unRef();
+					slot->mem = nullptr;
+					MutexLock l(&mu_);
+					recordError(s);
+				});
+			}
+
+			/// a batch that cannot be inserted or a memtable that cannot be
+			/// flushed loses writes that were acknowledged, unlike a corrupt
+			/// record it fails the replay whatever paranoid_checks says
+			void recordError(const Status& s)
+			{
+				if (s.ok()) {
+					return;
+				}
+				if (error_.ok()) {
+					error_ = s;
+					cv_.signalAll();
+				}
+			}
+
+			const LogReplayer::FlushFunction& flush_;
+			Mutex mu_;
+			CondVar cv_;
+			Status error_;
+			ThreadPool pool_;
+			size_t pendingBytes_;
+		};
+
+	}
+
+	LogReplayer::LogReplayer(const Options& options, const InternalKeyComparator& icmp, int threads)
+		:options_(options), icmp_(icmp), threads_(threads)
+	{
+
+	}
+
+	Status LogReplayer::replay(const std::vector<SequentialFile*>& logs, const FlushFunction& flush,
+		MemTable** mem, SequenceNumber* maxSequence, const std::vector<uint64_t>& logNumbers)
+	{
+		assert(logNumbers.empty() || logNumbers.size() == logs.size());
+		*mem = nullptr;
+		*maxSequence = 0;
+
+		std::vector<std::unique_ptr<Slot>> slots;
+		auto newSlot = [&]() {
+			slots.push_back(std::make_unique<Slot>());
+			Slot* slot = slots.back().get();
+			slot->mem = new MemTable(icmp_, options_.merge_operator);
+			slot->mem->ref();
+			return slot;
+		};
+
+		Status status;
+		bool stop = false;
+		// declared after slots so the pool is joined before they are freed
+		ReplayState state(flush, threads_);
+		Slot* current = newSlot();
+		for (size_t i = 0; i < logs.size() && !stop; ++i) {
+			LogReporter reporter;
+			reporter.infoLog = options_.infoLog;
+			reporter.status = options_.paranoid_checks ? &status : nullptr;
+			log::Reader reader(logs[i], &reporter, true, 0, logNumbers.empty() ? 0 : logNumbers[i]);
+			std::string scratch;
+			Slice record;
+			while (reader.readRecord(&record, &scratch)) {
+				if (!status.ok() || !state.error().ok()) {
+					stop = true;
+					break;
+				}
+				if (record.size() < KBatchHeader) {
+					reporter.corruption(record.size(), Status::Corruption("log record too small"));
+					continue;
+				}
+				const SequenceNumber sequence = DecodeFixed64(record.data());
+				const uint32_t count = DecodeFixed32(record.data() + 8);
+				if (count > 0 && sequence + count - 1 > *maxSequence) {
+					*maxSequence = sequence + count - 1;
+				}
+				// memtables are cut in log order, so each one holds a
+				// contiguous range of sequence numbers
+				if (current->bytes >= options_.write_buffer_size) {
+					state.seal(current);
+					current = newSlot();
+				}
+				current->bytes += record.size();
+				state.insert(current, std::string(record));
+			}
+		}
+
+		state.waitForIdle();
+		if (status.ok()) {
+			status = state.error();
+		}
+		if (status.ok() && current->bytes > 0) {
+			*mem = current->mem;
+		}
+		else {
+			current->mem->unRef();
+		}
+		current->mem = nullptr;
+		// slots sealed after an error may not have been flushed
+		for (auto& slot : slots) {
+			if (slot->mem != nullptr) {
+				slot->mem->unRef();
+			}
+		}
+		return status;
+	}
+
+}
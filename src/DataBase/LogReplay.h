@@ -0,0 +1,65 @@
+/*!
+ * \file LogReplay.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <functional>
+#include <vector>
+#include "CDataBase/Options.h"
+#include "CDataBase/Status.h"
+#include "DataBase/DBFormat.h"
+
+namespace CDB{
+
+	class MemTable;
+	class SequentialFile;
+
+	/*!
+	 * \class LogReplayer
+	 *
+	 * \brief rebuilds the memtables from the write ahead logs on open as a
+	 *  pipeline. the calling thread reads and checksums the 32KB blocks and
+	 *  cuts the records into memtables in log order, the pool threads decode
+	 *  the batches and insert them into their memtable concurrently, and
+	 *  each memtable that is full is flushed on the pool while the replay
+	 *  goes on. every entry keeps the sequence number of its batch, so the
+	 *  order the threads insert in does not matter
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class LogReplayer{
+	public:
+		/// write mem to a table, it is called from several threads at once
+		using FlushFunction = std::function<Status(MemTable* mem)>;
+
+		/// options.write_buffer_size bounds the memtables, a corrupt record
+		/// fails the replay if options.paranoid_checks is set and is logged
+		/// and skipped otherwise. a batch that cannot be inserted or a flush
+		/// that fails always fails the replay
+		LogReplayer(const Options& options, const InternalKeyComparator& icmp, int threads);
+
+		LogReplayer(const LogReplayer&) = delete;
+
+		LogReplayer& operator=(const LogReplayer&) = delete;
+
+		/// replay logs, oldest first. on success *mem holds the entries that were
+		/// not flushed with a reference for the caller, nullptr if there are
+		/// none, and *maxSequence the last sequence number found, 0 if none.
+		/// logNumbers holds the file number of each log, it is needed to skip
+		/// the stale records of recycled logs and may be empty otherwise
+		Status replay(const std::vector<SequentialFile*>& logs, const FlushFunction& flush,
+			MemTable** mem, SequenceNumber* maxSequence,
+			const std::vector<uint64_t>& logNumbers = {});
+
+	private:
+		const Options options_;
+		const InternalKeyComparator icmp_;
+		const int threads_;
+	};
+
+}
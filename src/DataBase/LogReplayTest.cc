@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "CDataBase/Iterator.h"
+#include "CDataBase/WriteBatch.h"
+#include "DataBase/LogReader.h"
+#include "DataBase/LogReplay.h"
+#include "DataBase/LogWriter.h"
+#include "DataBase/MemTable.h"
+#include "DataBase/MergeHelper.h"
+#include "DataBase/WriteBatchInternal.h"
+#include "DataBase/WriteThread.h"
+
+namespace CDB {
+
+	namespace {
+
+		class StringDest : public WritableFile {
+		public:
+			Status append(const Slice& data) override
+			{
+				contents.append(data.data(), data.size());
+				return Status::OK();
+			}
+			Status close() override { return Status::OK(); }
+			Status flush() override { return Status::OK(); }
+			Status sync() override { return Status::OK(); }
+
+			std::string contents;
+		};
+
+		class StringSource : public SequentialFile {
+		public:
+			explicit StringSource(const std::string& data) :contents_(data) {}
+
+			Status read(size_t n, Slice* result, char* scratch) override
+			{
+				if (n > contents_.size()) {
+					n = contents_.size();
+				}
+				std::memcpy(scratch, contents_.data(), n);
+				*result = Slice(scratch, n);
+				contents_.remove_prefix(n);
+				return Status::OK();
+			}
+			Status skip(uint64_t n) override
+			{
+				contents_.remove_prefix(std::min<uint64_t>(n, contents_.size()));
+				return Status::OK();
+			}
+
+		private:
+			Slice contents_;
+		};
+
+	}
+
+	class LogReplayTest : public testing::Test {
+	public:
+		LogReplayTest() :icmp_(byteWiseComparator()), sequence_(1) {}
+
+		/// one log with batches of batchSize puts, key i gets value "v<i>-<log>"
+		void writeLog(int log, int batches, int batchSize)
+		{
+			StringDest dest;
+			log::Writer writer(&dest);
+			for (int b = 0; b < batches; ++b) {
+				WriteBatch batch;
+				for (int i = 0; i < batchSize; ++i) {
+					const std::string key = "key" + std::to_string(b * batchSize + i);
+					batch.put(key, "v" + std::to_string(b * batchSize + i) + "-" + std::to_string(log));
+				}
+				WriteBatchInternal::setSequence(&batch, sequence_);
+				sequence_ += batchSize;
+				ASSERT_TRUE(writer.addRecord(WriteBatchInternal::contents(&batch)).ok());
+			}
+			logs_.push_back(dest.contents);
+		}
+
+		/// newest value of each key over the flushed memtables and the last one
+		Status replay(const Options& options, int threads, SequenceNumber* maxSequence)
+		{
+			std::vector<std::unique_ptr<StringSource>> sources;
+			std::vector<SequentialFile*> files;
+			for (const auto& log : logs_) {
+				sources.push_back(std::make_unique<StringSource>(log));
+				files.push_back(sources.back().get());
+			}
+			LogReplayer replayer(options, icmp_, threads);
+			MemTable* mem = nullptr;
+			Status s = replayer.replay(files, [this](MemTable* m) {
+				collect(m);
+				flushes_++;
+				return flushStatus_;
+			}, &mem, maxSequence);
+			if (mem != nullptr) {
+				collect(mem);
+				mem->unRef();
+			}
+			return s;
+		}
+
+		void collect(MemTable* mem)
+		{
+			std::unique_ptr<Iterator> iter(mem->newIterator());
+			std::lock_guard<std::mutex> l(mu_);
+			std::pair<SequenceNumber, SequenceNumber> range(kMaxSequenceNumber, 0);
+			for (iter->seekToFirst(); iter->valid(); iter->next()) {
+				ParsedInternalKey ikey;
+				ASSERT_TRUE(ParseInternalKey(iter->key(), &ikey));
+				range.first = std::min(range.first, ikey.sequence);
+				range.second = std::max(range.second, ikey.sequence);
+				auto& entry = contents_[std::string(ikey.user_key)];
+				if (ikey.sequence >= entry.first) {
+					entry = { ikey.sequence, std::string(iter->value()) };
+				}
+			}
+			ranges_.push_back(range);
+		}
+
+		InternalKeyComparator icmp_;
+		SequenceNumber sequence_;
+		std::vector<std::string> logs_;
+		std::mutex mu_;
+		std::map<std::string, std::pair<SequenceNumber, std::string>> contents_;
+		// the smallest and largest sequence number of each memtable
+		std::vector<std::pair<SequenceNumber, SequenceNumber>> ranges_;
+		std::atomic<int> flushes_{ 0 };
+		Status flushStatus_;
+	};
+
+	TEST_F(LogReplayTest, ReplayInParallel) {
+		writeLog(0, 200, 50);
+		writeLog(1, 200, 50);
+		writeLog(2, 100, 50);
+		Options options;
+		options.write_buffer_size = 64 * 1024;
+		SequenceNumber maxSequence;
+		ASSERT_TRUE(replay(options, 4, &maxSequence).ok());
+		ASSERT_EQ(sequence_ - 1, maxSequence);
+		ASSERT_GT(flushes_.load(), 1);
+		// keys written in every log carry the value of the newest one
+		ASSERT_EQ(10000u, contents_.size());
+		ASSERT_EQ("v0-2", contents_["key0"].second);
+		ASSERT_EQ("v4999-2", contents_["key4999"].second);
+		ASSERT_EQ("v5000-1", contents_["key5000"].second);
+		ASSERT_EQ("v9999-1", contents_["key9999"].second);
+	}
+
+	TEST_F(LogReplayTest, CorruptRecord) {
+		writeLog(0, 10, 10);
+		logs_[0][20] ^= 0x1;
+		Options options;
+		SequenceNumber maxSequence;
+		// the block with the corrupt record is skipped
+		ASSERT_TRUE(replay(options, 2, &maxSequence).ok());
+		ASSERT_TRUE(contents_.empty());
+
+		contents_.clear();
+		options.paranoid_checks = true;
+		ASSERT_TRUE(replay(options, 2, &maxSequence).IsCorruption());
+	}
+
+	TEST_F(LogReplayTest, FailedFlush) {
+		writeLog(0, 200, 50);
+		Options options;
+		options.write_buffer_size = 64 * 1024;
+		flushStatus_ = Status::IOError("flush failed");
+		SequenceNumber maxSequence;
+		// the memtable is gone with its writes, paranoid_checks or not
+		ASSERT_TRUE(replay(options, 4, &maxSequence).IsIOError());
+		ASSERT_GT(flushes_.load(), 0);
+	}
+
+	TEST_F(LogReplayTest, TwoWriteQueues) {
+		// the writes that skip the memtable take their own queue and share
+		// the log with the others
+		Options options;
+		options.two_write_queues = true;
+		options.write_buffer_size = 16 * 1024;
+		StringDest dest;
+		log::Writer writer(&dest);
+		MemTable* mem = new MemTable(icmp_);
+		mem->ref();
+		{
+			WriteThread wt(options, &writer, &dest, mem, 0);
+			std::vector<std::thread> workers;
+			for (int t = 0; t < 8; ++t) {
+				workers.emplace_back([&wt, t]() {
+					WriteOptions writeOptions;
+					writeOptions.disable_memtable = (t % 2 == 1);
+					for (int i = 0; i < 200; ++i) {
+						WriteBatch batch;
+						const std::string key = "t" + std::to_string(t) + "-" + std::to_string(i);
+						batch.put(key + "a", "va");
+						batch.put(key + "b", "vb");
+						ASSERT_TRUE(wt.write(writeOptions, &batch).ok());
+					}
+				});
+			}
+			for (auto& worker : workers) {
+				worker.join();
+			}
+		}
+		mem->unRef();
+		logs_.push_back(dest.contents);
+
+		// the records are appended in the order of their sequence numbers
+		StringSource source(dest.contents);
+		log::Reader reader(&source, nullptr, true, 0);
+		std::string scratch;
+		Slice record;
+		SequenceNumber next = 1;
+		while (reader.readRecord(&record, &scratch)) {
+			WriteBatch batch;
+			WriteBatchInternal::setContents(&batch, record);
+			ASSERT_EQ(next, WriteBatchInternal::sequence(&batch));
+			next += WriteBatchInternal::count(&batch);
+		}
+		ASSERT_EQ(3201u, next);
+
+		SequenceNumber maxSequence;
+		ASSERT_TRUE(replay(options, 4, &maxSequence).ok());
+		ASSERT_EQ(3200u, maxSequence);
+		ASSERT_EQ(3200u, contents_.size());
+		ASSERT_GT(flushes_.load(), 1);
+		// each memtable holds a range of sequence numbers of its own
+		std::sort(ranges_.begin(), ranges_.end());
+		for (size_t i = 1; i < ranges_.size(); ++i) {
+			ASSERT_EQ(ranges_[i - 1].second + 1, ranges_[i].first);
+		}
+		ASSERT_EQ(1u, ranges_.front().first);
+		ASSERT_EQ(3200u, ranges_.back().second);
+	}
+
+	TEST_F(LogReplayTest, Empty) {
+		Options options;
+		SequenceNumber maxSequence = 5;
+		ASSERT_TRUE(replay(options, 2, &maxSequence).ok());
+		ASSERT_EQ(0u, maxSequence);
+		ASSERT_EQ(0, flushes_.load());
+	}
+
+}
@@ -0,0 +1,199 @@
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "CDataBase/Env.h"
+#include "DataBase/LogReader.h"
+#include "DataBase/LogWriter.h"
+#include "Util/Coding.h"
+#include "Util/Crc32.h"
+#include "Util/Random.h"
+
+namespace CDB {
+
+	namespace log {
+
+		class LogTest : public testing::Test {
+		public:
+			class StringDest : public WritableFile {
+			public:
+				Status append(const Slice& data) override
+				{
+					contents.append(data.data(), data.size());
+					return Status::OK();
+				}
+				Status close() override { return Status::OK(); }
+				Status flush() override { return Status::OK(); }
+				Status sync() override { return Status::OK(); }
+
+				std::string contents;
+			};
+
+			class StringSource : public SequentialFile {
+			public:
+				Status read(size_t n, Slice* result, char* scratch) override
+				{
+					if (n > contents.size()) {
+						n = contents.size();
+					}
+					std::memcpy(scratch, contents.data(), n);
+					*result = Slice(scratch, n);
+					contents.remove_prefix(n);
+					return Status::OK();
+				}
+				Status skip(uint64_t n) override
+				{
+					if (n > contents.size()) {
+						contents = Slice();
+						return Status::NotFound("in-memory file skipped past end");
+					}
+					contents.remove_prefix(n);
+					return Status::OK();
+				}
+
+				Slice contents;
+			};
+
+			class ReportCollector : public Reader::Reporter {
+			public:
+				void corruption(size_t bytes, const Status& status) override
+				{
+					droppedBytes += bytes;
+					message.append(status.ToString());
+				}
+
+				size_t droppedBytes = 0;
+				std::string message;
+			};
+
+			LogTest() :writer_(&dest_) {}
+
+			void write(const std::string& msg) { ASSERT_TRUE(writer_.addRecord(Slice(msg)).ok()); }
+
+			std::vector<std::string> readAll(uint64_t logNumber = 0)
+			{
+				source_.contents = Slice(dest_.contents);
+				Reader reader(&source_, &report_, true, 0, logNumber);
+				std::vector<std::string> result;
+				std::string scratch;
+				Slice record;
+				while (reader.readRecord(&record, &scratch)) {
+					result.emplace_back(record);
+				}
+				return result;
+			}
+
+			static std::string bigString(const std::string& partial, size_t n)
+			{
+				std::string result;
+				while (result.size() < n) {
+					result.append(partial);
+				}
+				result.resize(n);
+				return result;
+			}
+
+			StringDest dest_;
+			StringSource source_;
+			ReportCollector report_;
+			Writer writer_;
+		};
+
+		TEST_F(LogTest, Empty) {
+			ASSERT_TRUE(readAll().empty());
+		}
+
+		TEST_F(LogTest, ReadWrite) {
+			write("foo");
+			write("bar");
+			write("");
+			write("xxxx");
+			std::vector<std::string> expected = { "foo", "bar", "", "xxxx" };
+			ASSERT_EQ(expected, readAll());
+			ASSERT_EQ(0u, report_.droppedBytes);
+		}
+
+		TEST_F(LogTest, Fragmentation) {
+			write("small");
+			write(bigString("medium", 50000));
+			write(bigString("large", 100000));
+			std::vector<std::string> expected = { "small", bigString("medium", 50000), bigString("large", 100000) };
+			ASSERT_EQ(expected, readAll());
+		}
+
+		TEST_F(LogTest, MarginalTrailer) {
+			// leave exactly a header's worth of space in the first block
+			const int n = KBlockSize - 2 * KHeaderSize;
+			write(bigString("foo", n));
+			ASSERT_EQ(static_cast<size_t>(KBlockSize - KHeaderSize), dest_.contents.size());
+			write("");
+			write("bar");
+			std::vector<std::string> expected = { bigString("foo", n), "", "bar" };
+			ASSERT_EQ(expected, readAll());
+		}
+
+		TEST_F(LogTest, ChecksumMismatch) {
+			write("foooooo");
+			write("bar");
+			dest_.contents[KHeaderSize] ^= 0x1;
+			// the block is dropped from the corrupt record on
+			ASSERT_TRUE(readAll().empty());
+			ASSERT_EQ(7u + 3u + 2 * KHeaderSize, report_.droppedBytes);
+			ASSERT_NE(std::string::npos, report_.message.find("checksum mismatch"));
+		}
+
+		TEST_F(LogTest, TruncatedTail) {
+			write("foo");
+			write(bigString("bar", 1000));
+			dest_.contents.resize(dest_.contents.size() - 10);
+			// a record cut short by a crash is not corruption
+			std::vector<std::string> expected = { "foo" };
+			ASSERT_EQ(expected, readAll());
+			ASSERT_EQ(0u, report_.droppedBytes);
+		}
+
+		TEST_F(LogTest, RecycledReadWrite) {
+			Writer writer(&dest_, 7, true);
+			ASSERT_TRUE(writer.addRecord("foo").ok());
+			ASSERT_TRUE(writer.addRecord(bigString("bar", 100000)).ok());
+			ASSERT_TRUE(writer.addRecord("").ok());
+			std::vector<std::string> expected = { "foo", bigString("bar", 100000), "" };
+			ASSERT_EQ(expected, readAll(7));
+			ASSERT_EQ(0u, report_.droppedBytes);
+		}
+
+		TEST_F(LogTest, RecycledStaleRecordsIgnored) {
+			{
+				Writer old(&dest_, 1, true);
+				ASSERT_TRUE(old.addRecord("aaa").ok());
+				ASSERT_TRUE(old.addRecord(bigString("old", 50000)).ok());
+				ASSERT_TRUE(old.addRecord("ccc").ok());
+			}
+			std::string previous = dest_.contents;
+			dest_.contents.clear();
+			Writer writer(&dest_, 2, true);
+			// the same length as the first old record, the next header read
+			// belongs to an old record with the old log number
+			ASSERT_TRUE(writer.addRecord("new").ok());
+			dest_.contents.append(previous.substr(dest_.contents.size()));
+			std::vector<std::string> expected = { "new" };
+			ASSERT_EQ(expected, readAll(2));
+			ASSERT_EQ(0u, report_.droppedBytes);
+		}
+
+		TEST_F(LogTest, RecycledOverLegacyLog) {
+			write(bigString("foo", 1000));
+			write("bar");
+			std::string previous = dest_.contents;
+			dest_.contents.clear();
+			Writer writer(&dest_, 3, true);
+			ASSERT_TRUE(writer.addRecord("new").ok());
+			dest_.contents.append(previous.substr(dest_.contents.size()));
+			// lands in the middle of an old record, that ends the log too
+			std::vector<std::string> expected = { "new" };
+			ASSERT_EQ(expected, readAll(3));
+			ASSERT_EQ(0u, report_.droppedBytes);
+		}
+
+	}
+
+}
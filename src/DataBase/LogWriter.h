@@ -1,46 +1,56 @@
-/*!
- * \file LogWriter.h
- *
- * \author czy
- * \date 2023.08.07
- *
- * 
- */
-#pragma once
-
-#include <cstdint>
-#include "CDataBase/Slice.h"
-#include "CDataBase/Status.h"
-#include "DataBase/DBFormat.h"
-#include "DataBase/LogFormat.h"
-namespace CDB{
-	class WritableFile;
-
-	namespace Log{
-		class Writer {
-		public:
-			explicit Writer(WritableFile* dest);
-
-			Writer(WritableFile* dest, uint64_t destLen);
-
-			Writer(const Writer&) = delete;
-
-			Writer& operator=(const Writer&) = delete;
-
-			~Writer() = default;
-
-			Status addRecord(const Slice& slice);
-
-		private:
-			Status emitPhysicalRecord(RecordType type, const char* ptr, size_t length);
-			
-			WritableFile* dest_;
-
-			int blockOffset_;
-
-			uint32_t typeCrc_[KMaxRecordType + 1];
-
-		};
-	}
-
-}
+/*!
+ * \file LogWriter.h
+ *
+ * \author czy
+ * \date 2023.08.07
+ *
+ * 
+ */
+#pragma once
+
+#include <cstdint>
+#include "CDataBase/Slice.h"
+#include "CDataBase/Status.h"
+#include "DataBase/DBFormat.h"
+#include "DataBase/LogFormat.h"
+namespace CDB{
+	class WritableFile;
+
+	namespace log{
+		class Writer {
+		public:
+			explicit Writer(WritableFile* dest);
+
+			Writer(WritableFile* dest, uint64_t destLen);
+
+			/// recycleLog writes the recyclable record types stamped with
+			/// logNumber, required when dest may be a reused file
+			Writer(WritableFile* dest, uint64_t logNumber, bool recycleLog);
+
+			Writer(const Writer&) = delete;
+
+			Writer& operator=(const Writer&) = delete;
+
+			~Writer() = default;
+
+			/// slice is written straight from the caller's memory, pass a
+			/// WriteBatch as WriteBatchInternal::contents() so it is not copied
+			Status addRecord(const Slice& slice);
+
+		private:
+			Status emitPhysicalRecord(RecordType type, const char* ptr, size_t length);
+			
+			WritableFile* dest_;
+
+			int blockOffset_;
+
+			const uint64_t logNumber_;
+
+			const bool recycleLog_;
+
+			uint32_t typeCrc_[KMaxRecordType + 1];
+
+		};
+	}
+
+}
@@ -1,159 +1,257 @@
-#include "DataBase/MemTable.h"
-#include "DataBase/DBFormat.h"
-#include "CDataBase/Comprator.h"
-#include "CDataBase/Env.h"
-#include "CDataBase/Iterator.h"
-#include "Util/Coding.h"
-
-namespace CDB{
-
-	static Slice getLengthPreFixedSlice(const char *data){
-		uint32_t len;
-		const char* p = data;
-		p = GetVarint32Ptr(p, p + 5, &len);
-		return Slice(p,len);
-	} 
-
-
-
-	MemTable::MemTable(const InternalKeyComparator& cmp)
-		:cmp_(cmp),refs_(0),table_(cmp_,&alloc_)
-	{
-
-	}
-
-	MemTable::~MemTable()
-	{
-		assert(refs_ == 0);
-	}
-
-	size_t MemTable::approximateMemUsage()
-	{
-		return allocator_->memUsage();
-	}
-
-
-
-	int MemTable::KeyComparator::operator()(const char* a, const char* b) const
-	{
-		Slice aSlice = getLengthPreFixedSlice(a);
-		Slice bSlice = getLengthPreFixedSlice(b);
-		return cmp_.compare(aSlice,bSlice);
-	}
-
-	static const char * encodeKey(std::string *scratch,const Slice &target){
-		scratch->clear();
-		PutVarint32(scratch, target.size());
-		scratch->append(target.data(),target.size());
-		return scratch->data();
-	}
-
-	class MemTableIterator : public Iterator{
-	public:
-		explicit MemTableIterator(MemTable::Table *table)
-			:iter(table){}	
-	
-		MemTableIterator(const MemTableIterator&) = delete;
-
-		MemTableIterator& operator=(const MemTableIterator&) = delete;
-
-		~MemTableIterator() = default;
-
-		bool valid() const override { return iter.valid(); }
-
-		bool seek(const Slice& key)  override { return iter_.seek(encodeKey(&tmp_, key)); }
-
-		void seekToFirst() override {
-			iter_.seekToFirst();
-		};
-			
-		void seekToLast() override{
-			iter_->seekToLast();
-		} 
-
-		void next() override
-		{
-			iter_.next();
-		}
-
-		void prev() override {
-			iter.prev();
-		}
-
-		Slice key() const override{
-			return getLengthPreFixedSlice(iter_.key());
-		}
-
-		Slice value() const override{
-			Slice keySlice = getLengthPreFixedSlice(iter_.key());
-			return getLengthPreFixedSlice(keySlice.data(),keySlice.size());
-		}
-
-		Status status () const override{
-			return Status::OK();
-		}
-	private:
-		MemTable::Table::Iterator iter_;
-		std::string tmp_;
-	};
-
-
-	Iterator* MemTable::newIterator() {
-		return new MemTableIterator(&table_);
-	}
-
-	void MemTable::add(SequenceNumber s,ValueType type,const Slice &key,const Slice &value){
-		/// levelDB save the key and value in 
-		/// Slice 
-		/// the memory like this
-		/// keySize :32bit of key length 4 byte
-		/// keyBytes :char[keySize]; keySize byte
-		/// tag  :uint64t((sequence << 8) | type) 8byte
-		/// valueSize :32bit of value size ;4 byte
-		/// valueByte : char[valueSize] ;valueSize byte  
-		size_t keySize = key.size();
-		size_t valSize = value.size();
-		size_t internalKeySize = keySize + 8;
-		const size_t encodedLen = VarintLength(internalKeySize) + VarintLength(valSize) + valSize + internalKeySize;
-		const char* buf = allocator_.allocate(encodedLen);
-		char* p = EncodeVarint32(buf, internalKeySize);
-		std::memcpy(p,key.data(),keySize);
-		p += keySize;
-		EncodeFixed64(p, (s<<8) | type);
-		p += 8;
-		p = EncodeVarint32(p,valSize);
-		std::memcpy(p,value.data(),valSize);
-		assert(p + valSize == buf + encodedLen);
-		table_.insert(buf);
-	}
-
-
-	bool MemTable::get(const LookupKey& key, std::string *value,Status *s){
-		Slice memKey = key.memtable_key();
-		Table::Iterator iter(&table_);
-		iter.seek(memKey.data());
-		if(iter.valid()){
-			const char* entry = iter.key();
-			uint32_t keyLen;
-			const char* keyPtr = GetVarint32Ptr(entry, entry + 5, &keyLen);
-			if(cmp_.cmp.user_comparator()->compare(Slice(keyPtr,keyLen - 8),key.user_key())){
-				const uint64_t tag = DecodeFixed64(keyPtr + keyLen - 8);
-				switch(static_cast<ValueType>(tag & 0xff)){
-				case kTypeValue:{
-					Slice v = getLengthPreFixedSlice(keyPtr + keyLen - 8);
-					value->assign(v.data(),v,size());
-					return true;
-				}
-				case kTypeDeletion:{
-					*s = Status::NotFound(Slice());
-					return true;
-				}
-
-				}
-			}
-			return false;
-		}
-	}
-
-}
-
+#include "DataBase/MemTable.h"
+#include <cstring>
+#include "DataBase/DBFormat.h"
+#include "DataBase/MergeHelper.h"
+#include "DataBase/RangeTombstone.h"
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "CDataBase/Iterator.h"
+#include "Util/Coding.h"
+
+namespace CDB{
+
+	static Slice getLengthPreFixedSlice(const char *data){
+		uint32_t len;
+		const char* p = data;
+		p = GetVarint32Ptr(p, p + 5, &len);
+		return Slice(p,len);
+	} 
+
+
+
+	MemTable::MemTable(const InternalKeyComparator& cmp, const MergeOperator* mergeOperator)
+		:cmp_(cmp),mergeOperator_(mergeOperator),refs_(0),table_(cmp_,&allocator_),rangeDelTable_(cmp_,&allocator_),
+		hasRangeDels_(false)
+	{
+
+	}
+
+	MemTable::~MemTable()
+	{
+		assert(refs_ == 0);
+	}
+
+	size_t MemTable::approximateMemUsage()
+	{
+		return allocator_.memUsage();
+	}
+
+
+
+	int MemTable::KeyComparator::operator()(const char* a, const char* b) const
+	{
+		Slice aSlice = getLengthPreFixedSlice(a);
+		Slice bSlice = getLengthPreFixedSlice(b);
+		return cmp.compare(aSlice,bSlice);
+	}
+
+	static const char * encodeKey(std::string *scratch,const Slice &target){
+		scratch->clear();
+		PutVarint32(scratch, target.size());
+		scratch->append(target.data(),target.size());
+		return scratch->data();
+	}
+
+	class MemTableIterator : public Iterator{
+	public:
+		explicit MemTableIterator(MemTable::Table *table)
+			:iter_(table){}	
+	
+		MemTableIterator(const MemTableIterator&) = delete;
+
+		MemTableIterator& operator=(const MemTableIterator&) = delete;
+
+		~MemTableIterator() = default;
+
+		bool valid() const override { return iter_.valid(); }
+
+		void seek(const Slice& key)  override { iter_.seek(encodeKey(&tmp_, key)); }
+
+		void seekToFirst() override {
+			iter_.seekToFirst();
+		};
+			
+		void seekToLast() override{
+			iter_.seekToLast();
+		} 
+
+		void next() override
+		{
+			iter_.next();
+		}
+
+		void prev() override {
+			iter_.prev();
+		}
+
+		Slice key() const override{
+			return getLengthPreFixedSlice(iter_.key());
+		}
+
+		Slice value() const override{
+			Slice keySlice = getLengthPreFixedSlice(iter_.key());
+			return getLengthPreFixedSlice(keySlice.data() + keySlice.size());
+		}
+
+		Status status () const override{
+			return Status::OK();
+		}
+	private:
+		MemTable::Table::Iterator iter_;
+		std::string tmp_;
+	};
+
+
+	Iterator* MemTable::newIterator() {
+		return new MemTableIterator(&table_);
+	}
+
+	Iterator* MemTable::newRangeTombstoneIterator() {
+		return new MemTableIterator(&rangeDelTable_);
+	}
+
+	std::shared_ptr<const FragmentedRangeTombstoneList> MemTable::getFragmentedRangeTombstones()
+	{
+		if (!hasRangeDels_.load(std::memory_order_acquire)) {
+			return nullptr;
+		}
+		std::shared_ptr<const FragmentedRangeTombstoneList> list = std::atomic_load(&fragmentedRangeDels_);
+		if (list != nullptr) {
+			return list;
+		}
+		// the first lookup after a range deletion rebuilds, under the mutex so
+		// a deletion added meanwhile drops the list it stores
+		MutexLock l(&rangeDelMutex_);
+		list = std::atomic_load(&fragmentedRangeDels_);
+		if (list == nullptr) {
+			std::unique_ptr<Iterator> iter(newRangeTombstoneIterator());
+			list = std::make_shared<const FragmentedRangeTombstoneList>(iter.get(), cmp_.cmp);
+			std::atomic_store(&fragmentedRangeDels_, list);
+		}
+		return list;
+	}
+
+	size_t MemTable::encodedLength(const Slice& key, const Slice& value){
+		const size_t internalKeySize = key.size() + 8;
+		return VarintLength(internalKeySize) + VarintLength(value.size()) + value.size() + internalKeySize;
+	}
+
+	void MemTable::encodeEntry(char* buf, size_t encodedLen, SequenceNumber s, ValueType type,
+		const Slice& key, const Slice& value){
+		/// levelDB save the key and value in 
+		/// Slice 
+		/// the memory like this
+		/// keySize :32bit of key length 4 byte
+		/// keyBytes :char[keySize]; keySize byte
+		/// tag  :uint64t((sequence << 8) | type) 8byte
+		/// valueSize :32bit of value size ;4 byte
+		/// valueByte : char[valueSize] ;valueSize byte  
+		size_t keySize = key.size();
+		size_t valSize = value.size();
+		size_t internalKeySize = keySize + 8;
+		char* p = EncodeVarint32(buf, internalKeySize);
+		std::memcpy(p,key.data(),keySize);
+		p += keySize;
+		EncodeFixed64(p, (s<<8) | type);
+		p += 8;
+		p = EncodeVarint32(p,valSize);
+		std::memcpy(p,value.data(),valSize);
+		assert(p + valSize == buf + encodedLen);
+		(void)encodedLen;
+	}
+
+	void MemTable::rangeDelAdded(){
+		MutexLock l(&rangeDelMutex_);
+		std::atomic_store(&fragmentedRangeDels_, std::shared_ptr<const FragmentedRangeTombstoneList>());
+		hasRangeDels_.store(true, std::memory_order_release);
+	}
+
+	void MemTable::add(SequenceNumber s,ValueType type,const Slice &key,const Slice &value){
+		const size_t encodedLen = encodedLength(key, value);
+		char* buf = allocator_.allocate(encodedLen);
+		encodeEntry(buf, encodedLen, s, type, key, value);
+		if(type == kTypeRangeDeletion){
+			rangeDelTable_.insert(buf);
+			rangeDelAdded();
+		}
+		else{
+			table_.insert(buf);
+		}
+	}
+
+	void MemTable::addConcurrently(SequenceNumber s,ValueType type,const Slice &key,const Slice &value){
+		const size_t encodedLen = encodedLength(key, value);
+		char* buf = allocator_.allocateConcurrently(encodedLen);
+		encodeEntry(buf, encodedLen, s, type, key, value);
+		if(type == kTypeRangeDeletion){
+			rangeDelTable_.insertConcurrently(buf);
+			rangeDelAdded();
+		}
+		else{
+			table_.insertConcurrently(buf);
+		}
+	}
+
+
+	bool MemTable::get(const LookupKey& key, std::string *value,Status *s,MergeContext *mergeContext){
+		Slice memKey = key.memtable_key();
+		// the newest range tombstone visible to this read that covers the key
+		SequenceNumber tombstoneSeq = 0;
+		std::shared_ptr<const FragmentedRangeTombstoneList> rangeDels = getFragmentedRangeTombstones();
+		if(rangeDels != nullptr){
+			const SequenceNumber snapshot = DecodeFixed64(key.internal_key().data() + key.internal_key().size() - 8) >> 8;
+			tombstoneSeq = rangeDels->maxCoveringTombstoneSeqnum(key.user_key(), snapshot);
+		}
+		// the entries of the key are visited newest first, merge operands are
+		// collected until something they can be applied to is found
+		auto foldOnto = [&](const Slice* base){
+			if(mergeContext->numOperands() == 0){
+				if(base == nullptr){
+					*s = Status::NotFound(Slice());
+				}
+				else{
+					value->assign(base->data(),base->size());
+				}
+				return true;
+			}
+			*s = MergeHelper::fullMerge(mergeOperator_, key.user_key(), base,
+				mergeContext->operandsOldestFirst(), value, nullptr);
+			return true;
+		};
+		Table::Iterator iter(&table_);
+		for(iter.seek(memKey.data()); iter.valid(); iter.next()){
+			const char* entry = iter.key();
+			uint32_t keyLen;
+			const char* keyPtr = GetVarint32Ptr(entry, entry + 5, &keyLen);
+			if(cmp_.cmp.user_comparator()->compare(Slice(keyPtr,keyLen - 8),key.user_key()) != 0){
+				break;
+			}
+			const uint64_t tag = DecodeFixed64(keyPtr + keyLen - 8);
+			if((tag >> 8) < tombstoneSeq){
+				return foldOnto(nullptr);
+			}
+			switch(static_cast<ValueType>(tag & 0xff)){
+			case kTypeValue:{
+				Slice v = getLengthPreFixedSlice(keyPtr + keyLen);
+				return foldOnto(&v);
+			}
+			case kTypeDeletion:
+				return foldOnto(nullptr);
+			case kTypeMerge:
+				if(mergeOperator_ == nullptr){
+					*s = Status::InvalidArgument("merge operand found but no merge_operator is set");
+					return true;
+				}
+				mergeContext->pushOperand(getLengthPreFixedSlice(keyPtr + keyLen));
+				break;
+			default:
+				break;
+			}
+		}
+		if(tombstoneSeq > 0){
+			return foldOnto(nullptr);
+		}
+		return false;
+	}
+
+}
@@ -1,83 +1,122 @@
-/*!
- * \file MemTable.h
- *
- * \author czy
- * \date 2023.08.02
- *
- * 
- */
-#pragma once
-#include <string>
-#include "DataBase/DBFormat.h"
-#include "DataBase/SkipList.h"
-#include "CDataBase/DB.h"
-#include "Util/Allocator.h" 
-namespace CDB{
-	
-	class InternalKeyComparator;
-	
-	class MemTableIterator;
-
-	class MemTable { 
-	public:
-		explicit MemTable(const InternalKeyComparator& cmp);
-
-		~MemTable();
-
-		MemTable(const MemTable&) = delete;
-
-		MemTable& operator(const MemTable&) = delete;
-
-		void ref() { ++refs_; }
-
-		void unRef(){
-			--refs_;
-			assert(refs_ >= 0);
-			if(refs_ <= 0){
-				delete this;
-			}
-		}
-
-		size_t approximateMemUsage();
-
-		void add(SequenceNumber seq, ValueType type, const Slice& key, const Slice& value);
-
-		bool get(const LookupKey& key, std::string* value, Status* s);
-
-
-
-
-		Iterator* newIterator();
-
-
-	private:
-		friend class MemTableIterator;
-
-		friend class MemTableBackWardIterator;
-
-		struct KeyComparator{
-			const InternalKeyComparator cmp;
-
-			explicit KeyComparator(const InternalKeyComparator & c) : 
-				:cmp(c){}
-
-			int operator()(const char* a, const char* b) const;
-		};
-
-		typedef SkipList<const char*, KeyComparator> Table;
-
-
-
-		~MemTable();
-
-		KeyComparator cmp_;
-	
-		int refs_;
-
-		Allocator allocator_;
-
-		Table table_;
-	};
-
-	
-} 
\ No newline at end of file
+/*!
+ * \file MemTable.h
+ *
+ * \author czy
+ * \date 2023.08.02
+ *
+ * 
+ */
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include "DataBase/DBFormat.h"
+#include "DataBase/SkipList.h"
+#include "CDataBase/DB.h"
+#include "Util/Allocator.h" 
+#include "Util/MutexLock.h"
+namespace CDB{
+	
+	class InternalKeyComparator;
+	
+	class MemTableIterator;
+
+	class FragmentedRangeTombstoneList;
+
+	class MergeContext;
+
+	class MergeOperator;
+
+	class MemTable { 
+	public:
+		/// mergeOperator folds the kTypeMerge entries met by get, not owned
+		explicit MemTable(const InternalKeyComparator& cmp, const MergeOperator* mergeOperator = nullptr);
+
+		MemTable(const MemTable&) = delete;
+
+		MemTable& operator=(const MemTable&) = delete;
+
+		void ref() { ++refs_; }
+
+		void unRef(){
+			--refs_;
+			assert(refs_ >= 0);
+			if(refs_ <= 0){
+				delete this;
+			}
+		}
+
+		size_t approximateMemUsage();
+
+		/// a kTypeRangeDeletion entry deletes [key, value) and is kept apart
+		/// from the point entries
+		void add(SequenceNumber seq, ValueType type, const Slice& key, const Slice& value);
+
+		/// add from several threads at once, used when logs are replayed in
+		/// parallel. must not run at the same time as add()
+		void addConcurrently(SequenceNumber seq, ValueType type, const Slice& key, const Slice& value);
+
+		/// true if the lookup is answered here. merge operands are collected in
+		/// mergeContext and folded once a value or a deletion is found, if the
+		/// key's entries end before that false is returned with the operands
+		/// left in mergeContext for the older sources
+		bool get(const LookupKey& key, std::string* value, Status* s, MergeContext* mergeContext);
+
+		Iterator* newIterator();
+
+		/// the range tombstones as written, keys are internal keys of the
+		/// begin keys and values the end keys
+		Iterator* newRangeTombstoneIterator();
+
+		/// the range tombstones fragmented for lookups, nullptr if there are
+		/// none. lock free unless the list has to be rebuilt
+		std::shared_ptr<const FragmentedRangeTombstoneList> getFragmentedRangeTombstones();
+
+	private:
+		friend class MemTableIterator;
+
+		friend class MemTableBackWardIterator;
+
+		struct KeyComparator{
+			const InternalKeyComparator cmp;
+
+			explicit KeyComparator(const InternalKeyComparator & c)
+				:cmp(c){}
+
+			int operator()(const char* a, const char* b) const;
+		};
+
+		typedef SkipList<const char*, KeyComparator> Table;
+
+		~MemTable();
+
+		static void encodeEntry(char* buf, size_t encodedLen, SequenceNumber seq, ValueType type,
+			const Slice& key, const Slice& value);
+
+		static size_t encodedLength(const Slice& key, const Slice& value);
+
+		void rangeDelAdded();
+
+		KeyComparator cmp_;
+
+		const MergeOperator* mergeOperator_;
+	
+		int refs_;
+
+		Allocator allocator_;
+
+		Table table_;
+
+		Table rangeDelTable_;
+
+		// serializes the rebuilds with the range deletions added meanwhile
+		Mutex rangeDelMutex_;
+		// rebuilt lazily after a range deletion was added, read and written
+		// with std::atomic_load and std::atomic_store
+		std::shared_ptr<const FragmentedRangeTombstoneList> fragmentedRangeDels_;
+		// lookups in a memtable without range deletions skip the list
+		std::atomic<bool> hasRangeDels_;
+	};
+
+	
+} 
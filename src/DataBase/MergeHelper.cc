@@ -0,0 +1,142 @@
+#include "DataBase/MergeHelper.h"
+
+#include <cassert>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "CDataBase/Iterator.h"
+#include "CDataBase/MergeOperator.h"
+#include "DataBase/RangeTombstone.h"
+
+namespace CDB{
+
+	std::vector<Slice> MergeContext::operandsOldestFirst() const
+	{
+		return std::vector<Slice>(operands_.rbegin(), operands_.rend());
+	}
+
+	MergeHelper::MergeHelper(const Comparator* userComparator, const MergeOperator* mergeOperator,
+		Logger* logger, bool atBottom)
+		:userComparator_(userComparator), mergeOperator_(mergeOperator),
+		logger_(logger), atBottom_(atBottom)
+	{
+
+	}
+
+	Status MergeHelper::fullMerge(const MergeOperator* mergeOperator, const Slice& key,
+		const Slice* value, const std::vector<Slice>& operands, std::string* result,
+		Logger* logger)
+	{
+		if (mergeOperator == nullptr) {
+			return Status::InvalidArgument("merge operand found but no merge_operator is set");
+		}
+		if (!mergeOperator->fullMerge(key, value, operands, result, logger)) {
+			return Status::Corruption("merge operator failed", key);
+		}
+		return Status::OK();
+	}
+
+	Status MergeHelper::mergeUntil(Iterator* iter, SequenceNumber stopBefore,
+		const FragmentedRangeTombstoneList* rangeDels)
+	{
+		keys_.clear();
+		values_.clear();
+		assert(iter->valid());
+
+		ParsedInternalKey ikey;
+		if (!ParseInternalKey(iter->key(), &ikey) || ikey.type != kTypeMerge) {
+			return Status::Corruption("mergeUntil not started at a merge operand");
+		}
+		// the result takes the place of the newest operand
+		const std::string userKey(ikey.user_key);
+		const SequenceNumber newestSeq = ikey.sequence;
+		const SequenceNumber tombstoneSeq = rangeDels == nullptr ? 0 :
+			rangeDels->maxCoveringTombstoneSeqnum(userKey, kMaxSequenceNumber);
+		if (newestSeq <= stopBefore || newestSeq < tombstoneSeq) {
+			// nothing to fold, the operand stays with the caller, which keeps
+			// it for the snapshot or drops it as deleted
+			return Status::OK();
+		}
+
+		// newest first
+		std::vector<std::string> operands;
+		std::vector<std::string> operandKeys;
+		bool hitBase = false;
+		bool hitSnapshot = false;
+		std::string baseValue;
+		bool baseIsValue = false;
+		for (; iter->valid(); iter->next()) {
+			if (!ParseInternalKey(iter->key(), &ikey)) {
+				return Status::Corruption("bad internal key", iter->key());
+			}
+			if (userComparator_->compare(ikey.user_key, userKey) != 0) {
+				break;
+			}
+			if (ikey.sequence <= stopBefore) {
+				hitSnapshot = true;
+				break;
+			}
+			if (ikey.sequence < tombstoneSeq) {
+				// covered by a newer range tombstone, the entry is left for
+				// the caller to drop
+				hitBase = true;
+				break;
+			}
+			if (ikey.type == kTypeMerge) {
+				operandKeys.emplace_back(iter->key());
+				operands.emplace_back(iter->value());
+				continue;
+			}
+			if (ikey.type == kTypeValue) {
+				baseValue.assign(iter->value().data(), iter->value().size());
+				baseIsValue = true;
+			}
+			hitBase = true;
+			iter->next();
+			break;
+		}
+		if (!iter->status().ok()) {
+			return iter->status();
+		}
+
+		std::vector<Slice> oldestFirst(operands.rbegin(), operands.rend());
+		if (hitBase || (atBottom_ && !hitSnapshot)) {
+			std::string result;
+			Slice base(baseValue);
+			Status s = fullMerge(mergeOperator_, userKey, baseIsValue ? &base : nullptr,
+				oldestFirst, &result, logger_);
+			if (!s.ok()) {
+				return s;
+			}
+			InternalKey key(userKey, newestSeq, kTypeValue);
+			keys_.emplace_back(key.Encode());
+			values_.push_back(std::move(result));
+			return Status::OK();
+		}
+
+		// an older value may still exist below, combine what can be combined
+		// and keep the result as operands
+		if (mergeOperator_ == nullptr) {
+			return Status::InvalidArgument("merge operand found but no merge_operator is set");
+		}
+		std::string combined(oldestFirst[0]);
+		size_t i = 1;
+		for (; i < oldestFirst.size(); ++i) {
+			std::string temp;
+			if (!mergeOperator_->partialMerge(userKey, combined, oldestFirst[i], &temp, logger_)) {
+				break;
+			}
+			combined.swap(temp);
+		}
+		if (i == oldestFirst.size()) {
+			InternalKey key(userKey, newestSeq, kTypeMerge);
+			keys_.emplace_back(key.Encode());
+			values_.push_back(std::move(combined));
+			return Status::OK();
+		}
+		// the operator cannot combine these, pass them through unchanged
+		keys_.swap(operandKeys);
+		values_.swap(operands);
+		return Status::OK();
+	}
+
+}
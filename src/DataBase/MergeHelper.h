@@ -0,0 +1,101 @@
+/*!
+ * \file MergeHelper.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <string>
+#include <vector>
+#include "CDataBase/Slice.h"
+#include "CDataBase/Status.h"
+#include "DataBase/DBFormat.h"
+
+namespace CDB{
+
+	class Comparator;
+	class FragmentedRangeTombstoneList;
+	class Iterator;
+	class Logger;
+	class MergeOperator;
+
+	/*!
+	 * \class MergeContext
+	 *
+	 * \brief the merge operands of a key met by a point lookup, carried from
+	 *  the memtables to the older sources until a value or a deletion is found
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class MergeContext{
+	public:
+		/// operands are pushed as they are met, newest first
+		void pushOperand(const Slice& operand) { operands_.emplace_back(operand); }
+
+		size_t numOperands() const { return operands_.size(); }
+
+		/// the order MergeOperator::fullMerge takes them in
+		std::vector<Slice> operandsOldestFirst() const;
+
+		void clear() { operands_.clear(); }
+
+	private:
+		// newest first
+		std::vector<std::string> operands_;
+	};
+
+	/*!
+	 * \class MergeHelper
+	 *
+	 * \brief folds the merge operands of one user key out of an internal
+	 *  iterator, used by compaction and by iterators over the merged view
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class MergeHelper{
+	public:
+		/// atBottom is true if no older entry of a key can exist below the
+		/// iterator, e.g. a compaction into the last level or an iterator over
+		/// every source, operands are then folded onto no value
+		MergeHelper(const Comparator* userComparator, const MergeOperator* mergeOperator,
+			Logger* logger, bool atBottom);
+
+		MergeHelper(const MergeHelper&) = delete;
+
+		MergeHelper& operator=(const MergeHelper&) = delete;
+
+		/// apply operands to value, nullptr if there is no value
+		static Status fullMerge(const MergeOperator* mergeOperator, const Slice& key,
+			const Slice* value, const std::vector<Slice>& operands, std::string* result,
+			Logger* logger);
+
+		/// iter is at a kTypeMerge entry. consume the entries of its user key
+		/// until a value, a deletion or an entry at or below stopBefore, which
+		/// belongs to an older snapshot and is left to the caller. entries
+		/// covered by a tombstone of rangeDels count as a deletion. afterwards
+		/// keys() and values() hold the entries to write in place of the
+		/// consumed ones, newest first, and iter is at the first entry not
+		/// consumed. if the entry at iter is itself at or below stopBefore or
+		/// covered by a tombstone nothing is consumed and keys() is empty
+		Status mergeUntil(Iterator* iter, SequenceNumber stopBefore = 0,
+			const FragmentedRangeTombstoneList* rangeDels = nullptr);
+
+		/// internal keys and values of the result
+		const std::vector<std::string>& keys() const { return keys_; }
+		const std::vector<std::string>& values() const { return values_; }
+
+	private:
+		const Comparator* userComparator_;
+		const MergeOperator* mergeOperator_;
+		Logger* logger_;
+		const bool atBottom_;
+
+		std::vector<std::string> keys_;
+		std::vector<std::string> values_;
+	};
+
+}
@@ -0,0 +1,205 @@
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Iterator.h"
+#include "CDataBase/MergeOperator.h"
+#include "CDataBase/WriteBatch.h"
+#include "DataBase/MemTable.h"
+#include "DataBase/MergeHelper.h"
+#include "DataBase/RangeTombstone.h"
+#include "DataBase/WriteBatchInternal.h"
+#include "Util/Coding.h"
+
+namespace CDB {
+
+	static std::string encodeU64(uint64_t v)
+	{
+		std::string result;
+		PutFixed64(&result, v);
+		return result;
+	}
+
+	class MergeTest : public testing::Test {
+	public:
+		MergeTest()
+			:icmp_(byteWiseComparator()), appendOp_(newStringAppendOperator(',')),
+			addOp_(newUInt64AddOperator())
+		{
+
+		}
+
+		MemTable* newMemTable(const MergeOperator* op)
+		{
+			MemTable* mem = new MemTable(icmp_, op);
+			mem->ref();
+			return mem;
+		}
+
+		static std::string get(MemTable* mem, const std::string& key, SequenceNumber seq,
+			MergeContext* mergeContext)
+		{
+			LookupKey lkey(key, seq);
+			std::string value;
+			Status s;
+			if (!mem->get(lkey, &value, &s, mergeContext)) {
+				return "MISSING";
+			}
+			if (s.IsNotFound()) {
+				return "NOT_FOUND";
+			}
+			return s.ok() ? value : s.ToString();
+		}
+
+		InternalKeyComparator icmp_;
+		std::unique_ptr<const MergeOperator> appendOp_;
+		std::unique_ptr<const MergeOperator> addOp_;
+	};
+
+	TEST_F(MergeTest, GetFoldsOperands) {
+		MemTable* mem = newMemTable(appendOp_.get());
+		mem->add(1, kTypeValue, "k", "a");
+		mem->add(2, kTypeMerge, "k", "b");
+		mem->add(3, kTypeMerge, "k", "c");
+		mem->add(4, kTypeDeletion, "d", "");
+		mem->add(5, kTypeMerge, "d", "x");
+
+		MergeContext ctx;
+		ASSERT_EQ("a,b,c", get(mem, "k", 100, &ctx));
+		ctx.clear();
+		ASSERT_EQ("a,b", get(mem, "k", 2, &ctx));
+		ctx.clear();
+		// a deletion below the operands leaves nothing to apply them to
+		ASSERT_EQ("x", get(mem, "d", 100, &ctx));
+		ctx.clear();
+		ASSERT_EQ("NOT_FOUND", get(mem, "d", 4, &ctx));
+		mem->unRef();
+	}
+
+	TEST_F(MergeTest, OperandsCarryToOlderSources) {
+		MemTable* older = newMemTable(addOp_.get());
+		MemTable* newer = newMemTable(addOp_.get());
+		older->add(1, kTypeValue, "counter", encodeU64(10));
+		newer->add(2, kTypeMerge, "counter", encodeU64(5));
+		newer->add(3, kTypeMerge, "counter", encodeU64(2));
+
+		MergeContext ctx;
+		ASSERT_EQ("MISSING", get(newer, "counter", 100, &ctx));
+		ASSERT_EQ(2u, ctx.numOperands());
+		ASSERT_EQ(encodeU64(17), get(older, "counter", 100, &ctx));
+		newer->unRef();
+		older->unRef();
+	}
+
+	TEST_F(MergeTest, RangeTombstoneEndsOperands) {
+		MemTable* mem = newMemTable(appendOp_.get());
+		mem->add(1, kTypeValue, "k", "old");
+		mem->add(2, kTypeRangeDeletion, "a", "z");
+		mem->add(3, kTypeMerge, "k", "new");
+		MergeContext ctx;
+		ASSERT_EQ("new", get(mem, "k", 100, &ctx));
+		mem->unRef();
+	}
+
+	TEST_F(MergeTest, NoOperator) {
+		MemTable* mem = newMemTable(nullptr);
+		mem->add(1, kTypeMerge, "k", "v");
+		MergeContext ctx;
+		ASSERT_NE(std::string::npos, get(mem, "k", 100, &ctx).find("merge_operator"));
+		mem->unRef();
+	}
+
+	TEST_F(MergeTest, BatchMerge) {
+		MemTable* mem = newMemTable(appendOp_.get());
+		WriteBatch batch;
+		batch.put("k", "1");
+		batch.merge("k", "2");
+		batch.merge("k", "3");
+		WriteBatchInternal::setSequence(&batch, 10);
+		ASSERT_TRUE(WriteBatchInternal::insertInto(&batch, mem).ok());
+		MergeContext ctx;
+		ASSERT_EQ("1,2,3", get(mem, "k", 100, &ctx));
+		mem->unRef();
+	}
+
+	TEST_F(MergeTest, MergeUntil) {
+		MemTable* mem = newMemTable(appendOp_.get());
+		mem->add(1, kTypeValue, "a", "base");
+		mem->add(2, kTypeMerge, "a", "x");
+		mem->add(3, kTypeMerge, "a", "y");
+		mem->add(4, kTypeMerge, "b", "p");
+		mem->add(5, kTypeMerge, "b", "q");
+		mem->add(6, kTypeValue, "c", "v");
+		std::unique_ptr<Iterator> iter(mem->newIterator());
+
+		// a value below the operands, they fold into a value with the newest sequence
+		MergeHelper helper(byteWiseComparator(), appendOp_.get(), nullptr, false);
+		iter->seekToFirst();
+		ASSERT_TRUE(helper.mergeUntil(iter.get()).ok());
+		ASSERT_EQ(1u, helper.keys().size());
+		ParsedInternalKey ikey;
+		ASSERT_TRUE(ParseInternalKey(helper.keys()[0], &ikey));
+		ASSERT_EQ(3u, ikey.sequence);
+		ASSERT_EQ(kTypeValue, ikey.type);
+		ASSERT_EQ("base,x,y", helper.values()[0]);
+
+		// no value below and not at the bottom, the operands are combined
+		ASSERT_TRUE(iter->valid());
+		ASSERT_TRUE(helper.mergeUntil(iter.get()).ok());
+		ASSERT_EQ(1u, helper.keys().size());
+		ASSERT_TRUE(ParseInternalKey(helper.keys()[0], &ikey));
+		ASSERT_EQ(kTypeMerge, ikey.type);
+		ASSERT_EQ("p,q", helper.values()[0]);
+		ASSERT_TRUE(iter->valid());
+		ASSERT_EQ("c", std::string(ExtractUserKey(iter->key())));
+
+		// at the bottom the operands fold onto no value
+		MergeHelper bottom(byteWiseComparator(), appendOp_.get(), nullptr, true);
+		iter->seek(InternalKey("b", kMaxSequenceNumber, kValueTypeForSeek).Encode());
+		ASSERT_TRUE(bottom.mergeUntil(iter.get()).ok());
+		ASSERT_EQ(1u, bottom.keys().size());
+		ASSERT_TRUE(ParseInternalKey(bottom.keys()[0], &ikey));
+		ASSERT_EQ(kTypeValue, ikey.type);
+		ASSERT_EQ("p,q", bottom.values()[0]);
+
+		// unless an older snapshot at 4 still sees the operand at 4
+		iter->seek(InternalKey("b", kMaxSequenceNumber, kValueTypeForSeek).Encode());
+		ASSERT_TRUE(bottom.mergeUntil(iter.get(), 4).ok());
+		ASSERT_EQ(1u, bottom.keys().size());
+		ASSERT_TRUE(ParseInternalKey(bottom.keys()[0], &ikey));
+		ASSERT_EQ(kTypeMerge, ikey.type);
+		ASSERT_EQ("q", bottom.values()[0]);
+		ASSERT_TRUE(ParseInternalKey(iter->key(), &ikey));
+		ASSERT_EQ(4u, ikey.sequence);
+
+		// an older snapshot sees the first operand, nothing is consumed
+		ASSERT_TRUE(bottom.mergeUntil(iter.get(), 4).ok());
+		ASSERT_TRUE(bottom.keys().empty());
+		ASSERT_TRUE(iter->valid());
+		ASSERT_TRUE(ParseInternalKey(iter->key(), &ikey));
+		ASSERT_EQ(4u, ikey.sequence);
+		mem->unRef();
+	}
+
+	TEST_F(MergeTest, MergeUntilCoveredOperand) {
+		MemTable* mem = newMemTable(appendOp_.get());
+		mem->add(1, kTypeMerge, "k", "x");
+		mem->add(2, kTypeMerge, "k", "y");
+		mem->add(3, kTypeRangeDeletion, "a", "z");
+		std::shared_ptr<const FragmentedRangeTombstoneList> rangeDels = mem->getFragmentedRangeTombstones();
+		ASSERT_NE(nullptr, rangeDels);
+		std::unique_ptr<Iterator> iter(mem->newIterator());
+
+		// the operands are deleted, no value is made up for the key
+		MergeHelper bottom(byteWiseComparator(), appendOp_.get(), nullptr, true);
+		iter->seekToFirst();
+		ASSERT_TRUE(bottom.mergeUntil(iter.get(), 0, rangeDels.get()).ok());
+		ASSERT_TRUE(bottom.keys().empty());
+		ASSERT_TRUE(iter->valid());
+		ParsedInternalKey ikey;
+		ASSERT_TRUE(ParseInternalKey(iter->key(), &ikey));
+		ASSERT_EQ(2u, ikey.sequence);
+		mem->unRef();
+	}
+
+}
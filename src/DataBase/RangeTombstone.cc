@@ -0,0 +1,105 @@
+#include "DataBase/RangeTombstone.h"
+
+#include <algorithm>
+#include <functional>
+#include "CDataBase/Iterator.h"
+
+namespace CDB{
+
+	namespace {
+
+		struct Tombstone {
+			std::string startKey;
+			std::string endKey;
+			SequenceNumber seq;
+		};
+
+	}
+
+	FragmentedRangeTombstoneList::FragmentedRangeTombstoneList(Iterator* iter,
+		const InternalKeyComparator& icmp)
+		:ucmp_(icmp.user_comparator())
+	{
+		std::vector<Tombstone> tombstones;
+		std::vector<std::string> bounds;
+		for (iter->seekToFirst(); iter->valid(); iter->next()) {
+			ParsedInternalKey ikey;
+			if (!ParseInternalKey(iter->key(), &ikey) || ikey.type != kTypeRangeDeletion) {
+				continue;
+			}
+			const Slice end = iter->value();
+			// an empty range deletes nothing
+			if (ucmp_->compare(ikey.user_key, end) >= 0) {
+				continue;
+			}
+			tombstones.push_back({ std::string(ikey.user_key), std::string(end), ikey.sequence });
+			bounds.emplace_back(ikey.user_key);
+			bounds.emplace_back(end);
+		}
+		if (tombstones.empty()) {
+			return;
+		}
+
+		auto less = [this](const std::string& a, const std::string& b) {
+			return ucmp_->compare(a, b) < 0;
+		};
+		std::sort(bounds.begin(), bounds.end(), less);
+		bounds.erase(std::unique(bounds.begin(), bounds.end(), [this](const std::string& a, const std::string& b) {
+			return ucmp_->compare(a, b) == 0;
+		}), bounds.end());
+		std::sort(tombstones.begin(), tombstones.end(), [&less](const Tombstone& a, const Tombstone& b) {
+			return less(a.startKey, b.startKey);
+		});
+
+		// sweep the bounds from left to right, every gap between two bounds is
+		// covered by exactly the tombstones active at its left bound
+		std::vector<const Tombstone*> active;
+		size_t next = 0;
+		for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+			const std::string& left = bounds[i];
+			while (next < tombstones.size() && !less(left, tombstones[next].startKey)) {
+				active.push_back(&tombstones[next++]);
+			}
+			active.erase(std::remove_if(active.begin(), active.end(), [&](const Tombstone* t) {
+				return !less(left, t->endKey);
+			}), active.end());
+			if (active.empty()) {
+				continue;
+			}
+
+			Fragment fragment;
+			fragment.startKey = left;
+			fragment.endKey = bounds[i + 1];
+			fragment.seqBegin = seqs_.size();
+			for (const Tombstone* t : active) {
+				seqs_.push_back(t->seq);
+			}
+			fragment.seqEnd = seqs_.size();
+			std::sort(seqs_.begin() + fragment.seqBegin, seqs_.end(), std::greater<SequenceNumber>());
+			fragments_.push_back(std::move(fragment));
+		}
+	}
+
+	SequenceNumber FragmentedRangeTombstoneList::maxCoveringTombstoneSeqnum(const Slice& userKey,
+		SequenceNumber upper) const
+	{
+		// the last fragment starting at or before userKey
+		auto pos = std::upper_bound(fragments_.begin(), fragments_.end(), userKey,
+			[this](const Slice& key, const Fragment& f) {
+				return ucmp_->compare(key, f.startKey) < 0;
+			});
+		if (pos == fragments_.begin()) {
+			return 0;
+		}
+		--pos;
+		if (ucmp_->compare(userKey, pos->endKey) >= 0) {
+			return 0;
+		}
+		// sequence numbers are decreasing, find the first one visible at upper
+		auto begin = seqs_.begin() + pos->seqBegin;
+		auto end = seqs_.begin() + pos->seqEnd;
+		auto seq = std::lower_bound(begin, end, upper, std::greater<SequenceNumber>());
+		return seq == end ? 0 : *seq;
+	}
+
+}
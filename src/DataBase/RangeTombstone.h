@@ -0,0 +1,70 @@
+/*!
+ * \file RangeTombstone.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <string>
+#include <vector>
+#include "DataBase/DBFormat.h"
+
+namespace CDB{
+
+	class Iterator;
+
+	/*!
+	 * \class FragmentedRangeTombstoneList
+	 *
+	 * \brief range tombstones cut into non-overlapping fragments sorted by
+	 *  their begin key, each fragment keeps the sequence numbers of all
+	 *  tombstones covering it in decreasing order, so a coverage check is
+	 *  two binary searches
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class FragmentedRangeTombstoneList{
+	public:
+		/// iter yields the tombstones as written, the key is the internal key of
+		/// the begin key with type kTypeRangeDeletion and the value the end key
+		FragmentedRangeTombstoneList(Iterator* iter, const InternalKeyComparator& icmp);
+
+		FragmentedRangeTombstoneList(const FragmentedRangeTombstoneList&) = delete;
+
+		FragmentedRangeTombstoneList& operator=(const FragmentedRangeTombstoneList&) = delete;
+
+		bool empty() const { return fragments_.empty(); }
+
+		size_t numFragments() const { return fragments_.size(); }
+
+		/// the largest sequence number <= upper of a tombstone covering userKey,
+		/// 0 if none covers it
+		SequenceNumber maxCoveringTombstoneSeqnum(const Slice& userKey, SequenceNumber upper) const;
+
+		/// true if a tombstone newer than the entry covers it. upper is the oldest
+		/// snapshot, only tombstones every reader sees may drop an entry
+		bool shouldDelete(const ParsedInternalKey& key, SequenceNumber upper = kMaxSequenceNumber) const
+		{
+			return maxCoveringTombstoneSeqnum(key.user_key, upper) > key.sequence;
+		}
+
+	private:
+		struct Fragment {
+			std::string startKey;
+			std::string endKey;
+			// the range of seqs_ holding this fragment's sequence numbers
+			size_t seqBegin;
+			size_t seqEnd;
+		};
+
+		const Comparator* const ucmp_;
+
+		std::vector<Fragment> fragments_;
+
+		std::vector<SequenceNumber> seqs_;
+	};
+
+}
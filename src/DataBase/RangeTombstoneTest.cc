@@ -0,0 +1,168 @@
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/WriteBatch.h"
+#include "DataBase/MemTable.h"
+#include "DataBase/MergeHelper.h"
+#include "DataBase/RangeTombstone.h"
+#include "DataBase/WriteBatchInternal.h"
+
+namespace CDB {
+
+	class RangeTombstoneTest : public testing::Test {
+	public:
+		RangeTombstoneTest()
+			:icmp_(byteWiseComparator()), mem_(new MemTable(icmp_))
+		{
+			mem_->ref();
+		}
+
+		~RangeTombstoneTest()
+		{
+			mem_->unRef();
+		}
+
+		std::string get(const std::string& key, SequenceNumber seq)
+		{
+			LookupKey lkey(key, seq);
+			std::string value;
+			Status s;
+			MergeContext mergeContext;
+			if (!mem_->get(lkey, &value, &s, &mergeContext)) {
+				return "MISSING";
+			}
+			return s.ok() ? value : "NOT_FOUND";
+		}
+
+		InternalKeyComparator icmp_;
+		MemTable* mem_;
+	};
+
+	TEST_F(RangeTombstoneTest, Fragments) {
+		mem_->add(10, kTypeRangeDeletion, "a", "e");
+		mem_->add(20, kTypeRangeDeletion, "c", "g");
+		mem_->add(5, kTypeRangeDeletion, "x", "z");
+		// an empty range is ignored
+		mem_->add(30, kTypeRangeDeletion, "m", "m");
+
+		std::shared_ptr<const FragmentedRangeTombstoneList> list = mem_->getFragmentedRangeTombstones();
+		ASSERT_NE(nullptr, list);
+		// [a,c) [c,e) [e,g) [x,z)
+		ASSERT_EQ(4u, list->numFragments());
+		ASSERT_EQ(10u, list->maxCoveringTombstoneSeqnum("b", kMaxSequenceNumber));
+		ASSERT_EQ(20u, list->maxCoveringTombstoneSeqnum("d", kMaxSequenceNumber));
+		ASSERT_EQ(10u, list->maxCoveringTombstoneSeqnum("d", 15));
+		ASSERT_EQ(0u, list->maxCoveringTombstoneSeqnum("d", 9));
+		ASSERT_EQ(20u, list->maxCoveringTombstoneSeqnum("f", kMaxSequenceNumber));
+		// end keys are exclusive
+		ASSERT_EQ(0u, list->maxCoveringTombstoneSeqnum("g", kMaxSequenceNumber));
+		ASSERT_EQ(0u, list->maxCoveringTombstoneSeqnum("m", kMaxSequenceNumber));
+		ASSERT_EQ(5u, list->maxCoveringTombstoneSeqnum("y", kMaxSequenceNumber));
+		ASSERT_EQ(0u, list->maxCoveringTombstoneSeqnum("0", kMaxSequenceNumber));
+
+		ASSERT_TRUE(list->shouldDelete(ParsedInternalKey("d", 15, kTypeValue)));
+		ASSERT_FALSE(list->shouldDelete(ParsedInternalKey("d", 25, kTypeValue)));
+		// a snapshot at 15 still reads the entry at 12, the tombstone at 20 can not drop it
+		ASSERT_FALSE(list->shouldDelete(ParsedInternalKey("d", 12, kTypeValue), 15));
+	}
+
+	TEST_F(RangeTombstoneTest, ListKeptUntilNextDeletion) {
+		ASSERT_EQ(nullptr, mem_->getFragmentedRangeTombstones());
+		mem_->add(10, kTypeRangeDeletion, "a", "e");
+		std::shared_ptr<const FragmentedRangeTombstoneList> list = mem_->getFragmentedRangeTombstones();
+		ASSERT_NE(nullptr, list);
+		// lookups share the list until a range deletion is added
+		ASSERT_EQ(list, mem_->getFragmentedRangeTombstones());
+		mem_->add(20, kTypeRangeDeletion, "x", "z");
+		std::shared_ptr<const FragmentedRangeTombstoneList> rebuilt = mem_->getFragmentedRangeTombstones();
+		ASSERT_NE(list, rebuilt);
+		ASSERT_EQ(2u, rebuilt->numFragments());
+		// the old list stays usable by whoever holds it
+		ASSERT_EQ(1u, list->numFragments());
+	}
+
+	TEST_F(RangeTombstoneTest, ConcurrentGetsWhileDeleting) {
+		mem_->add(1, kTypeValue, "k", "v");
+		std::atomic<bool> stop{ false };
+		std::vector<std::thread> readers;
+		for (int t = 0; t < 4; ++t) {
+			readers.emplace_back([this, &stop]() {
+				while (!stop.load()) {
+					const std::string v = get("k", kMaxSequenceNumber);
+					ASSERT_TRUE(v == "v" || v == "NOT_FOUND");
+				}
+			});
+		}
+		for (int i = 0; i < 200; ++i) {
+			const std::string begin = "r" + std::to_string(1000 + i);
+			mem_->add(10 + i, kTypeRangeDeletion, begin, begin + "z");
+		}
+		mem_->add(1000, kTypeRangeDeletion, "a", "z");
+		stop.store(true);
+		for (auto& reader : readers) {
+			reader.join();
+		}
+		ASSERT_EQ("NOT_FOUND", get("k", kMaxSequenceNumber));
+		ASSERT_GT(mem_->getFragmentedRangeTombstones()->numFragments(), 200u);
+	}
+
+	TEST_F(RangeTombstoneTest, MemTableGet) {
+		WriteBatch batch;
+		batch.put("apple", "1");
+		batch.put("banana", "2");
+		batch.put("cherry", "3");
+		batch.deleteRange("apple", "cherry");
+		batch.put("apricot", "4");
+		WriteBatchInternal::setSequence(&batch, 100);
+		ASSERT_EQ(5, WriteBatchInternal::count(&batch));
+		ASSERT_TRUE(WriteBatchInternal::insertInto(&batch, mem_).ok());
+
+		ASSERT_EQ("NOT_FOUND", get("apple", 200));
+		ASSERT_EQ("NOT_FOUND", get("banana", 200));
+		ASSERT_EQ("3", get("cherry", 200));
+		// written after the tombstone
+		ASSERT_EQ("4", get("apricot", 200));
+		// a key never written inside the range is known to be deleted
+		ASSERT_EQ("NOT_FOUND", get("avocado", 200));
+		ASSERT_EQ("MISSING", get("zucchini", 200));
+		// reads before the tombstone still see the values
+		ASSERT_EQ("1", get("apple", 102));
+		ASSERT_EQ("2", get("banana", 102));
+	}
+
+	TEST_F(RangeTombstoneTest, BatchIterate) {
+		class Recorder : public WriteBatch::Handler {
+		public:
+			void put(const Slice& key, const Slice& value) override
+			{
+				ops.append("put(" + std::string(key) + "," + std::string(value) + ")");
+			}
+			void deleteK(const Slice& key) override
+			{
+				ops.append("del(" + std::string(key) + ")");
+			}
+			void deleteRange(const Slice& begin, const Slice& end) override
+			{
+				ops.append("delRange(" + std::string(begin) + "," + std::string(end) + ")");
+			}
+			void merge(const Slice& key, const Slice& value) override
+			{
+				ops.append("merge(" + std::string(key) + "," + std::string(value) + ")");
+			}
+			std::string ops;
+		};
+
+		WriteBatch batch;
+		batch.put("a", "1");
+		batch.deleteK("b");
+		batch.deleteRange("c", "f");
+		Recorder recorder;
+		ASSERT_TRUE(batch.iterate(&recorder).ok());
+		ASSERT_EQ("put(a,1)del(b)delRange(c,f)", recorder.ops);
+	}
+
+}
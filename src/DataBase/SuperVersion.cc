@@ -0,0 +1,145 @@
+#include "DataBase/SuperVersion.h"
+
+#include <vector>
+#include "DataBase/MemTable.h"
+#include "DataBase/VersionSet.h"
+
+namespace CDB{
+
+	namespace {
+		// distinct addresses for the two markers
+		char gSVInUse;
+		char gSVObsolete;
+	}
+
+	void* const SuperVersionManager::KSVInUse = &gSVInUse;
+	void* const SuperVersionManager::KSVObsolete = &gSVObsolete;
+
+	void SuperVersion::cleanup()
+	{
+		mem->unRef();
+		if (imm != nullptr) {
+			imm->unRef();
+		}
+		current->unRef();
+	}
+
+	SuperVersionManager::SuperVersionManager(Mutex* mu)
+		:mu_(mu), localSV_(&SuperVersionManager::unrefHandler), current_(nullptr), versionNumber_(0)
+	{
+	}
+
+	SuperVersionManager::~SuperVersionManager()
+	{
+		// drop the cached references of all threads first, they never
+		// hold the last one while current_ is alive
+		std::vector<void*> cached;
+		localSV_.scrape(&cached, nullptr);
+		for (void* ptr : cached) {
+			assert(ptr != KSVInUse);
+			if (ptr != KSVObsolete) {
+				unrefAndMaybeDelete(static_cast<SuperVersion*>(ptr));
+			}
+		}
+		if (current_ != nullptr) {
+			unrefAndMaybeDelete(current_);
+		}
+	}
+
+	void SuperVersionManager::unrefHandler(void* ptr)
+	{
+		// a thread exited with a SuperVersion cached. it is usually not the
+		// last reference, but the exiting thread takes it out of its slot
+		// before the handler runs, so an install() in between does not
+		// scrape it and may drop the reference of current_ first
+		if (ptr == KSVInUse || ptr == KSVObsolete) {
+			return;
+		}
+		SuperVersion* sv = static_cast<SuperVersion*>(ptr);
+		if (sv->unRef()) {
+			{
+				MutexLock l(sv->mu);
+				sv->cleanup();
+			}
+			delete sv;
+		}
+	}
+
+	void SuperVersionManager::unrefAndMaybeDelete(SuperVersion* sv)
+	{
+		if (sv->unRef()) {
+			{
+				MutexLock l(mu_);
+				sv->cleanup();
+			}
+			delete sv;
+		}
+	}
+
+	void SuperVersionManager::install(SuperVersion* sv, MemTable* mem, MemTable* imm, Version* current)
+	{
+		mu_->assrtHeld();
+		sv->mem = mem;
+		sv->imm = imm;
+		sv->current = current;
+		sv->mu = mu_;
+		mem->ref();
+		if (imm != nullptr) {
+			imm->ref();
+		}
+		current->ref();
+		sv->versionNumber = versionNumber_.load(std::memory_order_relaxed) + 1;
+		sv->ref();
+
+		SuperVersion* old = current_;
+		current_ = sv;
+		versionNumber_.store(sv->versionNumber, std::memory_order_release);
+
+		// threads that are not using their cached SuperVersion lose it now,
+		// a thread using it finds KSVObsolete on release and unrefs it itself
+		std::vector<void*> cached;
+		localSV_.scrape(&cached, KSVObsolete);
+		for (void* ptr : cached) {
+			if (ptr == KSVInUse || ptr == KSVObsolete) {
+				continue;
+			}
+			SuperVersion* cachedSV = static_cast<SuperVersion*>(ptr);
+			if (cachedSV->unRef()) {
+				cachedSV->cleanup();
+				delete cachedSV;
+			}
+		}
+		if (old != nullptr && old->unRef()) {
+			old->cleanup();
+			delete old;
+		}
+	}
+
+	SuperVersion* SuperVersionManager::acquire()
+	{
+		// mark the slot in use so install() does not unref it under us
+		void* ptr = localSV_.swap(KSVInUse);
+		assert(ptr != KSVInUse);
+		SuperVersion* sv = static_cast<SuperVersion*>(ptr);
+		if (sv != nullptr && ptr != KSVObsolete) {
+			return sv;
+		}
+		// nothing cached or outdated, take a reference on the current one
+		MutexLock l(mu_);
+		assert(current_ != nullptr);
+		return current_->ref();
+	}
+
+	void SuperVersionManager::release(SuperVersion* sv)
+	{
+		void* expected = KSVInUse;
+		if (localSV_.compareAndSwap(sv, expected)) {
+			// cached for the next acquire, the reference stays with the slot
+			return;
+		}
+		// install() marked the slot obsolete meanwhile
+		assert(expected == KSVObsolete);
+		unrefAndMaybeDelete(sv);
+	}
+
+}
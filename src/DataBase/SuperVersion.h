@@ -0,0 +1,118 @@
+/*!
+ * \file SuperVersion.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "Util/MutexLock.h"
+#include "Util/ThreadLocal.h"
+
+namespace CDB{
+
+	class MemTable;
+	class Version;
+
+	/*!
+	 * \struct SuperVersion
+	 *
+	 * \brief the memtable, the immutable memtable and the current version
+	 *  pinned together, a reader holding a SuperVersion needs no db mutex,
+	 *  the reference count is atomic so readers ref and unref it freely
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	struct SuperVersion {
+		MemTable* mem = nullptr;
+		MemTable* imm = nullptr;
+		Version* current = nullptr;
+		// increases with every installed SuperVersion
+		uint64_t versionNumber = 0;
+		// the db mutex cleanup() is called with, set by install()
+		Mutex* mu = nullptr;
+
+		SuperVersion* ref()
+		{
+			refs_.fetch_add(1, std::memory_order_relaxed);
+			return this;
+		}
+
+		/// true if this was the last reference, the caller then calls
+		/// cleanup() with the db mutex held and deletes the SuperVersion
+		bool unRef()
+		{
+			const int previous = refs_.fetch_sub(1, std::memory_order_acq_rel);
+			assert(previous > 0);
+			return previous == 1;
+		}
+
+		/// drop the references on mem, imm and current
+		/// REQUIRES: db mutex held
+		void cleanup();
+
+	private:
+		std::atomic<int> refs_{ 0 };
+	};
+
+	/*!
+	 * \class SuperVersionManager
+	 *
+	 * \brief hands out the current SuperVersion, every thread caches the one
+	 *  it used last in a thread local slot so the common acquire/release
+	 *  pair is two atomic swaps, installing a new SuperVersion invalidates
+	 *  all cached ones
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class SuperVersionManager{
+	public:
+		/// mu is the db mutex, it guards the memtables and versions
+		explicit SuperVersionManager(Mutex* mu);
+
+		SuperVersionManager(const SuperVersionManager&) = delete;
+
+		SuperVersionManager& operator=(const SuperVersionManager&) = delete;
+
+		/// REQUIRES: no SuperVersion is acquired, the db mutex is not held
+		~SuperVersionManager();
+
+		/// make sv the current SuperVersion, sv takes references on mem, imm and current
+		/// REQUIRES: db mutex held
+		void install(SuperVersion* sv, MemTable* mem, MemTable* imm, Version* current)
+			EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+		/// pin the current SuperVersion, the db mutex is only taken when the
+		/// cached one of this thread is outdated
+		SuperVersion* acquire() LOCKS_EXCLUDED(mu_);
+
+		/// give back a SuperVersion returned by acquire()
+		void release(SuperVersion* sv) LOCKS_EXCLUDED(mu_);
+
+		uint64_t versionNumber() const { return versionNumber_.load(std::memory_order_acquire); }
+
+	private:
+		static void unrefHandler(void* ptr);
+
+		void unrefAndMaybeDelete(SuperVersion* sv) LOCKS_EXCLUDED(mu_);
+
+		Mutex* const mu_;
+
+		// the thread is using its cached SuperVersion right now
+		static void* const KSVInUse;
+		// the cached SuperVersion was replaced by a newer one
+		static void* const KSVObsolete;
+
+		ThreadLocalPtr localSV_;
+
+		SuperVersion* current_ GUARDED_BY(mu_);
+
+		std::atomic<uint64_t> versionNumber_;
+	};
+
+}
@@ -0,0 +1,116 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "CDataBase/Comprator.h"
+#include "DataBase/MemTable.h"
+#include "DataBase/SuperVersion.h"
+#include "DataBase/VersionSet.h"
+
+namespace CDB {
+
+	class SuperVersionTest : public testing::Test {
+	public:
+		SuperVersionTest()
+			:icmp_(byteWiseComparator()), manager_(&mu_)
+		{
+		}
+
+		// install a SuperVersion over a fresh memtable and version
+		void installNew()
+		{
+			MemTable* mem = new MemTable(icmp_);
+			Version* version = new Version;
+			MutexLock l(&mu_);
+			manager_.install(new SuperVersion, mem, nullptr, version);
+		}
+
+		InternalKeyComparator icmp_;
+		Mutex mu_;
+		SuperVersionManager manager_;
+	};
+
+	TEST_F(SuperVersionTest, CachedPerThread) {
+		installNew();
+		ASSERT_EQ(1u, manager_.versionNumber());
+
+		SuperVersion* sv = manager_.acquire();
+		ASSERT_EQ(1u, sv->versionNumber);
+		manager_.release(sv);
+
+		// the cached one comes back without the mutex, a held mutex proves it
+		mu_.lock();
+		SuperVersion* cached = manager_.acquire();
+		mu_.unlock();
+		ASSERT_EQ(sv, cached);
+		manager_.release(cached);
+
+		installNew();
+		sv = manager_.acquire();
+		ASSERT_EQ(2u, sv->versionNumber);
+		manager_.release(sv);
+	}
+
+	TEST_F(SuperVersionTest, InstallWhileInUse) {
+		installNew();
+		SuperVersion* sv = manager_.acquire();
+		MemTable* mem = sv->mem;
+		// the old SuperVersion stays usable until it is released
+		installNew();
+		ASSERT_EQ(mem, sv->mem);
+		ASSERT_EQ(1u, sv->versionNumber);
+		manager_.release(sv);
+
+		sv = manager_.acquire();
+		ASSERT_EQ(2u, sv->versionNumber);
+		manager_.release(sv);
+	}
+
+	TEST_F(SuperVersionTest, ConcurrentReaders) {
+		installNew();
+		std::atomic<bool> stop(false);
+		std::vector<std::thread> readers;
+		for (int t = 0; t < 4; ++t) {
+			readers.emplace_back([this, &stop] {
+				uint64_t last = 0;
+				while (!stop.load(std::memory_order_acquire)) {
+					SuperVersion* sv = manager_.acquire();
+					// never goes backwards
+					ASSERT_LE(last, sv->versionNumber);
+					last = sv->versionNumber;
+					ASSERT_NE(nullptr, sv->mem);
+					manager_.release(sv);
+				}
+			});
+		}
+		for (int i = 0; i < 200; ++i) {
+			installNew();
+		}
+		stop.store(true, std::memory_order_release);
+		for (auto& reader : readers) {
+			reader.join();
+		}
+		ASSERT_EQ(201u, manager_.versionNumber());
+	}
+
+	TEST_F(SuperVersionTest, ThreadsExitDuringInstall) {
+		installNew();
+		std::atomic<bool> stop(false);
+		std::thread installer([this, &stop] {
+			while (!stop.load(std::memory_order_acquire)) {
+				installNew();
+			}
+		});
+		// every thread exits with its SuperVersion cached, one the installer
+		// may be replacing at that moment
+		for (int i = 0; i < 200; ++i) {
+			std::thread reader([this] {
+				manager_.release(manager_.acquire());
+			});
+			reader.join();
+		}
+		stop.store(true, std::memory_order_release);
+		installer.join();
+	}
+
+}
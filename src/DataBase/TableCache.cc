@@ -0,0 +1,190 @@
+/*!
+ * \file TableCache.cc
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#include "DataBase/TableCache.h"
+
+#include <algorithm>
+#include "CDataBase/Env.h"
+#include "DataBase/FileName.h"
+#include "Util/Coding.h"
+
+namespace CDB{
+
+	namespace {
+
+		struct TableAndFile {
+			RandomAccessFile* file;
+			Table* table;
+		};
+
+		void deleteEntry(const Slice& key, void* value)
+		{
+			TableAndFile* tf = reinterpret_cast<TableAndFile*>(value);
+			delete tf->table;
+			delete tf->file;
+			delete tf;
+		}
+
+		void unrefEntry(void* arg1, void* arg2)
+		{
+			Cache* cache = reinterpret_cast<Cache*>(arg1);
+			Cache::Handle* h = reinterpret_cast<Cache::Handle*>(arg2);
+			cache->release(h);
+		}
+
+	}
+
+	int TableCache::tableCacheSize(const Options& options)
+	{
+		if (options.max_open_files < 0) {
+			return KInfiniteCapacity;
+		}
+		return std::max(options.max_open_files - KNumNonTableCacheFiles, 1);
+	}
+
+	TableCache::TableCache(const std::string& dbname, const Options& options, int entries)
+		: env_(options.env),
+		dbname_(dbname),
+		options_(options),
+		cache_(newLRUCache(entries)),
+		pinnedMemory_(0)
+	{
+	}
+
+	TableCache::~TableCache()
+	{
+		{
+			MutexLock l(&pinMu_);
+			for (const auto& [number, handle] : pinned_) {
+				cache_->release(handle);
+			}
+			pinned_.clear();
+		}
+		delete cache_;
+	}
+
+	Status TableCache::findTable(uint64_t fileNumber, uint64_t fileSize, int level, Cache::Handle** handle)
+	{
+		Status s;
+		char buf[sizeof(fileNumber)];
+		EncodeFixed64(buf, fileNumber);
+		Slice key(buf, sizeof(buf));
+		*handle = cache_->lookUp(key);
+		if (*handle == nullptr) {
+			std::string fname = tableFileName(dbname_, fileNumber);
+			RandomAccessFile* file = nullptr;
+			Table* table = nullptr;
+			s = env_->newRandomAccessFile(fname, &file);
+			if (s.ok()) {
+				s = Table::open(options_, file, fileSize, &table);
+			}
+
+			if (!s.ok()) {
+				assert(table == nullptr);
+				delete file;
+				// We do not cache error results so that if the error is transient,
+				// or somebody repairs the file, we recover automatically.
+				return s;
+			}
+			table->setMemoryCounter(&pinnedMemory_);
+			TableAndFile* tf = new TableAndFile;
+			tf->file = file;
+			tf->table = table;
+			*handle = cache_->insert(key, tf, 1, &deleteEntry);
+		}
+
+		// level 0 files overlap, every get searches all of them
+		if (level == 0) {
+			MutexLock l(&pinMu_);
+			if (pinned_.find(fileNumber) == pinned_.end()) {
+				Cache::Handle* pin = cache_->lookUp(key);
+				if (pin != nullptr) {
+					pinned_[fileNumber] = pin;
+					if (options_.cache_index_and_filter_blocks &&
+						options_.pin_l0_filter_and_index_blocks_in_cache) {
+						// on failure the blocks are read through the block cache
+						reinterpret_cast<TableAndFile*>(cache_->value(pin))->table->pinIndexAndFilter();
+					}
+				}
+			}
+		}
+		return s;
+	}
+
+	Iterator* TableCache::newIterator(const ReadOptions& options, uint64_t fileNumber,
+		uint64_t fileSize, int level, Table** tableptr, BlockPrefetcher* prefetcher)
+	{
+		if (tableptr != nullptr) {
+			*tableptr = nullptr;
+		}
+
+		Cache::Handle* handle = nullptr;
+		Status s = findTable(fileNumber, fileSize, level, &handle);
+		if (!s.ok()) {
+			return newErrorIterator(s);
+		}
+
+		Table* table = reinterpret_cast<TableAndFile*>(cache_->value(handle))->table;
+		Iterator* result = table->newIterator(options, prefetcher);
+		result->registerCleanup(&unrefEntry, cache_, handle);
+		if (tableptr != nullptr) {
+			*tableptr = table;
+		}
+		return result;
+	}
+
+	Status TableCache::get(const ReadOptions& options, uint64_t fileNumber, uint64_t fileSize,
+		int level, const Slice& k, void* arg,
+		void (*handleResult)(void*, const Slice&, const Slice&))
+	{
+		Cache::Handle* handle = nullptr;
+		Status s = findTable(fileNumber, fileSize, level, &handle);
+		if (s.ok()) {
+			Table* t = reinterpret_cast<TableAndFile*>(cache_->value(handle))->table;
+			s = t->internalGet(options, k, arg, handleResult);
+			cache_->release(handle);
+		}
+		return s;
+	}
+
+	Status TableCache::rangeTombstones(uint64_t fileNumber, uint64_t fileSize, int level,
+		std::shared_ptr<const FragmentedRangeTombstoneList>* tombstones)
+	{
+		tombstones->reset();
+		Cache::Handle* handle = nullptr;
+		Status s = findTable(fileNumber, fileSize, level, &handle);
+		if (s.ok()) {
+			Table* t = reinterpret_cast<TableAndFile*>(cache_->value(handle))->table;
+			s = t->rangeTombstones(tombstones);
+			cache_->release(handle);
+		}
+		return s;
+	}
+
+	void TableCache::evict(uint64_t fileNumber)
+	{
+		{
+			MutexLock l(&pinMu_);
+			auto it = pinned_.find(fileNumber);
+			if (it != pinned_.end()) {
+				cache_->release(it->second);
+				pinned_.erase(it);
+			}
+		}
+		char buf[sizeof(fileNumber)];
+		EncodeFixed64(buf, fileNumber);
+		cache_->erase(Slice(buf, sizeof(buf)));
+	}
+
+	size_t TableCache::pinnedTables() const
+	{
+		MutexLock l(&pinMu_);
+		return pinned_.size();
+	}
+
+}
@@ -0,0 +1,104 @@
+/*!
+ * \file TableCache.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "CDataBase/Cache.h"
+#include "CDataBase/Options.h"
+#include "CDataBase/Table.h"
+#include "Util/MutexLock.h"
+
+namespace CDB{
+
+	class BlockPrefetcher;
+	class Env;
+	class FragmentedRangeTombstoneList;
+
+	/*!
+	 * \class TableCache
+	 *
+	 * \brief keeps the tables of the db open in a Cache keyed by file
+	 *  number, so a read does not reopen the file and parse its footer. the
+	 *  cache holds at most max_open_files tables less the files the db keeps
+	 *  open itself, max_open_files = -1 keeps every table open. the tables
+	 *  of level 0 are read by every get and stay pinned until evicted, with
+	 *  pin_l0_filter_and_index_blocks_in_cache so do their index and filter
+	 *  blocks. thread safe
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class TableCache{
+	public:
+		// files the db keeps open besides the tables, the log, the
+		// descriptor, the info log and the lock file
+		static constexpr int KNumNonTableCacheFiles = 10;
+
+		// capacity used for max_open_files = -1
+		static constexpr int KInfiniteCapacity = 0x400000;
+
+		/// entries for the table cache of a db opened with options
+		static int tableCacheSize(const Options& options);
+
+		TableCache(const std::string& dbname, const Options& options, int entries);
+
+		TableCache(const TableCache&) = delete;
+
+		TableCache& operator=(const TableCache&) = delete;
+
+		~TableCache();
+
+		/// an iterator over the table of the file, the table of a level 0
+		/// file is pinned. if tableptr is non-null *tableptr is set to the
+		/// table, or to nullptr if there is none, it is owned by the cache
+		/// and valid while the iterator is. a compaction passes its
+		/// prefetcher to have the blocks of its inputs read ahead
+		Iterator* newIterator(const ReadOptions& options, uint64_t fileNumber,
+			uint64_t fileSize, int level = -1, Table** tableptr = nullptr,
+			BlockPrefetcher* prefetcher = nullptr);
+
+		/// if a seek to internal key k in the file finds an entry,
+		/// call handleResult(arg, found key, found value)
+		Status get(const ReadOptions& options, uint64_t fileNumber, uint64_t fileSize,
+			int level, const Slice& k, void* arg,
+			void (*handleResult)(void*, const Slice&, const Slice&));
+
+		/// the range tombstones of the file's table, nullptr if it has none.
+		/// they stay valid after the table is evicted
+		Status rangeTombstones(uint64_t fileNumber, uint64_t fileSize, int level,
+			std::shared_ptr<const FragmentedRangeTombstoneList>* tombstones);
+
+		/// drop the table of the file, called when the file is deleted
+		void evict(uint64_t fileNumber);
+
+		size_t pinnedTables() const;
+
+		/// bytes of the index and filter blocks held by the open tables
+		/// outside the block cache, the "cdb.estimate-table-readers-mem"
+		/// property of the db
+		uint64_t pinnedMemoryUsage() const { return pinnedMemory_.load(std::memory_order_relaxed); }
+
+	private:
+		Status findTable(uint64_t fileNumber, uint64_t fileSize, int level, Cache::Handle** handle);
+
+		Env* const env_;
+		const std::string dbname_;
+		const Options& options_;
+		Cache* cache_;
+		std::atomic<uint64_t> pinnedMemory_;
+
+		mutable Mutex pinMu_;
+		// an extra reference to the entry of each pinned table
+		std::unordered_map<uint64_t, Cache::Handle*> pinned_ GUARDED_BY(pinMu_);
+	};
+
+}
@@ -0,0 +1,268 @@
+#include "DataBase/TableCache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "CDataBase/TableBuilder.h"
+#include "DataBase/DBFormat.h"
+#include "DataBase/FileName.h"
+#include "DataBase/RangeTombstone.h"
+#include "Table/BlockPrefetcher.h"
+
+namespace CDB{
+
+	class TableCacheTest : public testing::Test {
+	protected:
+		void SetUp() override {
+			env_ = Env::Default();
+			ASSERT_TRUE(env_->getTestDir(&dbname_).ok());
+			dbname_ += "/table_cache_test";
+			env_->createDir(dbname_);
+			options_.comparator = byteWiseComparator();
+			for (uint64_t number = 1; number <= 5; ++number) {
+				writeTable(number);
+			}
+		}
+
+		void TearDown() override {
+			for (uint64_t number = 1; number <= 5; ++number) {
+				env_->removeFile(tableFileName(dbname_, number));
+			}
+			env_->removeDir(dbname_);
+		}
+
+		static std::string key(uint64_t number, int i) {
+			return "t" + std::to_string(number) + "k" + std::to_string(1000 + i);
+		}
+
+		void writeTable(uint64_t number) {
+			WritableFile* file;
+			ASSERT_TRUE(env_->newWritableFile(tableFileName(dbname_, number), &file).ok());
+			TableBuilder builder(options_, file);
+			for (int i = 0; i < 100; ++i) {
+				builder.add(key(number, i), "v" + std::to_string(i));
+			}
+			ASSERT_TRUE(builder.finish().ok());
+			sizes_[number] = builder.fileSize();
+			ASSERT_TRUE(file->close().ok());
+			delete file;
+		}
+
+		static void saveValue(void* arg, const Slice& k, const Slice& v) {
+			reinterpret_cast<std::string*>(arg)->assign(v.data(), v.size());
+		}
+
+		std::string get(TableCache* cache, uint64_t number, int i, int level = 1) {
+			std::string value = "NOT_FOUND";
+			Status s = cache->get(ReadOptions(), number, sizes_[number], level, key(number, i),
+				&value, &saveValue);
+			EXPECT_TRUE(s.ok()) << s.ToString();
+			return value;
+		}
+
+		Env* env_;
+		std::string dbname_;
+		Options options_;
+		uint64_t sizes_[6] = {};
+	};
+
+	TEST_F(TableCacheTest, GetAndIterate) {
+		TableCache cache(dbname_, options_, 100);
+		ASSERT_EQ("v7", get(&cache, 1, 7));
+		ASSERT_EQ("v99", get(&cache, 3, 99));
+
+		Table* table;
+		std::unique_ptr<Iterator> iter(cache.newIterator(ReadOptions(), 2, sizes_[2], 1, &table));
+		ASSERT_TRUE(table != nullptr);
+		int n = 0;
+		for (iter->seekToFirst(); iter->valid(); iter->next()) {
+			ASSERT_EQ(key(2, n), iter->key());
+			++n;
+		}
+		ASSERT_EQ(100, n);
+
+		std::unique_ptr<Iterator> missing(cache.newIterator(ReadOptions(), 42, 1000));
+		ASSERT_FALSE(missing->status().ok());
+	}
+
+	TEST_F(TableCacheTest, ReopensTablesPastCapacity) {
+		// one table open at a time
+		TableCache cache(dbname_, options_, 1);
+		for (int round = 0; round < 3; ++round) {
+			for (uint64_t number = 1; number <= 5; ++number) {
+				ASSERT_EQ("v42", get(&cache, number, 42));
+			}
+		}
+	}
+
+	TEST_F(TableCacheTest, PinsLevelZeroTables) {
+		TableCache cache(dbname_, options_, 1);
+		ASSERT_EQ("v1", get(&cache, 1, 1, 0));
+		ASSERT_EQ("v1", get(&cache, 2, 1, 0));
+		ASSERT_EQ("v1", get(&cache, 3, 1, 1));
+		ASSERT_EQ(2u, cache.pinnedTables());
+		cache.evict(1);
+		ASSERT_EQ(1u, cache.pinnedTables());
+		ASSERT_EQ("v1", get(&cache, 1, 1));
+	}
+
+	TEST_F(TableCacheTest, ReportsPinnedIndexMemory) {
+		TableCache cache(dbname_, options_, 100);
+		ASSERT_EQ(0u, cache.pinnedMemoryUsage());
+		ASSERT_EQ("v1", get(&cache, 1, 1));
+		const uint64_t one = cache.pinnedMemoryUsage();
+		ASSERT_GT(one, 0u);
+		ASSERT_EQ("v1", get(&cache, 2, 1));
+		ASSERT_GT(cache.pinnedMemoryUsage(), one);
+		cache.evict(1);
+		cache.evict(2);
+		ASSERT_EQ(0u, cache.pinnedMemoryUsage());
+	}
+
+	TEST_F(TableCacheTest, PinsLevelZeroIndexInBlockCacheMode) {
+		std::unique_ptr<Cache> blockCache(newLRUCache(1 << 20));
+		options_.block_cache = blockCache.get();
+		options_.cache_index_and_filter_blocks = true;
+		TableCache cache(dbname_, options_, 100);
+		ASSERT_EQ("v1", get(&cache, 1, 1, 1));
+		ASSERT_EQ(0u, cache.pinnedMemoryUsage());
+		ASSERT_GT(blockCache->totalCharge(), 0u);
+		ASSERT_EQ("v1", get(&cache, 2, 1, 0));
+		ASSERT_GT(cache.pinnedMemoryUsage(), 0u);
+		cache.evict(2);
+		ASSERT_EQ(0u, cache.pinnedMemoryUsage());
+		cache.evict(1);
+	}
+
+	TEST_F(TableCacheTest, PrefetchesCompactionInputs) {
+		options_.block_size = 256;
+		for (uint64_t number = 1; number <= 5; ++number) {
+			writeTable(number);
+		}
+		TableCache cache(dbname_, options_, 100);
+		BlockPrefetcher prefetcher(2, 4, 1 << 20);
+		{
+			// the inputs are advanced in turn like a merge does
+			std::unique_ptr<Iterator> iters[5];
+			for (uint64_t number = 1; number <= 5; ++number) {
+				iters[number - 1].reset(cache.newIterator(ReadOptions(), number, sizes_[number], 1,
+					nullptr, &prefetcher));
+				iters[number - 1]->seekToFirst();
+			}
+			for (int i = 0; i < 100; ++i) {
+				for (uint64_t number = 1; number <= 5; ++number) {
+					Iterator* iter = iters[number - 1].get();
+					ASSERT_TRUE(iter->valid());
+					ASSERT_EQ(key(number, i), iter->key());
+					ASSERT_EQ("v" + std::to_string(i), iter->value());
+					iter->next();
+				}
+			}
+			for (const std::unique_ptr<Iterator>& iter : iters) {
+				ASSERT_FALSE(iter->valid());
+				ASSERT_TRUE(iter->status().ok());
+			}
+		}
+		ASSERT_GT(prefetcher.prefetchedBlocks(), 5u);
+		ASSERT_EQ(0u, prefetcher.bytesInFlight());
+	}
+
+	TEST_F(TableCacheTest, PrefetchStaysWithinBudget) {
+		options_.block_size = 256;
+		writeTable(1);
+		TableCache cache(dbname_, options_, 100);
+		// less than any block
+		BlockPrefetcher prefetcher(2, 4, 1);
+		std::unique_ptr<Iterator> iter(cache.newIterator(ReadOptions(), 1, sizes_[1], 1,
+			nullptr, &prefetcher));
+		int n = 0;
+		for (iter->seekToFirst(); iter->valid(); iter->next()) {
+			ASSERT_EQ(key(1, n), iter->key());
+			++n;
+		}
+		ASSERT_EQ(100, n);
+		ASSERT_EQ(0u, prefetcher.prefetchedBlocks());
+	}
+
+	TEST_F(TableCacheTest, PrefetchFollowsSeeks) {
+		options_.block_size = 256;
+		writeTable(1);
+		TableCache cache(dbname_, options_, 100);
+		BlockPrefetcher prefetcher(2, 2, 1 << 20);
+		std::unique_ptr<Iterator> iter(cache.newIterator(ReadOptions(), 1, sizes_[1], 1,
+			nullptr, &prefetcher));
+		iter->seek(key(1, 60));
+		ASSERT_EQ(key(1, 60), iter->key());
+		// a seek back reads from the file from then on
+		int n = 0;
+		for (iter->seekToFirst(); iter->valid(); iter->next()) {
+			ASSERT_EQ(key(1, n), iter->key());
+			++n;
+		}
+		ASSERT_EQ(100, n);
+		ASSERT_TRUE(iter->status().ok());
+		iter.reset();
+		ASSERT_EQ(0u, prefetcher.bytesInFlight());
+	}
+
+	TEST_F(TableCacheTest, RangeTombstonesRoundTrip) {
+		InternalKeyComparator icmp(byteWiseComparator());
+		options_.comparator = &icmp;
+		WritableFile* file;
+		ASSERT_TRUE(env_->newWritableFile(tableFileName(dbname_, 1), &file).ok());
+		TableBuilder builder(options_, file);
+		builder.add(InternalKey("a", 5, kTypeValue).Encode(), "a5");
+		builder.add(InternalKey("c", 30, kTypeValue).Encode(), "c30");
+		builder.add(InternalKey("c", 5, kTypeValue).Encode(), "c5");
+		builder.add(InternalKey("e", 5, kTypeValue).Encode(), "e5");
+		builder.addRangeTombstone(InternalKey("b", 20, kTypeRangeDeletion).Encode(), "d");
+		ASSERT_TRUE(builder.finish().ok());
+		sizes_[1] = builder.fileSize();
+		ASSERT_TRUE(file->close().ok());
+		delete file;
+
+		TableCache cache(dbname_, options_, 100);
+		std::shared_ptr<const FragmentedRangeTombstoneList> tombstones;
+		ASSERT_TRUE(cache.rangeTombstones(1, sizes_[1], 1, &tombstones).ok());
+		ASSERT_NE(nullptr, tombstones);
+		ASSERT_EQ(1u, tombstones->numFragments());
+		ASSERT_EQ(20u, tombstones->maxCoveringTombstoneSeqnum("c", kMaxSequenceNumber));
+		cache.evict(1);
+		ASSERT_EQ(0u, tombstones->maxCoveringTombstoneSeqnum("e", kMaxSequenceNumber));
+
+		// the found entry as "key@seq:type=value"
+		auto lookup = [&](const char* userKey, SequenceNumber snapshot) {
+			std::string result = "NOT_FOUND";
+			auto save = [](void* arg, const Slice& k, const Slice& v) {
+				ParsedInternalKey ikey;
+				ASSERT_TRUE(ParseInternalKey(k, &ikey));
+				*reinterpret_cast<std::string*>(arg) = std::string(ikey.user_key) + "@" +
+					std::to_string(ikey.sequence) + ":" + std::to_string(ikey.type) + "=" + std::string(v);
+			};
+			Status s = cache.get(ReadOptions(), 1, sizes_[1], 1,
+				InternalKey(userKey, snapshot, kValueTypeForSeek).Encode(), &result, save);
+			EXPECT_TRUE(s.ok()) << s.ToString();
+			return result;
+		};
+		ASSERT_EQ("a@5:1=a5", lookup("a", 100));
+		ASSERT_EQ("c@30:1=c30", lookup("c", 100));
+		// c@5 is older than the tombstone, b has no entry of its own
+		ASSERT_EQ("c@20:0=", lookup("c", 25));
+		ASSERT_EQ("b@20:0=", lookup("b", 100));
+		// the tombstone is not visible to an older snapshot
+		ASSERT_EQ("c@5:1=c5", lookup("c", 10));
+		ASSERT_EQ("e@5:1=e5", lookup("e", 100));
+	}
+
+	TEST_F(TableCacheTest, TableCacheSize) {
+		Options options;
+		options.max_open_files = 1000;
+		ASSERT_EQ(1000 - TableCache::KNumNonTableCacheFiles, TableCache::tableCacheSize(options));
+		options.max_open_files = -1;
+		ASSERT_EQ(TableCache::KInfiniteCapacity, TableCache::tableCacheSize(options));
+	}
+
+}
@@ -0,0 +1,44 @@
+/*!
+ * \file VersionEdit.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ * 
+ */
+#pragma once
+#include <cstdint>
+#include "DataBase/DBFormat.h"
+
+namespace CDB{
+
+	struct FileMetaData {
+		FileMetaData() = default;
+
+		int refs = 0;
+		// seeks allowed until compaction
+		int allowedSeeks = (1 << 30);
+		uint64_t number = 0;
+		// file size in bytes
+		uint64_t fileSize = 0;
+		// smallest internal key served by table
+		InternalKey smallest;
+		// largest internal key served by table
+		InternalKey largest;
+		// sequence number range of the entries in the table, a level-0 file
+		// produced by a merge keeps the range of its inputs so it stays
+		// ordered before newer runs
+		SequenceNumber smallestSeqno = 0;
+		SequenceNumber largestSeqno = 0;
+		// seconds since the epoch when the table was written, approximates the
+		// age of its newest entry, 0 if unknown
+		uint64_t creationTime = 0;
+		// set while the file is an input of a running compaction
+		bool beingCompacted = false;
+		// set from TableBuilder::needCompact() when the table is written and
+		// from tableNeedsCompaction() of its properties when it is read back,
+		// the file holds enough tombstones to be worth compacting on its own
+		bool markedForCompaction = false;
+	};
+
+}
@@ -0,0 +1,44 @@
+#include "DataBase/VersionSet.h"
+
+namespace CDB{
+
+	Version::~Version()
+	{
+		assert(refs_ == 0);
+		for (int level = 0; level < Config::kNumLevels; ++level) {
+			for (FileMetaData* f : files_[level]) {
+				assert(f->refs > 0);
+				f->refs--;
+				if (f->refs <= 0) {
+					delete f;
+				}
+			}
+		}
+	}
+
+	void Version::unRef()
+	{
+		assert(refs_ >= 1);
+		--refs_;
+		if (refs_ == 0) {
+			delete this;
+		}
+	}
+
+	void Version::addFile(int level, FileMetaData* f)
+	{
+		assert(level >= 0 && level < Config::kNumLevels);
+		f->refs++;
+		files_[level].push_back(f);
+	}
+
+	uint64_t Version::numLevelBytes(int level) const
+	{
+		uint64_t sum = 0;
+		for (const FileMetaData* f : files_[level]) {
+			sum += f->fileSize;
+		}
+		return sum;
+	}
+
+}
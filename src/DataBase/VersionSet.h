@@ -0,0 +1,56 @@
+/*!
+ * \file VersionSet.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ * 
+ */
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "DataBase/DBFormat.h"
+#include "DataBase/VersionEdit.h"
+
+namespace CDB{
+
+	/*!
+	 * \class Version
+	 *
+	 * \brief the set of table files per level at one point in time,
+	 *  a version is immutable once it is published and ref counted by readers
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class Version{
+	public:
+		Version() = default;
+
+		Version(const Version&) = delete;
+
+		Version& operator=(const Version&) = delete;
+
+		void ref() { ++refs_; }
+
+		void unRef();
+
+		/// takes a reference on f, only legal before the version is published
+		void addFile(int level, FileMetaData* f);
+
+		int numFiles(int level) const { return static_cast<int>(files_[level].size()); }
+
+		const std::vector<FileMetaData*>& files(int level) const { return files_[level]; }
+
+		uint64_t numLevelBytes(int level) const;
+
+	private:
+		~Version();
+
+		int refs_ = 0;
+
+		// files per level, level-0 files are kept in the order they were added
+		std::vector<FileMetaData*> files_[Config::kNumLevels];
+	};
+
+}
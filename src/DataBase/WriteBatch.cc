@@ -0,0 +1,267 @@
+// WriteBatch::rep_ :=
+//    sequence: fixed64
+//    count: fixed32
+//    data: record[count]
+// record :=
+//    kTypeValue varstring varstring         |
+//    kTypeDeletion varstring                |
+//    kTypeRangeDeletion varstring varstring |
+//    kTypeMerge varstring varstring
+// varstring :=
+//    len: varint32
+//    data: uint8[len]
+
+#include "CDataBase/WriteBatch.h"
+
+#include "DataBase/DBFormat.h"
+#include "DataBase/MemTable.h"
+#include "DataBase/WriteBatchInternal.h"
+#include "Util/Coding.h"
+
+namespace CDB{
+
+	// WriteBatch header has an 8-byte sequence number followed by a 4-byte count.
+	static const size_t kHeader = 12;
+
+	WriteBatch::WriteBatch() { clear(); }
+
+	WriteBatch::WriteBatch(size_t reservedBytes)
+	{
+		rep_.reserve(kHeader + reservedBytes);
+		clear();
+	}
+
+	WriteBatch::WriteBatch(std::string&& buffer)
+		:rep_(std::move(buffer))
+	{
+		clear();
+	}
+
+	WriteBatch::WriteBatch(WriteBatch&& other) noexcept
+		:rep_(std::move(other.rep_))
+	{
+		other.clear();
+	}
+
+	WriteBatch& WriteBatch::operator=(WriteBatch&& other) noexcept
+	{
+		if (this != &other) {
+			rep_.swap(other.rep_);
+			other.clear();
+		}
+		return *this;
+	}
+
+	WriteBatch::~WriteBatch() = default;
+
+	WriteBatch::Handler::~Handler() = default;
+
+	void WriteBatch::clear()
+	{
+		rep_.clear();
+		rep_.resize(kHeader);
+	}
+
+	size_t WriteBatch::approximateSize() const { return rep_.size(); }
+
+	void WriteBatch::reserve(size_t bytes) { rep_.reserve(kHeader + bytes); }
+
+	size_t WriteBatch::capacity() const { return rep_.capacity() - kHeader; }
+
+	std::string WriteBatch::release()
+	{
+		std::string result;
+		result.swap(rep_);
+		clear();
+		return result;
+	}
+
+	Status WriteBatch::iterate(Handler* handler) const
+	{
+		Slice input(rep_);
+		if (input.size() < kHeader) {
+			return Status::Corruption("malformed WriteBatch (too small)");
+		}
+
+		input.remove_prefix(kHeader);
+		Slice key, value;
+		int found = 0;
+		while (!input.empty()) {
+			found++;
+			char tag = input[0];
+			input.remove_prefix(1);
+			switch (tag) {
+			case kTypeValue:
+				if (GetLengthPrefixedSlice(&input, &key) &&
+					GetLengthPrefixedSlice(&input, &value)) {
+					handler->put(key, value);
+				}
+				else {
+					return Status::Corruption("bad WriteBatch Put");
+				}
+				break;
+			case kTypeDeletion:
+				if (GetLengthPrefixedSlice(&input, &key)) {
+					handler->deleteK(key);
+				}
+				else {
+					return Status::Corruption("bad WriteBatch Delete");
+				}
+				break;
+			case kTypeRangeDeletion:
+				if (GetLengthPrefixedSlice(&input, &key) &&
+					GetLengthPrefixedSlice(&input, &value)) {
+					handler->deleteRange(key, value);
+				}
+				else {
+					return Status::Corruption("bad WriteBatch DeleteRange");
+				}
+				break;
+			case kTypeMerge:
+				if (GetLengthPrefixedSlice(&input, &key) &&
+					GetLengthPrefixedSlice(&input, &value)) {
+					handler->merge(key, value);
+				}
+				else {
+					return Status::Corruption("bad WriteBatch Merge");
+				}
+				break;
+			default:
+				return Status::Corruption("unknown WriteBatch tag");
+			}
+		}
+		if (found != WriteBatchInternal::count(this)) {
+			return Status::Corruption("WriteBatch has wrong count");
+		}
+		else {
+			return Status::OK();
+		}
+	}
+
+	int WriteBatchInternal::count(const WriteBatch* b)
+	{
+		return DecodeFixed32(b->rep_.data() + 8);
+	}
+
+	void WriteBatchInternal::setCount(WriteBatch* b, int n)
+	{
+		EncodeFixed32(&b->rep_[8], n);
+	}
+
+	SequenceNumber WriteBatchInternal::sequence(const WriteBatch* b)
+	{
+		return SequenceNumber(DecodeFixed64(b->rep_.data()));
+	}
+
+	void WriteBatchInternal::setSequence(WriteBatch* b, SequenceNumber seq)
+	{
+		EncodeFixed64(&b->rep_[0], seq);
+	}
+
+	void WriteBatch::put(const Slice& key, const Slice& value)
+	{
+		WriteBatchInternal::setCount(this, WriteBatchInternal::count(this) + 1);
+		rep_.push_back(static_cast<char>(kTypeValue));
+		PutLengthPrefixedSlice(&rep_, key);
+		PutLengthPrefixedSlice(&rep_, value);
+	}
+
+	void WriteBatch::deleteK(const Slice& key)
+	{
+		WriteBatchInternal::setCount(this, WriteBatchInternal::count(this) + 1);
+		rep_.push_back(static_cast<char>(kTypeDeletion));
+		PutLengthPrefixedSlice(&rep_, key);
+	}
+
+	void WriteBatch::deleteRange(const Slice& begin, const Slice& end)
+	{
+		WriteBatchInternal::setCount(this, WriteBatchInternal::count(this) + 1);
+		rep_.push_back(static_cast<char>(kTypeRangeDeletion));
+		PutLengthPrefixedSlice(&rep_, begin);
+		PutLengthPrefixedSlice(&rep_, end);
+	}
+
+	void WriteBatch::merge(const Slice& key, const Slice& value)
+	{
+		WriteBatchInternal::setCount(this, WriteBatchInternal::count(this) + 1);
+		rep_.push_back(static_cast<char>(kTypeMerge));
+		PutLengthPrefixedSlice(&rep_, key);
+		PutLengthPrefixedSlice(&rep_, value);
+	}
+
+	void WriteBatch::append(const WriteBatch& source)
+	{
+		WriteBatchInternal::append(this, &source);
+	}
+
+	namespace {
+
+		class MemTableInserter : public WriteBatch::Handler{
+		public:
+			SequenceNumber sequence_;
+			MemTable* mem_;
+			bool concurrently_;
+
+			void add(ValueType type, const Slice& key, const Slice& value)
+			{
+				if (concurrently_) {
+					mem_->addConcurrently(sequence_, type, key, value);
+				}
+				else {
+					mem_->add(sequence_, type, key, value);
+				}
+				sequence_++;
+			}
+
+			void put(const Slice& key, const Slice& value) override
+			{
+				add(kTypeValue, key, value);
+			}
+
+			void deleteK(const Slice& key) override
+			{
+				add(kTypeDeletion, key, Slice());
+			}
+
+			void deleteRange(const Slice& begin, const Slice& end) override
+			{
+				add(kTypeRangeDeletion, begin, end);
+			}
+
+			void merge(const Slice& key, const Slice& value) override
+			{
+				add(kTypeMerge, key, value);
+			}
+		};
+
+	}
+
+	Status WriteBatchInternal::insertInto(const WriteBatch* b, MemTable* memtable, bool concurrently)
+	{
+		MemTableInserter inserter;
+		inserter.sequence_ = WriteBatchInternal::sequence(b);
+		inserter.mem_ = memtable;
+		inserter.concurrently_ = concurrently;
+		return b->iterate(&inserter);
+	}
+
+	void WriteBatchInternal::setContents(WriteBatch* b, const Slice& contents)
+	{
+		assert(contents.size() >= kHeader);
+		b->rep_.assign(contents.data(), contents.size());
+	}
+
+	void WriteBatchInternal::setContents(WriteBatch* b, std::string&& contents)
+	{
+		assert(contents.size() >= kHeader);
+		b->rep_ = std::move(contents);
+	}
+
+	void WriteBatchInternal::append(WriteBatch* dst, const WriteBatch* src)
+	{
+		setCount(dst, count(dst) + count(src));
+		assert(src->rep_.size() >= kHeader);
+		dst->rep_.append(src->rep_.data() + kHeader, src->rep_.size() - kHeader);
+	}
+
+}
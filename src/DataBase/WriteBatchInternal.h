@@ -0,0 +1,56 @@
+/*!
+ * \file WriteBatchInternal.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include "CDataBase/WriteBatch.h"
+#include "DataBase/DBFormat.h"
+
+namespace CDB{
+
+	class MemTable;
+
+	/*!
+	 * \class WriteBatchInternal
+	 *
+	 * \brief methods for operating on a WriteBatch that we don't want
+	 *  in the public WriteBatch interface
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class WriteBatchInternal{
+	public:
+		// Return the number of entries in the batch.
+		static int count(const WriteBatch* batch);
+
+		// Set the count for the number of entries in the batch.
+		static void setCount(WriteBatch* batch, int n);
+
+		// Return the sequence number for the start of this batch.
+		static SequenceNumber sequence(const WriteBatch* batch);
+
+		// Store the specified number as the sequence number for the start of
+		// this batch.
+		static void setSequence(WriteBatch* batch, SequenceNumber seq);
+
+		static Slice contents(const WriteBatch* batch) { return Slice(batch->rep_); }
+
+		static size_t byteSize(const WriteBatch* batch) { return batch->rep_.size(); }
+
+		static void setContents(WriteBatch* batch, const Slice& contents);
+
+		/// adopt contents without copying it
+		static void setContents(WriteBatch* batch, std::string&& contents);
+
+		/// concurrently lets several threads insert batches into memtable at once
+		static Status insertInto(const WriteBatch* batch, MemTable* memtable, bool concurrently = false);
+
+		static void append(WriteBatch* dst, const WriteBatch* src);
+	};
+
+}
@@ -0,0 +1,113 @@
+#include <string>
+#include <utility>
+#include <gtest/gtest.h>
+#include "CDataBase/Env.h"
+#include "CDataBase/WriteBatch.h"
+#include "DataBase/LogFormat.h"
+#include "DataBase/LogWriter.h"
+#include "DataBase/WriteBatchInternal.h"
+#include "Util/Coding.h"
+#include "Util/Crc32.h"
+
+namespace CDB {
+
+	namespace {
+
+		class StringSink : public WritableFile {
+		public:
+			Status append(const Slice& data) override
+			{
+				contents_.append(data.data(), data.size());
+				return Status::OK();
+			}
+			Status close() override { return Status::OK(); }
+			Status flush() override
+			{
+				++flushes_;
+				return Status::OK();
+			}
+			Status sync() override { return Status::OK(); }
+
+			const std::string& contents() const { return contents_; }
+			int flushes() const { return flushes_; }
+
+		private:
+			std::string contents_;
+			int flushes_ = 0;
+		};
+
+	}
+
+	TEST(WriteBatchTest, Reserve) {
+		WriteBatch batch(1 << 20);
+		ASSERT_GE(batch.capacity(), static_cast<size_t>(1 << 20));
+		const char* data = WriteBatchInternal::contents(&batch).data();
+		std::string value(100, 'v');
+		for (int i = 0; i < 5000; ++i) {
+			batch.put("key" + std::to_string(i), value);
+		}
+		// no reallocation while the batch fits
+		ASSERT_EQ(data, WriteBatchInternal::contents(&batch).data());
+		ASSERT_EQ(5000, WriteBatchInternal::count(&batch));
+	}
+
+	TEST(WriteBatchTest, MoveAndRelease) {
+		WriteBatch a;
+		a.put("k", "v");
+		WriteBatchInternal::setSequence(&a, 7);
+		const std::string encoded(WriteBatchInternal::contents(&a));
+
+		WriteBatch b(std::move(a));
+		ASSERT_EQ(0, WriteBatchInternal::count(&a));
+		ASSERT_EQ(encoded, std::string(WriteBatchInternal::contents(&b)));
+
+		std::string released = b.release();
+		ASSERT_EQ(encoded, released);
+		ASSERT_EQ(0, WriteBatchInternal::count(&b));
+
+		// the released buffer can back the next batch
+		released.reserve(4096);
+		const size_t capacity = released.capacity();
+		WriteBatch c(std::move(released));
+		ASSERT_EQ(0, WriteBatchInternal::count(&c));
+		ASSERT_GE(c.capacity() + 12, capacity);
+		c.deleteK("k");
+		ASSERT_EQ(1, WriteBatchInternal::count(&c));
+
+		WriteBatch d;
+		d = std::move(c);
+		ASSERT_EQ(1, WriteBatchInternal::count(&d));
+		ASSERT_EQ(0, WriteBatchInternal::count(&c));
+		c.put("x", "y");
+		ASSERT_EQ(1, WriteBatchInternal::count(&c));
+	}
+
+	TEST(WriteBatchTest, LogRecordFragments) {
+		WriteBatch batch;
+		batch.put("k", std::string(log::KBlockSize * 2, 'x'));
+		StringSink sink;
+		log::Writer writer(&sink);
+		ASSERT_TRUE(writer.addRecord(WriteBatchInternal::contents(&batch)).ok());
+		ASSERT_EQ(1, sink.flushes());
+
+		// first, middle and last fragment, each with a valid checksum
+		const std::string& file = sink.contents();
+		const std::string payload(WriteBatchInternal::contents(&batch));
+		size_t offset = 0;
+		std::string reassembled;
+		const int expected[] = { log::KFirstType, log::KMiddleType, log::KLastType };
+		for (int type : expected) {
+			ASSERT_LE(offset + log::KHeaderSize, file.size());
+			const char* header = file.data() + offset;
+			const size_t length = static_cast<uint8_t>(header[4]) | (static_cast<uint8_t>(header[5]) << 8);
+			ASSERT_EQ(type, header[6]);
+			const uint32_t crc = crc32::Unmask(DecodeFixed32(header));
+			ASSERT_EQ(crc32::Value(header + 6, 1 + length), crc);
+			reassembled.append(header + log::KHeaderSize, length);
+			offset += log::KHeaderSize + length;
+		}
+		ASSERT_EQ(file.size(), offset);
+		ASSERT_EQ(payload, reassembled);
+	}
+
+}
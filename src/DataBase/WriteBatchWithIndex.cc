@@ -0,0 +1,538 @@
+#include "CDataBase/WriteBatchWithIndex.h"
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "CDataBase/DB.h"
+#include "CDataBase/MergeOperator.h"
+#include "CDataBase/WriteBatch.h"
+#include "DataBase/DBFormat.h"
+#include "DataBase/MergeHelper.h"
+#include "DataBase/SkipList.h"
+#include "DataBase/WriteBatchInternal.h"
+#include "Util/Allocator.h"
+#include "Util/Coding.h"
+
+namespace CDB{
+
+	namespace {
+
+		// a record of the batch. keys are kept as offsets because the batch
+		// moves when it grows
+		struct IndexEntry {
+			size_t offset;
+			size_t keyOffset;
+			size_t keySize;
+			// set on seek targets only, which sort before every entry of their key
+			const Slice* searchKey;
+		};
+
+		const size_t KSearchOffset = SIZE_MAX;
+
+		// what the records of one key in the batch amount to
+		enum DeltaType {
+			KDeltaPut,
+			KDeltaDelete,
+			// merge operands that still need the value in the db
+			KDeltaMerge
+		};
+
+	}
+
+	struct WriteBatchWithIndex::Rep {
+		// keys in order, the records of a key newest first
+		struct EntryComparator {
+			const Comparator* comparator;
+			const WriteBatch* batch;
+
+			int operator()(const IndexEntry* a, const IndexEntry* b) const
+			{
+				const char* data = WriteBatchInternal::contents(batch).data();
+				Slice aKey = a->searchKey != nullptr ? *a->searchKey : Slice(data + a->keyOffset, a->keySize);
+				Slice bKey = b->searchKey != nullptr ? *b->searchKey : Slice(data + b->keyOffset, b->keySize);
+				int r = comparator->compare(aKey, bKey);
+				if (r == 0) {
+					if (a->offset > b->offset) {
+						r = -1;
+					}
+					else if (a->offset < b->offset) {
+						r = +1;
+					}
+				}
+				return r;
+			}
+		};
+
+		typedef SkipList<const IndexEntry*, EntryComparator> Index;
+
+		Rep(const Comparator* cmp, const MergeOperator* op)
+			:comparator(cmp), mergeOperator(op)
+		{
+			resetIndex();
+		}
+
+		void resetIndex()
+		{
+			index.reset();
+			allocator = std::make_unique<Allocator>();
+			index = std::make_unique<Index>(EntryComparator{ comparator, &batch }, allocator.get());
+		}
+
+		/// index the record that was just appended at offset
+		void addEntry(size_t offset)
+		{
+			Slice input = WriteBatchInternal::contents(&batch);
+			input.remove_prefix(offset + 1);
+			Slice key;
+			bool ok = GetLengthPrefixedSlice(&input, &key);
+			assert(ok);
+			(void)ok;
+			char* mem = allocator->allocateAligned(sizeof(IndexEntry));
+			IndexEntry* entry = new (mem) IndexEntry;
+			entry->offset = offset;
+			entry->keyOffset = key.data() - WriteBatchInternal::contents(&batch).data();
+			entry->keySize = key.size();
+			entry->searchKey = nullptr;
+			index->insert(entry);
+		}
+
+		Slice entryKey(const IndexEntry* entry) const
+		{
+			return Slice(WriteBatchInternal::contents(&batch).data() + entry->keyOffset, entry->keySize);
+		}
+
+		/// type and value of the record at entry
+		void readEntry(const IndexEntry* entry, ValueType* type, Slice* value) const
+		{
+			Slice input = WriteBatchInternal::contents(&batch);
+			input.remove_prefix(entry->offset);
+			*type = static_cast<ValueType>(input[0]);
+			input.remove_prefix(1);
+			Slice key;
+			GetLengthPrefixedSlice(&input, &key);
+			if (*type == kTypeValue || *type == kTypeMerge) {
+				GetLengthPrefixedSlice(&input, value);
+			}
+			else {
+				*value = Slice();
+			}
+		}
+
+		WriteBatch batch;
+		const Comparator* comparator;
+		const MergeOperator* mergeOperator;
+		std::unique_ptr<Allocator> allocator;
+		std::unique_ptr<Index> index;
+	};
+
+	namespace {
+
+		/*!
+		 * \class BatchIndexIterator
+		 *
+		 * \brief visits the keys of the batch once each, positioned at the
+		 *  newest record of the key
+		 *
+		 * \author czy
+		 * \date 2026.10.19
+		 */
+		class BatchIndexIterator{
+		public:
+			explicit BatchIndexIterator(const WriteBatchWithIndex::Rep* rep)
+				:rep_(rep), iter_(rep->index.get())
+			{
+
+			}
+
+			bool valid() const { return iter_.valid(); }
+
+			Slice key() const { return rep_->entryKey(iter_.key()); }
+
+			void seekToFirst() { iter_.seekToFirst(); }
+
+			void seekToLast()
+			{
+				iter_.seekToLast();
+				toNewest();
+			}
+
+			void seek(const Slice& target)
+			{
+				IndexEntry entry{ KSearchOffset, 0, 0, &target };
+				iter_.seek(&entry);
+			}
+
+			/// the last key at or before target
+			void seekForPrev(const Slice& target)
+			{
+				seek(target);
+				if (!valid()) {
+					seekToLast();
+				}
+				else if (rep_->comparator->compare(key(), target) > 0) {
+					prev();
+				}
+			}
+
+			void next()
+			{
+				const Slice current = key();
+				do {
+					iter_.next();
+				} while (iter_.valid() && rep_->comparator->compare(key(), current) == 0);
+			}
+
+			void prev()
+			{
+				// lands on the oldest record of the previous key
+				iter_.prev();
+				toNewest();
+			}
+
+			/// fold the records of the current key, operands above a put or a
+			/// deletion are applied to it, otherwise they are left in operands
+			Status resolve(DeltaType* type, std::string* value, std::vector<std::string>* operands) const
+			{
+				operands->clear();
+				const Slice current = key();
+				auto iter = iter_;
+				for (; iter.valid() && rep_->comparator->compare(rep_->entryKey(iter.key()), current) == 0;
+					iter.next()) {
+					ValueType t;
+					Slice v;
+					rep_->readEntry(iter.key(), &t, &v);
+					if (t == kTypeMerge) {
+						operands->emplace_back(v);
+						continue;
+					}
+					if (operands->empty()) {
+						if (t == kTypeValue) {
+							*type = KDeltaPut;
+							value->assign(v.data(), v.size());
+						}
+						else {
+							*type = KDeltaDelete;
+						}
+						return Status::OK();
+					}
+					*type = KDeltaPut;
+					return foldOperands(t == kTypeValue ? &v : nullptr, value, operands);
+				}
+				*type = KDeltaMerge;
+				return Status::OK();
+			}
+
+			/// apply operands, newest first, to base
+			Status foldOperands(const Slice* base, std::string* value,
+				const std::vector<std::string>* operands) const
+			{
+				std::vector<Slice> oldestFirst(operands->rbegin(), operands->rend());
+				std::string result;
+				Status s = MergeHelper::fullMerge(rep_->mergeOperator, key(), base, oldestFirst,
+					&result, nullptr);
+				if (s.ok()) {
+					value->swap(result);
+				}
+				return s;
+			}
+
+		private:
+			void toNewest()
+			{
+				if (iter_.valid()) {
+					const Slice current = key();
+					seek(current);
+				}
+			}
+
+			const WriteBatchWithIndex::Rep* rep_;
+			WriteBatchWithIndex::Rep::Index::Iterator iter_;
+		};
+
+		/*!
+		 * \class BaseDeltaIterator
+		 *
+		 * \brief merges an iterator over the db with the writes of the batch,
+		 *  keys deleted in the batch are skipped and its values and merge
+		 *  operands take the place of the db's
+		 *
+		 * \author czy
+		 * \date 2026.10.19
+		 */
+		class BaseDeltaIterator : public Iterator{
+		public:
+			BaseDeltaIterator(Iterator* base, const WriteBatchWithIndex::Rep* rep)
+				:base_(base), delta_(rep), comparator_(rep->comparator),
+				forward_(true), currentAtBase_(true)
+			{
+
+			}
+
+			bool valid() const override
+			{
+				return status_.ok() && (currentAtBase_ ? base_->valid() : delta_.valid());
+			}
+
+			void seekToFirst() override
+			{
+				forward_ = true;
+				base_->seekToFirst();
+				delta_.seekToFirst();
+				updateCurrent();
+			}
+
+			void seekToLast() override
+			{
+				forward_ = false;
+				base_->seekToLast();
+				delta_.seekToLast();
+				updateCurrent();
+			}
+
+			void seek(const Slice& target) override
+			{
+				forward_ = true;
+				base_->seek(target);
+				delta_.seek(target);
+				updateCurrent();
+			}
+
+			void next() override
+			{
+				assert(valid());
+				const std::string current(key());
+				if (!forward_) {
+					forward_ = true;
+					base_->seek(current);
+					delta_.seek(current);
+				}
+				if (base_->valid() && comparator_->compare(base_->key(), current) == 0) {
+					base_->next();
+				}
+				if (delta_.valid() && comparator_->compare(delta_.key(), current) == 0) {
+					delta_.next();
+				}
+				updateCurrent();
+			}
+
+			void prev() override
+			{
+				assert(valid());
+				const std::string current(key());
+				if (forward_) {
+					forward_ = false;
+					baseSeekForPrev(current);
+					delta_.seekForPrev(current);
+				}
+				if (base_->valid() && comparator_->compare(base_->key(), current) == 0) {
+					base_->prev();
+				}
+				if (delta_.valid() && comparator_->compare(delta_.key(), current) == 0) {
+					delta_.prev();
+				}
+				updateCurrent();
+			}
+
+			Slice key() const override
+			{
+				return currentAtBase_ ? base_->key() : delta_.key();
+			}
+
+			Slice value() const override
+			{
+				return currentAtBase_ ? base_->value() : Slice(value_);
+			}
+
+			Status status() const override
+			{
+				if (!status_.ok()) {
+					return status_;
+				}
+				return base_->status();
+			}
+
+		private:
+			void baseSeekForPrev(const Slice& target)
+			{
+				base_->seek(target);
+				if (!base_->valid()) {
+					base_->seekToLast();
+				}
+				else if (comparator_->compare(base_->key(), target) > 0) {
+					base_->prev();
+				}
+			}
+
+			void advance(Iterator* iter) { forward_ ? iter->next() : iter->prev(); }
+
+			void advanceDelta() { forward_ ? delta_.next() : delta_.prev(); }
+
+			/// pick the iterator whose key comes first in the current
+			/// direction, skipping the keys the batch deletes
+			void updateCurrent()
+			{
+				status_ = Status::OK();
+				while (true) {
+					const bool baseValid = base_->valid();
+					const bool deltaValid = delta_.valid();
+					if (!deltaValid) {
+						currentAtBase_ = true;
+						return;
+					}
+					DeltaType type;
+					status_ = delta_.resolve(&type, &value_, &operands_);
+					if (!status_.ok()) {
+						return;
+					}
+					int c = 1;
+					if (baseValid) {
+						c = comparator_->compare(base_->key(), delta_.key());
+						if (!forward_) {
+							c = -c;
+						}
+					}
+					if (c < 0) {
+						currentAtBase_ = true;
+						return;
+					}
+					if (type == KDeltaDelete) {
+						if (c == 0) {
+							advance(base_.get());
+						}
+						advanceDelta();
+						continue;
+					}
+					currentAtBase_ = false;
+					if (type == KDeltaMerge) {
+						Slice baseValue;
+						if (c == 0) {
+							baseValue = base_->value();
+						}
+						status_ = delta_.foldOperands(c == 0 ? &baseValue : nullptr, &value_, &operands_);
+					}
+					return;
+				}
+			}
+
+			std::unique_ptr<Iterator> base_;
+			BatchIndexIterator delta_;
+			const Comparator* comparator_;
+			bool forward_;
+			bool currentAtBase_;
+			Status status_;
+			std::string value_;
+			std::vector<std::string> operands_;
+		};
+
+	}
+
+	WriteBatchWithIndex::WriteBatchWithIndex(const Comparator* comparator, const MergeOperator* mergeOperator)
+		:rep_(new Rep(comparator, mergeOperator))
+	{
+
+	}
+
+	WriteBatchWithIndex::~WriteBatchWithIndex()
+	{
+		delete rep_;
+	}
+
+	void WriteBatchWithIndex::put(const Slice& key, const Slice& value)
+	{
+		const size_t offset = WriteBatchInternal::byteSize(&rep_->batch);
+		rep_->batch.put(key, value);
+		rep_->addEntry(offset);
+	}
+
+	void WriteBatchWithIndex::deleteK(const Slice& key)
+	{
+		const size_t offset = WriteBatchInternal::byteSize(&rep_->batch);
+		rep_->batch.deleteK(key);
+		rep_->addEntry(offset);
+	}
+
+	void WriteBatchWithIndex::merge(const Slice& key, const Slice& value)
+	{
+		const size_t offset = WriteBatchInternal::byteSize(&rep_->batch);
+		rep_->batch.merge(key, value);
+		rep_->addEntry(offset);
+	}
+
+	void WriteBatchWithIndex::clear()
+	{
+		rep_->batch.clear();
+		rep_->resetIndex();
+	}
+
+	WriteBatch* WriteBatchWithIndex::getWriteBatch()
+	{
+		return &rep_->batch;
+	}
+
+	Status WriteBatchWithIndex::getFromBatch(const Slice& key, std::string* value) const
+	{
+		BatchIndexIterator iter(rep_);
+		iter.seek(key);
+		if (!iter.valid() || rep_->comparator->compare(iter.key(), key) != 0) {
+			return Status::NotFound(Slice());
+		}
+		DeltaType type;
+		std::vector<std::string> operands;
+		Status s = iter.resolve(&type, value, &operands);
+		if (!s.ok()) {
+			return s;
+		}
+		switch (type) {
+		case KDeltaPut:
+			return Status::OK();
+		case KDeltaDelete:
+			return Status::NotFound(Slice());
+		default:
+			return Status::NotSupported("merge operands in the batch need the value in the db", key);
+		}
+	}
+
+	Status WriteBatchWithIndex::getFromBatchAndDB(DB* db, const ReadOptions& options,
+		const Slice& key, std::string* value) const
+	{
+		BatchIndexIterator iter(rep_);
+		iter.seek(key);
+		if (!iter.valid() || rep_->comparator->compare(iter.key(), key) != 0) {
+			return db->get(options, key, value);
+		}
+		DeltaType type;
+		std::vector<std::string> operands;
+		Status s = iter.resolve(&type, value, &operands);
+		if (!s.ok()) {
+			return s;
+		}
+		if (type == KDeltaPut) {
+			return Status::OK();
+		}
+		if (type == KDeltaDelete) {
+			return Status::NotFound(Slice());
+		}
+		std::string dbValue;
+		s = db->get(options, key, &dbValue);
+		if (s.ok()) {
+			Slice base(dbValue);
+			return iter.foldOperands(&base, value, &operands);
+		}
+		if (s.IsNotFound()) {
+			return iter.foldOperands(nullptr, value, &operands);
+		}
+		return s;
+	}
+
+	Iterator* WriteBatchWithIndex::newIteratorWithBase(Iterator* baseIterator) const
+	{
+		return new BaseDeltaIterator(baseIterator, rep_);
+	}
+
+	Iterator* WriteBatchWithIndex::newIterator() const
+	{
+		return newIteratorWithBase(newEmptyIterator());
+	}
+
+}
@@ -0,0 +1,202 @@
+#include <map>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "CDataBase/DB.h"
+#include "CDataBase/MergeOperator.h"
+#include "CDataBase/WriteBatch.h"
+#include "CDataBase/WriteBatchWithIndex.h"
+#include "DataBase/WriteBatchInternal.h"
+
+namespace CDB {
+
+	namespace {
+
+		typedef std::map<std::string, std::string> KVMap;
+
+		class KVMapIterator : public Iterator {
+		public:
+			explicit KVMapIterator(const KVMap* map) :map_(map), iter_(map->end()) {}
+
+			bool valid() const override { return iter_ != map_->end(); }
+			void seekToFirst() override { iter_ = map_->begin(); }
+			void seekToLast() override { iter_ = map_->empty() ? map_->end() : std::prev(map_->end()); }
+			void seek(const Slice& target) override { iter_ = map_->lower_bound(std::string(target)); }
+			void next() override { ++iter_; }
+			void prev() override { iter_ = iter_ == map_->begin() ? map_->end() : std::prev(iter_); }
+			Slice key() const override { return iter_->first; }
+			Slice value() const override { return iter_->second; }
+			Status status() const override { return Status::OK(); }
+
+		private:
+			const KVMap* map_;
+			KVMap::const_iterator iter_;
+		};
+
+		// only get is used by the batch
+		class KVMapDB : public DB {
+		public:
+			Status put(const WriteOptions&, const Slice& key, const Slice& value) override
+			{
+				map[std::string(key)] = std::string(value);
+				return Status::OK();
+			}
+			Status deleteK(const WriteOptions&, const Slice& key, std::string*) override
+			{
+				map.erase(std::string(key));
+				return Status::OK();
+			}
+			Status deleteRange(const WriteOptions&, const Slice&, const Slice&) override
+			{
+				return Status::NotSupported("deleteRange");
+			}
+			Status merge(const WriteOptions&, const Slice&, const Slice&) override
+			{
+				return Status::NotSupported("merge");
+			}
+			Status get(const ReadOptions&, const Slice& key, std::string* value) override
+			{
+				auto iter = map.find(std::string(key));
+				if (iter == map.end()) {
+					return Status::NotFound(Slice());
+				}
+				*value = iter->second;
+				return Status::OK();
+			}
+			Iterator* newIterator(const ReadOptions&) override { return new KVMapIterator(&map); }
+			const Snapshot* getSnapshot() override { return nullptr; }
+			void releaseSnapshot(const Snapshot*) override {}
+			bool getProperty(const Slice&, std::string*) override { return false; }
+			void getApproximateSizes(const Range*, int, uint64_t*) override {}
+			void compactRange(const Slice*, const Slice*) override {}
+
+			KVMap map;
+		};
+
+		std::string contents(Iterator* iter, bool reverse)
+		{
+			std::string result;
+			if (reverse) {
+				for (iter->seekToLast(); iter->valid(); iter->prev()) {
+					result.append(std::string(iter->key()) + "=" + std::string(iter->value()) + ";");
+				}
+			}
+			else {
+				for (iter->seekToFirst(); iter->valid(); iter->next()) {
+					result.append(std::string(iter->key()) + "=" + std::string(iter->value()) + ";");
+				}
+			}
+			return result;
+		}
+
+	}
+
+	class WriteBatchWithIndexTest : public testing::Test {
+	public:
+		WriteBatchWithIndexTest()
+			:appendOp_(newStringAppendOperator(',')), batch_(byteWiseComparator(), appendOp_.get())
+		{
+
+		}
+
+		std::string getFromBatch(const std::string& key)
+		{
+			std::string value;
+			Status s = batch_.getFromBatch(key, &value);
+			if (s.IsNotFound()) {
+				return "NOT_FOUND";
+			}
+			return s.ok() ? value : "ERROR";
+		}
+
+		std::string getFromBatchAndDB(const std::string& key)
+		{
+			std::string value;
+			Status s = batch_.getFromBatchAndDB(&db_, ReadOptions(), key, &value);
+			if (s.IsNotFound()) {
+				return "NOT_FOUND";
+			}
+			return s.ok() ? value : "ERROR";
+		}
+
+		std::unique_ptr<const MergeOperator> appendOp_;
+		WriteBatchWithIndex batch_;
+		KVMapDB db_;
+	};
+
+	TEST_F(WriteBatchWithIndexTest, GetFromBatch) {
+		batch_.put("a", "1");
+		batch_.put("b", "2");
+		batch_.put("a", "3");
+		batch_.deleteK("b");
+		batch_.put("c", "4");
+		batch_.merge("c", "5");
+		batch_.merge("d", "6");
+		ASSERT_EQ("3", getFromBatch("a"));
+		ASSERT_EQ("NOT_FOUND", getFromBatch("b"));
+		ASSERT_EQ("4,5", getFromBatch("c"));
+		// the operands of d need the value in the db
+		ASSERT_EQ("ERROR", getFromBatch("d"));
+		ASSERT_EQ("NOT_FOUND", getFromBatch("e"));
+		// every write stays in the batch
+		ASSERT_EQ(7, WriteBatchInternal::count(batch_.getWriteBatch()));
+	}
+
+	TEST_F(WriteBatchWithIndexTest, GetFromBatchAndDB) {
+		db_.map = { { "a", "db" }, { "b", "db" }, { "c", "db" }, { "x", "db" } };
+		batch_.put("a", "batch");
+		batch_.deleteK("b");
+		batch_.merge("c", "m");
+		batch_.merge("d", "m");
+		ASSERT_EQ("batch", getFromBatchAndDB("a"));
+		ASSERT_EQ("NOT_FOUND", getFromBatchAndDB("b"));
+		ASSERT_EQ("db,m", getFromBatchAndDB("c"));
+		ASSERT_EQ("m", getFromBatchAndDB("d"));
+		ASSERT_EQ("db", getFromBatchAndDB("x"));
+		ASSERT_EQ("NOT_FOUND", getFromBatchAndDB("y"));
+	}
+
+	TEST_F(WriteBatchWithIndexTest, IteratorWithBase) {
+		db_.map = { { "a", "1" }, { "c", "3" }, { "e", "5" }, { "g", "7" } };
+		batch_.put("b", "x");
+		batch_.deleteK("c");
+		batch_.merge("e", "y");
+		batch_.put("g", "z");
+		batch_.deleteK("h");
+		batch_.merge("i", "w");
+		std::unique_ptr<Iterator> iter(batch_.newIteratorWithBase(db_.newIterator(ReadOptions())));
+		const std::string expected = "a=1;b=x;e=5,y;g=z;i=w;";
+		ASSERT_EQ(expected, contents(iter.get(), false));
+		ASSERT_EQ("i=w;g=z;e=5,y;b=x;a=1;", contents(iter.get(), true));
+
+		// change direction in the middle
+		iter->seek("d");
+		ASSERT_EQ("e", std::string(iter->key()));
+		iter->prev();
+		ASSERT_EQ("b", std::string(iter->key()));
+		iter->next();
+		ASSERT_EQ("e", std::string(iter->key()));
+		iter->next();
+		ASSERT_EQ("g", std::string(iter->key()));
+		iter->prev();
+		iter->prev();
+		ASSERT_EQ("b", std::string(iter->key()));
+		ASSERT_TRUE(iter->status().ok());
+	}
+
+	TEST_F(WriteBatchWithIndexTest, BatchOnlyIterator) {
+		batch_.put("b", "1");
+		batch_.put("a", "2");
+		batch_.put("b", "3");
+		batch_.deleteK("a");
+		batch_.put("c", "4");
+		std::unique_ptr<Iterator> iter(batch_.newIterator());
+		ASSERT_EQ("b=3;c=4;", contents(iter.get(), false));
+		ASSERT_EQ("c=4;b=3;", contents(iter.get(), true));
+
+		batch_.clear();
+		ASSERT_EQ("NOT_FOUND", getFromBatch("b"));
+		ASSERT_EQ(0, WriteBatchInternal::count(batch_.getWriteBatch()));
+	}
+
+}
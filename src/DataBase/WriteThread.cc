@@ -0,0 +1,399 @@
+#include "DataBase/WriteThread.h"
+
+#include <cassert>
+#include "CDataBase/Env.h"
+#include "CDataBase/WriteBatch.h"
+#include "DataBase/LogWriter.h"
+#include "DataBase/WriteBatchInternal.h"
+#include "Util/ThreadPool.h"
+
+namespace CDB{
+
+	namespace {
+
+		// a group is cut at this many bytes of batches
+		const size_t KMaxGroupSize = 1 << 20;
+
+		// a small first batch caps the group lower so its writer is not slowed
+		// down much by the others
+		const size_t KSmallBatchSize = 128 << 10;
+
+		// threads inserting the unordered groups
+		const int KAsyncInsertThreads = 2;
+
+	}
+
+	struct WriteThread::Writer {
+		explicit Writer(Mutex* mu) :cv(mu) {}
+
+		WriteBatch* batch = nullptr;
+		bool sync = false;
+		bool unordered = false;
+		bool disableMemtable = false;
+		bool done = false;
+		Status status;
+		// set once the group of the writer is logged and it may insert
+		Group* group = nullptr;
+		CondVar cv;
+	};
+
+	struct WriteThread::Group {
+		// empty for an unordered group, its writers have returned
+		std::vector<Writer*> writers;
+		// copies of the batches of an unordered group that go to the memtable
+		std::vector<WriteBatch> batches;
+		MemTable* mem = nullptr;
+		SequenceNumber lastSequence = 0;
+		// the result of the log write, the batches are inserted only if it is ok
+		Status status;
+		// writers that have not finished their insert, 1 for an unordered group
+		size_t pending = 0;
+		// allocated by the leader and freed when it is made visible
+		bool async = false;
+	};
+
+	WriteThread::WriteThread(const Options& options, log::Writer* log, WritableFile* logFile,
+		MemTable* mem, SequenceNumber lastSequence)
+		:pipelined_(options.enable_pipelined_write), mu_(options.use_adaptive_mutex), memIdleCv_(&mu_),
+		twoQueues_(options.two_write_queues), logCv_(&logMu_), lastLogged_(lastSequence),
+		log_(log), logFile_(logFile), mem_(mem),
+		lastAllocated_(lastSequence), lastVisible_(lastSequence)
+	{
+	}
+
+	WriteThread::~WriteThread()
+	{
+		waitForPendingWrites();
+	}
+
+	Status WriteThread::write(const WriteOptions& options, WriteBatch* batch)
+	{
+		assert(batch != nullptr);
+		Writer w(&mu_);
+		w.batch = batch;
+		w.sync = options.sync;
+		w.unordered = options.unordered;
+		w.disableMemtable = options.disable_memtable;
+
+		MutexLock l(&mu_);
+		if (twoQueues_ && w.disableMemtable) {
+			walWriters_.push_back(&w);
+			while (!w.done && &w != walWriters_.front()) {
+				w.cv.wait();
+			}
+			if (!w.done) {
+				leadWalGroup(&w);
+			}
+			return w.status;
+		}
+
+		writers_.push_back(&w);
+		while (!w.done && w.group == nullptr && &w != writers_.front()) {
+			w.cv.wait();
+		}
+		if (!w.done && w.group == nullptr) {
+			leadGroup(&w);
+		}
+		if (!w.done) {
+			insertAndWait(&w);
+		}
+		return w.status;
+	}
+
+	void WriteThread::switchTo(log::Writer* log, WritableFile* logFile, MemTable* mem)
+	{
+		// queue up like a writer without a batch, no group takes it in, so
+		// nothing is logged while it is at the front
+		Writer w(&mu_);
+		MutexLock l(&mu_);
+		writers_.push_back(&w);
+		while (&w != writers_.front()) {
+			w.cv.wait();
+		}
+		while (!memGroups_.empty()) {
+			memIdleCv_.wait();
+		}
+		{
+			// the other queue may be appending
+			MutexLock lg(&logMu_);
+			log_ = log;
+			logFile_ = logFile;
+		}
+		mem_ = mem;
+		writers_.pop_front();
+		if (!writers_.empty()) {
+			writers_.front()->cv.signal();
+		}
+	}
+
+	void WriteThread::waitForPendingWrites()
+	{
+		MutexLock l(&mu_);
+		while (!memGroups_.empty()) {
+			memIdleCv_.wait();
+		}
+	}
+
+	Status WriteThread::writeLog(const std::vector<Writer*>& writers, size_t size, bool sync)
+	{
+		WriteBatch merged;
+		const WriteBatch* record = writers[0]->batch;
+		const SequenceNumber first = WriteBatchInternal::sequence(record);
+		SequenceNumber last = first - 1;
+		for (Writer* w : writers) {
+			last += WriteBatchInternal::count(w->batch);
+		}
+		if (writers.size() > 1) {
+			merged.reserve(size);
+			for (Writer* w : writers) {
+				WriteBatchInternal::append(&merged, w->batch);
+			}
+			WriteBatchInternal::setSequence(&merged, WriteBatchInternal::sequence(writers[0]->batch));
+			record = &merged;
+		}
+		// the leader of the other queue may have taken its numbers first, the
+		// replay cuts its memtables assuming the log is in sequence order
+		MutexLock l(&logMu_);
+		while (lastLogged_ + 1 < first) {
+			logCv_.wait();
+		}
+		Status status = log_->addRecord(WriteBatchInternal::contents(record));
+		if (status.ok() && sync) {
+			status = logFile_->sync();
+		}
+		// a failed record is passed too, its writers get the error
+		if (last > lastLogged_) {
+			lastLogged_ = last;
+			logCv_.signalAll();
+		}
+		return status;
+	}
+
+	void WriteThread::leadGroup(Writer* leader)
+	{
+		if (!pipelined_ && !leader->unordered) {
+			// the group is made visible right after its insert, the unordered
+			// groups logged before it go first
+			while (!memGroups_.empty()) {
+				memIdleCv_.wait();
+			}
+		}
+
+		Group localGroup;
+		Group* group = &localGroup;
+		if (leader->unordered) {
+			group = new Group;
+			group->async = true;
+		}
+		group->mem = mem_;
+		size_t size = WriteBatchInternal::byteSize(leader->batch);
+		size_t maxSize = KMaxGroupSize;
+		if (size <= KSmallBatchSize) {
+			maxSize = size + KSmallBatchSize;
+		}
+		group->writers.push_back(leader);
+		for (size_t i = 1; i < writers_.size(); ++i) {
+			Writer* w = writers_[i];
+			// a sync write is not left to a leader that does not sync, and a
+			// memtable switch waits for its turn
+			if (w->batch == nullptr || (w->sync && !leader->sync) || w->unordered != leader->unordered) {
+				break;
+			}
+			size += WriteBatchInternal::byteSize(w->batch);
+			if (size > maxSize) {
+				break;
+			}
+			group->writers.push_back(w);
+		}
+
+		SequenceNumber sequence = lastAllocated_ + 1;
+		for (Writer* w : group->writers) {
+			WriteBatchInternal::setSequence(w->batch, sequence);
+			sequence += WriteBatchInternal::count(w->batch);
+		}
+		group->lastSequence = sequence - 1;
+		lastAllocated_ = group->lastSequence;
+
+		// only the leader logs, the writers behind it wait for it to leave the
+		// front of the queue
+		Status status;
+		{
+			mu_.unlock();
+			status = writeLog(group->writers, size, leader->sync);
+			if (status.ok() && !pipelined_ && !leader->unordered) {
+				for (Writer* w : group->writers) {
+					if (w->disableMemtable) {
+						continue;
+					}
+					status = WriteBatchInternal::insertInto(w->batch, group->mem);
+					if (!status.ok()) {
+						break;
+					}
+				}
+			}
+			mu_.lock();
+		}
+
+		for (size_t i = 0; i < group->writers.size(); ++i) {
+			assert(writers_.front() == group->writers[i]);
+			writers_.pop_front();
+			group->writers[i]->status = status;
+		}
+		group->status = status;
+
+		if (group->async) {
+			// acknowledged now, the copies outlive the batches of the writers
+			if (status.ok()) {
+				for (Writer* w : group->writers) {
+					if (!w->disableMemtable) {
+						group->batches.emplace_back(*w->batch);
+					}
+				}
+			}
+			for (Writer* w : group->writers) {
+				w->done = true;
+				if (w != leader) {
+					w->cv.signal();
+				}
+			}
+			group->writers.clear();
+			group->pending = 1;
+			memGroups_.push_back(group);
+			if (asyncPool_ == nullptr) {
+				asyncPool_ = std::make_unique<ThreadPool>(KAsyncInsertThreads);
+			}
+			asyncPool_->schedule([this, group]() { insertAsync(group); });
+			if (!writers_.empty()) {
+				writers_.front()->cv.signal();
+			}
+			return;
+		}
+
+		if (!pipelined_) {
+			// the sequence numbers of a group that failed to log are skipped
+			lastVisible_.store(group->lastSequence, std::memory_order_release);
+			for (Writer* w : group->writers) {
+				w->done = true;
+				if (w != leader) {
+					w->cv.signal();
+				}
+			}
+			if (!writers_.empty()) {
+				writers_.front()->cv.signal();
+			}
+			return;
+		}
+
+		// the next group may log while this one inserts. a group that failed
+		// to log is queued as well so the groups before it are visible first
+		group->pending = group->writers.size();
+		memGroups_.push_back(group);
+		for (Writer* w : group->writers) {
+			w->group = group;
+			if (w != leader) {
+				w->cv.signal();
+			}
+		}
+		if (!writers_.empty()) {
+			writers_.front()->cv.signal();
+		}
+		// the group lives on the stack of the leader, it returns only after
+		// the group was made visible
+		insertAndWait(leader);
+	}
+
+	void WriteThread::leadWalGroup(Writer* leader)
+	{
+		std::vector<Writer*> writers;
+		size_t size = 0;
+		for (Writer* w : walWriters_) {
+			if (w->sync && !leader->sync) {
+				break;
+			}
+			size += WriteBatchInternal::byteSize(w->batch);
+			if (!writers.empty() && size > KMaxGroupSize) {
+				break;
+			}
+			writers.push_back(w);
+		}
+
+		// the batches only need distinct numbers for the replay, they are
+		// never visible before it
+		SequenceNumber sequence = lastAllocated_ + 1;
+		for (Writer* w : writers) {
+			WriteBatchInternal::setSequence(w->batch, sequence);
+			sequence += WriteBatchInternal::count(w->batch);
+		}
+		lastAllocated_ = sequence - 1;
+
+		mu_.unlock();
+		Status status = writeLog(writers, size, leader->sync);
+		mu_.lock();
+
+		for (Writer* w : writers) {
+			assert(walWriters_.front() == w);
+			walWriters_.pop_front();
+			w->status = status;
+			w->done = true;
+			if (w != leader) {
+				w->cv.signal();
+			}
+		}
+		if (!walWriters_.empty()) {
+			walWriters_.front()->cv.signal();
+		}
+	}
+
+	void WriteThread::insertAsync(Group* group)
+	{
+		if (group->status.ok()) {
+			for (const WriteBatch& batch : group->batches) {
+				// a failed insert leaves a broken memtable, the log still has it
+				WriteBatchInternal::insertInto(&batch, group->mem, true);
+			}
+		}
+		MutexLock l(&mu_);
+		group->pending = 0;
+		publishGroups();
+	}
+
+	void WriteThread::insertAndWait(Writer* w)
+	{
+		Group* group = w->group;
+		assert(group != nullptr);
+		if (group->status.ok() && !w->disableMemtable) {
+			mu_.unlock();
+			Status s = WriteBatchInternal::insertInto(w->batch, group->mem, true);
+			mu_.lock();
+			if (!s.ok()) {
+				w->status = s;
+			}
+		}
+		if (--group->pending == 0) {
+			publishGroups();
+		}
+		while (!w->done) {
+			w->cv.wait();
+		}
+	}
+
+	void WriteThread::publishGroups()
+	{
+		while (!memGroups_.empty() && memGroups_.front()->pending == 0) {
+			Group* group = memGroups_.front();
+			memGroups_.pop_front();
+			lastVisible_.store(group->lastSequence, std::memory_order_release);
+			for (Writer* w : group->writers) {
+				w->done = true;
+				w->cv.signal();
+			}
+			if (group->async) {
+				delete group;
+			}
+		}
+		if (memGroups_.empty()) {
+			memIdleCv_.signalAll();
+		}
+	}
+
+}
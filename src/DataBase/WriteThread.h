@@ -0,0 +1,133 @@
+/*!
+ * \file WriteThread.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "CDataBase/Options.h"
+#include "CDataBase/Status.h"
+#include "DataBase/DBFormat.h"
+#include "Util/MutexLock.h"
+#include "Util/ThreadAnnotations.h"
+
+namespace CDB{
+
+	class MemTable;
+	class ThreadPool;
+	class WritableFile;
+	class WriteBatch;
+
+	namespace log{
+		class Writer;
+	}
+
+	/*!
+	 * \class WriteThread
+	 *
+	 * \brief the write path of the db. writers queue up and the one at the
+	 *  front becomes the leader of a group: it gives the batches of the
+	 *  queued writers their sequence numbers and appends them to the log as
+	 *  one record. without options.enable_pipelined_write the leader then
+	 *  inserts the group into the memtable before the next group starts.
+	 *  with it the next group appends to the log right away, and the writers
+	 *  of the logged group insert their own batches into the memtable at the
+	 *  same time. the groups are made visible in log order, so the last
+	 *  sequence never has holes below it.
+	 *
+	 *  a group of unordered writes returns as soon as it is logged and is
+	 *  inserted by a background thread. with options.two_write_queues the
+	 *  writes that skip the memtable queue up separately and only share the
+	 *  log with the others, the two queues append in the order of their
+	 *  sequence numbers so the replay sees them in order
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class WriteThread{
+	public:
+		/// writes go to log and logFile and are inserted into mem, none is owned.
+		/// lastSequence is the last sequence number in use
+		WriteThread(const Options& options, log::Writer* log, WritableFile* logFile, MemTable* mem,
+			SequenceNumber lastSequence);
+
+		WriteThread(const WriteThread&) = delete;
+
+		WriteThread& operator=(const WriteThread&) = delete;
+
+		/// waits for the unordered writes still being inserted
+		~WriteThread();
+
+		/// returns once batch and every write before it are visible
+		Status write(const WriteOptions& options, WriteBatch* batch);
+
+		/// waits for the writes in flight, then sends the next writes to the given
+		/// log and memtable, used when the memtable is full
+		void switchTo(log::Writer* log, WritableFile* logFile, MemTable* mem);
+
+		/// block until the unordered writes returned so far are visible
+		void waitForPendingWrites();
+
+		/// the last sequence number a read may see
+		SequenceNumber lastSequence() const { return lastVisible_.load(std::memory_order_acquire); }
+
+	private:
+		struct Group;
+		struct Writer;
+
+		// build a group from the writers at the front of the queue and log it
+		void leadGroup(Writer* leader) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+		// log a group of the writes that skip the memtable, from the front of walWriters_
+		void leadWalGroup(Writer* leader) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+		// append the batches of writers to the log as one record once the
+		// sequence numbers before theirs are logged
+		Status writeLog(const std::vector<Writer*>& writers, size_t size, bool sync) LOCKS_EXCLUDED(mu_);
+
+		// insert the batches of an unordered group in the background
+		void insertAsync(Group* group) LOCKS_EXCLUDED(mu_);
+
+		// insert the batch of w into the memtable of its group and wait until
+		// the group is visible
+		void insertAndWait(Writer* w) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+		// make the groups at the front of memGroups_ that are done visible
+		void publishGroups() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+		const bool pipelined_;
+
+		Mutex mu_;
+		// signalled when memGroups_ gets empty
+		CondVar memIdleCv_;
+		// writers waiting for the log, the front one is logging
+		std::deque<Writer*> writers_ GUARDED_BY(mu_);
+		// the writes that skip the memtable with options.two_write_queues
+		std::deque<Writer*> walWriters_ GUARDED_BY(mu_);
+		const bool twoQueues_;
+		// logged groups whose memtable inserts may run, in log order
+		std::deque<Group*> memGroups_ GUARDED_BY(mu_);
+		// held by the leaders of both queues while they append to the log,
+		// mu_ is never taken under it
+		Mutex logMu_;
+		// signalled when lastLogged_ moves
+		CondVar logCv_;
+		// the sequence numbers up to this one are in the log
+		SequenceNumber lastLogged_ GUARDED_BY(logMu_);
+		log::Writer* log_ GUARDED_BY(logMu_);
+		WritableFile* logFile_ GUARDED_BY(logMu_);
+		MemTable* mem_ GUARDED_BY(mu_);
+		// the last sequence number handed out
+		SequenceNumber lastAllocated_ GUARDED_BY(mu_);
+		std::atomic<SequenceNumber> lastVisible_;
+		// inserts the unordered groups, created on the first one
+		std::unique_ptr<ThreadPool> asyncPool_ GUARDED_BY(mu_);
+	};
+
+}
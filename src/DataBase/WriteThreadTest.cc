@@ -0,0 +1,233 @@
+#include "DataBase/WriteThread.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "CDataBase/Iterator.h"
+#include "CDataBase/WriteBatch.h"
+#include "DataBase/LogReader.h"
+#include "DataBase/LogWriter.h"
+#include "DataBase/MemTable.h"
+#include "DataBase/WriteBatchInternal.h"
+
+namespace CDB {
+
+	namespace {
+
+		class StringDest : public WritableFile {
+		public:
+			Status append(const Slice& data) override
+			{
+				contents.append(data.data(), data.size());
+				return Status::OK();
+			}
+			Status close() override { return Status::OK(); }
+			Status flush() override { return Status::OK(); }
+			Status sync() override
+			{
+				syncs++;
+				return Status::OK();
+			}
+
+			std::string contents;
+			int syncs = 0;
+		};
+
+		class StringSource : public SequentialFile {
+		public:
+			explicit StringSource(const std::string& data) :contents_(data) {}
+
+			Status read(size_t n, Slice* result, char* scratch) override
+			{
+				if (n > contents_.size()) {
+					n = contents_.size();
+				}
+				std::memcpy(scratch, contents_.data(), n);
+				*result = Slice(scratch, n);
+				contents_.remove_prefix(n);
+				return Status::OK();
+			}
+			Status skip(uint64_t n) override
+			{
+				contents_.remove_prefix(std::min<uint64_t>(n, contents_.size()));
+				return Status::OK();
+			}
+
+		private:
+			Slice contents_;
+		};
+
+	}
+
+	class WriteThreadTest : public testing::TestWithParam<bool> {
+	public:
+		WriteThreadTest() :icmp_(byteWiseComparator()), writer_(&dest_)
+		{
+			options_.enable_pipelined_write = GetParam();
+		}
+
+		/// every thread writes batches of two puts and checks that its batch
+		/// is visible when write returns, if it is an ordered write. mixed
+		/// makes every other thread use the given options, the rest the defaults
+		void runWriters(WriteThread* wt, int threads, int writes, WriteOptions base = WriteOptions(),
+			bool mixed = false)
+		{
+			std::vector<std::thread> workers;
+			for (int t = 0; t < threads; ++t) {
+				workers.emplace_back([wt, t, writes, base, mixed]() {
+					for (int i = 0; i < writes; ++i) {
+						WriteBatch batch;
+						const std::string key = "t" + std::to_string(t) + "-" + std::to_string(i);
+						batch.put(key + "a", "va");
+						batch.put(key + "b", "vb");
+						WriteOptions options = (mixed && t % 2 == 1) ? WriteOptions() : base;
+						options.sync = (i % 10 == 0);
+						ASSERT_TRUE(wt->write(options, &batch).ok());
+						if (!options.unordered && !options.disable_memtable) {
+							ASSERT_LE(WriteBatchInternal::sequence(&batch) + 1, wt->lastSequence());
+						}
+					}
+				});
+			}
+			for (auto& worker : workers) {
+				worker.join();
+			}
+		}
+
+		/// sequence numbers of the entries in mem
+		static void collect(MemTable* mem, std::set<SequenceNumber>* sequences)
+		{
+			std::unique_ptr<Iterator> iter(mem->newIterator());
+			for (iter->seekToFirst(); iter->valid(); iter->next()) {
+				ParsedInternalKey ikey;
+				ASSERT_TRUE(ParseInternalKey(iter->key(), &ikey));
+				ASSERT_TRUE(sequences->insert(ikey.sequence).second);
+			}
+		}
+
+		/// sequence numbers of the entries in the log
+		void collectLog(std::set<SequenceNumber>* sequences)
+		{
+			StringSource source(dest_.contents);
+			log::Reader reader(&source, nullptr, true, 0);
+			std::string scratch;
+			Slice record;
+			while (reader.readRecord(&record, &scratch)) {
+				WriteBatch batch;
+				WriteBatchInternal::setContents(&batch, record);
+				SequenceNumber seq = WriteBatchInternal::sequence(&batch);
+				for (int i = 0; i < WriteBatchInternal::count(&batch); ++i) {
+					ASSERT_TRUE(sequences->insert(seq + i).second);
+				}
+			}
+		}
+
+		Options options_;
+		InternalKeyComparator icmp_;
+		StringDest dest_;
+		log::Writer writer_;
+	};
+
+	TEST_P(WriteThreadTest, ConcurrentWriters) {
+		MemTable* mem = new MemTable(icmp_);
+		mem->ref();
+		WriteThread wt(options_, &writer_, &dest_, mem, 100);
+		const int threads = 8;
+		const int writes = 200;
+		runWriters(&wt, threads, writes);
+
+		const SequenceNumber total = 2 * threads * writes;
+		ASSERT_EQ(100 + total, wt.lastSequence());
+		std::set<SequenceNumber> inMem;
+		collect(mem, &inMem);
+		mem->unRef();
+		ASSERT_EQ(total, inMem.size());
+		ASSERT_EQ(101u, *inMem.begin());
+		ASSERT_EQ(100 + total, *inMem.rbegin());
+
+		std::set<SequenceNumber> inLog;
+		collectLog(&inLog);
+		ASSERT_EQ(inMem, inLog);
+		ASSERT_GT(dest_.syncs, 0);
+	}
+
+	TEST_P(WriteThreadTest, SwitchMemTable) {
+		MemTable* first = new MemTable(icmp_);
+		first->ref();
+		MemTable* second = new MemTable(icmp_);
+		second->ref();
+		WriteThread wt(options_, &writer_, &dest_, first, 0);
+		std::thread switcher([&]() {
+			while (wt.lastSequence() < 200) {
+				std::this_thread::yield();
+			}
+			wt.switchTo(&writer_, &dest_, second);
+		});
+		runWriters(&wt, 4, 100);
+		switcher.join();
+		// the switch may have come after the last write
+		runWriters(&wt, 2, 50);
+
+		std::set<SequenceNumber> inFirst, inSecond;
+		collect(first, &inFirst);
+		collect(second, &inSecond);
+		first->unRef();
+		second->unRef();
+		ASSERT_FALSE(inFirst.empty());
+		ASSERT_FALSE(inSecond.empty());
+		// everything in the first memtable is older than the second
+		ASSERT_LT(*inFirst.rbegin(), *inSecond.begin());
+		ASSERT_EQ(1000u, inFirst.size() + inSecond.size());
+	}
+
+	TEST_P(WriteThreadTest, UnorderedWrites) {
+		MemTable* mem = new MemTable(icmp_);
+		mem->ref();
+		WriteThread wt(options_, &writer_, &dest_, mem, 0);
+		WriteOptions unordered;
+		unordered.unordered = true;
+		runWriters(&wt, 8, 100, unordered, true);
+		wt.waitForPendingWrites();
+
+		ASSERT_EQ(1600u, wt.lastSequence());
+		std::set<SequenceNumber> inMem;
+		collect(mem, &inMem);
+		mem->unRef();
+		ASSERT_EQ(1600u, inMem.size());
+		std::set<SequenceNumber> inLog;
+		collectLog(&inLog);
+		ASSERT_EQ(inMem, inLog);
+	}
+
+	TEST_P(WriteThreadTest, TwoQueues) {
+		options_.two_write_queues = true;
+		MemTable* mem = new MemTable(icmp_);
+		mem->ref();
+		WriteThread wt(options_, &writer_, &dest_, mem, 0);
+		WriteOptions walOnly;
+		walOnly.disable_memtable = true;
+		runWriters(&wt, 8, 100, walOnly, true);
+
+		std::set<SequenceNumber> inMem;
+		collect(mem, &inMem);
+		mem->unRef();
+		// the ordered half only, the rest waits in the log for the replay
+		ASSERT_EQ(800u, inMem.size());
+		std::set<SequenceNumber> inLog;
+		collectLog(&inLog);
+		ASSERT_EQ(1600u, inLog.size());
+		ASSERT_EQ(1u, *inLog.begin());
+		ASSERT_EQ(1600u, *inLog.rbegin());
+		for (SequenceNumber seq : inMem) {
+			ASSERT_EQ(1u, inLog.count(seq));
+		}
+	}
+
+	INSTANTIATE_TEST_SUITE_P(Pipelined, WriteThreadTest, testing::Bool());
+
+}
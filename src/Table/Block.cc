@@ -0,0 +1,311 @@
+// Decodes the blocks generated by BlockBuilder.
+
+#include "Table/Block.h"
+
+#include <algorithm>
+#include <string>
+#include "CDataBase/Comprator.h"
+#include "Table/Format.h"
+#include "Util/Coding.h"
+
+namespace CDB{
+
+	inline uint32_t Block::numRestarts() const
+	{
+		assert(size_ >= sizeof(uint32_t));
+		return DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+	}
+
+	Block::Block(const BlockContents& contents)
+		: data_(contents.data.data()),
+		size_(contents.data.size()),
+		owned_(contents.heapAllocated)
+	{
+		if (size_ < sizeof(uint32_t)) {
+			size_ = 0;  // Error marker
+		}
+		else {
+			size_t maxRestartsAllowed = (size_ - sizeof(uint32_t)) / sizeof(uint32_t);
+			if (numRestarts() > maxRestartsAllowed) {
+				// The size is too small for NumRestarts()
+				size_ = 0;
+			}
+			else {
+				restartOffset_ = static_cast<uint32_t>(size_ - (1 + numRestarts()) * sizeof(uint32_t));
+			}
+		}
+	}
+
+	Block::~Block()
+	{
+		if (owned_) {
+			delete[] data_;
+		}
+	}
+
+	// Helper routine: decode the next block entry starting at "p",
+	// storing the number of shared key bytes, non_shared key bytes,
+	// and the length of the value in "*shared", "*non_shared", and
+	// "*value_length", respectively.  Will not dereference past "limit".
+	//
+	// If any errors are detected, returns nullptr.  Otherwise, returns a
+	// pointer to the key delta (just past the three decoded values).
+	static inline const char* decodeEntry(const char* p, const char* limit,
+		uint32_t* shared, uint32_t* nonShared, uint32_t* valueLength)
+	{
+		if (limit - p < 3) return nullptr;
+		*shared = reinterpret_cast<const uint8_t*>(p)[0];
+		*nonShared = reinterpret_cast<const uint8_t*>(p)[1];
+		*valueLength = reinterpret_cast<const uint8_t*>(p)[2];
+		if ((*shared | *nonShared | *valueLength) < 128) {
+			// Fast path: all three values are encoded in one byte each
+			p += 3;
+		}
+		else {
+			if ((p = GetVarint32Ptr(p, limit, shared)) == nullptr) return nullptr;
+			if ((p = GetVarint32Ptr(p, limit, nonShared)) == nullptr) return nullptr;
+			if ((p = GetVarint32Ptr(p, limit, valueLength)) == nullptr) return nullptr;
+		}
+
+		if (static_cast<uint32_t>(limit - p) < (*nonShared + *valueLength)) {
+			return nullptr;
+		}
+		return p;
+	}
+
+	class Block::Iter : public Iterator{
+	private:
+		const Comparator* const comparator_;
+		const char* const data_;       // underlying block contents
+		uint32_t const restarts_;      // Offset of restart array (list of fixed32)
+		uint32_t const numRestarts_;   // Number of uint32_t entries in restart array
+
+		// current_ is offset in data_ of current entry.  >= restarts_ if !Valid
+		uint32_t current_;
+		uint32_t restartIndex_;  // Index of restart block in which current_ falls
+		std::string key_;
+		Slice value_;
+		Status status_;
+
+		inline int compare(const Slice& a, const Slice& b) const
+		{
+			return comparator_->compare(a, b);
+		}
+
+		// Return the offset in data_ just past the end of the current entry.
+		inline uint32_t nextEntryOffset() const
+		{
+			return static_cast<uint32_t>((value_.data() + value_.size()) - data_);
+		}
+
+		uint32_t getRestartPoint(uint32_t index)
+		{
+			assert(index < numRestarts_);
+			return DecodeFixed32(data_ + restarts_ + index * sizeof(uint32_t));
+		}
+
+		void seekToRestartPoint(uint32_t index)
+		{
+			key_.clear();
+			restartIndex_ = index;
+			// current_ will be fixed by ParseNextKey();
+
+			// ParseNextKey() starts at the end of value_, so set value_ accordingly
+			uint32_t offset = getRestartPoint(index);
+			value_ = Slice(data_ + offset, 0);
+		}
+
+	public:
+		Iter(const Comparator* comparator, const char* data, uint32_t restarts,
+			uint32_t numRestarts)
+			: comparator_(comparator),
+			data_(data),
+			restarts_(restarts),
+			numRestarts_(numRestarts),
+			current_(restarts_),
+			restartIndex_(numRestarts_)
+		{
+			assert(numRestarts_ > 0);
+		}
+
+		bool valid() const override { return current_ < restarts_; }
+		Status status() const override { return status_; }
+		Slice key() const override
+		{
+			assert(valid());
+			return key_;
+		}
+		Slice value() const override
+		{
+			assert(valid());
+			return value_;
+		}
+
+		void next() override
+		{
+			assert(valid());
+			parseNextKey();
+		}
+
+		void prev() override
+		{
+			assert(valid());
+
+			// Scan backwards to a restart point before current_
+			const uint32_t original = current_;
+			while (getRestartPoint(restartIndex_) >= original) {
+				if (restartIndex_ == 0) {
+					// No more entries
+					current_ = restarts_;
+					restartIndex_ = numRestarts_;
+					return;
+				}
+				restartIndex_--;
+			}
+
+			seekToRestartPoint(restartIndex_);
+			do {
+				// Loop until end of current entry hits the start of original entry
+			} while (parseNextKey() && nextEntryOffset() < original);
+		}
+
+		void seek(const Slice& target) override
+		{
+			// Binary search in restart array to find the last restart point
+			// with a key < target
+			uint32_t left = 0;
+			uint32_t right = numRestarts_ - 1;
+			int currentKeyCompare = 0;
+
+			if (valid()) {
+				// If we're already scanning, use the current position as a starting
+				// point. This is beneficial if the key we're seeking to is ahead of the
+				// current position.
+				currentKeyCompare = compare(key_, target);
+				if (currentKeyCompare < 0) {
+					// key_ is smaller than target
+					left = restartIndex_;
+				}
+				else if (currentKeyCompare > 0) {
+					right = restartIndex_;
+				}
+				else {
+					// We're seeking to the key we're already at.
+					return;
+				}
+			}
+
+			while (left < right) {
+				uint32_t mid = (left + right + 1) / 2;
+				uint32_t regionOffset = getRestartPoint(mid);
+				uint32_t shared, nonShared, valueLength;
+				const char* keyPtr =
+					decodeEntry(data_ + regionOffset, data_ + restarts_, &shared,
+						&nonShared, &valueLength);
+				if (keyPtr == nullptr || (shared != 0)) {
+					corruptionError();
+					return;
+				}
+				Slice midKey(keyPtr, nonShared);
+				if (compare(midKey, target) < 0) {
+					// Key at "mid" is smaller than "target".  Therefore all
+					// blocks before "mid" are uninteresting.
+					left = mid;
+				}
+				else {
+					// Key at "mid" is >= "target".  Therefore all blocks at or
+					// after "mid" are uninteresting.
+					right = mid - 1;
+				}
+			}
+
+			// We might be able to use our current position within the restart block.
+			// This is true if we determined the key we desire is in the current block
+			// and is after than the current key.
+			assert(currentKeyCompare == 0 || valid());
+			bool skipSeek = left == restartIndex_ && currentKeyCompare < 0;
+			if (!skipSeek) {
+				seekToRestartPoint(left);
+			}
+			// Linear search (within restart block) for first key >= target
+			while (true) {
+				if (!parseNextKey()) {
+					return;
+				}
+				if (compare(key_, target) >= 0) {
+					return;
+				}
+			}
+		}
+
+		void seekToFirst() override
+		{
+			seekToRestartPoint(0);
+			parseNextKey();
+		}
+
+		void seekToLast() override
+		{
+			seekToRestartPoint(numRestarts_ - 1);
+			while (parseNextKey() && nextEntryOffset() < restarts_) {
+				// Keep skipping
+			}
+		}
+
+	private:
+		void corruptionError()
+		{
+			current_ = restarts_;
+			restartIndex_ = numRestarts_;
+			status_ = Status::Corruption("bad entry in block");
+			key_.clear();
+			value_ = Slice();
+		}
+
+		bool parseNextKey()
+		{
+			current_ = nextEntryOffset();
+			const char* p = data_ + current_;
+			const char* limit = data_ + restarts_;  // Restarts come right after data
+			if (p >= limit) {
+				// No more entries to return.  Mark as invalid.
+				current_ = restarts_;
+				restartIndex_ = numRestarts_;
+				return false;
+			}
+
+			// Decode next entry
+			uint32_t shared, nonShared, valueLength;
+			p = decodeEntry(p, limit, &shared, &nonShared, &valueLength);
+			if (p == nullptr || key_.size() < shared) {
+				corruptionError();
+				return false;
+			}
+			else {
+				key_.resize(shared);
+				key_.append(p, nonShared);
+				value_ = Slice(p + nonShared, valueLength);
+				while (restartIndex_ + 1 < numRestarts_ &&
+					getRestartPoint(restartIndex_ + 1) < current_) {
+					++restartIndex_;
+				}
+				return true;
+			}
+		}
+	};
+
+	Iterator* Block::newIterator(const Comparator* comparator)
+	{
+		if (size_ < sizeof(uint32_t)) {
+			return newErrorIterator(Status::Corruption("bad block contents"));
+		}
+		const uint32_t restarts = numRestarts();
+		if (restarts == 0) {
+			return newEmptyIterator();
+		}
+		else {
+			return new Iter(comparator, data_, restartOffset_, restarts);
+		}
+	}
+
+}
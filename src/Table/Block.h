@@ -0,0 +1,56 @@
+/*!
+ * \file Block.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "CDataBase/Iterator.h"
+
+namespace CDB{
+
+	struct BlockContents;
+	class Comparator;
+
+	/*!
+	 * \class Block
+	 *
+	 * \brief read side of a block written by BlockBuilder
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class Block{
+	public:
+		// Initialize the block with the specified contents.
+		explicit Block(const BlockContents& contents);
+
+		Block(const Block&) = delete;
+
+		Block& operator=(const Block&) = delete;
+
+		~Block();
+
+		size_t size() const { return size_; }
+
+		// the uncompressed block as it was read, what a secondary cache keeps
+		Slice contents() const { return Slice(data_, size_); }
+
+		Iterator* newIterator(const Comparator* comparator);
+
+	private:
+		class Iter;
+
+		uint32_t numRestarts() const;
+
+		const char* data_;
+		size_t size_;
+		uint32_t restartOffset_;  // Offset in data_ of restart array
+		bool owned_;              // Block owns data_[]
+	};
+
+}
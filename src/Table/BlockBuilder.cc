@@ -0,0 +1,108 @@
+// BlockBuilder generates blocks where keys are prefix-compressed:
+//
+// When we store a key, we drop the prefix shared with the previous
+// string.  This helps reduce the space requirement significantly.
+// Furthermore, once every K keys, we do not apply the prefix
+// compression and store the entire key.  We call this a "restart
+// point".  The tail end of the block stores the offsets of all of the
+// restart points, and can be used to do a binary search when looking
+// for a particular key.  Values are stored as-is (without compression)
+// immediately following the corresponding key.
+//
+// An entry for a particular key-value pair has the form:
+//     shared_bytes: varint32
+//     unshared_bytes: varint32
+//     value_length: varint32
+//     key_delta: char[unshared_bytes]
+//     value: char[value_length]
+// shared_bytes == 0 for restart points.
+//
+// The trailer of the block has the form:
+//     restarts: uint32[num_restarts]
+//     num_restarts: uint32
+// restarts[i] contains the offset within the block of the ith restart point.
+
+#include "Table/BlockBuilder.h"
+
+#include <algorithm>
+#include <cassert>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Options.h"
+#include "Util/Coding.h"
+
+namespace CDB{
+
+	BlockBuilder::BlockBuilder(const Options* options)
+		: options_(options), restarts_(), counter_(0), finished_(false)
+	{
+		assert(options->block_restart_interval >= 1);
+		restarts_.push_back(0);  // First restart point is at offset 0
+	}
+
+	void BlockBuilder::reset()
+	{
+		buffer_.clear();
+		restarts_.clear();
+		restarts_.push_back(0);  // First restart point is at offset 0
+		counter_ = 0;
+		finished_ = false;
+		lastKey_.clear();
+	}
+
+	size_t BlockBuilder::currentSizeEstimate() const
+	{
+		return (buffer_.size() +                       // Raw data buffer
+			restarts_.size() * sizeof(uint32_t) +      // Restart array
+			sizeof(uint32_t));                         // Restart array length
+	}
+
+	Slice BlockBuilder::finish()
+	{
+		// Append restart array
+		for (size_t i = 0; i < restarts_.size(); i++) {
+			PutFixed32(&buffer_, restarts_[i]);
+		}
+		PutFixed32(&buffer_, static_cast<uint32_t>(restarts_.size()));
+		finished_ = true;
+		return Slice(buffer_);
+	}
+
+	void BlockBuilder::add(const Slice& key, const Slice& value)
+	{
+		Slice lastKeyPiece(lastKey_);
+		assert(!finished_);
+		assert(counter_ <= options_->block_restart_interval);
+		assert(buffer_.empty()  // No values yet?
+			|| options_->comparator->compare(key, lastKeyPiece) > 0);
+		size_t shared = 0;
+		if (counter_ < options_->block_restart_interval) {
+			// See how much sharing to do with previous string
+			const size_t minLength = std::min(lastKeyPiece.size(), key.size());
+			while ((shared < minLength) && (lastKeyPiece[shared] == key[shared])) {
+				shared++;
+			}
+		}
+		else {
+			// Restart compression
+			restarts_.push_back(static_cast<uint32_t>(buffer_.size()));
+			counter_ = 0;
+		}
+		const size_t nonShared = key.size() - shared;
+
+		// Add "<shared><non_shared><value_size>" to buffer_
+		PutVarint32(&buffer_, static_cast<uint32_t>(shared));
+		PutVarint32(&buffer_, static_cast<uint32_t>(nonShared));
+		PutVarint32(&buffer_, static_cast<uint32_t>(value.size()));
+
+		// Add string delta to buffer_ followed by value
+		buffer_.append(key.data() + shared, nonShared);
+		buffer_.append(value.data(), value.size());
+
+		// Update state
+		lastKey_.resize(shared);
+		lastKey_.append(key.data() + shared, nonShared);
+		assert(Slice(lastKey_) == key);
+		counter_++;
+	}
+
+}
@@ -0,0 +1,61 @@
+/*!
+ * \file BlockBuilder.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CDataBase/Slice.h"
+
+namespace CDB{
+
+	struct Options;
+
+	/*!
+	 * \class BlockBuilder
+	 *
+	 * \brief builds a block of prefix compressed keys, every
+	 *  block_restart_interval keys a full key is stored as a restart point
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class BlockBuilder{
+	public:
+		explicit BlockBuilder(const Options* options);
+
+		BlockBuilder(const BlockBuilder&) = delete;
+
+		BlockBuilder& operator=(const BlockBuilder&) = delete;
+
+		/// reset the contents as if the BlockBuilder was just constructed.
+		void reset();
+
+		/// REQUIRES: finish() has not been called since the last call to reset().
+		/// REQUIRES: key is larger than any previously added key
+		void add(const Slice& key, const Slice& value);
+
+		/// finish building the block and return a slice that refers to the
+		/// block contents, the slice remains valid until reset() is called.
+		Slice finish();
+
+		/// an estimate of the current (uncompressed) size of the block we are building.
+		size_t currentSizeEstimate() const;
+
+		bool empty() const { return buffer_.empty(); }
+
+	private:
+		const Options* options_;
+		std::string buffer_;              // Destination buffer
+		std::vector<uint32_t> restarts_;  // Restart points
+		int counter_;                     // Number of entries emitted since restart
+		bool finished_;                   // Has finish() been called?
+		std::string lastKey_;
+	};
+
+}
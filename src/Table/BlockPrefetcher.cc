@@ -0,0 +1,213 @@
+/*!
+ * \file BlockPrefetcher.cc
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#include "Table/BlockPrefetcher.h"
+
+#include "CDataBase/Env.h"
+#include "CDataBase/Iterator.h"
+#include "Table/Format.h"
+
+namespace CDB{
+
+	struct BlockPrefetcher::Stream::Slot {
+		uint64_t offset;
+		size_t charge;
+		// set with the fields below once the read is over
+		bool done = false;
+		Status status;
+		BlockContents contents = { Slice(), false, false };
+	};
+
+	namespace {
+
+		// no page is smaller, one byte of each is read to fault a block in
+		const size_t KPageSize = 4096;
+
+		void touchPages(const Slice& data)
+		{
+			volatile char sink = 0;
+			for (size_t i = 0; i < data.size(); i += KPageSize) {
+				sink = sink + data[i];
+			}
+			if (!data.empty()) {
+				sink = sink + data[data.size() - 1];
+			}
+		}
+
+		void freeContents(BlockContents* contents)
+		{
+			if (contents->heapAllocated) {
+				delete[] contents->data.data();
+			}
+			contents->data = Slice();
+		}
+
+	}
+
+	BlockPrefetcher::BlockPrefetcher(int threads, int blocksPerInput, size_t memoryBudget)
+		:blocksPerInput_(blocksPerInput), memoryBudget_(memoryBudget), doneCv_(&mu_),
+		bytesInFlight_(0), prefetchedBlocks_(0), pool_(threads)
+	{}
+
+	BlockPrefetcher::BlockPrefetcher(const Options& options)
+		:BlockPrefetcher(KDefaultThreads, options.compaction_prefetch_blocks, options.compaction_prefetch_memory)
+	{}
+
+	BlockPrefetcher::~BlockPrefetcher()
+	{
+		MutexLock l(&mu_);
+		assert(bytesInFlight_ == 0);
+	}
+
+	BlockPrefetcher::Stream* BlockPrefetcher::newStream(RandomAccessFile* file, const ReadOptions& options,
+		Iterator* indexIter, const port::ZstdUncompressionDict* compressionDict)
+	{
+		return new Stream(this, file, options, indexIter, compressionDict);
+	}
+
+	size_t BlockPrefetcher::bytesInFlight() const
+	{
+		MutexLock l(&mu_);
+		return bytesInFlight_;
+	}
+
+	uint64_t BlockPrefetcher::prefetchedBlocks() const
+	{
+		MutexLock l(&mu_);
+		return prefetchedBlocks_;
+	}
+
+	BlockPrefetcher::Stream::Stream(BlockPrefetcher* prefetcher, RandomAccessFile* file,
+		const ReadOptions& options, Iterator* indexIter, const port::ZstdUncompressionDict* compressionDict)
+		:prefetcher_(prefetcher), file_(file), options_(options), compressionDict_(compressionDict),
+		indexIter_(indexIter), started_(false), disabled_(false)
+	{}
+
+	BlockPrefetcher::Stream::~Stream()
+	{
+		MutexLock l(&prefetcher_->mu_);
+		for (const std::shared_ptr<Slot>& slot : slots_) {
+			release(slot.get());
+			freeContents(&slot->contents);
+		}
+	}
+
+	Status BlockPrefetcher::Stream::read(const BlockHandle& handle, BlockContents* contents)
+	{
+		{
+			MutexLock l(&prefetcher_->mu_);
+			if (!disabled_) {
+				if (!started_) {
+					started_ = true;
+					indexIter_->seekToFirst();
+				}
+				if (skipTo(handle.offset())) {
+					if (!slots_.empty()) {
+						std::shared_ptr<Slot> slot = slots_.front();
+						slots_.pop_front();
+						release(slot.get());
+						++prefetcher_->prefetchedBlocks_;
+						fill();
+						*contents = slot->contents;
+						return slot->status;
+					}
+					// nothing was read ahead, the budget was used up by the
+					// other inputs. this block is read below
+					indexIter_->next();
+					fill();
+				}
+			}
+		}
+		return readBlock(file_, options_, handle, contents, compressionDict_);
+	}
+
+	bool BlockPrefetcher::Stream::skipTo(uint64_t offset)
+	{
+		while (!slots_.empty() && slots_.front()->offset < offset) {
+			release(slots_.front().get());
+			freeContents(&slots_.front()->contents);
+			slots_.pop_front();
+		}
+		if (!slots_.empty()) {
+			if (slots_.front()->offset == offset) {
+				return true;
+			}
+		}
+		else {
+			while (indexIter_->valid()) {
+				BlockHandle h;
+				Slice v = indexIter_->value();
+				if (!h.decodeFrom(&v).ok() || h.offset() > offset) {
+					break;
+				}
+				if (h.offset() == offset) {
+					return true;
+				}
+				indexIter_->next();
+			}
+		}
+
+		// a read behind the stream, the reads go to the file from now on
+		disabled_ = true;
+		for (const std::shared_ptr<Slot>& slot : slots_) {
+			release(slot.get());
+			freeContents(&slot->contents);
+		}
+		slots_.clear();
+		return false;
+	}
+
+	void BlockPrefetcher::Stream::fill()
+	{
+		while (static_cast<int>(slots_.size()) < prefetcher_->blocksPerInput_ && indexIter_->valid()) {
+			BlockHandle h;
+			Slice v = indexIter_->value();
+			if (!h.decodeFrom(&v).ok()) {
+				break;
+			}
+			const size_t charge = static_cast<size_t>(h.size()) + kBlockTrailerSize;
+			if (prefetcher_->bytesInFlight_ + charge > prefetcher_->memoryBudget_) {
+				break;
+			}
+			prefetcher_->bytesInFlight_ += charge;
+			std::shared_ptr<Slot> slot = std::make_shared<Slot>();
+			slot->offset = h.offset();
+			slot->charge = charge;
+			slots_.push_back(slot);
+			indexIter_->next();
+
+			// the stream waits for its slots before it goes away
+			prefetcher_->pool_.schedule([this, h, charge, slot]() {
+				// a mapped table hands out pointers into the mapping, so the
+				// pages are brought in here or the merge would fault on them
+				file_->prefetch(h.offset(), charge);
+				BlockContents contents;
+				Status s = readBlock(file_, options_, h, &contents, compressionDict_);
+				if (s.ok() && !contents.heapAllocated) {
+					touchPages(contents.data);
+				}
+				MutexLock l(&prefetcher_->mu_);
+				if (s.ok()) {
+					slot->contents = contents;
+				}
+				slot->status = s;
+				slot->done = true;
+				prefetcher_->doneCv_.signalAll();
+			});
+		}
+	}
+
+	void BlockPrefetcher::Stream::release(Slot* slot)
+	{
+		while (!slot->done) {
+			prefetcher_->doneCv_.wait();
+		}
+		prefetcher_->bytesInFlight_ -= slot->charge;
+	}
+
+}
@@ -0,0 +1,141 @@
+/*!
+ * \file BlockPrefetcher.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include "CDataBase/Options.h"
+#include "CDataBase/Slice.h"
+#include "CDataBase/Status.h"
+#include "Util/MutexLock.h"
+#include "Util/ThreadAnnotations.h"
+#include "Util/ThreadPool.h"
+
+namespace CDB{
+
+	class BlockHandle;
+	struct BlockContents;
+	class Iterator;
+	class RandomAccessFile;
+
+	namespace port {
+		class ZstdUncompressionDict;
+	}
+
+	/*!
+	 * \class BlockPrefetcher
+	 *
+	 * \brief reads the data blocks of the inputs of a compaction before the
+	 *  merge asks for them, so the merge does not wait on the disk at every
+	 *  block boundary. each input keeps its next blocks reading, and
+	 *  uncompressing, on a pool of threads, as long as the blocks read but
+	 *  not yet used fit in the memory budget. a stream only reads forward,
+	 *  a block it skips is dropped and one behind it turns it off. one per
+	 *  compaction, it must outlive the iterators using it
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class BlockPrefetcher{
+	public:
+		class Stream;
+
+		// threads of a prefetcher built from the options
+		static constexpr int KDefaultThreads = 4;
+
+		/// blocksPerInput blocks of every input in flight at most, and
+		/// memoryBudget bytes of blocks across all of them, by their size
+		/// in the file
+		BlockPrefetcher(int threads, int blocksPerInput, size_t memoryBudget);
+
+		/// from compaction_prefetch_blocks and compaction_prefetch_memory
+		explicit BlockPrefetcher(const Options& options);
+
+		BlockPrefetcher(const BlockPrefetcher&) = delete;
+
+		BlockPrefetcher& operator=(const BlockPrefetcher&) = delete;
+
+		~BlockPrefetcher();
+
+		/// a stream over the data blocks indexIter lists, read from file with
+		/// options. takes indexIter, file and compressionDict must stay live
+		Stream* newStream(RandomAccessFile* file, const ReadOptions& options,
+			Iterator* indexIter, const port::ZstdUncompressionDict* compressionDict);
+
+		/// bytes of the blocks read or being read ahead and not used yet
+		size_t bytesInFlight() const;
+
+		/// blocks handed out that were read ahead
+		uint64_t prefetchedBlocks() const;
+
+	private:
+		const int blocksPerInput_;
+		const size_t memoryBudget_;
+
+		mutable Mutex mu_;
+		CondVar doneCv_;
+		size_t bytesInFlight_ GUARDED_BY(mu_);
+		uint64_t prefetchedBlocks_ GUARDED_BY(mu_);
+		// declared last, its threads are joined before the rest goes away
+		ThreadPool pool_;
+	};
+
+	/*!
+	 * \class BlockPrefetcher::Stream
+	 *
+	 * \brief the blocks of one input read ahead, used by the iterator of
+	 *  the input from one thread
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class BlockPrefetcher::Stream{
+	public:
+		Stream(const Stream&) = delete;
+
+		Stream& operator=(const Stream&) = delete;
+
+		/// waits for the blocks still being read
+		~Stream();
+
+		/// read the block of handle, from the blocks read ahead when it is
+		/// one of them
+		Status read(const BlockHandle& handle, BlockContents* contents);
+
+	private:
+		friend class BlockPrefetcher;
+
+		struct Slot;
+
+		Stream(BlockPrefetcher* prefetcher, RandomAccessFile* file, const ReadOptions& options,
+			Iterator* indexIter, const port::ZstdUncompressionDict* compressionDict);
+
+		/// drop the blocks read ahead of offset, true if the block at offset
+		/// is the next one to read
+		bool skipTo(uint64_t offset) EXCLUSIVE_LOCKS_REQUIRED(prefetcher_->mu_);
+
+		/// start reading the next blocks while the limits allow
+		void fill() EXCLUSIVE_LOCKS_REQUIRED(prefetcher_->mu_);
+
+		/// wait for the slot and give its bytes back to the budget
+		void release(Slot* slot) EXCLUSIVE_LOCKS_REQUIRED(prefetcher_->mu_);
+
+		BlockPrefetcher* const prefetcher_;
+		RandomAccessFile* const file_;
+		const ReadOptions options_;
+		const port::ZstdUncompressionDict* const compressionDict_;
+		// the next block to read ahead
+		std::unique_ptr<Iterator> indexIter_;
+		bool started_;
+		bool disabled_;
+		std::deque<std::shared_ptr<Slot>> slots_;
+	};
+
+}
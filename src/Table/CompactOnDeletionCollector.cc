@@ -0,0 +1,114 @@
+#include <cassert>
+#include <vector>
+#include "CDataBase/TableProperties.h"
+
+namespace CDB{
+
+	namespace {
+
+		/*!
+		 * \class CompactOnDeletionCollector
+		 *
+		 * \brief counts the deletions among the last slidingWindowSize entries,
+		 *  long runs of tombstones make every seek and next over them slow
+		 *
+		 * \author czy
+		 * \date 2026.10.19
+		 */
+		class CompactOnDeletionCollector : public TablePropertiesCollector{
+		public:
+			CompactOnDeletionCollector(size_t slidingWindowSize, size_t deletionTrigger,
+				double deletionRatio)
+				:window_(slidingWindowSize, 0), deletionTrigger_(deletionTrigger),
+				deletionRatio_(deletionRatio)
+			{
+			}
+
+			Status addUserKey(const Slice& key, const Slice& value, EntryType type,
+				uint64_t seq, uint64_t fileSize) override
+			{
+				const char isDeletion = type == KEntryDelete ? 1 : 0;
+				++numEntries_;
+				numDeletions_ += isDeletion;
+				if (needCompact_ || window_.empty()) {
+					return Status::OK();
+				}
+				// the slot being overwritten leaves the window
+				windowDeletions_ -= window_[pos_];
+				window_[pos_] = isDeletion;
+				windowDeletions_ += isDeletion;
+				pos_ = (pos_ + 1) % window_.size();
+				if (deletionTrigger_ > 0 && windowDeletions_ >= deletionTrigger_) {
+					needCompact_ = true;
+				}
+				return Status::OK();
+			}
+
+			Status finish(UserCollectedProperties* properties) override
+			{
+				// the flag outlives the builder, a reopened file is marked from it
+				(*properties)[KNeedCompactProperty] = needCompact() ? "1" : "0";
+				return Status::OK();
+			}
+
+			const char* name() const override { return "CompactOnDeletionCollector"; }
+
+			bool needCompact() const override
+			{
+				if (needCompact_) {
+					return true;
+				}
+				return deletionRatio_ > 0 && numEntries_ > 0 &&
+					static_cast<double>(numDeletions_) >= deletionRatio_ * numEntries_;
+			}
+
+		private:
+			// one slot per entry of the window, 1 for a deletion
+			std::vector<char> window_;
+			size_t pos_ = 0;
+			size_t windowDeletions_ = 0;
+			const size_t deletionTrigger_;
+			const double deletionRatio_;
+			uint64_t numEntries_ = 0;
+			uint64_t numDeletions_ = 0;
+			bool needCompact_ = false;
+		};
+
+		class CompactOnDeletionCollectorFactory : public TablePropertiesCollectorFactory{
+		public:
+			CompactOnDeletionCollectorFactory(size_t slidingWindowSize, size_t deletionTrigger,
+				double deletionRatio)
+				:slidingWindowSize_(slidingWindowSize), deletionTrigger_(deletionTrigger),
+				deletionRatio_(deletionRatio)
+			{
+				assert(deletionTrigger_ <= slidingWindowSize_);
+			}
+
+			TablePropertiesCollector* createTablePropertiesCollector() override
+			{
+				return new CompactOnDeletionCollector(slidingWindowSize_, deletionTrigger_, deletionRatio_);
+			}
+
+			const char* name() const override { return "CompactOnDeletionCollectorFactory"; }
+
+		private:
+			const size_t slidingWindowSize_;
+			const size_t deletionTrigger_;
+			const double deletionRatio_;
+		};
+
+	}
+
+	TablePropertiesCollectorFactory* newCompactOnDeletionCollectorFactory(
+		size_t slidingWindowSize, size_t deletionTrigger, double deletionRatio)
+	{
+		return new CompactOnDeletionCollectorFactory(slidingWindowSize, deletionTrigger, deletionRatio);
+	}
+
+	bool tableNeedsCompaction(const TableProperties& properties)
+	{
+		auto it = properties.user_collected_properties.find(KNeedCompactProperty);
+		return it != properties.user_collected_properties.end() && it->second == "1";
+	}
+
+}
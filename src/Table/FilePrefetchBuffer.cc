@@ -0,0 +1,69 @@
+/*!
+ * \file FilePrefetchBuffer.cc
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#include "Table/FilePrefetchBuffer.h"
+
+#include <algorithm>
+#include "CDataBase/Env.h"
+
+namespace CDB{
+
+	FilePrefetchBuffer::FilePrefetchBuffer(const RandomAccessFile* file, uint64_t fileSize,
+		size_t readaheadSize, size_t maxReadaheadSize)
+		:file_(file), fileSize_(fileSize), autoReadahead_(readaheadSize == 0),
+		maxReadaheadSize_(maxReadaheadSize),
+		readaheadSize_(readaheadSize == 0 ? std::min(KInitAutoReadaheadSize, maxReadaheadSize) : readaheadSize),
+		capacity_(0), bufferOffset_(0), prevOffset_(0), prevLen_(0), sequentialReads_(0)
+	{}
+
+	bool FilePrefetchBuffer::tryRead(uint64_t offset, size_t n, Slice* result)
+	{
+		const bool sequential = (offset == prevOffset_ + prevLen_);
+		prevOffset_ = offset;
+		prevLen_ = n;
+		if (offset >= bufferOffset_ && offset + n <= bufferOffset_ + data_.size()) {
+			*result = Slice(data_.data() + (offset - bufferOffset_), n);
+			return true;
+		}
+
+		if (autoReadahead_) {
+			if (!sequential) {
+				sequentialReads_ = 0;
+				readaheadSize_ = std::min(KInitAutoReadaheadSize, maxReadaheadSize_);
+			}
+			if (++sequentialReads_ < KMinSequentialReads || readaheadSize_ == 0) {
+				return false;
+			}
+		}
+		if (offset + n > fileSize_) {
+			return false;
+		}
+
+		const size_t len = static_cast<size_t>(std::min<uint64_t>(n + readaheadSize_, fileSize_ - offset));
+		if (capacity_ < len) {
+			buf_.reset(new char[len]);
+			capacity_ = len;
+		}
+		if (!file_->read(offset, len, &data_, buf_.get()).ok() || data_.size() < n) {
+			data_ = Slice();
+			return false;
+		}
+		bufferOffset_ = offset;
+		if (autoReadahead_) {
+			readaheadSize_ = std::min(readaheadSize_ * 2, maxReadaheadSize_);
+		}
+		// the file reads the next window while the caller works through this one
+		const uint64_t next = offset + data_.size();
+		if (next < fileSize_) {
+			file_->prefetch(next, static_cast<size_t>(std::min<uint64_t>(readaheadSize_, fileSize_ - next)));
+		}
+		*result = Slice(data_.data(), n);
+		return true;
+	}
+
+}
@@ -0,0 +1,76 @@
+/*!
+ * \file FilePrefetchBuffer.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "CDataBase/Slice.h"
+
+namespace CDB{
+
+	class RandomAccessFile;
+
+	/*!
+	 * \class FilePrefetchBuffer
+	 *
+	 * \brief reads a file ahead of the blocks an iterator asks for, so a
+	 *  scan turns one read per block into a few large ones. with a fixed
+	 *  readahead every read it cannot serve reads that many bytes more,
+	 *  otherwise it starts once KMinSequentialReads reads followed each
+	 *  other, at KInitAutoReadaheadSize, and doubles up to the max with
+	 *  every read after. a read elsewhere starts over. the window after the
+	 *  buffered one is hinted to the file to be read in the background.
+	 *  not thread safe, one per iterator
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class FilePrefetchBuffer{
+	public:
+		static constexpr size_t KInitAutoReadaheadSize = 8 * 1024;
+
+		static constexpr int KMinSequentialReads = 2;
+
+		/// reads bytes [0, fileSize) of file. readaheadSize > 0 is a fixed
+		/// readahead, 0 reads ahead automatically up to maxReadaheadSize
+		FilePrefetchBuffer(const RandomAccessFile* file, uint64_t fileSize,
+			size_t readaheadSize, size_t maxReadaheadSize);
+
+		FilePrefetchBuffer(const FilePrefetchBuffer&) = delete;
+
+		FilePrefetchBuffer& operator=(const FilePrefetchBuffer&) = delete;
+
+		/// set *result to bytes [offset, offset + n) of the file if they are
+		/// buffered or read ahead now, valid until the next call. false if
+		/// the caller should read them itself, a failed read ahead leaves
+		/// the read and its error to the caller
+		bool tryRead(uint64_t offset, size_t n, Slice* result);
+
+		/// bytes the next read ahead reads past the request
+		size_t readaheadSize() const { return readaheadSize_; }
+
+	private:
+		const RandomAccessFile* const file_;
+		const uint64_t fileSize_;
+		const bool autoReadahead_;
+		const size_t maxReadaheadSize_;
+		size_t readaheadSize_;
+
+		std::unique_ptr<char[]> buf_;
+		size_t capacity_;
+		// bytes [bufferOffset_, bufferOffset_ + data_.size()) of the file
+		uint64_t bufferOffset_;
+		Slice data_;
+
+		uint64_t prevOffset_;
+		size_t prevLen_;
+		int sequentialReads_;
+	};
+
+}
@@ -0,0 +1,106 @@
+#include "Table/FilterBlock.h"
+
+#include <cassert>
+#include "CDataBase/FilterPolicy.h"
+#include "Util/Coding.h"
+
+namespace CDB{
+
+	// Generate new filter every 2KB of data
+	static const size_t kFilterBaseLg = 11;
+	static const size_t kFilterBase = 1 << kFilterBaseLg;
+
+	FilterBlockBuilder::FilterBlockBuilder(const FilterPolicy* policy)
+		: policy_(policy) {}
+
+	void FilterBlockBuilder::startBlock(uint64_t blockOffset)
+	{
+		uint64_t filterIndex = (blockOffset / kFilterBase);
+		assert(filterIndex >= filterOffsets_.size());
+		while (filterIndex > filterOffsets_.size()) {
+			generateFilter();
+		}
+	}
+
+	void FilterBlockBuilder::addKey(const Slice& key)
+	{
+		start_.push_back(keys_.size());
+		keys_.append(key.data(), key.size());
+	}
+
+	Slice FilterBlockBuilder::finish()
+	{
+		if (!start_.empty()) {
+			generateFilter();
+		}
+
+		// Append array of per-filter offsets
+		const uint32_t arrayOffset = static_cast<uint32_t>(result_.size());
+		for (size_t i = 0; i < filterOffsets_.size(); i++) {
+			PutFixed32(&result_, filterOffsets_[i]);
+		}
+
+		PutFixed32(&result_, arrayOffset);
+		result_.push_back(kFilterBaseLg);  // Save encoding parameter in result
+		return Slice(result_);
+	}
+
+	void FilterBlockBuilder::generateFilter()
+	{
+		const size_t numKeys = start_.size();
+		if (numKeys == 0) {
+			// Fast path if there are no keys for this filter
+			filterOffsets_.push_back(static_cast<uint32_t>(result_.size()));
+			return;
+		}
+
+		// Make list of keys from flattened key structure
+		start_.push_back(keys_.size());  // Simplify length computation
+		tmpKeys_.resize(numKeys);
+		for (size_t i = 0; i < numKeys; i++) {
+			const char* base = keys_.data() + start_[i];
+			size_t length = start_[i + 1] - start_[i];
+			tmpKeys_[i] = Slice(base, length);
+		}
+
+		// Generate filter for current set of keys and append to result_.
+		filterOffsets_.push_back(static_cast<uint32_t>(result_.size()));
+		policy_->createFilter(&tmpKeys_[0], static_cast<int>(numKeys), &result_);
+
+		tmpKeys_.clear();
+		keys_.clear();
+		start_.clear();
+	}
+
+	FilterBlockReader::FilterBlockReader(const FilterPolicy* policy, const Slice& contents)
+		: policy_(policy), data_(nullptr), offset_(nullptr), num_(0), baseLg_(0)
+	{
+		size_t n = contents.size();
+		if (n < 5) return;  // 1 byte for base_lg_ and 4 for start of offset array
+		baseLg_ = contents[n - 1];
+		uint32_t lastWord = DecodeFixed32(contents.data() + n - 5);
+		if (lastWord > n - 5) return;
+		data_ = contents.data();
+		offset_ = data_ + lastWord;
+		num_ = (n - 5 - lastWord) / 4;
+	}
+
+	bool FilterBlockReader::keyMayMatch(uint64_t blockOffset, const Slice& key)
+	{
+		uint64_t index = blockOffset >> baseLg_;
+		if (index < num_) {
+			uint32_t start = DecodeFixed32(offset_ + index * 4);
+			uint32_t limit = DecodeFixed32(offset_ + index * 4 + 4);
+			if (start <= limit && limit <= static_cast<size_t>(offset_ - data_)) {
+				Slice filter = Slice(data_ + start, limit - start);
+				return policy_->keyMayMatch(key, filter);
+			}
+			else if (start == limit) {
+				// Empty filters do not match any keys
+				return false;
+			}
+		}
+		return true;  // Errors are treated as potential matches
+	}
+
+}
@@ -0,0 +1,70 @@
+/*!
+ * \file FilterBlock.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CDataBase/Slice.h"
+
+namespace CDB{
+
+	class FilterPolicy;
+
+	/*!
+	 * \class FilterBlockBuilder
+	 *
+	 * \brief constructs all of the filters for a table, the result is stored
+	 *  as a meta block of the table. The sequence of calls must match the
+	 *  regexp (startBlock addKey*)* finish
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class FilterBlockBuilder{
+	public:
+		explicit FilterBlockBuilder(const FilterPolicy*);
+
+		FilterBlockBuilder(const FilterBlockBuilder&) = delete;
+
+		FilterBlockBuilder& operator=(const FilterBlockBuilder&) = delete;
+
+		void startBlock(uint64_t blockOffset);
+
+		void addKey(const Slice& key);
+
+		Slice finish();
+
+	private:
+		void generateFilter();
+
+		const FilterPolicy* policy_;
+		std::string keys_;                 // Flattened key contents
+		std::vector<size_t> start_;        // Starting index in keys_ of each key
+		std::string result_;               // Filter data computed so far
+		std::vector<Slice> tmpKeys_;       // policy_->createFilter() argument
+		std::vector<uint32_t> filterOffsets_;
+	};
+
+	class FilterBlockReader{
+	public:
+		// REQUIRES: "contents" and *policy must stay live while *this is live.
+		FilterBlockReader(const FilterPolicy* policy, const Slice& contents);
+
+		bool keyMayMatch(uint64_t blockOffset, const Slice& key);
+
+	private:
+		const FilterPolicy* policy_;
+		const char* data_;    // Pointer to filter data (at block-start)
+		const char* offset_;  // Pointer to beginning of offset array (at block-end)
+		size_t num_;          // Number of entries in offset array
+		size_t baseLg_;       // Encoding parameter (see kFilterBaseLg in .cc file)
+	};
+
+}
@@ -0,0 +1,254 @@
+#include "Table/Format.h"
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "CDataBase/Options.h"
+#include "Port/Port.h"
+#include "Table/Block.h"
+#include "Table/FilePrefetchBuffer.h"
+#include "Util/Coding.h"
+#include "Util/Crc32.h"
+
+namespace CDB{
+
+	void BlockHandle::encodeTo(std::string* dst) const
+	{
+		// Sanity check that all fields have been set
+		assert(offset_ != ~static_cast<uint64_t>(0));
+		assert(size_ != ~static_cast<uint64_t>(0));
+		PutVarint64(dst, offset_);
+		PutVarint64(dst, size_);
+	}
+
+	Status BlockHandle::decodeFrom(Slice* input)
+	{
+		if (GetVarint64(input, &offset_) && GetVarint64(input, &size_)) {
+			return Status::OK();
+		}
+		return Status::Corruption("bad block handle");
+	}
+
+	void Footer::encodeTo(std::string* dst) const
+	{
+		const size_t originalSize = dst->size();
+		metaindexHandle_.encodeTo(dst);
+		indexHandle_.encodeTo(dst);
+		dst->resize(2 * BlockHandle::KMaxEncodedLength);  // Padding
+		PutFixed32(dst, static_cast<uint32_t>(kTableMagicNumber & 0xffffffffu));
+		PutFixed32(dst, static_cast<uint32_t>(kTableMagicNumber >> 32));
+		assert(dst->size() == originalSize + KEncodedLength);
+		(void)originalSize;  // Disable unused variable warning.
+	}
+
+	Status Footer::decodeFrom(Slice* input)
+	{
+		if (input->size() < KEncodedLength) {
+			return Status::Corruption("not an sstable (footer too short)");
+		}
+		const char* magicPtr = input->data() + KEncodedLength - 8;
+		const uint32_t magicLo = DecodeFixed32(magicPtr);
+		const uint32_t magicHi = DecodeFixed32(magicPtr + 4);
+		const uint64_t magic = ((static_cast<uint64_t>(magicHi) << 32) |
+			(static_cast<uint64_t>(magicLo)));
+		if (magic != kTableMagicNumber) {
+			return Status::Corruption("not an sstable (bad magic number)");
+		}
+
+		Status result = metaindexHandle_.decodeFrom(input);
+		if (result.ok()) {
+			result = indexHandle_.decodeFrom(input);
+		}
+		if (result.ok()) {
+			// We skip over any leftover data (just padding for now) in "input"
+			const char* end = magicPtr + 8;
+			*input = Slice(end, input->data() + input->size() - end);
+		}
+		return result;
+	}
+
+	const char* compressionTypeName(CompressionType type)
+	{
+		switch (type) {
+		case KNoCompression:
+			return "NoCompression";
+		case KSnappyCompression:
+			return "Snappy";
+		case KZstdCompression:
+			return "ZSTD";
+		case KLZ4Compression:
+			return "LZ4";
+		case KDisableCompressionOption:
+			break;
+		}
+		return "Unknown";
+	}
+
+	Status readBlock(RandomAccessFile* file, const ReadOptions& options,
+		const BlockHandle& handle, BlockContents* result, const port::ZstdUncompressionDict* compressionDict,
+		FilePrefetchBuffer* prefetchBuffer)
+	{
+		result->data = Slice();
+		result->cachable = false;
+		result->heapAllocated = false;
+
+		// Read the block contents as well as the type/crc footer.
+		// See TableBuilder.cc for the code that built this structure.
+		const size_t n = static_cast<size_t>(handle.size());
+		char* buf = new char[n + kBlockTrailerSize];
+		Slice contents;
+		Status s;
+		if (prefetchBuffer != nullptr && prefetchBuffer->tryRead(handle.offset(), n + kBlockTrailerSize, &contents)) {
+			// the buffer is reused by the next read, the block outlives it
+			std::memcpy(buf, contents.data(), contents.size());
+			contents = Slice(buf, contents.size());
+		}
+		else {
+			s = file->read(handle.offset(), n + kBlockTrailerSize, &contents, buf);
+		}
+		if (!s.ok()) {
+			delete[] buf;
+			return s;
+		}
+		if (contents.size() != n + kBlockTrailerSize) {
+			delete[] buf;
+			return Status::Corruption("truncated block read");
+		}
+
+		// Check the crc of the type and the block contents
+		const char* data = contents.data();  // Pointer to where Read put the data
+		if (options.verify_checksums) {
+			const uint32_t crc = crc32::Unmask(DecodeFixed32(data + n + 1));
+			const uint32_t actual = crc32::Value(data, n + 1);
+			if (actual != crc) {
+				delete[] buf;
+				s = Status::Corruption("block checksum mismatch");
+				return s;
+			}
+		}
+
+		switch (data[n]) {
+		case KNoCompression:
+			if (data != buf) {
+				// File implementation gave us pointer to some other data.
+				// Use it directly under the assumption that it will be live
+				// while the file is open.
+				delete[] buf;
+				result->data = Slice(data, n);
+				result->heapAllocated = false;
+				result->cachable = false;  // Do not double-cache
+			}
+			else {
+				result->data = Slice(buf, n);
+				result->heapAllocated = true;
+				result->cachable = true;
+			}
+
+			// Ok
+			break;
+		case KSnappyCompression: {
+			size_t ulength = 0;
+			if (!port::Snappy_GetUncompressedLength(data, n, &ulength)) {
+				delete[] buf;
+				return Status::Corruption("corrupted snappy compressed block length");
+			}
+			char* ubuf = new char[ulength];
+			if (!port::Snappy_Uncompress(data, n, ubuf)) {
+				delete[] buf;
+				delete[] ubuf;
+				return Status::Corruption("corrupted snappy compressed block contents");
+			}
+			delete[] buf;
+			result->data = Slice(ubuf, ulength);
+			result->heapAllocated = true;
+			result->cachable = true;
+			break;
+		}
+		case KLZ4Compression: {
+			size_t ulength = 0;
+			if (!port::LZ4_GetUncompressedLength(data, n, &ulength)) {
+				delete[] buf;
+				return Status::Corruption("corrupted lz4 compressed block length");
+			}
+			char* ubuf = new char[ulength];
+			if (!port::LZ4_Uncompress(data, n, ubuf)) {
+				delete[] buf;
+				delete[] ubuf;
+				return Status::Corruption("corrupted lz4 compressed block contents");
+			}
+			delete[] buf;
+			result->data = Slice(ubuf, ulength);
+			result->heapAllocated = true;
+			result->cachable = true;
+			break;
+		}
+		case KZstdCompression: {
+			size_t ulength = 0;
+			if (!port::Zstd_GetUncompressedLength(data, n, &ulength)) {
+				delete[] buf;
+				return Status::Corruption("corrupted zstd compressed block length");
+			}
+			char* ubuf = new char[ulength];
+			bool uncompressed = compressionDict == nullptr
+				? port::Zstd_Uncompress(data, n, ubuf)
+				: port::Zstd_UncompressWithDict(*compressionDict, data, n, ubuf);
+			if (!uncompressed) {
+				delete[] buf;
+				delete[] ubuf;
+				return Status::Corruption("corrupted zstd compressed block contents");
+			}
+			delete[] buf;
+			result->data = Slice(ubuf, ulength);
+			result->heapAllocated = true;
+			result->cachable = true;
+			break;
+		}
+		default:
+			delete[] buf;
+			return Status::Corruption("bad block type");
+		}
+
+		return Status::OK();
+	}
+
+	Status readFooter(RandomAccessFile* file, uint64_t fileSize, Footer* footer)
+	{
+		if (fileSize < Footer::KEncodedLength) {
+			return Status::Corruption("file is too short to be an sstable");
+		}
+		char footerSpace[Footer::KEncodedLength];
+		Slice footerInput;
+		Status s = file->read(fileSize - Footer::KEncodedLength, Footer::KEncodedLength,
+			&footerInput, footerSpace);
+		if (!s.ok()) {
+			return s;
+		}
+		return footer->decodeFrom(&footerInput);
+	}
+
+	Status findMetaBlock(RandomAccessFile* file, const Footer& footer,
+		const Slice& name, BlockHandle* handle)
+	{
+		ReadOptions opt;
+		opt.verify_checksums = true;
+		BlockContents contents;
+		Status s = readBlock(file, opt, footer.metaindexHandle(), &contents);
+		if (!s.ok()) {
+			return s;
+		}
+		Block metaindex(contents);
+		std::unique_ptr<Iterator> iter(metaindex.newIterator(byteWiseComparator()));
+		iter->seek(name);
+		if (iter->valid() && iter->key() == name) {
+			Slice v = iter->value();
+			return handle->decodeFrom(&v);
+		}
+		if (!iter->status().ok()) {
+			return iter->status();
+		}
+		return Status::NotFound(name);
+	}
+
+}
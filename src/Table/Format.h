@@ -0,0 +1,142 @@
+/*!
+ * \file Format.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include "CDataBase/Slice.h"
+#include "CDataBase/Status.h"
+#include "CDataBase/Options.h"
+
+namespace CDB{
+
+	class Block;
+	class FilePrefetchBuffer;
+	class RandomAccessFile;
+
+	namespace port {
+		class ZstdUncompressionDict;
+	}
+	struct ReadOptions;
+
+	/*!
+	 * \class BlockHandle
+	 *
+	 * \brief a pointer to the extent of a file that stores a data block or a meta block
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class BlockHandle{
+	public:
+		// Maximum encoding length of a BlockHandle
+		enum { KMaxEncodedLength = 10 + 10 };
+
+		BlockHandle();
+
+		// The offset of the block in the file.
+		uint64_t offset() const { return offset_; }
+		void setOffset(uint64_t offset) { offset_ = offset; }
+
+		// The size of the stored block
+		uint64_t size() const { return size_; }
+		void setSize(uint64_t size) { size_ = size; }
+
+		void encodeTo(std::string* dst) const;
+
+		Status decodeFrom(Slice* input);
+
+	private:
+		uint64_t offset_;
+		uint64_t size_;
+	};
+
+	/*!
+	 * \class Footer
+	 *
+	 * \brief fixed information stored at the tail end of every table file
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class Footer{
+	public:
+		// Encoded length of a Footer.  Note that the serialization of a
+		// Footer will always occupy exactly this many bytes.  It consists
+		// of two block handles and a magic number.
+		enum { KEncodedLength = 2 * BlockHandle::KMaxEncodedLength + 8 };
+
+		Footer() = default;
+
+		// The block handle for the metaindex block of the table
+		const BlockHandle& metaindexHandle() const { return metaindexHandle_; }
+		void setMetaindexHandle(const BlockHandle& h) { metaindexHandle_ = h; }
+
+		// The block handle for the index block of the table
+		const BlockHandle& indexHandle() const { return indexHandle_; }
+		void setIndexHandle(const BlockHandle& h) { indexHandle_ = h; }
+
+		void encodeTo(std::string* dst) const;
+
+		Status decodeFrom(Slice* input);
+
+	private:
+		BlockHandle metaindexHandle_;
+		BlockHandle indexHandle_;
+	};
+
+	// kTableMagicNumber was picked by running
+	//    echo http://code.google.com/p/leveldb/ | sha1sum
+	// and taking the leading 64 bits.
+	static const uint64_t kTableMagicNumber = 0xdb4775248b80fb57ull;
+
+	// 1-byte type + 32-bit crc
+	static const size_t kBlockTrailerSize = 5;
+
+	// names of the meta blocks listed in the metaindex block
+	static const char kPropertiesBlockName[] = "cdb.properties";
+	static const char kRangeDelBlockName[] = "cdb.range_del";
+	static const char kFilterBlockPrefix[] = "filter.";
+	static const char kCompressionDictBlockName[] = "cdb.compression_dict";
+	// random bytes naming the table, the entry holds them instead of a
+	// handle. the data blocks are cached under them so a cache that outlives
+	// the process never hands the blocks of one table to another
+	static const char kUniqueIdName[] = "cdb.unique_id";
+	static const size_t kUniqueIdSize = 16;
+
+	struct BlockContents {
+		Slice data;           // Actual contents of data
+		bool cachable;        // True iff data can be cached
+		bool heapAllocated;   // True iff caller should delete[] data.data()
+	};
+
+	/// read the block identified by "handle" from "file",
+	/// on failure return non-OK, on success fill *result and return OK.
+	/// compressionDict is the digested dictionary of the table for its data
+	/// blocks, a non-null prefetchBuffer serves the read if it can
+	Status readBlock(RandomAccessFile* file, const ReadOptions& options,
+		const BlockHandle& handle, BlockContents* result,
+		const port::ZstdUncompressionDict* compressionDict = nullptr, FilePrefetchBuffer* prefetchBuffer = nullptr);
+
+	/// the name of the compression in the table properties
+	const char* compressionTypeName(CompressionType type);
+
+	/// read the footer stored in the last Footer::KEncodedLength bytes of a file
+	Status readFooter(RandomAccessFile* file, uint64_t fileSize, Footer* footer);
+
+	/// find the meta block called name in the metaindex block and return its handle,
+	/// NotFound if the table has no such block
+	Status findMetaBlock(RandomAccessFile* file, const Footer& footer,
+		const Slice& name, BlockHandle* handle);
+
+	// Implementation details follow.  Clients should ignore,
+
+	inline BlockHandle::BlockHandle()
+		: offset_(~static_cast<uint64_t>(0)), size_(~static_cast<uint64_t>(0)) {}
+
+}
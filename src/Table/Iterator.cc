@@ -0,0 +1,79 @@
+#include "CDataBase/Iterator.h"
+
+namespace CDB{
+
+	Iterator::Iterator()
+	{
+		cleanup_head_.function = nullptr;
+		cleanup_head_.next = nullptr;
+	}
+
+	Iterator::~Iterator()
+	{
+		if (!cleanup_head_.isEmpty()) {
+			cleanup_head_.run();
+			for (CleanupNode* node = cleanup_head_.next; node != nullptr;) {
+				node->run();
+				CleanupNode* nextNode = node->next;
+				delete node;
+				node = nextNode;
+			}
+		}
+	}
+
+	void Iterator::registerCleanup(CleanupFunction func, void* arg1, void* arg2)
+	{
+		assert(func != nullptr);
+		CleanupNode* node;
+		if (cleanup_head_.isEmpty()) {
+			node = &cleanup_head_;
+		}
+		else {
+			node = new CleanupNode();
+			node->next = cleanup_head_.next;
+			cleanup_head_.next = node;
+		}
+		node->function = func;
+		node->arg1 = arg1;
+		node->arg2 = arg2;
+	}
+
+	namespace {
+
+		class EmptyIterator : public Iterator{
+		public:
+			EmptyIterator(const Status& s) : status_(s) {}
+			~EmptyIterator() override = default;
+
+			bool valid() const override { return false; }
+			void seek(const Slice& target) override {}
+			void seekToFirst() override {}
+			void seekToLast() override {}
+			void next() override { assert(false); }
+			void prev() override { assert(false); }
+			Slice key() const override
+			{
+				assert(false);
+				return Slice();
+			}
+			Slice value() const override
+			{
+				assert(false);
+				return Slice();
+			}
+			Status status() const override { return status_; }
+
+		private:
+			Status status_;
+		};
+
+	}
+
+	Iterator* newEmptyIterator() { return new EmptyIterator(Status::OK()); }
+
+	Iterator* newErrorIterator(const Status& status)
+	{
+		return new EmptyIterator(status);
+	}
+
+}
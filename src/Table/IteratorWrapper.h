@@ -0,0 +1,101 @@
+/*!
+ * \file IteratorWrapper.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include "CDataBase/Iterator.h"
+#include "CDataBase/Slice.h"
+
+namespace CDB{
+
+	/*!
+	 * \class IteratorWrapper
+	 *
+	 * \brief caches the valid() and key() results of an underlying
+	 *  iterator, this avoids virtual calls and gives better cache locality
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class IteratorWrapper{
+	public:
+		IteratorWrapper() : iter_(nullptr), valid_(false) {}
+
+		explicit IteratorWrapper(Iterator* iter) : iter_(nullptr) { set(iter); }
+
+		~IteratorWrapper() { delete iter_; }
+
+		Iterator* iter() const { return iter_; }
+
+		// Takes ownership of "iter" and will delete it when destroyed, or
+		// when set() is invoked again.
+		void set(Iterator* iter) {
+			delete iter_;
+			iter_ = iter;
+			if (iter_ == nullptr) {
+				valid_ = false;
+			}
+			else {
+				update();
+			}
+		}
+
+		// Iterator interface methods
+		bool valid() const { return valid_; }
+		Slice key() const {
+			assert(valid());
+			return key_;
+		}
+		Slice value() const {
+			assert(valid());
+			return iter_->value();
+		}
+		// Methods below require iter() != nullptr
+		Status status() const {
+			assert(iter_);
+			return iter_->status();
+		}
+		void next() {
+			assert(iter_);
+			iter_->next();
+			update();
+		}
+		void prev() {
+			assert(iter_);
+			iter_->prev();
+			update();
+		}
+		void seek(const Slice& k) {
+			assert(iter_);
+			iter_->seek(k);
+			update();
+		}
+		void seekToFirst() {
+			assert(iter_);
+			iter_->seekToFirst();
+			update();
+		}
+		void seekToLast() {
+			assert(iter_);
+			iter_->seekToLast();
+			update();
+		}
+
+	private:
+		void update() {
+			valid_ = iter_->valid();
+			if (valid_) {
+				key_ = iter_->key();
+			}
+		}
+
+		Iterator* iter_;
+		bool valid_;
+		Slice key_;
+	};
+
+}
@@ -0,0 +1,264 @@
+/*!
+ * \file Merger.cc
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#include "Table/Merger.h"
+
+#include <vector>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Iterator.h"
+#include "Table/IteratorWrapper.h"
+
+namespace CDB{
+
+	namespace {
+
+		/*!
+		 * \class MergingIterator
+		 *
+		 * \brief the child at the current key is the top of a heap of the
+		 *  valid children, a min heap going forward and a max heap going
+		 *  back. the keys are cached by the wrappers, and the runner up, the
+		 *  better of the two children of the top, is kept so a step that
+		 *  leaves the top in front costs one comparison
+		 *
+		 * \author czy
+		 * \date 2026.10.19
+		 */
+		class MergingIterator : public Iterator{
+		public:
+			MergingIterator(const Comparator* comparator, Iterator** children, int n)
+				:comparator_(comparator), children_(new IteratorWrapper[n]), n_(n),
+				direction_(KForward), runnerUp_(nullptr)
+			{
+				for (int i = 0; i < n; ++i) {
+					children_[i].set(children[i]);
+				}
+				heap_.reserve(n);
+			}
+
+			~MergingIterator() override { delete[] children_; }
+
+			bool valid() const override { return !heap_.empty(); }
+
+			void seekToFirst() override
+			{
+				for (int i = 0; i < n_; ++i) {
+					children_[i].seekToFirst();
+				}
+				direction_ = KForward;
+				rebuild();
+			}
+
+			void seekToLast() override
+			{
+				for (int i = 0; i < n_; ++i) {
+					children_[i].seekToLast();
+				}
+				direction_ = KReverse;
+				rebuild();
+			}
+
+			void seek(const Slice& target) override
+			{
+				for (int i = 0; i < n_; ++i) {
+					children_[i].seek(target);
+				}
+				direction_ = KForward;
+				rebuild();
+			}
+
+			void next() override
+			{
+				assert(valid());
+				// Ensure that all children are positioned after key().
+				// If we are moving in the forward direction, it is already
+				// true for all of the non-current children since current is
+				// the smallest child and key() == current->key().  Otherwise,
+				// we explicitly position the non-current children.
+				if (direction_ != KForward) {
+					IteratorWrapper* current = heap_[0];
+					const Slice k = current->key();
+					for (int i = 0; i < n_; ++i) {
+						IteratorWrapper* child = &children_[i];
+						if (child != current) {
+							child->seek(k);
+							if (child->valid() && comparator_->compare(k, child->key()) == 0) {
+								child->next();
+							}
+						}
+					}
+					direction_ = KForward;
+					rebuild();
+				}
+				heap_[0]->next();
+				topMoved();
+			}
+
+			void prev() override
+			{
+				assert(valid());
+				// Ensure that all children are positioned before key().
+				// If we are moving in the reverse direction, it is already
+				// true for all of the non-current children since current is
+				// the largest child and key() == current->key().  Otherwise,
+				// we explicitly position the non-current children.
+				if (direction_ != KReverse) {
+					IteratorWrapper* current = heap_[0];
+					const Slice k = current->key();
+					for (int i = 0; i < n_; ++i) {
+						IteratorWrapper* child = &children_[i];
+						if (child != current) {
+							child->seek(k);
+							if (child->valid()) {
+								// Child is at first entry >= key().  Step back one to be < key()
+								child->prev();
+							}
+							else {
+								// Child has no entries >= key().  Position at last entry.
+								child->seekToLast();
+							}
+						}
+					}
+					direction_ = KReverse;
+					rebuild();
+				}
+				heap_[0]->prev();
+				topMoved();
+			}
+
+			Slice key() const override
+			{
+				assert(valid());
+				return heap_[0]->key();
+			}
+
+			Slice value() const override
+			{
+				assert(valid());
+				return heap_[0]->value();
+			}
+
+			Status status() const override
+			{
+				Status status;
+				for (int i = 0; i < n_; ++i) {
+					status = children_[i].status();
+					if (!status.ok()) {
+						break;
+					}
+				}
+				return status;
+			}
+
+		private:
+			// Which direction is the iterator moving?
+			enum Direction { KForward, KReverse };
+
+			/// a comes out before b in the direction of the iteration
+			bool before(const IteratorWrapper* a, const IteratorWrapper* b) const
+			{
+				const int r = comparator_->compare(a->key(), b->key());
+				return direction_ == KForward ? r < 0 : r > 0;
+			}
+
+			/// heap the valid children
+			void rebuild()
+			{
+				heap_.clear();
+				for (int i = 0; i < n_; ++i) {
+					if (children_[i].valid()) {
+						heap_.push_back(&children_[i]);
+					}
+				}
+				for (size_t i = heap_.size() / 2; i-- > 0;) {
+					siftDown(i);
+				}
+				updateRunnerUp();
+			}
+
+			/// restore the heap after the top child stepped
+			void topMoved()
+			{
+				if (!heap_[0]->valid()) {
+					heap_[0] = heap_.back();
+					heap_.pop_back();
+					if (!heap_.empty()) {
+						siftDown(0);
+					}
+				}
+				else if (runnerUp_ != nullptr && !before(heap_[0], runnerUp_)) {
+					siftDown(0);
+				}
+				else {
+					// still in front, the rest of the heap did not change
+					return;
+				}
+				updateRunnerUp();
+			}
+
+			void siftDown(size_t i)
+			{
+				IteratorWrapper* const child = heap_[i];
+				const size_t size = heap_.size();
+				while (true) {
+					size_t best = 2 * i + 1;
+					if (best >= size) {
+						break;
+					}
+					if (best + 1 < size && before(heap_[best + 1], heap_[best])) {
+						++best;
+					}
+					if (!before(heap_[best], child)) {
+						break;
+					}
+					heap_[i] = heap_[best];
+					i = best;
+				}
+				heap_[i] = child;
+			}
+
+			void updateRunnerUp()
+			{
+				if (heap_.size() < 2) {
+					runnerUp_ = nullptr;
+				}
+				else if (heap_.size() == 2 || !before(heap_[2], heap_[1])) {
+					runnerUp_ = heap_[1];
+				}
+				else {
+					runnerUp_ = heap_[2];
+				}
+			}
+
+			const Comparator* comparator_;
+			IteratorWrapper* children_;
+			int n_;
+			Direction direction_;
+			// the valid children, heap_[0] is at key()
+			std::vector<IteratorWrapper*> heap_;
+			// the child next to heap_[0], nullptr if it is alone
+			IteratorWrapper* runnerUp_;
+		};
+
+	}
+
+	Iterator* newMergingIterator(const Comparator* comparator, Iterator** children, int n)
+	{
+		assert(n >= 0);
+		if (n == 0) {
+			return newEmptyIterator();
+		}
+		else if (n == 1) {
+			return children[0];
+		}
+		else {
+			return new MergingIterator(comparator, children, n);
+		}
+	}
+
+}
@@ -0,0 +1,30 @@
+/*!
+ * \file Merger.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+
+namespace CDB{
+
+	class Comparator;
+	class Iterator;
+
+	/// Return an iterator that provided the union of the data in
+	/// children[0,n-1].  Takes ownership of the child iterators and
+	/// will delete them when the result iterator is deleted.
+	///
+	/// The result does no duplicate suppression.  I.e., if a particular
+	/// key is present in K child iterators, it will be yielded K times.
+	///
+	/// the children are kept in a binary heap on their cached keys, a step
+	/// costs O(log n) comparisons and a single one while the same child
+	/// keeps yielding the smallest key
+	///
+	/// REQUIRES: n >= 0
+	Iterator* newMergingIterator(const Comparator* comparator, Iterator** children, int n);
+
+}
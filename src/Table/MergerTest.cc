@@ -0,0 +1,171 @@
+#include "Table/Merger.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Iterator.h"
+#include "Util/Random.h"
+
+namespace CDB {
+
+	namespace {
+
+		// a sorted run held in memory, the keys are its values too
+		class SortedRunIterator : public Iterator {
+		public:
+			explicit SortedRunIterator(std::vector<std::string> keys)
+				: keys_(std::move(keys)), pos_(keys_.size()) {}
+
+			bool valid() const override { return pos_ < keys_.size(); }
+			void seekToFirst() override { pos_ = 0; }
+			void seekToLast() override { pos_ = keys_.empty() ? 0 : keys_.size() - 1; }
+			void seek(const Slice& target) override
+			{
+				pos_ = std::lower_bound(keys_.begin(), keys_.end(), std::string(target)) - keys_.begin();
+			}
+			void next() override { ++pos_; }
+			void prev() override { pos_ = pos_ == 0 ? keys_.size() : pos_ - 1; }
+			Slice key() const override { return keys_[pos_]; }
+			Slice value() const override { return keys_[pos_]; }
+			Status status() const override { return Status::OK(); }
+
+		private:
+			const std::vector<std::string> keys_;
+			size_t pos_;
+		};
+
+		class CountingComparator : public Comparator {
+		public:
+			int compare(const Slice& a, const Slice& b) const override
+			{
+				++comparisons;
+				return byteWiseComparator()->compare(a, b);
+			}
+			const char* name() const override { return "CountingComparator"; }
+			void findShortestSeparator(std::string* start, const Slice& limit) const override {}
+			void findShortSuccessor(std::string* key) const override {}
+
+			mutable uint64_t comparisons = 0;
+		};
+
+		std::string runKey(int i)
+		{
+			char buf[16];
+			std::snprintf(buf, sizeof(buf), "%08d", i);
+			return buf;
+		}
+
+	}
+
+	class MergerTest : public testing::Test {
+	public:
+		/// children from runs, and all their keys sorted
+		Iterator* merge(const std::vector<std::vector<std::string>>& runs)
+		{
+			expected_.clear();
+			std::vector<Iterator*> children;
+			for (const std::vector<std::string>& run : runs) {
+				children.push_back(new SortedRunIterator(run));
+				expected_.insert(expected_.end(), run.begin(), run.end());
+			}
+			std::sort(expected_.begin(), expected_.end());
+			return newMergingIterator(&cmp_, children.data(), static_cast<int>(children.size()));
+		}
+
+		CountingComparator cmp_;
+		std::vector<std::string> expected_;
+	};
+
+	TEST_F(MergerTest, Empty) {
+		std::unique_ptr<Iterator> iter(merge({}));
+		iter->seekToFirst();
+		ASSERT_FALSE(iter->valid());
+		std::unique_ptr<Iterator> empties(merge({ {}, {}, {} }));
+		empties->seekToLast();
+		ASSERT_FALSE(empties->valid());
+		empties->seek("a");
+		ASSERT_FALSE(empties->valid());
+	}
+
+	TEST_F(MergerTest, ForwardAndBackward) {
+		Random rnd(301);
+		std::vector<std::vector<std::string>> runs(24);
+		for (int i = 0; i < 3000; ++i) {
+			runs[rnd.Uniform(runs.size())].push_back(runKey(i));
+		}
+		std::unique_ptr<Iterator> iter(merge(runs));
+
+		size_t i = 0;
+		for (iter->seekToFirst(); iter->valid(); iter->next(), ++i) {
+			ASSERT_EQ(expected_[i], iter->key());
+		}
+		ASSERT_EQ(expected_.size(), i);
+		for (iter->seekToLast(); iter->valid(); iter->prev()) {
+			ASSERT_EQ(expected_[--i], iter->key());
+		}
+		ASSERT_EQ(0u, i);
+
+		// turn around at random
+		iter->seek(runKey(1500));
+		i = 1500;
+		for (int step = 0; step < 5000; ++step) {
+			ASSERT_TRUE(iter->valid());
+			ASSERT_EQ(expected_[i], iter->key());
+			if ((rnd.OneIn(2) && i > 0) || i + 1 == expected_.size()) {
+				iter->prev();
+				--i;
+			}
+			else {
+				iter->next();
+				++i;
+			}
+		}
+		ASSERT_TRUE(iter->status().ok());
+	}
+
+	TEST_F(MergerTest, DuplicateKeys) {
+		std::unique_ptr<Iterator> iter(merge({ { "a", "c", "e" }, { "a", "b", "e" }, { "e", "f" } }));
+		std::string forward;
+		for (iter->seekToFirst(); iter->valid(); iter->next()) {
+			forward += std::string(iter->key());
+		}
+		ASSERT_EQ("aabceeef", forward);
+		std::string backward;
+		for (iter->seekToLast(); iter->valid(); iter->prev()) {
+			backward += std::string(iter->key());
+		}
+		ASSERT_EQ("feeecbaa", backward);
+	}
+
+	TEST_F(MergerTest, OneComparisonWhileAChildKeepsWinning) {
+		// the first run holds the first 1000 keys, 19 more runs follow it
+		std::vector<std::vector<std::string>> runs(20);
+		for (int i = 0; i < 1000; ++i) {
+			runs[0].push_back(runKey(i));
+		}
+		for (int i = 1000; i < 3000; ++i) {
+			runs[1 + i % 19].push_back(runKey(i));
+		}
+		std::unique_ptr<Iterator> iter(merge(runs));
+		iter->seekToFirst();
+		const uint64_t start = cmp_.comparisons;
+		for (int i = 1; i < 1000; ++i) {
+			iter->next();
+			ASSERT_EQ(runKey(i), iter->key());
+		}
+		ASSERT_EQ(999u, cmp_.comparisons - start);
+
+		// the other runs interleave, every step sifts through the heap
+		for (int i = 1000; i < 3000; ++i) {
+			iter->next();
+			ASSERT_EQ(runKey(i), iter->key());
+		}
+		iter->next();
+		ASSERT_FALSE(iter->valid());
+	}
+
+}
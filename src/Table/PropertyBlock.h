@@ -0,0 +1,73 @@
+/*!
+ * \file PropertyBlock.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <map>
+#include <string>
+#include "CDataBase/Options.h"
+#include "CDataBase/TableProperties.h"
+#include "Table/BlockBuilder.h"
+
+namespace CDB{
+
+	// names of the table properties inside the properties block
+	namespace TablePropertiesNames{
+		static const char kNumEntries[] = "cdb.num.entries";
+		static const char kNumDeletions[] = "cdb.num.deletions";
+		static const char kNumMergeOperands[] = "cdb.num.merge-operands";
+		static const char kNumRangeDeletions[] = "cdb.num.range-deletions";
+		static const char kRawKeySize[] = "cdb.raw.key.size";
+		static const char kRawValueSize[] = "cdb.raw.value.size";
+		static const char kDataSize[] = "cdb.data.size";
+		static const char kIndexSize[] = "cdb.index.size";
+		static const char kFilterSize[] = "cdb.filter.size";
+		static const char kNumDataBlocks[] = "cdb.num.data.blocks";
+		static const char kCreationTime[] = "cdb.creation.time";
+		static const char kSmallestSeqno[] = "cdb.smallest.seqno";
+		static const char kLargestSeqno[] = "cdb.largest.seqno";
+		static const char kSmallestKey[] = "cdb.smallest.key";
+		static const char kLargestKey[] = "cdb.largest.key";
+		static const char kCompressionName[] = "cdb.compression";
+		static const char kCompressionDictSize[] = "cdb.compression.dict.size";
+	}
+
+	/*!
+	 * \class PropertyBlockBuilder
+	 *
+	 * \brief writes the table properties and the user collected properties
+	 *  into a block, keys are the property names in bytewise order, numbers
+	 *  are stored as varint64
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class PropertyBlockBuilder{
+	public:
+		PropertyBlockBuilder();
+
+		PropertyBlockBuilder(const PropertyBlockBuilder&) = delete;
+
+		PropertyBlockBuilder& operator=(const PropertyBlockBuilder&) = delete;
+
+		void addTableProperties(const TableProperties& props);
+
+		void add(const UserCollectedProperties& props);
+
+		/// the slice is valid as long as the builder is alive
+		Slice finish();
+
+	private:
+		void add(const std::string& name, uint64_t value);
+
+		Options options_;
+		BlockBuilder builder_;
+		// the block needs sorted keys, the properties are collected first
+		std::map<std::string, std::string> props_;
+	};
+
+}
@@ -0,0 +1,662 @@
+/*!
+ * \file Table.cc
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#include "CDataBase/Table.h"
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include "CDataBase/Cache.h"
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "CDataBase/FilterPolicy.h"
+#include "CDataBase/Options.h"
+#include "DataBase/DBFormat.h"
+#include "DataBase/RangeTombstone.h"
+#include "Port/Port.h"
+#include "Table/Block.h"
+#include "Table/BlockPrefetcher.h"
+#include "Table/FilePrefetchBuffer.h"
+#include "Table/FilterBlock.h"
+#include "Table/Format.h"
+#include "Table/TwoLevelIterator.h"
+#include "Util/Coding.h"
+#include "Util/MutexLock.h"
+
+namespace CDB{
+
+	struct Table::Rep {
+		~Rep() {
+			delete filter;
+			delete[] filterData;
+			delete indexBlock;
+			if (memoryCounter != nullptr) {
+				memoryCounter->fetch_sub(pinnedBytes, std::memory_order_relaxed);
+			}
+		}
+
+		// the index and the filter live in the block cache
+		bool cached() const {
+			return options.cache_index_and_filter_blocks && options.block_cache != nullptr;
+		}
+
+		Options options;
+		RandomAccessFile* file;
+		uint64_t fileSize;
+		uint64_t cacheId;
+		Footer footer;
+
+		// guards the loading of the fields below, they do not change once
+		// the flag that covers them is set
+		Mutex loadMu;
+		// the meta blocks were read
+		std::atomic<bool> loaded{ false };
+		// the index and the filter are held below
+		std::atomic<bool> pinned{ false };
+		// the dictionary of the data blocks, null if they have none
+		std::unique_ptr<port::ZstdUncompressionDict> compressionDict;
+		// names the data blocks in the block cache, empty for a table
+		// written without one
+		std::string uniqueId;
+		bool hasFilter = false;
+		BlockHandle filterHandle;
+		std::shared_ptr<const FragmentedRangeTombstoneList> rangeDels;
+		FilterBlockReader* filter = nullptr;
+		const char* filterData = nullptr;
+		Block* indexBlock = nullptr;
+		uint64_t pinnedBytes = 0;
+		std::atomic<uint64_t>* memoryCounter = nullptr;
+	};
+
+	namespace {
+
+		// a filter kept in the block cache with the block it reads
+		struct CachedFilter {
+			~CachedFilter() {
+				delete reader;
+				delete[] data;
+			}
+
+			FilterBlockReader* reader;
+			const char* data;
+		};
+
+		void deleteCachedFilter(const Slice& key, void* value)
+		{
+			delete reinterpret_cast<CachedFilter*>(value);
+		}
+
+		void deleteCachedIndex(const Slice& key, void* value)
+		{
+			delete reinterpret_cast<Block*>(value);
+		}
+
+		// the index and the filter are not demoted to a secondary cache, a
+		// table reads them again faster than it rebuilds them from there
+		const Cache::CacheItemHelper KFilterCacheHelper = { &deleteCachedFilter, nullptr, nullptr };
+		const Cache::CacheItemHelper KIndexCacheHelper = { &deleteCachedIndex, nullptr, nullptr };
+
+		void releaseHandle(void* arg, void* h)
+		{
+			reinterpret_cast<Cache*>(arg)->release(reinterpret_cast<Cache::Handle*>(h));
+		}
+
+	}
+
+	Status Table::open(const Options& options, RandomAccessFile* file, uint64_t size, Table** table)
+	{
+		*table = nullptr;
+		Footer footer;
+		Status s = readFooter(file, size, &footer);
+		if (!s.ok()) {
+			return s;
+		}
+
+		Rep* rep = new Table::Rep;
+		rep->options = options;
+		rep->file = file;
+		rep->fileSize = size;
+		rep->footer = footer;
+		rep->cacheId = (options.block_cache ? options.block_cache->newId() : 0);
+		*table = new Table(rep);
+		return s;
+	}
+
+	Table::~Table() { delete rep_; }
+
+	bool Table::indexLoaded() const { return rep_->loaded.load(std::memory_order_acquire); }
+
+	uint64_t Table::pinnedMemoryUsage() const
+	{
+		if (!rep_->pinned.load(std::memory_order_acquire)) {
+			return 0;
+		}
+		return rep_->pinnedBytes;
+	}
+
+	void Table::setMemoryCounter(std::atomic<uint64_t>* counter)
+	{
+		MutexLock l(&rep_->loadMu);
+		assert(rep_->memoryCounter == nullptr);
+		rep_->memoryCounter = counter;
+		counter->fetch_add(rep_->pinnedBytes, std::memory_order_relaxed);
+	}
+
+	Status Table::loadIndex() const
+	{
+		if (rep_->loaded.load(std::memory_order_acquire)) {
+			return Status::OK();
+		}
+		MutexLock l(&rep_->loadMu);
+		if (rep_->loaded.load(std::memory_order_relaxed)) {
+			return Status::OK();
+		}
+		Status s = readMeta(rep_->footer);
+		if (!s.ok()) {
+			return s;
+		}
+		if (!rep_->cached()) {
+			s = pinIndexAndFilterLocked();
+			if (!s.ok()) {
+				// a later search tries again
+				return s;
+			}
+		}
+		rep_->loaded.store(true, std::memory_order_release);
+		return Status::OK();
+	}
+
+	Status Table::rangeTombstones(std::shared_ptr<const FragmentedRangeTombstoneList>* tombstones) const
+	{
+		tombstones->reset();
+		Status s = loadIndex();
+		if (s.ok()) {
+			*tombstones = rep_->rangeDels;
+		}
+		return s;
+	}
+
+	Status Table::pinIndexAndFilter() const
+	{
+		Status s = loadIndex();
+		if (!s.ok() || rep_->pinned.load(std::memory_order_acquire)) {
+			return s;
+		}
+		MutexLock l(&rep_->loadMu);
+		return pinIndexAndFilterLocked();
+	}
+
+	Status Table::pinIndexAndFilterLocked() const
+	{
+		if (rep_->pinned.load(std::memory_order_relaxed)) {
+			return Status::OK();
+		}
+		ReadOptions opt;
+		if (rep_->options.paranoid_checks) {
+			opt.verify_checksums = true;
+		}
+		BlockContents indexBlockContents;
+		Status s = readBlock(rep_->file, opt, rep_->footer.indexHandle(), &indexBlockContents);
+		if (!s.ok()) {
+			return s;
+		}
+		rep_->indexBlock = new Block(indexBlockContents);
+		rep_->pinnedBytes = rep_->indexBlock->size();
+		if (rep_->hasFilter) {
+			rep_->filter = readFilter(&rep_->filterData);
+			if (rep_->filter != nullptr) {
+				rep_->pinnedBytes += rep_->filterHandle.size();
+			}
+		}
+		if (rep_->memoryCounter != nullptr) {
+			rep_->memoryCounter->fetch_add(rep_->pinnedBytes, std::memory_order_relaxed);
+		}
+		rep_->pinned.store(true, std::memory_order_release);
+		return s;
+	}
+
+	Status Table::indexBlock(Block** block, Cache::Handle** handle) const
+	{
+		*block = nullptr;
+		*handle = nullptr;
+		Status s = loadIndex();
+		if (!s.ok()) {
+			return s;
+		}
+		if (rep_->pinned.load(std::memory_order_acquire)) {
+			*block = rep_->indexBlock;
+			return s;
+		}
+
+		Cache* cache = rep_->options.block_cache;
+		char cacheKeyBuffer[16];
+		EncodeFixed64(cacheKeyBuffer, rep_->cacheId);
+		EncodeFixed64(cacheKeyBuffer + 8, rep_->footer.indexHandle().offset());
+		Slice key(cacheKeyBuffer, sizeof(cacheKeyBuffer));
+		*handle = cache->lookUp(key);
+		if (*handle == nullptr) {
+			ReadOptions opt;
+			if (rep_->options.paranoid_checks) {
+				opt.verify_checksums = true;
+			}
+			BlockContents contents;
+			s = readBlock(rep_->file, opt, rep_->footer.indexHandle(), &contents);
+			if (!s.ok()) {
+				return s;
+			}
+			Block* index = new Block(contents);
+			*handle = cache->insert(key, index, index->size(), &KIndexCacheHelper,
+				rep_->options.cache_index_and_filter_blocks_with_high_priority
+				? Cache::KHighPriority : Cache::KLowPriority);
+		}
+		*block = reinterpret_cast<Block*>(cache->value(*handle));
+		return s;
+	}
+
+	FilterBlockReader* Table::filter(Cache::Handle** handle) const
+	{
+		*handle = nullptr;
+		if (rep_->pinned.load(std::memory_order_acquire)) {
+			return rep_->filter;
+		}
+		if (!rep_->hasFilter) {
+			return nullptr;
+		}
+
+		Cache* cache = rep_->options.block_cache;
+		char cacheKeyBuffer[16];
+		EncodeFixed64(cacheKeyBuffer, rep_->cacheId);
+		EncodeFixed64(cacheKeyBuffer + 8, rep_->filterHandle.offset());
+		Slice key(cacheKeyBuffer, sizeof(cacheKeyBuffer));
+		*handle = cache->lookUp(key);
+		if (*handle == nullptr) {
+			CachedFilter* cachedFilter = new CachedFilter;
+			cachedFilter->data = nullptr;
+			cachedFilter->reader = readFilter(&cachedFilter->data);
+			if (cachedFilter->reader == nullptr) {
+				delete cachedFilter;
+				return nullptr;
+			}
+			*handle = cache->insert(key, cachedFilter, rep_->filterHandle.size(), &KFilterCacheHelper,
+				rep_->options.cache_index_and_filter_blocks_with_high_priority
+				? Cache::KHighPriority : Cache::KLowPriority);
+		}
+		return reinterpret_cast<CachedFilter*>(cache->value(*handle))->reader;
+	}
+
+	Status Table::readMeta(const Footer& footer) const
+	{
+		ReadOptions opt;
+		if (rep_->options.paranoid_checks) {
+			opt.verify_checksums = true;
+		}
+		BlockContents contents;
+		Status s = readBlock(rep_->file, opt, footer.metaindexHandle(), &contents);
+		if (!s.ok()) {
+			return s;
+		}
+		Block* meta = new Block(contents);
+
+		Iterator* iter = meta->newIterator(byteWiseComparator());
+		if (rep_->options.filter_policy != nullptr) {
+			std::string key = kFilterBlockPrefix;
+			key.append(rep_->options.filter_policy->name());
+			iter->seek(key);
+			if (iter->valid() && iter->key() == Slice(key)) {
+				Slice v = iter->value();
+				rep_->hasFilter = rep_->filterHandle.decodeFrom(&v).ok();
+			}
+		}
+		// the data blocks of a table with a dictionary need it to uncompress
+		iter->seek(kCompressionDictBlockName);
+		if (iter->valid() && iter->key() == Slice(kCompressionDictBlockName)) {
+			Slice v = iter->value();
+			BlockHandle dictHandle;
+			BlockContents dict;
+			if (dictHandle.decodeFrom(&v).ok() && readBlock(rep_->file, opt, dictHandle, &dict).ok()) {
+				rep_->compressionDict = std::make_unique<port::ZstdUncompressionDict>(
+					dict.data.data(), dict.data.size());
+				if (dict.heapAllocated) {
+					delete[] dict.data.data();
+				}
+			}
+		}
+		iter->seek(kUniqueIdName);
+		if (iter->valid() && iter->key() == Slice(kUniqueIdName) && iter->value().size() == kUniqueIdSize) {
+			rep_->uniqueId.assign(iter->value().data(), iter->value().size());
+		}
+		// the tombstones are keyed by internal keys, a lookup can only be
+		// checked against them when the data is too
+		const InternalKeyComparator* icmp = dynamic_cast<const InternalKeyComparator*>(rep_->options.comparator);
+		iter->seek(kRangeDelBlockName);
+		if (icmp != nullptr && iter->valid() && iter->key() == Slice(kRangeDelBlockName)) {
+			Slice v = iter->value();
+			BlockHandle rangeDelHandle;
+			BlockContents rangeDelContents;
+			s = rangeDelHandle.decodeFrom(&v);
+			if (s.ok()) {
+				s = readBlock(rep_->file, opt, rangeDelHandle, &rangeDelContents);
+			}
+			if (s.ok()) {
+				Block rangeDelBlock(rangeDelContents);
+				std::unique_ptr<Iterator> rangeDelIter(rangeDelBlock.newIterator(icmp));
+				rep_->rangeDels = std::make_shared<const FragmentedRangeTombstoneList>(rangeDelIter.get(), *icmp);
+				if (rep_->rangeDels->empty()) {
+					rep_->rangeDels.reset();
+				}
+			}
+		}
+		delete iter;
+		delete meta;
+		return s;
+	}
+
+	FilterBlockReader* Table::readFilter(const char** data) const
+	{
+		// We might want to unify with readBlock() if we start
+		// requiring checksum verification in Table::open.
+		ReadOptions opt;
+		if (rep_->options.paranoid_checks) {
+			opt.verify_checksums = true;
+		}
+		BlockContents block;
+		if (!readBlock(rep_->file, opt, rep_->filterHandle, &block).ok()) {
+			return nullptr;
+		}
+		if (block.heapAllocated) {
+			*data = block.data.data();  // Will need to delete later
+		}
+		return new FilterBlockReader(rep_->options.filter_policy, block.data);
+	}
+
+	static void deleteBlock(void* arg, void* ignored)
+	{
+		delete reinterpret_cast<Block*>(arg);
+	}
+
+	static void deleteCachedBlock(const Slice& key, void* value)
+	{
+		Block* block = reinterpret_cast<Block*>(value);
+		delete block;
+	}
+
+	static void saveCachedBlock(void* value, std::string* dst)
+	{
+		Slice contents = reinterpret_cast<Block*>(value)->contents();
+		dst->assign(contents.data(), contents.size());
+	}
+
+	static void* createCachedBlock(const Slice& contents, size_t* charge)
+	{
+		char* buf = new char[contents.size()];
+		std::memcpy(buf, contents.data(), contents.size());
+		BlockContents blockContents;
+		blockContents.data = Slice(buf, contents.size());
+		blockContents.cachable = true;
+		blockContents.heapAllocated = true;
+		Block* block = new Block(blockContents);
+		*charge = block->size();
+		return block;
+	}
+
+	// lets a block evicted from the block cache move to its secondary cache
+	static const Cache::CacheItemHelper KBlockCacheHelper = {
+		&deleteCachedBlock, &saveCachedBlock, &createCachedBlock };
+
+	// the blocks of a table without a unique id are cached under an id of
+	// this process only, a secondary cache kept across runs could serve
+	// them to another table so they stay out of it
+	static const Cache::CacheItemHelper KLocalBlockCacheHelper = {
+		&deleteCachedBlock, nullptr, nullptr };
+
+	struct Table::IterState {
+		IterState(const Table* t, size_t readaheadSize)
+			:table(t),
+			prefetchBuffer(t->rep_->file, t->rep_->fileSize, readaheadSize, t->rep_->options.max_auto_readahead_size) {}
+
+		static void cleanup(void* arg, void* ignored)
+		{
+			delete reinterpret_cast<IterState*>(arg);
+		}
+
+		Status read(const ReadOptions& options, const BlockHandle& handle, BlockContents* contents)
+		{
+			if (stream != nullptr) {
+				return stream->read(handle, contents);
+			}
+			return readBlock(table->rep_->file, options, handle, contents, table->rep_->compressionDict.get(),
+				&prefetchBuffer);
+		}
+
+		const Table* table;
+		FilePrefetchBuffer prefetchBuffer;
+		// reads the blocks ahead instead of the buffer when set
+		std::unique_ptr<BlockPrefetcher::Stream> stream;
+	};
+
+	Iterator* Table::blockReader(void* arg, const ReadOptions& options, const Slice& indexValue)
+	{
+		return reinterpret_cast<Table*>(arg)->readDataBlock(options, indexValue, nullptr);
+	}
+
+	Iterator* Table::prefetchingBlockReader(void* arg, const ReadOptions& options, const Slice& indexValue)
+	{
+		IterState* state = reinterpret_cast<IterState*>(arg);
+		return state->table->readDataBlock(options, indexValue, state);
+	}
+
+	// Convert an index iterator value (i.e., an encoded BlockHandle)
+	// into an iterator over the contents of the corresponding block.
+	Iterator* Table::readDataBlock(const ReadOptions& options, const Slice& indexValue, IterState* state) const
+	{
+		Cache* blockCache = rep_->options.block_cache;
+		const port::ZstdUncompressionDict* dict = rep_->compressionDict.get();
+		Block* block = nullptr;
+		Cache::Handle* cacheHandle = nullptr;
+
+		BlockHandle handle;
+		Slice input = indexValue;
+		Status s = handle.decodeFrom(&input);
+		// We intentionally allow extra stuff in indexValue so that we
+		// can add more features in the future.
+
+		if (s.ok()) {
+			BlockContents contents;
+			if (blockCache != nullptr) {
+				// a key with the unique id is longer than one with the cache id
+				char cacheKeyBuffer[kUniqueIdSize + 8];
+				const Cache::CacheItemHelper* helper = &KLocalBlockCacheHelper;
+				size_t idSize = 8;
+				if (!rep_->uniqueId.empty()) {
+					std::memcpy(cacheKeyBuffer, rep_->uniqueId.data(), kUniqueIdSize);
+					helper = &KBlockCacheHelper;
+					idSize = kUniqueIdSize;
+				}
+				else {
+					EncodeFixed64(cacheKeyBuffer, rep_->cacheId);
+				}
+				EncodeFixed64(cacheKeyBuffer + idSize, handle.offset());
+				Slice key(cacheKeyBuffer, idSize + 8);
+				cacheHandle = blockCache->lookUp(key, helper);
+				if (cacheHandle != nullptr) {
+					block = reinterpret_cast<Block*>(blockCache->value(cacheHandle));
+				}
+				else {
+					s = state != nullptr ? state->read(options, handle, &contents)
+					: readBlock(rep_->file, options, handle, &contents, dict);
+					if (s.ok()) {
+						block = new Block(contents);
+						if (contents.cachable && options.fill_cache) {
+							cacheHandle = blockCache->insert(key, block, block->size(), helper);
+						}
+					}
+				}
+			}
+			else {
+				s = state != nullptr ? state->read(options, handle, &contents)
+					: readBlock(rep_->file, options, handle, &contents, dict);
+				if (s.ok()) {
+					block = new Block(contents);
+				}
+			}
+		}
+
+		Iterator* iter;
+		if (block != nullptr) {
+			iter = block->newIterator(rep_->options.comparator);
+			if (cacheHandle == nullptr) {
+				iter->registerCleanup(&deleteBlock, block, nullptr);
+			}
+			else {
+				iter->registerCleanup(&releaseHandle, blockCache, cacheHandle);
+			}
+		}
+		else {
+			iter = newErrorIterator(s);
+		}
+		return iter;
+	}
+
+	Iterator* Table::newIterator(const ReadOptions& options) const
+	{
+		return newIterator(options, nullptr);
+	}
+
+	Iterator* Table::newIterator(const ReadOptions& options, BlockPrefetcher* prefetcher) const
+	{
+		Block* index;
+		Cache::Handle* handle;
+		Status s = indexBlock(&index, &handle);
+		if (!s.ok()) {
+			return newErrorIterator(s);
+		}
+		Iterator* indexIter = index->newIterator(rep_->options.comparator);
+		if (handle != nullptr) {
+			indexIter->registerCleanup(&releaseHandle, rep_->options.block_cache, handle);
+		}
+		if (prefetcher == nullptr && options.readahead_size == 0 && rep_->options.max_auto_readahead_size == 0) {
+			return newTwoLevelIterator(indexIter, &Table::blockReader, const_cast<Table*>(this), options);
+		}
+		IterState* state = new IterState(this, options.readahead_size);
+		if (prefetcher != nullptr) {
+			// the stream walks its own copy of the index ahead of the iterator
+			Block* streamIndex;
+			Cache::Handle* streamHandle;
+			s = indexBlock(&streamIndex, &streamHandle);
+			if (!s.ok()) {
+				delete state;
+				delete indexIter;
+				return newErrorIterator(s);
+			}
+			Iterator* streamIndexIter = streamIndex->newIterator(rep_->options.comparator);
+			if (streamHandle != nullptr) {
+				streamIndexIter->registerCleanup(&releaseHandle, rep_->options.block_cache, streamHandle);
+			}
+			state->stream.reset(prefetcher->newStream(rep_->file, options, streamIndexIter, rep_->compressionDict.get()));
+		}
+		Iterator* iter = newTwoLevelIterator(indexIter, &Table::prefetchingBlockReader, state, options);
+		iter->registerCleanup(&IterState::cleanup, state, nullptr);
+		return iter;
+	}
+
+	Status Table::internalGet(const ReadOptions& options, const Slice& k, void* arg,
+		void (*handleResult)(void*, const Slice&, const Slice&))
+	{
+		Block* index;
+		Cache::Handle* indexHandle;
+		Status s = indexBlock(&index, &indexHandle);
+		if (!s.ok()) {
+			return s;
+		}
+		// the newest range tombstone visible to this read that covers the key
+		SequenceNumber tombstoneSeq = 0;
+		ParsedInternalKey target;
+		const Comparator* ucmp = nullptr;
+		if (rep_->rangeDels != nullptr && ParseInternalKey(k, &target)) {
+			// the table has tombstones only when its keys are internal keys
+			ucmp = static_cast<const InternalKeyComparator*>(rep_->options.comparator)->user_comparator();
+			tombstoneSeq = rep_->rangeDels->maxCoveringTombstoneSeqnum(target.user_key, target.sequence);
+		}
+		bool reported = false;
+		Iterator* iiter = index->newIterator(rep_->options.comparator);
+		iiter->seek(k);
+		if (iiter->valid()) {
+			Slice handleValue = iiter->value();
+			Cache::Handle* filterHandle;
+			FilterBlockReader* filterReader = filter(&filterHandle);
+			BlockHandle handle;
+			const bool mayMatch = filterReader == nullptr || !handle.decodeFrom(&handleValue).ok() ||
+				filterReader->keyMayMatch(handle.offset(), k);
+			if (filterHandle != nullptr) {
+				rep_->options.block_cache->release(filterHandle);
+			}
+			if (mayMatch) {
+				Iterator* blockIter = readDataBlock(options, iiter->value(), nullptr);
+				blockIter->seek(k);
+				ParsedInternalKey found;
+				if (blockIter->valid() && (tombstoneSeq == 0 || (ParseInternalKey(blockIter->key(), &found) &&
+					found.sequence >= tombstoneSeq && ucmp->compare(found.user_key, target.user_key) == 0))) {
+					(*handleResult)(arg, blockIter->key(), blockIter->value());
+					reported = true;
+				}
+				s = blockIter->status();
+				delete blockIter;
+			}
+		}
+		if (s.ok()) {
+			s = iiter->status();
+		}
+		if (s.ok() && !reported && tombstoneSeq > 0) {
+			const InternalKey deleted(target.user_key, tombstoneSeq, kTypeDeletion);
+			(*handleResult)(arg, deleted.Encode(), Slice());
+		}
+		delete iiter;
+		if (indexHandle != nullptr) {
+			rep_->options.block_cache->release(indexHandle);
+		}
+		return s;
+	}
+
+	uint64_t Table::approximateOffsetOf(const Slice& key) const
+	{
+		Block* index;
+		Cache::Handle* indexHandle;
+		if (!indexBlock(&index, &indexHandle).ok()) {
+			return rep_->footer.metaindexHandle().offset();
+		}
+		Iterator* indexIter = index->newIterator(rep_->options.comparator);
+		indexIter->seek(key);
+		uint64_t result;
+		if (indexIter->valid()) {
+			BlockHandle handle;
+			Slice input = indexIter->value();
+			Status s = handle.decodeFrom(&input);
+			if (s.ok()) {
+				result = handle.offset();
+			}
+			else {
+				// Strange: we can't decode the block handle in the index block.
+				// We'll just return the offset of the metaindex block, which is
+				// close to the whole file size for this case.
+				result = rep_->footer.metaindexHandle().offset();
+			}
+		}
+		else {
+			// key is past the last key in the file.  Approximate the offset
+			// by returning the offset of the metaindex block (which is
+			// right near the end of the file).
+			result = rep_->footer.metaindexHandle().offset();
+		}
+		delete indexIter;
+		if (indexHandle != nullptr) {
+			rep_->options.block_cache->release(indexHandle);
+		}
+		return result;
+	}
+
+}
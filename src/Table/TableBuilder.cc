@@ -0,0 +1,685 @@
+#include "CDataBase/TableBuilder.h"
+
+#include <cassert>
+#include <deque>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "CDataBase/FilterPolicy.h"
+#include "DataBase/DBFormat.h"
+#include "Port/Port.h"
+#include "Table/Block.h"
+#include "Table/BlockBuilder.h"
+#include "Table/FilterBlock.h"
+#include "Table/Format.h"
+#include "Table/PropertyBlock.h"
+#include "Util/Coding.h"
+#include "Util/Crc32.h"
+#include "Util/MutexLock.h"
+#include "Util/ThreadPool.h"
+
+namespace CDB{
+
+	namespace {
+
+		// a compressed block is stored only if it saves an eighth of the raw
+		// size, otherwise reading it costs more than it saves
+		bool goodCompressionRatio(size_t compressedSize, size_t rawSize)
+		{
+			return compressedSize < rawSize - (rawSize / 8u);
+		}
+
+		// compress raw into *compressed and return the type to store it with,
+		// KNoCompression if the compression is not built in or does not pay.
+		// dict is the digested dictionary of the data blocks, if any
+		CompressionType compressBlock(CompressionType compression, int zstdLevel,
+			const port::ZstdCompressionDict* dict, const Slice& raw, std::string* compressed)
+		{
+			bool compressedOk = false;
+			switch (compression) {
+			case KNoCompression:
+			case KDisableCompressionOption:
+				return KNoCompression;
+			case KLZ4Compression:
+				compressedOk = port::LZ4_Compress(raw.data(), raw.size(), compressed);
+				break;
+			case KSnappyCompression:
+				compressedOk = port::Snappy_Compress(raw.data(), raw.size(), compressed);
+				break;
+			case KZstdCompression:
+				compressedOk = dict == nullptr
+					? port::Zstd_Compress(zstdLevel, raw.data(), raw.size(), compressed)
+					: port::Zstd_CompressWithDict(*dict, raw.data(), raw.size(), compressed);
+				break;
+			}
+			if (compressedOk && goodCompressionRatio(compressed->size(), raw.size())) {
+				return compression;
+			}
+			return KNoCompression;
+		}
+
+		// a data block handed to the compression threads
+		struct CompressionJob {
+			std::string raw;
+			std::string compressed;
+			CompressionType type = KNoCompression;
+			// set by the compression thread under the mutex of the queue
+			bool done = false;
+			// the key of the index entry, known once the next key was added
+			bool hasIndexKey = false;
+			std::string indexKey;
+		};
+
+		bool useCompressionDict(const Options& options)
+		{
+			return options.compression == KZstdCompression && options.zstd_max_dict_bytes > 0;
+		}
+
+	}
+
+	struct TableBuilder::Rep {
+		Rep(const Options& opt, WritableFile* f)
+			: options(opt),
+			indexBlockOptions(opt),
+			file(f),
+			offset(0),
+			dataBlock(&options),
+			indexBlock(&indexBlockOptions),
+			rangeDelBlock(&indexBlockOptions),
+			numEntries(0),
+			closed(false),
+			filterBlock(opt.filter_policy == nullptr
+				? nullptr
+				: new FilterBlockBuilder(opt.filter_policy)),
+			internalKeys(dynamic_cast<const InternalKeyComparator*>(opt.comparator) != nullptr),
+			pendingIndexEntry(false),
+			buffering(useCompressionDict(opt)),
+			bufferedBytes(0),
+			queuedBytes(0),
+			compressionCv(&compressionMu)
+		{
+			indexBlockOptions.block_restart_interval = 1;
+			for (TablePropertiesCollectorFactory* factory : opt.table_properties_collector_factories) {
+				collectors.emplace_back(factory->createTablePropertiesCollector());
+			}
+			if (opt.compression_parallel_threads > 1) {
+				compressionPool = std::make_unique<ThreadPool>(opt.compression_parallel_threads);
+			}
+		}
+
+		Options options;
+		Options indexBlockOptions;
+		WritableFile* file;
+		uint64_t offset;
+		Status status;
+		BlockBuilder dataBlock;
+		BlockBuilder indexBlock;
+		// range tombstones, begin internal key -> end user key
+		BlockBuilder rangeDelBlock;
+		std::string lastRangeDelKey;
+		std::string lastKey;
+		int64_t numEntries;
+		bool closed;  // Either Finish() or Abandon() has been called.
+		std::unique_ptr<FilterBlockBuilder> filterBlock;
+
+		// keys are internal keys, the sequence number and the type
+		// are taken from them when the properties are collected
+		const bool internalKeys;
+		TableProperties props;
+		std::vector<std::unique_ptr<TablePropertiesCollector>> collectors;
+
+		// We do not emit the index entry for a block until we have seen the
+		// first key for the next data block.  This allows us to use shorter
+		// keys in the index block.  For example, consider a block boundary
+		// between the keys "the quick brown fox" and "the who".  We can use
+		// "the r" as the key for the index block entry since it is >= all
+		// entries in the first block and < all entries in subsequent
+		// blocks.
+		//
+		// Invariant: r->pendingIndexEntry is true only if dataBlock is empty.
+		bool pendingIndexEntry;
+		BlockHandle pendingHandle;  // Handle to add to index block
+
+		std::string compressedOutput;
+
+		// set while the first data blocks are held back as the samples for
+		// the compression dictionary, their index and filter entries are
+		// added when they are written
+		bool buffering;
+		std::vector<std::string> bufferedBlocks;
+		uint64_t bufferedBytes;
+		std::string compressionDict;
+		// compressionDict digested at the compression level of the time it
+		// was trained, null while there is none
+		std::unique_ptr<port::ZstdCompressionDict> compressDict;
+
+		// data blocks being compressed by compressionPool, in table order. a
+		// block is written once it is compressed and its index key is known,
+		// its filter keys are added then so the filter offsets stay exact
+		std::deque<std::unique_ptr<CompressionJob>> compressionQueue;
+		uint64_t queuedBytes;
+		Mutex compressionMu;
+		CondVar compressionCv;
+		// declared last, its threads are joined before the queue goes away
+		std::unique_ptr<ThreadPool> compressionPool;
+	};
+
+	TableBuilder::TableBuilder(const Options& options, WritableFile* file)
+		: rep_(new Rep(options, file))
+	{
+		if (rep_->filterBlock != nullptr) {
+			rep_->filterBlock->startBlock(0);
+		}
+	}
+
+	TableBuilder::~TableBuilder()
+	{
+		assert(rep_->closed);  // Catch errors where caller forgot to call Finish()
+		delete rep_;
+	}
+
+	Status TableBuilder::changeOptions(const Options& options)
+	{
+		// Note: if more fields are added to Options, update
+		// this function to catch changes that should not be allowed to
+		// change in the middle of building a Table.
+		if (options.comparator != rep_->options.comparator) {
+			return Status::InvalidArgument("changing comparator while building table");
+		}
+
+		// Note that any live BlockBuilders point to rep_->options and therefore
+		// will automatically pick up the updated options.
+		rep_->options = options;
+		rep_->indexBlockOptions = options;
+		rep_->indexBlockOptions.block_restart_interval = 1;
+		// whether the table has a dictionary is settled by its first block
+		if (rep_->numEntries == 0) {
+			rep_->buffering = useCompressionDict(options);
+		}
+		return Status::OK();
+	}
+
+	void TableBuilder::add(const Slice& key, const Slice& value)
+	{
+		Rep* r = rep_;
+		assert(!r->closed);
+		if (!ok()) return;
+		if (r->numEntries > 0) {
+			assert(r->options.comparator->compare(key, Slice(r->lastKey)) > 0);
+		}
+
+		if (r->pendingIndexEntry) {
+			assert(r->dataBlock.empty());
+			r->options.comparator->findShortestSeparator(&r->lastKey, key);
+			std::string handleEncoding;
+			r->pendingHandle.encodeTo(&handleEncoding);
+			r->indexBlock.add(r->lastKey, Slice(handleEncoding));
+			r->pendingIndexEntry = false;
+		}
+		else if (!r->compressionQueue.empty() && !r->compressionQueue.back()->hasIndexKey) {
+			CompressionJob* last = r->compressionQueue.back().get();
+			r->options.comparator->findShortestSeparator(&r->lastKey, key);
+			last->indexKey = r->lastKey;
+			last->hasIndexKey = true;
+		}
+
+		if (r->filterBlock != nullptr && !r->buffering && r->compressionPool == nullptr) {
+			r->filterBlock->addKey(key);
+		}
+
+		collectProperties(key, value);
+
+		r->lastKey.assign(key.data(), key.size());
+		r->numEntries++;
+		r->dataBlock.add(key, value);
+
+		const size_t estimatedBlockSize = r->dataBlock.currentSizeEstimate();
+		if (estimatedBlockSize >= r->options.block_size) {
+			flush();
+		}
+	}
+
+	void TableBuilder::addRangeTombstone(const Slice& key, const Slice& end)
+	{
+		Rep* r = rep_;
+		assert(!r->closed);
+		if (!ok()) return;
+		if (r->props.num_range_deletions > 0) {
+			assert(r->options.comparator->compare(key, Slice(r->lastRangeDelKey)) > 0);
+		}
+		r->lastRangeDelKey.assign(key.data(), key.size());
+		r->rangeDelBlock.add(key, end);
+		r->props.num_range_deletions++;
+	}
+
+	void TableBuilder::collectProperties(const Slice& key, const Slice& value)
+	{
+		Rep* r = rep_;
+		Slice userKey = key;
+		SequenceNumber seq = 0;
+		EntryType type = KEntryPut;
+		if (r->internalKeys) {
+			ParsedInternalKey ikey;
+			if (!ParseInternalKey(key, &ikey)) {
+				r->status = Status::Corruption("bad internal key in table", key);
+				return;
+			}
+			userKey = ikey.user_key;
+			seq = ikey.sequence;
+			switch (ikey.type) {
+			case kTypeValue:
+				type = KEntryPut;
+				break;
+			case kTypeDeletion:
+				type = KEntryDelete;
+				break;
+			case kTypeMerge:
+				type = KEntryMerge;
+				break;
+			default:
+				type = KEntryOther;
+				break;
+			}
+			if (r->props.num_entries == 0 || seq < r->props.smallest_seqno) {
+				r->props.smallest_seqno = seq;
+			}
+			if (r->props.num_entries == 0 || seq > r->props.largest_seqno) {
+				r->props.largest_seqno = seq;
+			}
+		}
+
+		if (r->props.num_entries == 0) {
+			r->props.smallest_key.assign(userKey.data(), userKey.size());
+		}
+		r->props.largest_key.assign(userKey.data(), userKey.size());
+		r->props.num_entries++;
+		if (type == KEntryDelete) {
+			r->props.num_deletions++;
+		}
+		else if (type == KEntryMerge) {
+			r->props.num_merge_operands++;
+		}
+		r->props.raw_key_size += key.size();
+		r->props.raw_value_size += value.size();
+
+		for (auto& collector : r->collectors) {
+			Status s = collector->addUserKey(userKey, value, type, seq, r->offset);
+			if (!s.ok() && r->status.ok()) {
+				r->status = s;
+			}
+		}
+	}
+
+	void TableBuilder::flush()
+	{
+		Rep* r = rep_;
+		assert(!r->closed);
+		if (!ok()) return;
+		if (r->dataBlock.empty()) return;
+		assert(!r->pendingIndexEntry);
+		if (r->buffering) {
+			Slice raw = r->dataBlock.finish();
+			r->bufferedBlocks.emplace_back(raw);
+			r->bufferedBytes += raw.size();
+			r->dataBlock.reset();
+			const uint64_t maxTrainBytes = r->options.zstd_max_train_bytes > 0
+				? r->options.zstd_max_train_bytes
+				: 100 * static_cast<uint64_t>(r->options.zstd_max_dict_bytes);
+			if (r->bufferedBytes >= maxTrainBytes) {
+				unbufferBlocks();
+			}
+			return;
+		}
+		if (r->compressionPool != nullptr) {
+			scheduleCompression(r->dataBlock.finish());
+			r->dataBlock.reset();
+			writeCompressedBlocks(false);
+			return;
+		}
+		compressAndWrite(r->dataBlock.finish(), true, &r->pendingHandle);
+		r->dataBlock.reset();
+		if (ok()) {
+			r->pendingIndexEntry = true;
+			r->status = r->file->flush();
+			r->props.num_data_blocks++;
+			r->props.data_size = r->offset;
+		}
+		if (r->filterBlock != nullptr) {
+			r->filterBlock->startBlock(r->offset);
+		}
+	}
+
+	void TableBuilder::writeBlock(BlockBuilder* block, BlockHandle* handle)
+	{
+		// File format contains a sequence of blocks where each block has:
+		//    block_data: uint8[n]
+		//    type: uint8
+		//    crc: uint32
+		assert(ok());
+		compressAndWrite(block->finish(), false, handle);
+		block->reset();
+	}
+
+	void TableBuilder::compressAndWrite(const Slice& raw, bool dataBlock, BlockHandle* handle)
+	{
+		Rep* r = rep_;
+		const port::ZstdCompressionDict* dict = dataBlock ? r->compressDict.get() : nullptr;
+		const CompressionType type = compressBlock(r->options.compression, r->options.zstd_compression_level,
+			dict, raw, &r->compressedOutput);
+		writeRawBlock(type == KNoCompression ? raw : Slice(r->compressedOutput), type, handle);
+		r->compressedOutput.clear();
+	}
+
+	void TableBuilder::scheduleCompression(const Slice& raw)
+	{
+		Rep* r = rep_;
+		auto job = std::make_unique<CompressionJob>();
+		job->raw.assign(raw.data(), raw.size());
+		r->queuedBytes += job->raw.size();
+		CompressionJob* j = job.get();
+		r->compressionQueue.push_back(std::move(job));
+		// the dictionary is fixed once blocks are queued
+		const port::ZstdCompressionDict* dict = r->compressDict.get();
+		const CompressionType compression = r->options.compression;
+		const int level = r->options.zstd_compression_level;
+		r->compressionPool->schedule([r, j, dict, compression, level]() {
+			std::string compressed;
+			const CompressionType type = compressBlock(compression, level, dict, j->raw, &compressed);
+			MutexLock l(&r->compressionMu);
+			j->compressed.swap(compressed);
+			j->type = type;
+			j->done = true;
+			r->compressionCv.signalAll();
+		});
+	}
+
+	void TableBuilder::writeCompressedBlocks(bool wait)
+	{
+		Rep* r = rep_;
+		// keep the compressed blocks waiting for the writer bounded
+		const size_t maxQueued = 4 * static_cast<size_t>(r->compressionPool->size());
+		while (!r->compressionQueue.empty() && ok()) {
+			CompressionJob* job = r->compressionQueue.front().get();
+			if (!job->hasIndexKey) {
+				break;
+			}
+			{
+				MutexLock l(&r->compressionMu);
+				if (!job->done && !wait && r->compressionQueue.size() <= maxQueued) {
+					break;
+				}
+				while (!job->done) {
+					r->compressionCv.wait();
+				}
+			}
+
+			if (r->filterBlock != nullptr) {
+				BlockContents contents;
+				contents.data = job->raw;
+				contents.cachable = false;
+				contents.heapAllocated = false;
+				Block block(contents);
+				std::unique_ptr<Iterator> iter(block.newIterator(r->options.comparator));
+				for (iter->seekToFirst(); iter->valid(); iter->next()) {
+					r->filterBlock->addKey(iter->key());
+				}
+			}
+			BlockHandle handle;
+			writeRawBlock(job->type == KNoCompression ? Slice(job->raw) : Slice(job->compressed),
+				job->type, &handle);
+			if (ok()) {
+				std::string handleEncoding;
+				handle.encodeTo(&handleEncoding);
+				r->indexBlock.add(job->indexKey, Slice(handleEncoding));
+				r->props.num_data_blocks++;
+				r->props.data_size = r->offset;
+				r->status = r->file->flush();
+			}
+			if (r->filterBlock != nullptr) {
+				r->filterBlock->startBlock(r->offset);
+			}
+			r->queuedBytes -= job->raw.size();
+			r->compressionQueue.pop_front();
+		}
+	}
+
+	void TableBuilder::unbufferBlocks()
+	{
+		Rep* r = rep_;
+		assert(r->buffering);
+		r->buffering = false;
+		if (r->bufferedBlocks.empty()) {
+			return;
+		}
+
+		std::string samples;
+		std::vector<size_t> sampleSizes;
+		samples.reserve(r->bufferedBytes);
+		for (const std::string& block : r->bufferedBlocks) {
+			samples.append(block);
+			sampleSizes.push_back(block.size());
+		}
+		if (!port::Zstd_TrainDictionary(samples, sampleSizes, r->options.zstd_max_dict_bytes,
+			&r->compressionDict)) {
+			// too few samples, the blocks are compressed on their own
+			r->compressionDict.clear();
+		}
+		else {
+			r->compressDict = std::make_unique<port::ZstdCompressionDict>(r->options.zstd_compression_level,
+				r->compressionDict.data(), r->compressionDict.size());
+		}
+
+		std::string lastKey;
+		for (size_t i = 0; i < r->bufferedBlocks.size() && ok(); ++i) {
+			BlockContents contents;
+			contents.data = r->bufferedBlocks[i];
+			contents.cachable = false;
+			contents.heapAllocated = false;
+			Block block(contents);
+			std::unique_ptr<Iterator> iter(block.newIterator(r->options.comparator));
+			iter->seekToFirst();
+			if (i > 0) {
+				// the index entry of the previous block, its successor is known now
+				r->options.comparator->findShortestSeparator(&lastKey, iter->key());
+				std::string handleEncoding;
+				r->pendingHandle.encodeTo(&handleEncoding);
+				r->indexBlock.add(lastKey, Slice(handleEncoding));
+			}
+			for (; iter->valid(); iter->next()) {
+				if (r->filterBlock != nullptr) {
+					r->filterBlock->addKey(iter->key());
+				}
+				lastKey.assign(iter->key().data(), iter->key().size());
+			}
+			compressAndWrite(r->bufferedBlocks[i], true, &r->pendingHandle);
+			if (ok()) {
+				r->props.num_data_blocks++;
+				r->props.data_size = r->offset;
+			}
+			if (r->filterBlock != nullptr) {
+				r->filterBlock->startBlock(r->offset);
+			}
+		}
+		if (ok()) {
+			// the last block gets its entry from the next key added, as usual
+			r->pendingIndexEntry = true;
+			r->status = r->file->flush();
+		}
+		r->bufferedBlocks.clear();
+		r->bufferedBytes = 0;
+	}
+
+	void TableBuilder::writeRawBlock(const Slice& blockContents, CompressionType type,
+		BlockHandle* handle)
+	{
+		Rep* r = rep_;
+		handle->setOffset(r->offset);
+		handle->setSize(blockContents.size());
+		r->status = r->file->append(blockContents);
+		if (r->status.ok()) {
+			char trailer[kBlockTrailerSize];
+			trailer[0] = type;
+			uint32_t crc = crc32::Value(blockContents.data(), blockContents.size());
+			crc = crc32::Extend(crc, trailer, 1);  // Extend crc to cover block type
+			EncodeFixed32(trailer + 1, crc32::Mask(crc));
+			r->status = r->file->append(Slice(trailer, kBlockTrailerSize));
+			if (r->status.ok()) {
+				r->offset += blockContents.size() + kBlockTrailerSize;
+			}
+		}
+	}
+
+	Status TableBuilder::status() const { return rep_->status; }
+
+	Status TableBuilder::finish()
+	{
+		Rep* r = rep_;
+		flush();
+		if (r->buffering && ok()) {
+			unbufferBlocks();
+		}
+		if (!r->compressionQueue.empty()) {
+			// the last block is indexed by a successor of the last key
+			CompressionJob* last = r->compressionQueue.back().get();
+			if (!last->hasIndexKey) {
+				r->options.comparator->findShortSuccessor(&r->lastKey);
+				last->indexKey = r->lastKey;
+				last->hasIndexKey = true;
+			}
+			writeCompressedBlocks(true);
+		}
+		assert(!r->closed);
+		r->closed = true;
+
+		BlockHandle filterBlockHandle, metaindexBlockHandle, indexBlockHandle,
+			propertiesBlockHandle;
+		// metaindex entries, the block needs them in sorted order
+		std::map<std::string, std::string> metaEntries;
+
+		// Write filter block
+		if (ok() && r->filterBlock != nullptr) {
+			writeRawBlock(r->filterBlock->finish(), KNoCompression, &filterBlockHandle);
+			r->props.filter_size = filterBlockHandle.size() + kBlockTrailerSize;
+			std::string handleEncoding;
+			filterBlockHandle.encodeTo(&handleEncoding);
+			metaEntries[std::string(kFilterBlockPrefix) + r->options.filter_policy->name()] =
+				handleEncoding;
+		}
+
+		// Write compression dictionary block, the reader needs it for the data blocks
+		if (ok() && !r->compressionDict.empty()) {
+			BlockHandle dictHandle;
+			writeRawBlock(r->compressionDict, KNoCompression, &dictHandle);
+			r->props.compression_dict_size = r->compressionDict.size();
+			std::string handleEncoding;
+			dictHandle.encodeTo(&handleEncoding);
+			metaEntries[kCompressionDictBlockName] = handleEncoding;
+		}
+
+		// Write index block
+		if (ok()) {
+			if (r->pendingIndexEntry) {
+				r->options.comparator->findShortSuccessor(&r->lastKey);
+				std::string handleEncoding;
+				r->pendingHandle.encodeTo(&handleEncoding);
+				r->indexBlock.add(r->lastKey, Slice(handleEncoding));
+				r->pendingIndexEntry = false;
+			}
+			const uint64_t indexStart = r->offset;
+			writeBlock(&r->indexBlock, &indexBlockHandle);
+			r->props.index_size = r->offset - indexStart;
+		}
+
+		// Write range deletion block
+		if (ok() && !r->rangeDelBlock.empty()) {
+			BlockHandle rangeDelBlockHandle;
+			writeBlock(&r->rangeDelBlock, &rangeDelBlockHandle);
+			std::string handleEncoding;
+			rangeDelBlockHandle.encodeTo(&handleEncoding);
+			metaEntries[kRangeDelBlockName] = handleEncoding;
+		}
+
+		// Write properties block
+		if (ok()) {
+			r->props.creation_time = r->options.env->nowMicros() / 1000000;
+			r->props.compression_name = compressionTypeName(r->options.compression);
+			PropertyBlockBuilder builder;
+			builder.addTableProperties(r->props);
+			for (auto& collector : r->collectors) {
+				UserCollectedProperties userProps;
+				Status s = collector->finish(&userProps);
+				if (!s.ok()) {
+					// the table would miss properties its readers rely on
+					r->status = s;
+					break;
+				}
+				builder.add(userProps);
+				r->props.user_collected_properties.insert(userProps.begin(), userProps.end());
+			}
+			if (ok()) {
+				writeRawBlock(builder.finish(), KNoCompression, &propertiesBlockHandle);
+				std::string handleEncoding;
+				propertiesBlockHandle.encodeTo(&handleEncoding);
+				metaEntries[kPropertiesBlockName] = handleEncoding;
+			}
+		}
+
+		// Write metaindex block
+		if (ok()) {
+			std::random_device rd;
+			std::string uniqueId;
+			while (uniqueId.size() < kUniqueIdSize) {
+				PutFixed32(&uniqueId, rd());
+			}
+			metaEntries[kUniqueIdName] = uniqueId;
+			Options metaOptions(r->options);
+			metaOptions.comparator = byteWiseComparator();
+			BlockBuilder metaindexBlock(&metaOptions);
+			for (const auto& [name, handle] : metaEntries) {
+				metaindexBlock.add(name, handle);
+			}
+			writeBlock(&metaindexBlock, &metaindexBlockHandle);
+		}
+
+		// Write footer
+		if (ok()) {
+			Footer footer;
+			footer.setMetaindexHandle(metaindexBlockHandle);
+			footer.setIndexHandle(indexBlockHandle);
+			std::string footerEncoding;
+			footer.encodeTo(&footerEncoding);
+			r->status = r->file->append(footerEncoding);
+			if (r->status.ok()) {
+				r->offset += footerEncoding.size();
+			}
+		}
+		return r->status;
+	}
+
+	void TableBuilder::abandon()
+	{
+		Rep* r = rep_;
+		assert(!r->closed);
+		r->closed = true;
+	}
+
+	uint64_t TableBuilder::numEntires() const { return rep_->numEntries; }
+
+	uint64_t TableBuilder::fileSize() const { return rep_->offset + rep_->bufferedBytes + rep_->queuedBytes; }
+
+	const TableProperties& TableBuilder::getTableProperties() const { return rep_->props; }
+
+	bool TableBuilder::needCompact() const
+	{
+		for (const auto& collector : rep_->collectors) {
+			if (collector->needCompact()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+}
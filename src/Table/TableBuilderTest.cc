@@ -0,0 +1,332 @@
+#include "CDataBase/TableBuilder.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "CDataBase/FilterPolicy.h"
+#include "CDataBase/Iterator.h"
+#include "CDataBase/TableProperties.h"
+#include "Port/Port.h"
+#include "Table/Block.h"
+#include "Table/FilterBlock.h"
+#include "Table/Format.h"
+#include "Util/Coding.h"
+#include "Util/Random.h"
+
+namespace CDB {
+
+	namespace {
+
+		class StringSink : public WritableFile {
+		public:
+			Status append(const Slice& data) override
+			{
+				contents.append(data.data(), data.size());
+				return Status::OK();
+			}
+			Status close() override { return Status::OK(); }
+			Status flush() override { return Status::OK(); }
+			Status sync() override { return Status::OK(); }
+
+			std::string contents;
+		};
+
+		class StringSource : public RandomAccessFile {
+		public:
+			explicit StringSource(const std::string& contents) : contents_(contents) {}
+
+			Status read(uint64_t offset, size_t n, Slice* result, char* scratch) const override
+			{
+				if (offset >= contents_.size()) {
+					return Status::InvalidArgument("invalid Read offset");
+				}
+				if (offset + n > contents_.size()) {
+					n = contents_.size() - offset;
+				}
+				std::memcpy(scratch, &contents_[offset], n);
+				*result = Slice(scratch, n);
+				return Status::OK();
+			}
+
+		private:
+			std::string contents_;
+		};
+
+		// an exact filter, the keys are stored length prefixed
+		class KeyListPolicy : public FilterPolicy {
+		public:
+			const char* name() const override { return "test.KeyList"; }
+
+			void createFilter(const Slice* keys, int n, std::string* dst) const override
+			{
+				for (int i = 0; i < n; ++i) {
+					PutLengthPrefixedSlice(dst, keys[i]);
+				}
+			}
+
+			bool keyMayMatch(const Slice& key, const Slice& filter) const override
+			{
+				Slice input = filter;
+				Slice k;
+				while (GetLengthPrefixedSlice(&input, &k)) {
+					if (k == key) {
+						return true;
+					}
+				}
+				return false;
+			}
+		};
+
+		// the creation time is fixed so two builds give the same bytes
+		class FixedClockEnv : public EnvWrapper {
+		public:
+			FixedClockEnv() :EnvWrapper(Env::Default()) {}
+
+			uint64_t nowMicros() override { return 1000000; }
+		};
+
+		bool zstdAvailable()
+		{
+			std::string out;
+			return port::Zstd_Compress(1, "aaaaaaaa", 8, &out);
+		}
+
+	}
+
+	class TableBuilderTest : public testing::Test {
+	public:
+		TableBuilderTest()
+		{
+			options_.comparator = byteWiseComparator();
+			options_.env = Env::Default();
+			options_.block_size = 1024;
+		}
+
+		static std::string key(int i)
+		{
+			char buf[32];
+			std::snprintf(buf, sizeof(buf), "user%08d", i);
+			return buf;
+		}
+
+		/// small values that look alike, the case a dictionary helps with
+		static std::string value(int i)
+		{
+			return "{\"id\":" + std::to_string(i) + ",\"status\":\"active\",\"region\":\"eu-west\"}";
+		}
+
+		std::string build(int n)
+		{
+			StringSink sink;
+			TableBuilder builder(options_, &sink);
+			for (int i = 0; i < n; ++i) {
+				builder.add(key(i), value(i));
+			}
+			EXPECT_TRUE(builder.finish().ok());
+			EXPECT_EQ(sink.contents.size(), builder.fileSize());
+			return sink.contents;
+		}
+
+		/// read every data block through the index and check the entries, the
+		/// filter and the block types
+		void verify(const std::string& table, int n, std::vector<CompressionType>* types)
+		{
+			StringSource file(table);
+			Footer footer;
+			ASSERT_TRUE(readFooter(&file, table.size(), &footer).ok());
+
+			std::unique_ptr<port::ZstdUncompressionDict> uncompressionDict;
+			BlockHandle dictHandle;
+			if (findMetaBlock(&file, footer, kCompressionDictBlockName, &dictHandle).ok()) {
+				ReadOptions opt;
+				BlockContents contents;
+				ASSERT_TRUE(readBlock(&file, opt, dictHandle, &contents).ok());
+				uncompressionDict = std::make_unique<port::ZstdUncompressionDict>(
+					contents.data.data(), contents.data.size());
+				Block owner(contents);
+			}
+
+			std::unique_ptr<FilterBlockReader> filter;
+			std::unique_ptr<Block> filterOwner;
+			if (options_.filter_policy != nullptr) {
+				BlockHandle filterHandle;
+				ASSERT_TRUE(findMetaBlock(&file, footer,
+					std::string(kFilterBlockPrefix) + options_.filter_policy->name(), &filterHandle).ok());
+				ReadOptions opt;
+				BlockContents contents;
+				ASSERT_TRUE(readBlock(&file, opt, filterHandle, &contents).ok());
+				filterOwner = std::make_unique<Block>(contents);
+				filter = std::make_unique<FilterBlockReader>(options_.filter_policy, contents.data);
+			}
+
+			ReadOptions opt;
+			opt.verify_checksums = true;
+			BlockContents indexContents;
+			ASSERT_TRUE(readBlock(&file, opt, footer.indexHandle(), &indexContents).ok());
+			Block index(indexContents);
+			std::unique_ptr<Iterator> indexIter(index.newIterator(options_.comparator));
+			int i = 0;
+			for (indexIter->seekToFirst(); indexIter->valid(); indexIter->next()) {
+				Slice encoded = indexIter->value();
+				BlockHandle handle;
+				ASSERT_TRUE(handle.decodeFrom(&encoded).ok());
+				types->push_back(static_cast<CompressionType>(table[handle.offset() + handle.size()]));
+				BlockContents contents;
+				ASSERT_TRUE(readBlock(&file, opt, handle, &contents, uncompressionDict.get()).ok());
+				Block block(contents);
+				std::unique_ptr<Iterator> iter(block.newIterator(options_.comparator));
+				for (iter->seekToFirst(); iter->valid(); iter->next(), ++i) {
+					ASSERT_EQ(key(i), iter->key());
+					ASSERT_EQ(value(i), iter->value());
+					ASSERT_LE(iter->key(), indexIter->key());
+					if (filter != nullptr) {
+						ASSERT_TRUE(filter->keyMayMatch(handle.offset(), iter->key()));
+					}
+				}
+			}
+			ASSERT_EQ(n, i);
+		}
+
+		Options options_;
+	};
+
+	TEST_F(TableBuilderTest, Uncompressed) {
+		options_.compression = KNoCompression;
+		std::string table = build(2000);
+		std::vector<CompressionType> types;
+		verify(table, 2000, &types);
+		for (CompressionType type : types) {
+			ASSERT_EQ(KNoCompression, type);
+		}
+	}
+
+	TEST_F(TableBuilderTest, CompressedBlocks) {
+		options_.compression = KZstdCompression;
+		std::string table = build(2000);
+		std::vector<CompressionType> types;
+		verify(table, 2000, &types);
+		// without zstd built in the blocks fall back to raw
+		const CompressionType expected = zstdAvailable() ? KZstdCompression : KNoCompression;
+		for (CompressionType type : types) {
+			ASSERT_EQ(expected, type);
+		}
+	}
+
+	TEST_F(TableBuilderTest, IncompressibleBlocksStoredRaw) {
+		if (!zstdAvailable()) {
+			GTEST_SKIP() << "zstd is not built in";
+		}
+		options_.compression = KZstdCompression;
+		StringSink sink;
+		TableBuilder builder(options_, &sink);
+		Random rnd(301);
+		for (int i = 0; i < 200; ++i) {
+			std::string v;
+			for (int j = 0; j < 100; ++j) {
+				v.push_back(static_cast<char>(rnd.Uniform(256)));
+			}
+			builder.add(key(i), v);
+		}
+		ASSERT_TRUE(builder.finish().ok());
+		// the first data block starts the file
+		StringSource file(sink.contents);
+		Footer footer;
+		ASSERT_TRUE(readFooter(&file, sink.contents.size(), &footer).ok());
+		BlockContents indexContents;
+		ASSERT_TRUE(readBlock(&file, ReadOptions(), footer.indexHandle(), &indexContents).ok());
+		Block index(indexContents);
+		std::unique_ptr<Iterator> iter(index.newIterator(options_.comparator));
+		iter->seekToFirst();
+		ASSERT_TRUE(iter->valid());
+		Slice encoded = iter->value();
+		BlockHandle handle;
+		ASSERT_TRUE(handle.decodeFrom(&encoded).ok());
+		ASSERT_EQ(KNoCompression, sink.contents[handle.offset() + handle.size()]);
+	}
+
+	TEST_F(TableBuilderTest, ZstdDictionary) {
+		KeyListPolicy policy;
+		options_.filter_policy = &policy;
+		options_.compression = KZstdCompression;
+		std::string plain = build(5000);
+
+		options_.zstd_max_dict_bytes = 4096;
+		options_.zstd_max_train_bytes = 64 * 1024;
+		std::string withDict = build(5000);
+		std::vector<CompressionType> types;
+		verify(withDict, 5000, &types);
+
+		TableProperties props;
+		StringSource file(withDict);
+		ASSERT_TRUE(readTableProperties(&file, withDict.size(), &props).ok());
+		ASSERT_EQ("ZSTD", props.compression_name);
+		ASSERT_EQ(5000u, props.num_entries);
+		if (!zstdAvailable()) {
+			ASSERT_EQ(0u, props.compression_dict_size);
+			return;
+		}
+		ASSERT_GT(props.compression_dict_size, 0u);
+		ASSERT_LT(props.data_size + props.compression_dict_size, plain.size());
+	}
+
+	TEST_F(TableBuilderTest, ChangeOptionsPicksCompression) {
+		options_.compression = KNoCompression;
+		StringSink sink;
+		TableBuilder builder(options_, &sink);
+		// what a flush or compaction does when it opens the output
+		Options levelOptions = options_;
+		levelOptions.compression = KLZ4Compression;
+		ASSERT_TRUE(builder.changeOptions(levelOptions).ok());
+		for (int i = 0; i < 1000; ++i) {
+			builder.add(key(i), value(i));
+		}
+		ASSERT_TRUE(builder.finish().ok());
+		ASSERT_EQ("LZ4", builder.getTableProperties().compression_name);
+
+		std::vector<CompressionType> types;
+		verify(sink.contents, 1000, &types);
+		std::string out;
+		const CompressionType expected = port::LZ4_Compress("aaaaaaaa", 8, &out) ? KLZ4Compression : KNoCompression;
+		for (CompressionType type : types) {
+			ASSERT_EQ(expected, type);
+		}
+	}
+
+	TEST_F(TableBuilderTest, ParallelCompression) {
+		FixedClockEnv env;
+		KeyListPolicy policy;
+		options_.env = &env;
+		options_.filter_policy = &policy;
+		options_.compression = KZstdCompression;
+		std::string serial = build(5000);
+
+		options_.compression_parallel_threads = 4;
+		std::string parallel = build(5000);
+		// the same bytes up to the metaindex, which holds the unique id
+		auto sameBlocks = [](const std::string& a, const std::string& b) {
+			StringSource file(a);
+			Footer footer;
+			ASSERT_TRUE(readFooter(&file, a.size(), &footer).ok());
+			const size_t metaindexOffset = footer.metaindexHandle().offset();
+			ASSERT_EQ(a.size(), b.size());
+			ASSERT_EQ(a.substr(0, metaindexOffset), b.substr(0, metaindexOffset));
+		};
+		sameBlocks(serial, parallel);
+		std::vector<CompressionType> types;
+		verify(parallel, 5000, &types);
+
+		// the blocks after the dictionary samples go to the threads
+		options_.zstd_max_dict_bytes = 2048;
+		options_.zstd_max_train_bytes = 16 * 1024;
+		std::string withDict = build(5000);
+		types.clear();
+		verify(withDict, 5000, &types);
+		options_.compression_parallel_threads = 1;
+		sameBlocks(build(5000), withDict);
+	}
+
+}
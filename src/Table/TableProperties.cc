@@ -0,0 +1,166 @@
+#include "CDataBase/TableProperties.h"
+
+#include <cstdio>
+#include <memory>
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "Table/Block.h"
+#include "Table/Format.h"
+#include "Table/PropertyBlock.h"
+#include "Util/Coding.h"
+
+namespace CDB{
+
+	std::string TableProperties::toString() const
+	{
+		char buf[512];
+		std::snprintf(buf, sizeof(buf),
+			"entries=%llu deletions=%llu merge_operands=%llu range_deletions=%llu raw_key_size=%llu raw_value_size=%llu "
+			"data_size=%llu index_size=%llu filter_size=%llu data_blocks=%llu "
+			"creation_time=%llu seqno=[%llu,%llu] compression=%s dict_size=%llu",
+			static_cast<unsigned long long>(num_entries),
+			static_cast<unsigned long long>(num_deletions),
+			static_cast<unsigned long long>(num_merge_operands),
+			static_cast<unsigned long long>(num_range_deletions),
+			static_cast<unsigned long long>(raw_key_size),
+			static_cast<unsigned long long>(raw_value_size),
+			static_cast<unsigned long long>(data_size),
+			static_cast<unsigned long long>(index_size),
+			static_cast<unsigned long long>(filter_size),
+			static_cast<unsigned long long>(num_data_blocks),
+			static_cast<unsigned long long>(creation_time),
+			static_cast<unsigned long long>(smallest_seqno),
+			static_cast<unsigned long long>(largest_seqno),
+			compression_name.c_str(),
+			static_cast<unsigned long long>(compression_dict_size));
+		std::string result(buf);
+		for (const auto& [name, value] : user_collected_properties) {
+			result.append(" ");
+			result.append(name);
+			result.append("=");
+			result.append(std::to_string(value.size()));
+			result.append("B");
+		}
+		return result;
+	}
+
+	PropertyBlockBuilder::PropertyBlockBuilder()
+		:builder_(&options_)
+	{
+		// every entry is a restart point, names are short and rarely share prefixes
+		options_.block_restart_interval = 1;
+	}
+
+	void PropertyBlockBuilder::add(const std::string& name, uint64_t value)
+	{
+		std::string dst;
+		PutVarint64(&dst, value);
+		props_[name] = std::move(dst);
+	}
+
+	void PropertyBlockBuilder::addTableProperties(const TableProperties& props)
+	{
+		using namespace TablePropertiesNames;
+		add(kNumEntries, props.num_entries);
+		add(kNumDeletions, props.num_deletions);
+		add(kNumMergeOperands, props.num_merge_operands);
+		add(kNumRangeDeletions, props.num_range_deletions);
+		add(kRawKeySize, props.raw_key_size);
+		add(kRawValueSize, props.raw_value_size);
+		add(kDataSize, props.data_size);
+		add(kIndexSize, props.index_size);
+		add(kFilterSize, props.filter_size);
+		add(kNumDataBlocks, props.num_data_blocks);
+		add(kCreationTime, props.creation_time);
+		add(kSmallestSeqno, props.smallest_seqno);
+		add(kLargestSeqno, props.largest_seqno);
+		props_[kSmallestKey] = props.smallest_key;
+		props_[kLargestKey] = props.largest_key;
+		add(kCompressionDictSize, props.compression_dict_size);
+		props_[kCompressionName] = props.compression_name;
+	}
+
+	void PropertyBlockBuilder::add(const UserCollectedProperties& props)
+	{
+		for (const auto& [name, value] : props) {
+			props_[name] = value;
+		}
+	}
+
+	Slice PropertyBlockBuilder::finish()
+	{
+		for (const auto& [name, value] : props_) {
+			builder_.add(name, value);
+		}
+		return builder_.finish();
+	}
+
+	Status readTableProperties(RandomAccessFile* file, uint64_t fileSize,
+		TableProperties* properties)
+	{
+		using namespace TablePropertiesNames;
+		Footer footer;
+		Status s = readFooter(file, fileSize, &footer);
+		if (!s.ok()) {
+			return s;
+		}
+		BlockHandle handle;
+		s = findMetaBlock(file, footer, kPropertiesBlockName, &handle);
+		if (!s.ok()) {
+			return s;
+		}
+
+		ReadOptions opt;
+		opt.verify_checksums = true;
+		BlockContents contents;
+		s = readBlock(file, opt, handle, &contents);
+		if (!s.ok()) {
+			return s;
+		}
+
+		const std::map<std::string, uint64_t TableProperties::*> numbers = {
+			{ kNumEntries, &TableProperties::num_entries },
+			{ kNumDeletions, &TableProperties::num_deletions },
+			{ kNumMergeOperands, &TableProperties::num_merge_operands },
+			{ kNumRangeDeletions, &TableProperties::num_range_deletions },
+			{ kRawKeySize, &TableProperties::raw_key_size },
+			{ kRawValueSize, &TableProperties::raw_value_size },
+			{ kDataSize, &TableProperties::data_size },
+			{ kIndexSize, &TableProperties::index_size },
+			{ kFilterSize, &TableProperties::filter_size },
+			{ kNumDataBlocks, &TableProperties::num_data_blocks },
+			{ kCreationTime, &TableProperties::creation_time },
+			{ kSmallestSeqno, &TableProperties::smallest_seqno },
+			{ kLargestSeqno, &TableProperties::largest_seqno },
+			{ kCompressionDictSize, &TableProperties::compression_dict_size },
+		};
+
+		*properties = TableProperties();
+		Block block(contents);
+		std::unique_ptr<Iterator> iter(block.newIterator(byteWiseComparator()));
+		for (iter->seekToFirst(); iter->valid(); iter->next()) {
+			const std::string name(iter->key());
+			Slice value = iter->value();
+			auto pos = numbers.find(name);
+			if (pos != numbers.end()) {
+				if (!GetVarint64(&value, &(properties->*(pos->second)))) {
+					return Status::Corruption("bad table property", name);
+				}
+			}
+			else if (name == kSmallestKey) {
+				properties->smallest_key.assign(value.data(), value.size());
+			}
+			else if (name == kLargestKey) {
+				properties->largest_key.assign(value.data(), value.size());
+			}
+			else if (name == kCompressionName) {
+				properties->compression_name.assign(value.data(), value.size());
+			}
+			else {
+				properties->user_collected_properties[name].assign(value.data(), value.size());
+			}
+		}
+		return iter->status();
+	}
+
+}
@@ -0,0 +1,224 @@
+#include <cstring>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "CDataBase/Env.h"
+#include "CDataBase/Options.h"
+#include "CDataBase/TableBuilder.h"
+#include "CDataBase/TableProperties.h"
+#include "DataBase/DBFormat.h"
+
+namespace CDB {
+
+	namespace {
+
+		class StringSink : public WritableFile {
+		public:
+			Status append(const Slice& data) override
+			{
+				contents_.append(data.data(), data.size());
+				return Status::OK();
+			}
+			Status close() override { return Status::OK(); }
+			Status flush() override { return Status::OK(); }
+			Status sync() override { return Status::OK(); }
+
+			const std::string& contents() const { return contents_; }
+
+		private:
+			std::string contents_;
+		};
+
+		class StringSource : public RandomAccessFile {
+		public:
+			explicit StringSource(const std::string& contents) : contents_(contents) {}
+
+			Status read(uint64_t offset, size_t n, Slice* result, char* scratch) const override
+			{
+				if (offset >= contents_.size()) {
+					return Status::InvalidArgument("invalid Read offset");
+				}
+				if (offset + n > contents_.size()) {
+					n = contents_.size() - offset;
+				}
+				std::memcpy(scratch, &contents_[offset], n);
+				*result = Slice(scratch, n);
+				return Status::OK();
+			}
+
+		private:
+			std::string contents_;
+		};
+
+		// counts the puts whose value is empty
+		class EmptyValueCollector : public TablePropertiesCollector {
+		public:
+			Status addUserKey(const Slice& key, const Slice& value, EntryType type,
+				uint64_t seq, uint64_t fileSize) override
+			{
+				if (type == KEntryPut && value.empty()) {
+					++count_;
+				}
+				return Status::OK();
+			}
+
+			Status finish(UserCollectedProperties* properties) override
+			{
+				(*properties)["test.empty.values"] = std::to_string(count_);
+				return Status::OK();
+			}
+
+			const char* name() const override { return "EmptyValueCollector"; }
+
+		private:
+			int count_ = 0;
+		};
+
+		class EmptyValueCollectorFactory : public TablePropertiesCollectorFactory {
+		public:
+			TablePropertiesCollector* createTablePropertiesCollector() override
+			{
+				return new EmptyValueCollector;
+			}
+
+			const char* name() const override { return "EmptyValueCollectorFactory"; }
+		};
+
+		// fails the table when it is finished
+		class FailingCollector : public TablePropertiesCollector {
+		public:
+			Status addUserKey(const Slice& key, const Slice& value, EntryType type,
+				uint64_t seq, uint64_t fileSize) override
+			{
+				return Status::OK();
+			}
+
+			Status finish(UserCollectedProperties* properties) override
+			{
+				return Status::Corruption("collector failed");
+			}
+
+			const char* name() const override { return "FailingCollector"; }
+		};
+
+		class FailingCollectorFactory : public TablePropertiesCollectorFactory {
+		public:
+			TablePropertiesCollector* createTablePropertiesCollector() override
+			{
+				return new FailingCollector;
+			}
+
+			const char* name() const override { return "FailingCollectorFactory"; }
+		};
+
+	}
+
+	TEST(TablePropertiesTest, RoundTrip) {
+		InternalKeyComparator icmp(byteWiseComparator());
+		EmptyValueCollectorFactory factory;
+		Options options;
+		options.comparator = &icmp;
+		options.block_size = 64;
+		options.table_properties_collector_factories.push_back(&factory);
+
+		StringSink sink;
+		TableBuilder builder(options, &sink);
+		const char* keys[] = { "apple", "banana", "cherry", "grape", "lemon" };
+		for (int i = 0; i < 5; ++i) {
+			InternalKey key(keys[i], 10 + i, i == 2 ? kTypeDeletion : kTypeValue);
+			builder.add(key.Encode(), i % 2 == 0 ? "" : "some value");
+		}
+		builder.addRangeTombstone(InternalKey("b", 20, kTypeRangeDeletion).Encode(), "d");
+		ASSERT_TRUE(builder.finish().ok());
+		ASSERT_EQ(sink.contents().size(), builder.fileSize());
+
+		StringSource source(sink.contents());
+		TableProperties props;
+		ASSERT_TRUE(readTableProperties(&source, sink.contents().size(), &props).ok());
+		ASSERT_EQ(5u, props.num_entries);
+		ASSERT_EQ(1u, props.num_deletions);
+		ASSERT_EQ(1u, props.num_range_deletions);
+		ASSERT_EQ(10u, props.smallest_seqno);
+		ASSERT_EQ(14u, props.largest_seqno);
+		ASSERT_EQ("apple", props.smallest_key);
+		ASSERT_EQ("lemon", props.largest_key);
+		ASSERT_EQ(20u, props.raw_value_size);
+		ASSERT_LT(1u, props.num_data_blocks);
+		ASSERT_EQ(builder.getTableProperties().data_size, props.data_size);
+		ASSERT_LT(0u, props.index_size);
+		ASSERT_EQ("2", props.user_collected_properties["test.empty.values"]);
+	}
+
+	TEST(TablePropertiesTest, FailedCollectorFailsTable) {
+		FailingCollectorFactory factory;
+		Options options;
+		options.table_properties_collector_factories.push_back(&factory);
+		StringSink sink;
+		TableBuilder builder(options, &sink);
+		builder.add("a", "v");
+		ASSERT_TRUE(builder.finish().IsCorruption());
+		ASSERT_TRUE(builder.status().IsCorruption());
+	}
+
+	TEST(TablePropertiesTest, CompactOnDeletionWindow) {
+		std::unique_ptr<TablePropertiesCollectorFactory> factory(
+			newCompactOnDeletionCollectorFactory(10, 5));
+		std::unique_ptr<TablePropertiesCollector> collector(factory->createTablePropertiesCollector());
+		// deletions spread out never reach 5 within 10 entries
+		for (int i = 0; i < 100; ++i) {
+			ASSERT_TRUE(collector->addUserKey("k", "", i % 3 == 0 ? KEntryDelete : KEntryPut, i, 0).ok());
+		}
+		ASSERT_FALSE(collector->needCompact());
+		for (int i = 0; i < 5; ++i) {
+			collector->addUserKey("k", "", KEntryDelete, i, 0);
+		}
+		ASSERT_TRUE(collector->needCompact());
+	}
+
+	TEST(TablePropertiesTest, CompactOnDeletionRatio) {
+		std::unique_ptr<TablePropertiesCollectorFactory> factory(
+			newCompactOnDeletionCollectorFactory(0, 0, 0.5));
+		std::unique_ptr<TablePropertiesCollector> collector(factory->createTablePropertiesCollector());
+		collector->addUserKey("a", "v", KEntryPut, 1, 0);
+		collector->addUserKey("b", "", KEntryDelete, 2, 0);
+		collector->addUserKey("c", "v", KEntryPut, 3, 0);
+		ASSERT_FALSE(collector->needCompact());
+		collector->addUserKey("d", "", KEntryDelete, 4, 0);
+		ASSERT_TRUE(collector->needCompact());
+	}
+
+	TEST(TablePropertiesTest, CompactOnDeletionStored) {
+		std::unique_ptr<TablePropertiesCollectorFactory> factory(
+			newCompactOnDeletionCollectorFactory(10, 5));
+		Options options;
+		options.table_properties_collector_factories.push_back(factory.get());
+		for (bool dense : { false, true }) {
+			InternalKeyComparator icmp(byteWiseComparator());
+			options.comparator = &icmp;
+			StringSink sink;
+			TableBuilder builder(options, &sink);
+			for (int i = 0; i < 20; ++i) {
+				const bool deletion = dense || i % 5 == 0;
+				InternalKey key("k" + std::to_string(100 + i), i + 1, deletion ? kTypeDeletion : kTypeValue);
+				builder.add(key.Encode(), "");
+			}
+			ASSERT_TRUE(builder.finish().ok());
+			ASSERT_EQ(dense, builder.needCompact());
+
+			// the flag is read back without the builder
+			StringSource source(sink.contents());
+			TableProperties props;
+			ASSERT_TRUE(readTableProperties(&source, sink.contents().size(), &props).ok());
+			ASSERT_EQ(dense ? "1" : "0", props.user_collected_properties[KNeedCompactProperty]);
+			ASSERT_EQ(dense, tableNeedsCompaction(props));
+		}
+		ASSERT_FALSE(tableNeedsCompaction(TableProperties()));
+	}
+
+	TEST(TablePropertiesTest, NotATable) {
+		StringSource source(std::string(100, 'x'));
+		TableProperties props;
+		ASSERT_TRUE(readTableProperties(&source, 100, &props).IsCorruption());
+	}
+
+}
@@ -0,0 +1,394 @@
+#include "CDataBase/Table.h"
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "CDataBase/Cache.h"
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+#include "CDataBase/Options.h"
+#include "CDataBase/SecondaryCache.h"
+#include "CDataBase/TableBuilder.h"
+#include "Table/Block.h"
+#include "Table/BlockPrefetcher.h"
+#include "Table/Format.h"
+
+namespace CDB {
+
+	namespace {
+
+		class TableSink : public WritableFile {
+		public:
+			Status append(const Slice& data) override
+			{
+				contents.append(data.data(), data.size());
+				return Status::OK();
+			}
+			Status close() override { return Status::OK(); }
+			Status flush() override { return Status::OK(); }
+			Status sync() override { return Status::OK(); }
+
+			std::string contents;
+		};
+
+		// counts the reads so the tests can tell what was served from memory,
+		// a mapped source hands out pointers into its contents like an mmap'd file
+		class CountingSource : public RandomAccessFile {
+		public:
+			explicit CountingSource(const std::string& contents) : contents_(contents) {}
+
+			Status read(uint64_t offset, size_t n, Slice* result, char* scratch) const override
+			{
+				++reads;
+				if (offset >= contents_.size()) {
+					return Status::InvalidArgument("invalid Read offset");
+				}
+				if (offset + n > contents_.size()) {
+					n = contents_.size() - offset;
+				}
+				if (mapped) {
+					*result = Slice(&contents_[offset], n);
+					return Status::OK();
+				}
+				std::memcpy(scratch, &contents_[offset], n);
+				*result = Slice(scratch, n);
+				bytesRead += n;
+				return Status::OK();
+			}
+
+			Status prefetch(uint64_t offset, size_t n) const override
+			{
+				++prefetches;
+				std::lock_guard<std::mutex> l(mu);
+				prefetched.insert(offset);
+				return Status::OK();
+			}
+
+			bool mapped = false;
+			mutable int reads = 0;
+			mutable uint64_t bytesRead = 0;
+			mutable std::atomic<int> prefetches{ 0 };
+			mutable std::mutex mu;
+			// the offsets passed to prefetch
+			mutable std::set<uint64_t> prefetched;
+
+		private:
+			std::string contents_;
+		};
+
+	}
+
+	class TableTest : public testing::Test {
+	public:
+		TableTest()
+		{
+			options_.comparator = byteWiseComparator();
+			options_.block_size = 1024;
+		}
+
+		static std::string key(int i)
+		{
+			char buf[32];
+			std::snprintf(buf, sizeof(buf), "key%08d", i * 2);
+			return buf;
+		}
+
+		static std::string value(int i, char fill = 'x') { return "value" + std::to_string(i) + std::string(50, fill); }
+
+		void build(int n, char fill = 'x')
+		{
+			TableSink sink;
+			TableBuilder builder(options_, &sink);
+			for (int i = 0; i < n; ++i) {
+				builder.add(key(i), value(i, fill));
+			}
+			ASSERT_TRUE(builder.finish().ok());
+			file_ = std::make_unique<CountingSource>(sink.contents);
+			size_ = sink.contents.size();
+			Table* table;
+			ASSERT_TRUE(Table::open(options_, file_.get(), size_, &table).ok());
+			table_.reset(table);
+		}
+
+		Options options_;
+		std::unique_ptr<CountingSource> file_;
+		uint64_t size_ = 0;
+		std::unique_ptr<Table> table_;
+	};
+
+	TEST_F(TableTest, IndexIsLoadedOnFirstUse) {
+		build(100);
+		// only the footer
+		ASSERT_EQ(1, file_->reads);
+		ASSERT_FALSE(table_->indexLoaded());
+		std::unique_ptr<Iterator> iter(table_->newIterator(ReadOptions()));
+		ASSERT_TRUE(table_->indexLoaded());
+		const int reads = file_->reads;
+		std::unique_ptr<Iterator> again(table_->newIterator(ReadOptions()));
+		ASSERT_EQ(reads, file_->reads);
+	}
+
+	TEST_F(TableTest, IterateAndSeek) {
+		build(2000);
+		std::unique_ptr<Iterator> iter(table_->newIterator(ReadOptions()));
+		int i = 0;
+		for (iter->seekToFirst(); iter->valid(); iter->next(), ++i) {
+			ASSERT_EQ(key(i), iter->key());
+			ASSERT_EQ(value(i), iter->value());
+		}
+		ASSERT_EQ(2000, i);
+		ASSERT_TRUE(iter->status().ok());
+
+		for (iter->seekToLast(); iter->valid(); iter->prev()) {
+			--i;
+			ASSERT_EQ(key(i), iter->key());
+		}
+		ASSERT_EQ(0, i);
+
+		// between key(500) and key(501)
+		std::string target = key(500) + "a";
+		iter->seek(target);
+		ASSERT_TRUE(iter->valid());
+		ASSERT_EQ(key(501), iter->key());
+		iter->seek("zzz");
+		ASSERT_FALSE(iter->valid());
+	}
+
+	TEST_F(TableTest, BlockCacheServesRepeatReads) {
+		std::unique_ptr<Cache> cache(newLRUCache(8 << 20));
+		options_.block_cache = cache.get();
+		build(2000);
+		std::unique_ptr<Iterator> iter(table_->newIterator(ReadOptions()));
+		for (iter->seekToFirst(); iter->valid(); iter->next()) {
+		}
+		const int reads = file_->reads;
+		ASSERT_GT(cache->totalCharge(), 0u);
+		for (iter->seekToFirst(); iter->valid(); iter->next()) {
+		}
+		ASSERT_EQ(reads, file_->reads);
+		iter.reset();
+		table_.reset();
+	}
+
+	TEST_F(TableTest, IndexInBlockCache) {
+		std::unique_ptr<Cache> cache(newLRUCache(8 << 20));
+		options_.block_cache = cache.get();
+		options_.cache_index_and_filter_blocks = true;
+		build(2000);
+		std::unique_ptr<Iterator> iter(table_->newIterator(ReadOptions()));
+		iter->seek(key(10));
+		ASSERT_TRUE(iter->valid());
+		ASSERT_EQ(0u, table_->pinnedMemoryUsage());
+		const int reads = file_->reads;
+		// the index and the block come from the cache
+		std::unique_ptr<Iterator> again(table_->newIterator(ReadOptions()));
+		again->seek(key(10));
+		ASSERT_EQ(key(10), again->key());
+		ASSERT_EQ(reads, file_->reads);
+		iter.reset();
+		again.reset();
+		table_.reset();
+	}
+
+	TEST_F(TableTest, IndexHeldByTable) {
+		build(2000);
+		ASSERT_EQ(0u, table_->pinnedMemoryUsage());
+		std::unique_ptr<Iterator> iter(table_->newIterator(ReadOptions()));
+		ASSERT_GT(table_->pinnedMemoryUsage(), 0u);
+	}
+
+	TEST_F(TableTest, ScanReadsAhead) {
+		options_.compression = KNoCompression;
+		options_.max_auto_readahead_size = 0;
+		build(2000);
+		std::unique_ptr<Iterator> iter(table_->newIterator(ReadOptions()));
+		int reads = file_->reads;
+		for (iter->seekToFirst(); iter->valid(); iter->next()) {
+		}
+		// one read per block
+		const int blocks = file_->reads - reads;
+		ASSERT_GT(blocks, 100);
+		ASSERT_EQ(0, file_->prefetches);
+
+		iter.reset();
+		options_.max_auto_readahead_size = 256 * 1024;
+		build(2000);
+		iter.reset(table_->newIterator(ReadOptions()));
+		reads = file_->reads;
+		int i = 0;
+		for (iter->seekToFirst(); iter->valid(); iter->next(), ++i) {
+			ASSERT_EQ(key(i), iter->key());
+			ASSERT_EQ(value(i), iter->value());
+		}
+		ASSERT_EQ(2000, i);
+		ASSERT_TRUE(iter->status().ok());
+		// 8KB, 16KB, ... up to 256KB after the first two blocks
+		ASSERT_LT(file_->reads - reads, 10);
+		ASSERT_GT(file_->prefetches, 0);
+	}
+
+	TEST_F(TableTest, FixedReadaheadSize) {
+		options_.compression = KNoCompression;
+		options_.max_auto_readahead_size = 0;
+		build(2000);
+		ReadOptions ro;
+		ro.readahead_size = 64 * 1024;
+		std::unique_ptr<Iterator> iter(table_->newIterator(ro));
+		const int reads = file_->reads;
+		int i = 0;
+		for (iter->seekToFirst(); iter->valid(); iter->next(), ++i) {
+			ASSERT_EQ(key(i), iter->key());
+		}
+		ASSERT_EQ(2000, i);
+		ASSERT_LE(file_->reads - reads, 4);
+	}
+
+	TEST_F(TableTest, RandomSeeksDoNotReadAhead) {
+		options_.compression = KNoCompression;
+		uint64_t bytes[2];
+		for (int round = 0; round < 2; ++round) {
+			options_.max_auto_readahead_size = round == 0 ? 0 : 256 * 1024;
+			build(2000);
+			std::unique_ptr<Iterator> iter(table_->newIterator(ReadOptions()));
+			iter->seekToFirst();
+			const uint64_t before = file_->bytesRead;
+			for (int i = 0; i < 20; ++i) {
+				const int k = (i * 397) % 2000;
+				iter->seek(key(k));
+				ASSERT_TRUE(iter->valid());
+				ASSERT_EQ(key(k), iter->key());
+			}
+			bytes[round] = file_->bytesRead - before;
+		}
+		ASSERT_EQ(bytes[0], bytes[1]);
+	}
+
+	TEST_F(TableTest, PrefetcherFaultsMappedBlocksIn) {
+		options_.compression = KNoCompression;
+		build(2000);
+		file_->mapped = true;
+		Footer footer;
+		ASSERT_TRUE(readFooter(file_.get(), size_, &footer).ok());
+		BlockContents indexContents;
+		ASSERT_TRUE(readBlock(file_.get(), ReadOptions(), footer.indexHandle(), &indexContents).ok());
+		Block index(indexContents);
+
+		BlockPrefetcher prefetcher(2, 4, 1 << 20);
+		std::unique_ptr<BlockPrefetcher::Stream> stream(prefetcher.newStream(file_.get(), ReadOptions(),
+			index.newIterator(options_.comparator), nullptr));
+		std::unique_ptr<Iterator> indexIter(index.newIterator(options_.comparator));
+		std::vector<uint64_t> offsets;
+		for (indexIter->seekToFirst(); indexIter->valid(); indexIter->next()) {
+			Slice v = indexIter->value();
+			BlockHandle handle;
+			ASSERT_TRUE(handle.decodeFrom(&v).ok());
+			BlockContents contents;
+			ASSERT_TRUE(stream->read(handle, &contents).ok());
+			// nothing is copied out of the mapping
+			ASSERT_FALSE(contents.heapAllocated);
+			offsets.push_back(handle.offset());
+		}
+		stream.reset();
+		ASSERT_GT(offsets.size(), 100u);
+		ASSERT_EQ(offsets.size() - 1, prefetcher.prefetchedBlocks());
+		// the blocks read ahead were paged in by the workers, only the first
+		// one was read by the caller
+		std::lock_guard<std::mutex> l(file_->mu);
+		ASSERT_EQ(0u, file_->prefetched.count(offsets[0]));
+		for (size_t i = 1; i < offsets.size(); ++i) {
+			ASSERT_EQ(1u, file_->prefetched.count(offsets[i]));
+		}
+	}
+
+	TEST_F(TableTest, ApproximateOffsetOf) {
+		options_.compression = KNoCompression;
+		build(2000);
+		uint64_t last = 0;
+		for (int i = 0; i < 2000; i += 100) {
+			uint64_t offset = table_->approximateOffsetOf(key(i));
+			ASSERT_GE(offset, last);
+			last = offset;
+		}
+		ASSERT_GT(last, 0u);
+		ASSERT_LT(table_->approximateOffsetOf("zzz"), size_);
+		ASSERT_GT(table_->approximateOffsetOf("zzz"), last);
+	}
+
+	TEST_F(TableTest, PersistentCacheKeepsTablesApart) {
+		Env* env = Env::Default();
+		std::string dir;
+		ASSERT_TRUE(env->getTestDir(&dir).ok());
+		dir += "/table_persistent_cache_test";
+		auto destroy = [&]() {
+			std::vector<std::string> children;
+			env->getChildren(dir, &children);
+			for (const std::string& child : children) {
+				env->removeFile(dir + "/" + child);
+			}
+			env->removeDir(dir);
+		};
+		destroy();
+		options_.compression = KNoCompression;
+
+		SecondaryCache* secondary;
+		ASSERT_TRUE(newPersistentCache(env, dir, 64 << 20, &secondary).ok());
+		std::unique_ptr<SecondaryCache> persistent(secondary);
+		// a block or two per shard, the rest of a scan moves to the files
+		std::unique_ptr<Cache> cache(newLRUCache(16 * 2048, persistent.get()));
+		options_.block_cache = cache.get();
+		build(2000);
+		std::unique_ptr<Iterator> iter(table_->newIterator(ReadOptions()));
+		for (iter->seekToFirst(); iter->valid(); iter->next()) {
+		}
+		iter.reset();
+		table_.reset();
+		std::unique_ptr<CountingSource> first = std::move(file_);
+		const uint64_t firstSize = size_;
+		ASSERT_GT(persistent->totalCharge(), 0u);
+
+		// a new process, the ids handed out by a new block cache start over
+		cache.reset();
+		persistent.reset();
+		ASSERT_TRUE(newPersistentCache(env, dir, 64 << 20, &secondary).ok());
+		persistent.reset(secondary);
+		cache.reset(newLRUCache(16 * 2048, persistent.get()));
+		options_.block_cache = cache.get();
+
+		// the same layout with other values, none of the first table's blocks
+		// may show up in it
+		build(2000, 'y');
+		iter.reset(table_->newIterator(ReadOptions()));
+		int i = 0;
+		for (iter->seekToFirst(); iter->valid(); iter->next(), ++i) {
+			ASSERT_EQ(value(i, 'y'), iter->value()) << i;
+		}
+		ASSERT_EQ(2000, i);
+		iter.reset();
+		table_.reset();
+
+		// the first table finds its blocks again
+		Table* table;
+		ASSERT_TRUE(Table::open(options_, first.get(), firstSize, &table).ok());
+		table_.reset(table);
+		iter.reset(table_->newIterator(ReadOptions()));
+		const int reads = first->reads;
+		// the last blocks of the scan were still in the old block cache
+		for (i = 0; i < 1500; i += 100) {
+			iter->seek(key(i));
+			ASSERT_TRUE(iter->valid());
+			ASSERT_EQ(value(i), iter->value());
+		}
+		ASSERT_EQ(reads, first->reads);
+		iter.reset();
+		table_.reset();
+		cache.reset();
+		persistent.reset();
+		destroy();
+	}
+
+}
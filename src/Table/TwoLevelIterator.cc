@@ -0,0 +1,167 @@
+#include "Table/TwoLevelIterator.h"
+
+#include <string>
+#include "CDataBase/Options.h"
+#include "Table/IteratorWrapper.h"
+
+namespace CDB{
+
+	namespace {
+
+		typedef Iterator* (*BlockFunction)(void*, const ReadOptions&, const Slice&);
+
+		class TwoLevelIterator : public Iterator {
+		public:
+			TwoLevelIterator(Iterator* indexIter, BlockFunction blockFunction, void* arg,
+				const ReadOptions& options);
+
+			~TwoLevelIterator() override;
+
+			void seek(const Slice& target) override;
+			void seekToFirst() override;
+			void seekToLast() override;
+			void next() override;
+			void prev() override;
+
+			bool valid() const override { return dataIter_.valid(); }
+			Slice key() const override {
+				assert(valid());
+				return dataIter_.key();
+			}
+			Slice value() const override {
+				assert(valid());
+				return dataIter_.value();
+			}
+			Status status() const override {
+				// It'd be nice if status() returned a const Status& instead of a Status
+				if (!indexIter_.status().ok()) {
+					return indexIter_.status();
+				}
+				else if (dataIter_.iter() != nullptr && !dataIter_.status().ok()) {
+					return dataIter_.status();
+				}
+				else {
+					return status_;
+				}
+			}
+
+		private:
+			void saveError(const Status& s) {
+				if (status_.ok() && !s.ok()) status_ = s;
+			}
+			void skipEmptyDataBlocksForward();
+			void skipEmptyDataBlocksBackward();
+			void setDataIterator(Iterator* dataIter);
+			void initDataBlock();
+
+			BlockFunction blockFunction_;
+			void* arg_;
+			const ReadOptions options_;
+			Status status_;
+			IteratorWrapper indexIter_;
+			IteratorWrapper dataIter_;  // May be nullptr
+			// If dataIter_ is non-null, then "dataBlockHandle_" holds the
+			// "indexValue" passed to blockFunction_ to create the dataIter_.
+			std::string dataBlockHandle_;
+		};
+
+		TwoLevelIterator::TwoLevelIterator(Iterator* indexIter, BlockFunction blockFunction,
+			void* arg, const ReadOptions& options)
+			: blockFunction_(blockFunction),
+			arg_(arg),
+			options_(options),
+			indexIter_(indexIter),
+			dataIter_(nullptr) {}
+
+		TwoLevelIterator::~TwoLevelIterator() = default;
+
+		void TwoLevelIterator::seek(const Slice& target) {
+			indexIter_.seek(target);
+			initDataBlock();
+			if (dataIter_.iter() != nullptr) dataIter_.seek(target);
+			skipEmptyDataBlocksForward();
+		}
+
+		void TwoLevelIterator::seekToFirst() {
+			indexIter_.seekToFirst();
+			initDataBlock();
+			if (dataIter_.iter() != nullptr) dataIter_.seekToFirst();
+			skipEmptyDataBlocksForward();
+		}
+
+		void TwoLevelIterator::seekToLast() {
+			indexIter_.seekToLast();
+			initDataBlock();
+			if (dataIter_.iter() != nullptr) dataIter_.seekToLast();
+			skipEmptyDataBlocksBackward();
+		}
+
+		void TwoLevelIterator::next() {
+			assert(valid());
+			dataIter_.next();
+			skipEmptyDataBlocksForward();
+		}
+
+		void TwoLevelIterator::prev() {
+			assert(valid());
+			dataIter_.prev();
+			skipEmptyDataBlocksBackward();
+		}
+
+		void TwoLevelIterator::skipEmptyDataBlocksForward() {
+			while (dataIter_.iter() == nullptr || !dataIter_.valid()) {
+				// Move to next block
+				if (!indexIter_.valid()) {
+					setDataIterator(nullptr);
+					return;
+				}
+				indexIter_.next();
+				initDataBlock();
+				if (dataIter_.iter() != nullptr) dataIter_.seekToFirst();
+			}
+		}
+
+		void TwoLevelIterator::skipEmptyDataBlocksBackward() {
+			while (dataIter_.iter() == nullptr || !dataIter_.valid()) {
+				// Move to next block
+				if (!indexIter_.valid()) {
+					setDataIterator(nullptr);
+					return;
+				}
+				indexIter_.prev();
+				initDataBlock();
+				if (dataIter_.iter() != nullptr) dataIter_.seekToLast();
+			}
+		}
+
+		void TwoLevelIterator::setDataIterator(Iterator* dataIter) {
+			if (dataIter_.iter() != nullptr) saveError(dataIter_.status());
+			dataIter_.set(dataIter);
+		}
+
+		void TwoLevelIterator::initDataBlock() {
+			if (!indexIter_.valid()) {
+				setDataIterator(nullptr);
+			}
+			else {
+				Slice handle = indexIter_.value();
+				if (dataIter_.iter() != nullptr && handle == dataBlockHandle_) {
+					// dataIter_ is already constructed with this iterator, so
+					// no need to change anything
+				}
+				else {
+					Iterator* iter = (*blockFunction_)(arg_, options_, handle);
+					dataBlockHandle_.assign(handle.data(), handle.size());
+					setDataIterator(iter);
+				}
+			}
+		}
+
+	}
+
+	Iterator* newTwoLevelIterator(Iterator* indexIter, BlockFunction blockFunction,
+		void* arg, const ReadOptions& options) {
+		return new TwoLevelIterator(indexIter, blockFunction, arg, options);
+	}
+
+}
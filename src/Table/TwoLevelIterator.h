@@ -0,0 +1,30 @@
+/*!
+ * \file TwoLevelIterator.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include "CDataBase/Iterator.h"
+
+namespace CDB{
+
+	struct ReadOptions;
+
+	/// Return a new two level iterator.  A two-level iterator contains an
+	/// index iterator whose values point to a sequence of blocks where
+	/// each block is itself a sequence of key,value pairs.  The returned
+	/// two-level iterator yields the concatenation of all key/value pairs
+	/// in the sequence of blocks.  Takes ownership of "indexIter" and
+	/// will delete it when no longer needed.
+	///
+	/// Uses a supplied function to convert an index_iter value into
+	/// an iterator over the contents of the corresponding block.
+	Iterator* newTwoLevelIterator(
+		Iterator* indexIter,
+		Iterator* (*blockFunction)(void* arg, const ReadOptions& options, const Slice& indexValue),
+		void* arg, const ReadOptions& options);
+
+}
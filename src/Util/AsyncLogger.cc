@@ -0,0 +1,213 @@
+#include "Util/AsyncLogger.h"
+
+#include <sys/time.h>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <string>
+
+namespace CDB{
+
+	namespace {
+
+		std::atomic<uint64_t> gNextLoggerId{ 1 };
+
+		// the per-thread part of the line prefix
+		struct ThreadLogState {
+			// the logger the cached ring belongs to
+			uint64_t loggerId = 0;
+			void* ring = nullptr;
+			// gives the ring back to its logger when reset, also at thread exit
+			std::shared_ptr<void> lease;
+
+			std::string threadId;
+
+			// "YYYY/MM/DD-HH:MM:SS" of cachedSecond, rebuilt once a second
+			std::time_t cachedSecond = -1;
+			char timePrefix[32] = { 0 };
+			int timePrefixSize = 0;
+		};
+
+		thread_local ThreadLogState tlsLogState;
+
+		constexpr int KMaxThreadIdSize = 32;
+
+	}
+
+	AsyncLogger::AsyncLogger(std::FILE* fp)
+		:fp_(fp), id_(gNextLoggerId.fetch_add(1, std::memory_order_relaxed)),
+		stop_(false), dropped_(0), reportedDropped_(0)
+	{
+		assert(fp_ != nullptr);
+		drainThread_ = std::thread(&AsyncLogger::drainLoop, this);
+	}
+
+	AsyncLogger::~AsyncLogger()
+	{
+		{
+			std::lock_guard<std::mutex> l(mu_);
+			stop_ = true;
+		}
+		cv_.notify_one();
+		drainThread_.join();
+		std::fclose(fp_);
+	}
+
+	AsyncLogger::Ring* AsyncLogger::threadRing()
+	{
+		ThreadLogState& state = tlsLogState;
+		if (state.loggerId == id_) {
+			return static_cast<Ring*>(state.ring);
+		}
+		// first line of this thread, or the thread switched loggers. the
+		// ring of the previous logger is free for its other threads now
+		state.lease.reset();
+		std::shared_ptr<Ring> ring;
+		{
+			std::lock_guard<std::mutex> l(mu_);
+			for (const auto& candidate : rings_) {
+				bool expected = false;
+				if (candidate->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+					ring = candidate;
+					break;
+				}
+			}
+			if (ring == nullptr) {
+				ring = std::make_shared<Ring>();
+				rings_.push_back(ring);
+			}
+		}
+		// the lease keeps the ring alive if the logger goes first
+		state.lease = std::shared_ptr<void>(nullptr, [ring](void*) {
+			ring->inUse.store(false, std::memory_order_release);
+		});
+		state.loggerId = id_;
+		state.ring = ring.get();
+		return ring.get();
+	}
+
+	size_t AsyncLogger::ringCount()
+	{
+		std::lock_guard<std::mutex> l(mu_);
+		return rings_.size();
+	}
+
+	void AsyncLogger::Logv(const char* format, std::va_list ap)
+	{
+		Ring* ring = threadRing();
+		const uint64_t head = ring->head.load(std::memory_order_relaxed);
+		if (head - ring->tail.load(std::memory_order_acquire) >= KRingSize) {
+			// the disk can not keep up, losing a line beats stalling the caller
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		Slot& slot = ring->slots[head % KRingSize];
+
+		ThreadLogState& state = tlsLogState;
+		struct ::timeval now;
+		::gettimeofday(&now, nullptr);
+		if (now.tv_sec != state.cachedSecond) {
+			struct std::tm t;
+			const std::time_t seconds = now.tv_sec;
+			localtime_r(&seconds, &t);
+			state.timePrefixSize = std::snprintf(state.timePrefix, sizeof(state.timePrefix),
+				"%04d/%02d/%02d-%02d:%02d:%02d",
+				t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec);
+			state.cachedSecond = now.tv_sec;
+		}
+		if (state.threadId.empty()) {
+			std::ostringstream threadStream;
+			threadStream << std::this_thread::get_id();
+			state.threadId = threadStream.str();
+			if (state.threadId.size() > KMaxThreadIdSize) {
+				state.threadId.resize(KMaxThreadIdSize);
+			}
+		}
+
+		char* const buffer = slot.data;
+		std::memcpy(buffer, state.timePrefix, state.timePrefixSize);
+		int offset = state.timePrefixSize;
+		offset += std::snprintf(buffer + offset, KMaxLineSize - offset, ".%06d %s ",
+			static_cast<int>(now.tv_usec), state.threadId.c_str());
+
+		std::va_list argumentCopy;
+		va_copy(argumentCopy, ap);
+		const int n = std::vsnprintf(buffer + offset, KMaxLineSize - offset, format, argumentCopy);
+		va_end(argumentCopy);
+		if (n > 0) {
+			offset += n;
+		}
+		// keep the room for the newline, a long line is cut short
+		if (offset > KMaxLineSize - 1) {
+			offset = KMaxLineSize - 1;
+		}
+		if (offset == 0 || buffer[offset - 1] != '\n') {
+			buffer[offset++] = '\n';
+		}
+		slot.size = offset;
+		ring->head.store(head + 1, std::memory_order_release);
+
+		// wake the drain thread early once a ring is half full, otherwise it
+		// picks the lines up on its next round
+		if (head + 1 - ring->tail.load(std::memory_order_relaxed) == KRingSize / 2) {
+			cv_.notify_one();
+		}
+	}
+
+	size_t AsyncLogger::drainOnce()
+	{
+		std::vector<Ring*> rings;
+		{
+			std::lock_guard<std::mutex> l(mu_);
+			rings.reserve(rings_.size());
+			for (const auto& ring : rings_) {
+				rings.push_back(ring.get());
+			}
+		}
+
+		size_t written = 0;
+		for (Ring* ring : rings) {
+			uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+			const uint64_t head = ring->head.load(std::memory_order_acquire);
+			for (; tail != head; ++tail) {
+				const Slot& slot = ring->slots[tail % KRingSize];
+				std::fwrite(slot.data, 1, slot.size, fp_);
+				++written;
+			}
+			ring->tail.store(tail, std::memory_order_release);
+		}
+
+		const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+		if (dropped != reportedDropped_) {
+			std::fprintf(fp_, "dropped %llu log lines\n",
+				static_cast<unsigned long long>(dropped - reportedDropped_));
+			reportedDropped_ = dropped;
+		}
+		if (written > 0) {
+			std::fflush(fp_);
+		}
+		return written;
+	}
+
+	void AsyncLogger::drainLoop()
+	{
+		while (true) {
+			{
+				std::unique_lock<std::mutex> l(mu_);
+				if (!stop_) {
+					cv_.wait_for(l, std::chrono::milliseconds(100));
+				}
+				if (stop_) {
+					break;
+				}
+			}
+			drainOnce();
+		}
+		// the destructor runs after the last Logv, write what is left
+		drainOnce();
+		std::fflush(fp_);
+	}
+
+}
@@ -0,0 +1,105 @@
+/*!
+ * \file AsyncLogger.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CDataBase/Env.h"
+
+namespace CDB{
+
+	/*!
+	 * \class AsyncLogger
+	 *
+	 * \brief a logger that never blocks the calling thread on the file,
+	 *  every thread formats its lines into a ring buffer of its own and a
+	 *  background thread drains the rings into the file, a line is dropped
+	 *  when the ring of its thread is full. a thread gives its ring back
+	 *  when it exits or logs to another logger, so thread churn reuses the
+	 *  rings instead of adding new ones
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class AsyncLogger final : public Logger{
+	public:
+		// lines longer than this are truncated
+		static constexpr int KMaxLineSize = 512;
+
+		// number of lines a thread may have pending before lines are dropped
+		static constexpr int KRingSize = 256;
+
+		/// takes ownership of fp and closes it when destroyed
+		explicit AsyncLogger(std::FILE* fp);
+
+		AsyncLogger(const AsyncLogger&) = delete;
+
+		AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+		/// writes every pending line before the file is closed
+		~AsyncLogger() override;
+
+		void Logv(const char* format, std::va_list ap) override;
+
+		/// number of lines dropped because a ring was full
+		uint64_t droppedLines() const { return dropped_.load(std::memory_order_relaxed); }
+
+		/// number of rings allocated, at most the number of threads that
+		/// logged at the same time
+		size_t ringCount();
+
+	private:
+		struct Slot {
+			int size;
+			char data[KMaxLineSize];
+		};
+
+		// single producer (the owning thread), single consumer (the drain thread)
+		struct Ring {
+			std::atomic<uint64_t> head{ 0 };  // next slot the producer fills
+			std::atomic<uint64_t> tail{ 0 };  // next slot the consumer reads
+			// a thread owns the ring, cleared when it exits or moves to
+			// another logger so the next thread takes the ring over
+			std::atomic<bool> inUse{ true };
+			Slot slots[KRingSize];
+		};
+
+		/// the ring of the calling thread, taken on its first line from the
+		/// rings no thread owns or created
+		Ring* threadRing();
+
+		void drainLoop();
+
+		/// write the pending lines of all rings, return the number written
+		size_t drainOnce();
+
+		std::FILE* const fp_;
+
+		// distinguishes loggers in the per-thread ring cache
+		const uint64_t id_;
+
+		std::mutex mu_;
+		std::condition_variable cv_;
+		std::vector<std::shared_ptr<Ring>> rings_;  // guarded by mu_
+		bool stop_;                                 // guarded by mu_
+
+		std::atomic<uint64_t> dropped_;
+		uint64_t reportedDropped_;  // only touched by the drain thread
+
+		std::thread drainThread_;
+	};
+
+}
@@ -0,0 +1,122 @@
+#include "Util/AsyncLogger.h"
+
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace CDB{
+
+	static void logLine(Logger* logger, const char* format, ...)
+	{
+		std::va_list ap;
+		va_start(ap, format);
+		logger->Logv(format, ap);
+		va_end(ap);
+	}
+
+	static std::vector<std::string> readLines(std::FILE* fp)
+	{
+		std::vector<std::string> lines;
+		std::rewind(fp);
+		std::string line;
+		int c;
+		while ((c = std::fgetc(fp)) != EOF) {
+			if (c == '\n') {
+				lines.push_back(line);
+				line.clear();
+			}
+			else {
+				line.push_back(static_cast<char>(c));
+			}
+		}
+		return lines;
+	}
+
+	TEST(AsyncLogger, AllLinesWritten) {
+		std::FILE* fp = std::tmpfile();
+		ASSERT_NE(nullptr, fp);
+		// keep the file readable after the logger closes its stream
+		std::FILE* reader = ::fdopen(::dup(fileno(fp)), "r");
+		{
+			AsyncLogger logger(fp);
+			std::vector<std::thread> threads;
+			for (int t = 0; t < 4; ++t) {
+				threads.emplace_back([&logger, t] {
+					for (int i = 0; i < 100; ++i) {
+						logLine(&logger, "thread %d line %d", t, i);
+						if (i % 50 == 49) {
+							// let the drain thread catch up, no line should be dropped
+							std::this_thread::sleep_for(std::chrono::milliseconds(200));
+						}
+					}
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			ASSERT_EQ(0u, logger.droppedLines());
+		}
+		std::vector<std::string> lines = readLines(reader);
+		std::fclose(reader);
+		ASSERT_EQ(400u, lines.size());
+		// "YYYY/MM/DD-HH:MM:SS.uuuuuu <thread> <message>"
+		ASSERT_EQ('/', lines[0][4]);
+		ASSERT_EQ('.', lines[0][19]);
+		ASSERT_NE(std::string::npos, lines[0].find(" line "));
+	}
+
+	TEST(AsyncLogger, LongLineTruncated) {
+		std::FILE* fp = std::tmpfile();
+		ASSERT_NE(nullptr, fp);
+		std::FILE* reader = ::fdopen(::dup(fileno(fp)), "r");
+		{
+			AsyncLogger logger(fp);
+			const std::string big(AsyncLogger::KMaxLineSize * 2, 'x');
+			logLine(&logger, "%s", big.c_str());
+			logLine(&logger, "after");
+		}
+		std::vector<std::string> lines = readLines(reader);
+		std::fclose(reader);
+		ASSERT_EQ(2u, lines.size());
+		ASSERT_EQ(static_cast<size_t>(AsyncLogger::KMaxLineSize - 1), lines[0].size());
+		ASSERT_NE(std::string::npos, lines[1].find("after"));
+	}
+
+	TEST(AsyncLogger, RingsReused) {
+		std::FILE* fp = std::tmpfile();
+		ASSERT_NE(nullptr, fp);
+		std::FILE* reader = ::fdopen(::dup(fileno(fp)), "r");
+		std::FILE* otherFp = std::tmpfile();
+		ASSERT_NE(nullptr, otherFp);
+		{
+			AsyncLogger logger(fp);
+			AsyncLogger other(otherFp);
+			// each thread takes over the ring of the one that exited
+			for (int t = 0; t < 50; ++t) {
+				std::thread thread([&logger, t] { logLine(&logger, "thread %d", t); });
+				thread.join();
+			}
+			ASSERT_EQ(1u, logger.ringCount());
+
+			// a thread switching loggers takes its old ring back
+			std::thread thread([&logger, &other] {
+				for (int i = 0; i < 50; ++i) {
+					logLine(&logger, "switch %d", i);
+					logLine(&other, "switch %d", i);
+				}
+			});
+			thread.join();
+			ASSERT_EQ(1u, logger.ringCount());
+			ASSERT_EQ(1u, other.ringCount());
+			ASSERT_EQ(0u, logger.droppedLines());
+		}
+		std::vector<std::string> lines = readLines(reader);
+		std::fclose(reader);
+		ASSERT_EQ(100u, lines.size());
+	}
+
+}
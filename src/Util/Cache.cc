@@ -0,0 +1,521 @@
+/*!
+ * \file Cache.cc
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#include "CDataBase/Cache.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "CDataBase/SecondaryCache.h"
+#include "Util/Hash.h"
+#include "Util/MutexLock.h"
+
+namespace CDB{
+
+	Cache::~Cache() {}
+
+	Cache::Handle* Cache::insert(const Slice& key, void* value, size_t charge, const CacheItemHelper* helper,
+		Priority priority) {
+		(void)priority;
+		return insert(key, value, charge, helper->deleter);
+	}
+
+	Cache::Handle* Cache::lookUp(const Slice& key, const CacheItemHelper* helper) {
+		(void)helper;
+		return lookUp(key);
+	}
+
+	void Cache::prune() {}
+
+	SecondaryCache::~SecondaryCache() {}
+
+	namespace {
+
+		// LRU cache implementation
+		//
+		// Cache entries have an "inCache" boolean indicating whether the cache has a
+		// reference on the entry.  The only ways that this can become false without the
+		// entry being passed to its "deleter" are via erase(), via insert() when
+		// an element with a duplicate key is inserted, or on destruction of the cache.
+		//
+		// The cache keeps two linked lists of items in the cache.  All items in the
+		// cache are in one list or the other, and never both.  Items still referenced
+		// by clients but erased from the cache are in neither list.  The lists are:
+		// - inUse:  contains the items currently referenced by clients, in no
+		//   particular order.
+		// - lru:  contains the items not currently referenced by clients, in LRU order
+		// - highPriLru:  like lru for the items inserted with KHighPriority,
+		//   they are evicted once lru is empty or their pool is over its share
+		// Elements are moved between these lists by the ref() and unref() methods,
+		// when they detect an element in the cache acquiring or losing its only
+		// external reference.
+
+		// An entry is a variable length heap-allocated structure.  Entries
+		// are kept in a circular doubly linked list ordered by access time.
+		struct LRUHandle {
+			void* value;
+			void (*deleter)(const Slice&, void* value);
+			// set for the entries that can be demoted to the secondary cache
+			const Cache::CacheItemHelper* helper;
+			LRUHandle* nextHash;
+			LRUHandle* next;
+			LRUHandle* prev;
+			size_t charge;
+			size_t keyLength;
+			bool inCache;      // Whether entry is in the cache.
+			bool highPri;      // Whether entry goes to the high priority lru list.
+			uint32_t refs;     // References, including cache reference, if present.
+			uint32_t hash;     // Hash of key(); used for fast sharding and comparisons
+			char keyData[1];   // Beginning of key
+
+			Slice key() const {
+				// next is only equal to this if the LRU handle is the list head of an
+				// empty list. List heads never have meaningful keys.
+				assert(next != this);
+				return Slice(keyData, keyLength);
+			}
+		};
+
+		// We provide our own simple hash table since it removes a whole bunch
+		// of porting hacks and is also faster than some of the built-in hash
+		// table implementations in some of the compiler/runtime combinations
+		// we have tested.  E.g., readrandom speeds up by ~5% over the g++
+		// 4.4.3's builtin hashtable.
+		class HandleTable {
+		public:
+			HandleTable() : length_(0), elems_(0), list_(nullptr) { resize(); }
+			~HandleTable() { delete[] list_; }
+
+			LRUHandle* lookUp(const Slice& key, uint32_t hash) {
+				return *findPointer(key, hash);
+			}
+
+			LRUHandle* insert(LRUHandle* h) {
+				LRUHandle** ptr = findPointer(h->key(), h->hash);
+				LRUHandle* old = *ptr;
+				h->nextHash = (old == nullptr ? nullptr : old->nextHash);
+				*ptr = h;
+				if (old == nullptr) {
+					++elems_;
+					if (elems_ > length_) {
+						// Since each cache entry is fairly large, we aim for a small
+						// average linked list length (<= 1).
+						resize();
+					}
+				}
+				return old;
+			}
+
+			LRUHandle* remove(const Slice& key, uint32_t hash) {
+				LRUHandle** ptr = findPointer(key, hash);
+				LRUHandle* result = *ptr;
+				if (result != nullptr) {
+					*ptr = result->nextHash;
+					--elems_;
+				}
+				return result;
+			}
+
+		private:
+			// The table consists of an array of buckets where each bucket is
+			// a linked list of cache entries that hash into the bucket.
+			uint32_t length_;
+			uint32_t elems_;
+			LRUHandle** list_;
+
+			// Return a pointer to slot that points to a cache entry that
+			// matches key/hash.  If there is no such cache entry, return a
+			// pointer to the trailing slot in the corresponding linked list.
+			LRUHandle** findPointer(const Slice& key, uint32_t hash) {
+				LRUHandle** ptr = &list_[hash & (length_ - 1)];
+				while (*ptr != nullptr && ((*ptr)->hash != hash || key != (*ptr)->key())) {
+					ptr = &(*ptr)->nextHash;
+				}
+				return ptr;
+			}
+
+			void resize() {
+				uint32_t newLength = 4;
+				while (newLength < elems_) {
+					newLength *= 2;
+				}
+				LRUHandle** newList = new LRUHandle*[newLength];
+				memset(newList, 0, sizeof(newList[0]) * newLength);
+				uint32_t count = 0;
+				for (uint32_t i = 0; i < length_; i++) {
+					LRUHandle* h = list_[i];
+					while (h != nullptr) {
+						LRUHandle* next = h->nextHash;
+						uint32_t hash = h->hash;
+						LRUHandle** ptr = &newList[hash & (newLength - 1)];
+						h->nextHash = *ptr;
+						*ptr = h;
+						h = next;
+						count++;
+					}
+				}
+				assert(elems_ == count);
+				delete[] list_;
+				list_ = newList;
+				length_ = newLength;
+			}
+		};
+
+		// an entry evicted for room, key and the contents saved by its helper
+		using Demoted = std::pair<std::string, std::string>;
+
+		// A single shard of sharded cache.
+		class LRUCacheShard {
+		public:
+			LRUCacheShard();
+			~LRUCacheShard();
+
+			// Separate from constructor so caller can easily make an array of LRUCacheShard
+			void setCapacity(size_t capacity, double highPriPoolRatio) {
+				capacity_ = capacity;
+				highPriCapacity_ = static_cast<size_t>(capacity * highPriPoolRatio);
+			}
+
+			// Like Cache methods, but with an extra "hash" parameter. the
+			// evicted entries that have a helper are appended to *demoted
+			Cache::Handle* insert(const Slice& key, uint32_t hash, void* value, size_t charge,
+				void (*deleter)(const Slice& key, void* value),
+				const Cache::CacheItemHelper* helper, bool highPri, std::vector<Demoted>* demoted);
+			Cache::Handle* lookUp(const Slice& key, uint32_t hash);
+			void release(Cache::Handle* handle);
+			void erase(const Slice& key, uint32_t hash);
+			void prune();
+			size_t totalCharge() const {
+				MutexLock l(&mutex_);
+				return usage_;
+			}
+
+		private:
+			void lruRemove(LRUHandle* e);
+			void lruAppend(LRUHandle* list, LRUHandle* e);
+			void ref(LRUHandle* e);
+			void unref(LRUHandle* e);
+			bool finishErase(LRUHandle* e) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+			LRUHandle* nextVictim() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+			// Initialized before use.
+			size_t capacity_;
+			size_t highPriCapacity_;
+
+			// mutex_ protects the following state.
+			mutable Mutex mutex_;
+			size_t usage_ GUARDED_BY(mutex_);
+			// charge of the high priority entries, in use or not
+			size_t highPriUsage_ GUARDED_BY(mutex_);
+
+			// Dummy head of LRU list.
+			// lru.prev is newest entry, lru.next is oldest entry.
+			// Entries have refs==1 and inCache==true.
+			LRUHandle lru_ GUARDED_BY(mutex_);
+
+			// Dummy head of the LRU list of the high priority entries.
+			LRUHandle highPriLru_ GUARDED_BY(mutex_);
+
+			// Dummy head of in-use list.
+			// Entries are in use by clients, and have refs >= 2 and inCache==true.
+			LRUHandle inUse_ GUARDED_BY(mutex_);
+
+			HandleTable table_ GUARDED_BY(mutex_);
+		};
+
+		LRUCacheShard::LRUCacheShard() : capacity_(0), highPriCapacity_(0), usage_(0), highPriUsage_(0) {
+			// Make empty circular linked lists.
+			lru_.next = &lru_;
+			lru_.prev = &lru_;
+			highPriLru_.next = &highPriLru_;
+			highPriLru_.prev = &highPriLru_;
+			inUse_.next = &inUse_;
+			inUse_.prev = &inUse_;
+		}
+
+		LRUCacheShard::~LRUCacheShard() {
+			assert(inUse_.next == &inUse_);  // Error if caller has an unreleased handle
+			for (LRUHandle* list : { &lru_, &highPriLru_ }) {
+				for (LRUHandle* e = list->next; e != list;) {
+					LRUHandle* next = e->next;
+					assert(e->inCache);
+					e->inCache = false;
+					assert(e->refs == 1);  // Invariant of lru_ list.
+					unref(e);
+					e = next;
+				}
+			}
+		}
+
+		void LRUCacheShard::ref(LRUHandle* e) {
+			if (e->refs == 1 && e->inCache) {  // If on lru_ list, move to inUse_ list.
+				lruRemove(e);
+				lruAppend(&inUse_, e);
+			}
+			e->refs++;
+		}
+
+		void LRUCacheShard::unref(LRUHandle* e) {
+			assert(e->refs > 0);
+			e->refs--;
+			if (e->refs == 0) {  // Deallocate.
+				assert(!e->inCache);
+				(*e->deleter)(e->key(), e->value);
+				free(e);
+			}
+			else if (e->inCache && e->refs == 1) {
+				// No longer in use; move to lru_ list.
+				lruRemove(e);
+				lruAppend(e->highPri ? &highPriLru_ : &lru_, e);
+			}
+		}
+
+		void LRUCacheShard::lruRemove(LRUHandle* e) {
+			e->next->prev = e->prev;
+			e->prev->next = e->next;
+		}
+
+		void LRUCacheShard::lruAppend(LRUHandle* list, LRUHandle* e) {
+			// Make "e" newest entry by inserting just before *list
+			e->next = list;
+			e->prev = list->prev;
+			e->prev->next = e;
+			e->next->prev = e;
+		}
+
+		Cache::Handle* LRUCacheShard::lookUp(const Slice& key, uint32_t hash) {
+			MutexLock l(&mutex_);
+			LRUHandle* e = table_.lookUp(key, hash);
+			if (e != nullptr) {
+				ref(e);
+			}
+			return reinterpret_cast<Cache::Handle*>(e);
+		}
+
+		void LRUCacheShard::release(Cache::Handle* handle) {
+			MutexLock l(&mutex_);
+			unref(reinterpret_cast<LRUHandle*>(handle));
+		}
+
+		Cache::Handle* LRUCacheShard::insert(const Slice& key, uint32_t hash, void* value,
+			size_t charge, void (*deleter)(const Slice& key, void* value),
+			const Cache::CacheItemHelper* helper, bool highPri, std::vector<Demoted>* demoted) {
+			MutexLock l(&mutex_);
+
+			LRUHandle* e =
+				reinterpret_cast<LRUHandle*>(malloc(sizeof(LRUHandle) - 1 + key.size()));
+			e->value = value;
+			e->deleter = deleter;
+			e->helper = helper;
+			e->highPri = highPri;
+			e->charge = charge;
+			e->keyLength = key.size();
+			e->hash = hash;
+			e->inCache = false;
+			e->refs = 1;  // for the returned handle.
+			std::memcpy(e->keyData, key.data(), key.size());
+
+			if (capacity_ > 0) {
+				e->refs++;  // for the cache's reference.
+				e->inCache = true;
+				lruAppend(&inUse_, e);
+				usage_ += charge;
+				if (highPri) {
+					highPriUsage_ += charge;
+				}
+				finishErase(table_.insert(e));
+			}
+			else {  // don't cache. (capacity_==0 is supported and turns off caching.)
+				// next is read by key() in an assert, so it must be initialized
+				e->next = nullptr;
+			}
+			LRUHandle* old;
+			while (usage_ > capacity_ && (old = nextVictim()) != nullptr) {
+				assert(old->refs == 1);
+				// saving is a copy, the caller compresses outside the lock
+				if (demoted != nullptr && old->helper != nullptr && old->helper->saveTo != nullptr) {
+					demoted->emplace_back(std::string(old->key()), std::string());
+					old->helper->saveTo(old->value, &demoted->back().second);
+				}
+				bool erased = finishErase(table_.remove(old->key(), old->hash));
+				if (!erased) {  // to avoid unused variable when compiled NDEBUG
+					assert(erased);
+				}
+			}
+
+			return reinterpret_cast<Cache::Handle*>(e);
+		}
+
+		// the oldest unused low priority entry, or the oldest high priority one
+		// when there is none or their pool has grown past its share
+		LRUHandle* LRUCacheShard::nextVictim() {
+			const bool highPriFull = highPriUsage_ > highPriCapacity_;
+			if (lru_.next != &lru_ && !(highPriFull && highPriLru_.next != &highPriLru_)) {
+				return lru_.next;
+			}
+			if (highPriLru_.next != &highPriLru_) {
+				return highPriLru_.next;
+			}
+			return nullptr;
+		}
+
+		// If e != nullptr, finish removing *e from the cache; it has already been
+		// removed from the hash table.  Return whether e != nullptr.
+		bool LRUCacheShard::finishErase(LRUHandle* e) {
+			if (e != nullptr) {
+				assert(e->inCache);
+				lruRemove(e);
+				e->inCache = false;
+				usage_ -= e->charge;
+				if (e->highPri) {
+					highPriUsage_ -= e->charge;
+				}
+				unref(e);
+			}
+			return e != nullptr;
+		}
+
+		void LRUCacheShard::erase(const Slice& key, uint32_t hash) {
+			MutexLock l(&mutex_);
+			finishErase(table_.remove(key, hash));
+		}
+
+		void LRUCacheShard::prune() {
+			MutexLock l(&mutex_);
+			for (LRUHandle* list : { &lru_, &highPriLru_ }) {
+				while (list->next != list) {
+					LRUHandle* e = list->next;
+					assert(e->refs == 1);
+					bool erased = finishErase(table_.remove(e->key(), e->hash));
+					if (!erased) {  // to avoid unused variable when compiled NDEBUG
+						assert(erased);
+					}
+				}
+			}
+		}
+
+		static const int KNumShardBits = 4;
+		static const int KNumShards = 1 << KNumShardBits;
+
+		class ShardedLRUCache : public Cache {
+		public:
+			ShardedLRUCache(size_t capacity, SecondaryCache* secondary, double highPriPoolRatio)
+				: lastId_(0), secondary_(secondary) {
+				const size_t perShard = (capacity + (KNumShards - 1)) / KNumShards;
+				for (int s = 0; s < KNumShards; s++) {
+					shard_[s].setCapacity(perShard, highPriPoolRatio);
+				}
+			}
+
+			~ShardedLRUCache() override {}
+
+			Handle* insert(const Slice& key, void* value, size_t charge,
+				void (*deleter)(const Slice& key, void* value)) override {
+				const uint32_t hash = hashSlice(key);
+				return shard_[shard(hash)].insert(key, hash, value, charge, deleter, nullptr, false, nullptr);
+			}
+
+			Handle* insert(const Slice& key, void* value, size_t charge,
+				const CacheItemHelper* helper, Priority priority) override {
+				const uint32_t hash = hashSlice(key);
+				std::vector<Demoted> demoted;
+				Handle* h = shard_[shard(hash)].insert(key, hash, value, charge, helper->deleter,
+					helper, priority == KHighPriority, secondary_ != nullptr ? &demoted : nullptr);
+				for (const Demoted& d : demoted) {
+					secondary_->insert(d.first, d.second);
+				}
+				return h;
+			}
+
+			Handle* lookUp(const Slice& key) override {
+				const uint32_t hash = hashSlice(key);
+				return shard_[shard(hash)].lookUp(key, hash);
+			}
+
+			Handle* lookUp(const Slice& key, const CacheItemHelper* helper) override {
+				Handle* h = lookUp(key);
+				if (h != nullptr || secondary_ == nullptr || helper == nullptr || helper->create == nullptr) {
+					return h;
+				}
+				std::string contents;
+				if (!secondary_->lookUp(key, &contents)) {
+					return nullptr;
+				}
+				size_t charge = 0;
+				void* value = helper->create(contents, &charge);
+				if (value == nullptr) {
+					return nullptr;
+				}
+				// the tiers hold an entry once, it goes back to the secondary
+				// cache when it is evicted again, unless that one kept it
+				if (!secondary_->keepsPromotedEntries()) {
+					secondary_->erase(key);
+				}
+				return insert(key, value, charge, helper, KLowPriority);
+			}
+
+			void release(Handle* handle) override {
+				LRUHandle* h = reinterpret_cast<LRUHandle*>(handle);
+				shard_[shard(h->hash)].release(handle);
+			}
+
+			void erase(const Slice& key) override {
+				const uint32_t hash = hashSlice(key);
+				shard_[shard(hash)].erase(key, hash);
+				if (secondary_ != nullptr) {
+					secondary_->erase(key);
+				}
+			}
+
+			void* value(Handle* handle) override {
+				return reinterpret_cast<LRUHandle*>(handle)->value;
+			}
+
+			uint64_t newId() override {
+				MutexLock l(&idMutex_);
+				return ++(lastId_);
+			}
+
+			void prune() override {
+				for (int s = 0; s < KNumShards; s++) {
+					shard_[s].prune();
+				}
+			}
+
+			size_t totalCharge() const override {
+				size_t total = 0;
+				for (int s = 0; s < KNumShards; s++) {
+					total += shard_[s].totalCharge();
+				}
+				return total;
+			}
+
+		private:
+			static inline uint32_t hashSlice(const Slice& s) {
+				return Hash(s.data(), s.size(), 0);
+			}
+
+			static uint32_t shard(uint32_t hash) { return hash >> (32 - KNumShardBits); }
+
+			LRUCacheShard shard_[KNumShards];
+			Mutex idMutex_;
+			uint64_t lastId_;
+			SecondaryCache* const secondary_;
+		};
+
+	}
+
+	Cache* newLRUCache(size_t capacity) { return new ShardedLRUCache(capacity, nullptr, 0.5); }
+
+	Cache* newLRUCache(size_t capacity, SecondaryCache* secondary, double highPriPoolRatio) {
+		return new ShardedLRUCache(capacity, secondary, highPriPoolRatio);
+	}
+
+}
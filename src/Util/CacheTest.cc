@@ -0,0 +1,181 @@
+#include "CDataBase/Cache.h"
+
+#include <memory>
+#include <string>
+#include "CDataBase/SecondaryCache.h"
+#include "gtest/gtest.h"
+
+namespace CDB{
+
+	namespace {
+
+		int gDeleted = 0;
+
+		void deleteBlock(const Slice& key, void* value) {
+			(void)key;
+			++gDeleted;
+			delete reinterpret_cast<std::string*>(value);
+		}
+
+		void saveBlock(void* value, std::string* dst) {
+			*dst = *reinterpret_cast<std::string*>(value);
+		}
+
+		void* createBlock(const Slice& contents, size_t* charge) {
+			*charge = contents.size();
+			return new std::string(contents);
+		}
+
+		const Cache::CacheItemHelper KBlockHelper = { &deleteBlock, &saveBlock, &createBlock };
+
+		// a block that compresses well, tagged so every key has its own
+		std::string block(int i) {
+			return std::to_string(i) + std::string(1000, 'a' + i % 26);
+		}
+
+		std::string key(int i) { return "block" + std::to_string(i); }
+
+	}
+
+	class CacheTest : public testing::Test {
+	protected:
+		void SetUp() override { gDeleted = 0; }
+
+		void insert(Cache* cache, int i) {
+			std::string* value = new std::string(block(i));
+			cache->release(cache->insert(key(i), value, value->size(), &KBlockHelper));
+		}
+
+		// the block of key i through cache, empty on a miss
+		std::string lookUp(Cache* cache, int i) {
+			Cache::Handle* h = cache->lookUp(key(i), &KBlockHelper);
+			if (h == nullptr) {
+				return std::string();
+			}
+			std::string result = *reinterpret_cast<std::string*>(cache->value(h));
+			cache->release(h);
+			return result;
+		}
+	};
+
+	TEST_F(CacheTest, HitAndMiss) {
+		std::unique_ptr<Cache> cache(newLRUCache(1 << 20));
+		ASSERT_EQ("", lookUp(cache.get(), 1));
+		insert(cache.get(), 1);
+		ASSERT_EQ(block(1), lookUp(cache.get(), 1));
+		insert(cache.get(), 1);
+		ASSERT_EQ(1, gDeleted);
+		cache->erase(key(1));
+		ASSERT_EQ(2, gDeleted);
+		ASSERT_EQ("", lookUp(cache.get(), 1));
+	}
+
+	TEST_F(CacheTest, EvictsLeastRecentlyUsed) {
+		// one shard holds a few blocks, the keys spread over all shards
+		std::unique_ptr<Cache> cache(newLRUCache(16 * 1024 * 4));
+		for (int i = 0; i < 1000; ++i) {
+			insert(cache.get(), i);
+			// key 0 stays warm
+			ASSERT_EQ(block(0), lookUp(cache.get(), 0));
+		}
+		ASSERT_LE(cache->totalCharge(), 16 * 1024 * 4u);
+		ASSERT_EQ(block(0), lookUp(cache.get(), 0));
+		ASSERT_EQ("", lookUp(cache.get(), 1));
+	}
+
+	TEST_F(CacheTest, PinnedEntriesAreNotEvicted) {
+		std::unique_ptr<Cache> cache(newLRUCache(0));
+		std::string* value = new std::string(block(1));
+		Cache::Handle* h = cache->insert(key(1), value, value->size(), &KBlockHelper);
+		ASSERT_EQ(block(1), *reinterpret_cast<std::string*>(cache->value(h)));
+		ASSERT_EQ(0, gDeleted);
+		cache->release(h);
+		ASSERT_EQ(1, gDeleted);
+	}
+
+	TEST_F(CacheTest, HighPriorityEntriesOutliveScans) {
+		// the pool may take all of a shard, the keys do not spread evenly
+		std::unique_ptr<Cache> cache(newLRUCache(16 * 1024 * 4, nullptr, 1.0));
+		for (int i = 0; i < 16; ++i) {
+			std::string* value = new std::string(block(i));
+			cache->release(cache->insert(key(i), value, value->size(), &KBlockHelper, Cache::KHighPriority));
+		}
+		for (int i = 100; i < 2000; ++i) {
+			insert(cache.get(), i);
+		}
+		for (int i = 0; i < 16; ++i) {
+			ASSERT_EQ(block(i), lookUp(cache.get(), i)) << i;
+		}
+	}
+
+	TEST_F(CacheTest, HighPriorityPoolIsBounded) {
+		std::unique_ptr<Cache> cache(newLRUCache(16 * 1024 * 4, nullptr, 0.25));
+		for (int i = 0; i < 2000; ++i) {
+			std::string* value = new std::string(block(i));
+			cache->release(cache->insert(key(i), value, value->size(), &KBlockHelper, Cache::KHighPriority));
+		}
+		// low priority entries still find room next to a full high priority pool
+		for (int i = 5000; i < 5010; ++i) {
+			insert(cache.get(), i);
+			ASSERT_EQ(block(i), lookUp(cache.get(), i));
+		}
+		ASSERT_LE(cache->totalCharge(), 16 * 1024 * 4u);
+	}
+
+	TEST_F(CacheTest, MissIsServedBySecondaryCache) {
+		std::unique_ptr<SecondaryCache> secondary(newCompressedSecondaryCache(1 << 20));
+		std::unique_ptr<Cache> cache(newLRUCache(16 * 1024 * 4, secondary.get()));
+		for (int i = 0; i < 200; ++i) {
+			insert(cache.get(), i);
+		}
+		ASSERT_GT(secondary->totalCharge(), 0u);
+		// every block is in one of the tiers
+		for (int i = 0; i < 200; ++i) {
+			ASSERT_EQ(block(i), lookUp(cache.get(), i)) << i;
+		}
+		// a plain look up does not reach the secondary cache
+		int misses = 0;
+		for (int i = 0; i < 200; ++i) {
+			Cache::Handle* h = cache->lookUp(key(i));
+			if (h == nullptr) {
+				++misses;
+			}
+			else {
+				cache->release(h);
+			}
+		}
+		ASSERT_GT(misses, 0);
+	}
+
+	TEST_F(CacheTest, EraseDropsBothTiers) {
+		std::unique_ptr<SecondaryCache> secondary(newCompressedSecondaryCache(1 << 20));
+		std::unique_ptr<Cache> cache(newLRUCache(16 * 1024 * 4, secondary.get()));
+		for (int i = 0; i < 200; ++i) {
+			insert(cache.get(), i);
+		}
+		for (int i = 0; i < 200; ++i) {
+			cache->erase(key(i));
+		}
+		ASSERT_EQ(0u, secondary->totalCharge());
+		for (int i = 0; i < 200; ++i) {
+			ASSERT_EQ("", lookUp(cache.get(), i));
+		}
+	}
+
+	TEST(CompressedSecondaryCacheTest, RoundTrip) {
+		for (CompressionType type : { KNoCompression, KSnappyCompression,
+			KZstdCompression, KLZ4Compression }) {
+			std::unique_ptr<SecondaryCache> secondary(newCompressedSecondaryCache(1 << 20, type));
+			std::string contents(4096, 'x');
+			secondary->insert("k", contents);
+			ASSERT_LE(secondary->totalCharge(), contents.size() + 1);
+			std::string found;
+			ASSERT_TRUE(secondary->lookUp("k", &found));
+			ASSERT_EQ(contents, found);
+			ASSERT_FALSE(secondary->lookUp("other", &found));
+			secondary->erase("k");
+			ASSERT_FALSE(secondary->lookUp("k", &found));
+		}
+	}
+
+}
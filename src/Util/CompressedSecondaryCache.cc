@@ -0,0 +1,125 @@
+/*!
+ * \file CompressedSecondaryCache.cc
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#include "CDataBase/SecondaryCache.h"
+
+#include <memory>
+#include "CDataBase/Cache.h"
+#include "Port/Port.h"
+
+namespace CDB{
+
+	namespace {
+
+		/*!
+		 * \class CompressedSecondaryCache
+		 *
+		 * \brief keeps the contents in an lru cache of its own, each entry
+		 *  is a type byte followed by the contents compressed with that type
+		 *
+		 * \author czy
+		 * \date 2026.10.19
+		 */
+		class CompressedSecondaryCache : public SecondaryCache {
+		public:
+			CompressedSecondaryCache(size_t capacity, CompressionType type)
+				: cache_(newLRUCache(capacity)), type_(type) {}
+
+			const char* name() const override { return "CDB.CompressedSecondaryCache"; }
+
+			void insert(const Slice& key, const Slice& contents) override {
+				std::string* entry = new std::string;
+				entry->push_back(static_cast<char>(KNoCompression));
+				std::string compressed;
+				// a saving under 1/8 is not worth a decompression on every hit
+				if (compress(contents, &compressed) &&
+					compressed.size() < contents.size() - (contents.size() / 8u)) {
+					(*entry)[0] = static_cast<char>(type_);
+					entry->append(compressed);
+				}
+				else {
+					entry->append(contents.data(), contents.size());
+				}
+				cache_->release(cache_->insert(key, entry, entry->size(), &deleteEntry));
+			}
+
+			bool lookUp(const Slice& key, std::string* contents) override {
+				Cache::Handle* h = cache_->lookUp(key);
+				if (h == nullptr) {
+					return false;
+				}
+				const std::string* entry = reinterpret_cast<std::string*>(cache_->value(h));
+				const bool ok = uncompress(static_cast<CompressionType>((*entry)[0]),
+					Slice(entry->data() + 1, entry->size() - 1), contents);
+				cache_->release(h);
+				return ok;
+			}
+
+			void erase(const Slice& key) override { cache_->erase(key); }
+
+			size_t totalCharge() const override { return cache_->totalCharge(); }
+
+		private:
+			static void deleteEntry(const Slice& key, void* value) {
+				(void)key;
+				delete reinterpret_cast<std::string*>(value);
+			}
+
+			bool compress(const Slice& raw, std::string* output) const {
+				switch (type_) {
+				case KSnappyCompression:
+					return port::Snappy_Compress(raw.data(), raw.size(), output);
+				case KZstdCompression:
+					return port::Zstd_Compress(1, raw.data(), raw.size(), output);
+				case KLZ4Compression:
+					return port::LZ4_Compress(raw.data(), raw.size(), output);
+				default:
+					return false;
+				}
+			}
+
+			static bool uncompress(CompressionType type, const Slice& data, std::string* output) {
+				size_t n = 0;
+				switch (type) {
+				case KNoCompression:
+					output->assign(data.data(), data.size());
+					return true;
+				case KSnappyCompression:
+					if (!port::Snappy_GetUncompressedLength(data.data(), data.size(), &n)) {
+						return false;
+					}
+					output->resize(n);
+					return port::Snappy_Uncompress(data.data(), data.size(), output->data());
+				case KZstdCompression:
+					if (!port::Zstd_GetUncompressedLength(data.data(), data.size(), &n)) {
+						return false;
+					}
+					output->resize(n);
+					return port::Zstd_Uncompress(data.data(), data.size(), output->data());
+				case KLZ4Compression:
+					if (!port::LZ4_GetUncompressedLength(data.data(), data.size(), &n)) {
+						return false;
+					}
+					output->resize(n);
+					return port::LZ4_Uncompress(data.data(), data.size(), output->data());
+				default:
+					return false;
+				}
+			}
+
+			const std::unique_ptr<Cache> cache_;
+			const CompressionType type_;
+		};
+
+	}
+
+	SecondaryCache* newCompressedSecondaryCache(size_t capacity, CompressionType type) {
+		return new CompressedSecondaryCache(capacity, type);
+	}
+
+}
@@ -1,30 +1,124 @@
-#include <dirent.h>
-#include <fcntl.h>
-#include <sys/mman.h>
-#ifndef __Fuchsia__
-#include <sys/resource.h>
-#endif
-#include <sys/stat.h>
-#include <sys/time.h>
-#include <sys/types.h>
-#include <unistd.h>
-
-#include <atomic>
-#include <cerrno>
-#include <cstddef>
-#include <cstdint>
-#include <cstdio>
-#include <cstdlib>
-#include <cstring>
-#include <limits>
-#include <queue>
-#include <set>
-#include <string>
-#include <thread>
-#include <type_traits>
-#include <utility>
-#include "CDataBase/Env.h"
-#include "CDataBase/Slice.h"
-#include "CDataBase/Status.h"
-#include "Util/ThreadAnnotations.h"
-
+#include "CDataBase/Env.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include "CDataBase/Slice.h"
+#include "CDataBase/Status.h"
+
+namespace CDB{
+
+	Env::Env() = default;
+
+	bool Env::fileExists(const std::string& fname)
+	{
+		uint64_t size;
+		return getFileSize(fname, &size).ok();
+	}
+
+	// removeFile and deleteFile are the same operation under two names, an
+	// Env overrides one of them
+	Status Env::removeFile(const std::string& fname) { return deleteFile(fname); }
+
+	Status Env::deleteFile(const std::string& fname) { return removeFile(fname); }
+
+	Status Env::removeDir(const std::string& dirname) { return deleteDir(dirname); }
+
+	Status Env::deleteDir(const std::string& dirname) { return removeDir(dirname); }
+
+	Status Env::reuseWritableFile(const std::string& fname, const std::string& oldFname,
+		WritableFile** result)
+	{
+		Status s = renameFile(oldFname, fname);
+		if (!s.ok()) {
+			*result = nullptr;
+			return s;
+		}
+		return newWritableFile(fname, result);
+	}
+
+	SequentialFile::~SequentialFile() = default;
+
+	RandomAccessFile::~RandomAccessFile() = default;
+
+	Status RandomAccessFile::prefetch(uint64_t offset, size_t n) const
+	{
+		return Status::OK();
+	}
+
+	WritableFile::~WritableFile() = default;
+
+	Status WritableFile::preallocate(uint64_t bytes)
+	{
+		return Status::OK();
+	}
+
+	Logger::~Logger() = default;
+
+	FileLock::~FileLock() = default;
+
+	EnvWrapper::~EnvWrapper() = default;
+
+	void Log(Logger* infoLog, const char* format, ...)
+	{
+		if (infoLog != nullptr) {
+			std::va_list ap;
+			va_start(ap, format);
+			infoLog->Logv(format, ap);
+			va_end(ap);
+		}
+	}
+
+	static Status doWriteStringToFile(Env* env, const Slice& data, const std::string& fname,
+		bool shouldSync)
+	{
+		WritableFile* file;
+		Status s = env->newWritableFile(fname, &file);
+		if (!s.ok()) {
+			return s;
+		}
+		s = file->append(data);
+		if (s.ok() && shouldSync) {
+			s = file->sync();
+		}
+		if (s.ok()) {
+			s = file->close();
+		}
+		delete file;  // Will auto-close if we did not close above
+		if (!s.ok()) {
+			env->removeFile(fname);
+		}
+		return s;
+	}
+
+	Status WriteStringToFile(Env* env, const Slice& data, const std::string& fname)
+	{
+		return doWriteStringToFile(env, data, fname, false);
+	}
+
+	Status ReadFileToString(Env* env, const std::string& fname, std::string* data)
+	{
+		data->clear();
+		SequentialFile* file;
+		Status s = env->newSequentialFile(fname, &file);
+		if (!s.ok()) {
+			return s;
+		}
+		static const int kBufferSize = 8192;
+		char* space = new char[kBufferSize];
+		while (true) {
+			Slice fragment;
+			s = file->read(kBufferSize, &fragment, space);
+			if (!s.ok()) {
+				break;
+			}
+			data->append(fragment.data(), fragment.size());
+			if (fragment.empty()) {
+				break;
+			}
+		}
+		delete[] space;
+		delete file;
+		return s;
+	}
+
+}
@@ -1,49 +1,49 @@
-
-#include "Util/Hash.h"
-
-#include "Util/Coding.h"
-
-#include <cstring>
-
-#ifndef FALLTHROUGH_INTENDED 
-#define FALLTHROUGH_INTENDED  \
-do{\
-}while(0)
-
-#endif
-
-
-namespace CDB{
-	/*!
-	 *  @brief A Func that hash a  C-Style-String  
-	 *  @param
-	 *  @return a number indicate the hash Result;
-	 */
-	uint32_t Hash(const char *data,size_t n,uint32_t seed){
-		const uint32_t m = 0xc6a4a793;
-		const uint32_t r = 24;
-		const char* limit = data + n;
-		uint32_t h = seed ^ (n * m);
-		while(data + 4 <= limit){
-			uint32_t w = DecodeFixed32(data);
-			data += 4;
-			h += w;
-			h *= m;
-			h ^= (h>>16);
-		}
-		switch(limit - data){
-		case 3:
-			h += static_cast<uint8_t> (data[2]) << 16;
-			FALLTHROUGH_INTENDED;
-		case 2:
-			h += static_cast<uint8_t> (data[1]) << 8;
-			FALLTHROUGH_INTENDED;
-		case 1:
-			h += static_cast<uint8_t>(data[0]);
-			h *= m;
-			h ^= (h >> r);
-			break;
-		}
-		return h;
-	}
-}
+
+#include "Util/Hash.h"
+
+#include "Util/Coding.h"
+
+#include <cstring>
+
+#ifndef FALLTHROUGH_INTENDED 
+#define FALLTHROUGH_INTENDED  \
+do{\
+}while(0)
+
+#endif
+
+
+namespace CDB{
+	/*!
+	 *  @brief A Func that hash a  C-Style-String  
+	 *  @param
+	 *  @return a number indicate the hash Result;
+	 */
+	uint32_t Hash(const char *data,size_t n,uint32_t seed){
+		const uint32_t m = 0xc6a4a793;
+		const uint32_t r = 24;
+		const char* limit = data + n;
+		uint32_t h = seed ^ (n * m);
+		while(data + 4 <= limit){
+			uint32_t w = DecodeFixed32(data);
+			data += 4;
+			h += w;
+			h *= m;
+			h ^= (h>>16);
+		}
+		switch(limit - data){
+		case 3:
+			h += static_cast<uint8_t> (data[2]) << 16;
+			FALLTHROUGH_INTENDED;
+		case 2:
+			h += static_cast<uint8_t> (data[1]) << 8;
+			FALLTHROUGH_INTENDED;
+		case 1:
+			h += static_cast<uint8_t>(data[0]);
+			h *= m;
+			h ^= (h >> r);
+			break;
+		}
+		return h;
+	}
+}
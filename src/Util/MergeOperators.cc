@@ -0,0 +1,112 @@
+#include "CDataBase/MergeOperator.h"
+
+#include "CDataBase/Env.h"
+#include "Util/Coding.h"
+
+namespace CDB{
+
+	MergeOperator::~MergeOperator() = default;
+
+	bool MergeOperator::partialMerge(const Slice& key, const Slice& leftOperand,
+		const Slice& rightOperand, std::string* newValue, Logger* logger) const
+	{
+		return false;
+	}
+
+	bool AssociativeMergeOperator::fullMerge(const Slice& key, const Slice* existingValue,
+		const std::vector<Slice>& operands, std::string* newValue, Logger* logger) const
+	{
+		std::string temp;
+		Slice current;
+		const Slice* existing = existingValue;
+		for (const Slice& operand : operands) {
+			temp.clear();
+			if (!merge(key, existing, operand, &temp, logger)) {
+				return false;
+			}
+			newValue->swap(temp);
+			current = *newValue;
+			existing = &current;
+		}
+		if (operands.empty() && existingValue != nullptr) {
+			newValue->assign(existingValue->data(), existingValue->size());
+		}
+		return true;
+	}
+
+	bool AssociativeMergeOperator::partialMerge(const Slice& key, const Slice& leftOperand,
+		const Slice& rightOperand, std::string* newValue, Logger* logger) const
+	{
+		return merge(key, &leftOperand, rightOperand, newValue, logger);
+	}
+
+	namespace {
+
+		class UInt64AddOperator : public AssociativeMergeOperator{
+		public:
+			bool merge(const Slice& key, const Slice* existingValue, const Slice& value,
+				std::string* newValue, Logger* logger) const override
+			{
+				uint64_t base = 0;
+				if (existingValue != nullptr && !decode(*existingValue, &base, logger)) {
+					return false;
+				}
+				uint64_t operand;
+				if (!decode(value, &operand, logger)) {
+					return false;
+				}
+				newValue->clear();
+				PutFixed64(newValue, base + operand);
+				return true;
+			}
+
+			const char* name() const override { return "UInt64AddOperator"; }
+
+		private:
+			static bool decode(const Slice& value, uint64_t* result, Logger* logger)
+			{
+				if (value.size() != sizeof(uint64_t)) {
+					Log(logger, "uint64 add operator: value of %zu bytes", value.size());
+					return false;
+				}
+				*result = DecodeFixed64(value.data());
+				return true;
+			}
+		};
+
+		class StringAppendOperator : public AssociativeMergeOperator{
+		public:
+			explicit StringAppendOperator(char delim) : delim_(delim) {}
+
+			bool merge(const Slice& key, const Slice* existingValue, const Slice& value,
+				std::string* newValue, Logger* logger) const override
+			{
+				newValue->clear();
+				if (existingValue != nullptr) {
+					newValue->reserve(existingValue->size() + 1 + value.size());
+					newValue->assign(existingValue->data(), existingValue->size());
+					newValue->push_back(delim_);
+				}
+				newValue->append(value.data(), value.size());
+				return true;
+			}
+
+			const char* name() const override { return "StringAppendOperator"; }
+
+		private:
+			const char delim_;
+		};
+
+	}
+
+	const MergeOperator* newUInt64AddOperator()
+	{
+		return new UInt64AddOperator;
+	}
+
+	const MergeOperator* newStringAppendOperator(char delim)
+	{
+		return new StringAppendOperator(delim);
+	}
+
+}
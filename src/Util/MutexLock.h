@@ -1,90 +1,165 @@
-/*!
- * \file MutexLock.h
- *
- * \author czy
- * \date 2023.07.29
- *
- * 
- */
-#pragma once
-#include "Util/ThreadAnnotations.h"
-#include <cassert>
-#include <condition_variable>  // NOLINT
-#include <cstddef>
-#include <cstdint>
-#include <mutex>  // NOLINT
-#include <string>
-
-namespace CDB{
-	class CondVar;
-
-	class LOCKABLE Mutex{
-	public:
-		Mutex() = default;
-		~Mutex() = default;
-
-		Mutex(const Mutex&) = delete;
-
-		Mutex& operator=(const Mutex&) = delete;
-
-		void lock() EXCLUSIVE_LOCK_FUNCTION() { mu_.lock(); }
-
-		void unlock() UNLOCK_FUNCTION() { mu_.unlock(); }
-
-		void assrtHeld() ASSERT_EXCLUSIVE_LOCK() {}
-			
-
-	private:
-		friend class CondVar;
-		std::mutex mu_;
-	};
-
-	class CondVar{
-	public:
-		explicit CondVar(Mutex * mu)
-			:mu_(mu)
-		{
-			assert(mu_ != nullptr);
-		}
-
-		~CondVar() = default;
-
-		CondVar(const CondVar&) = delete;
-
-		CondVar& operator=(const CondVar&) = delete;
-
-		void wait(){
-			///adopt lock mutex,
-			///ǻĽ
-			std::unique_lock<std::mutex> lock(mu_->mu_,std::adopt_lock);
-			cv_.wait(lock);
-			lock.release();
-		}
-
-		void signal(){
-			cv_.notify_one();
-		}
-		void signalAll(){
-			cv_.notify_all();
-		}
-
-	private:
-		Mutex* const mu_;
-		std::condition_variable cv_;
-	};
-
-
-	class SCOPED_LOCKABLE MutexLock {
-	public:
-		explicit MutexLock(Mutex* mu) EXCLUSIVE_LOCK_FUNCTION(mu) : mu_(mu) {
-			this->mu_->lock();
-		}
-		~MutexLock() UNLOCK_FUNCTION() { this->mu_->unlock(); }
-
-		MutexLock(const MutexLock&) = delete;
-		MutexLock& operator=(const MutexLock&) = delete;
-
-	private:
-		Mutex* const mu_;
-	};
+/*!
+ * \file MutexLock.h
+ *
+ * \author czy
+ * \date 2023.07.29
+ *
+ * 
+ */
+#pragma once
+#include "Util/ThreadAnnotations.h"
+#include <atomic>
+#include <cassert>
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>  // NOLINT
+#include <string>
+#include "Port/Port.h"
+
+namespace CDB{
+	class CondVar;
+
+	/// an adaptive mutex spins for a short while before it parks the
+	/// thread, critical sections of a few hundred nanoseconds are over
+	/// before a futex round trip would be
+	class LOCKABLE Mutex{
+	public:
+		// number of try_lock attempts before an adaptive mutex parks
+		static constexpr int KMaxSpins = 20;
+
+		// upper bound of the pause instructions between two attempts
+		static constexpr int KMaxBackoff = 8;
+
+		struct Stats {
+			// lock() calls that found the mutex held
+			uint64_t contended = 0;
+			// contended calls that got the mutex while spinning
+			uint64_t spinAcquired = 0;
+			// contended calls that had to block
+			uint64_t parked = 0;
+
+			std::string toString() const {
+				char buf[100];
+				std::snprintf(buf, sizeof(buf), "contended=%llu spin_acquired=%llu parked=%llu",
+					static_cast<unsigned long long>(contended),
+					static_cast<unsigned long long>(spinAcquired),
+					static_cast<unsigned long long>(parked));
+				return buf;
+			}
+		};
+
+		explicit Mutex(bool adaptive = false)
+			:adaptive_(adaptive), contended_(0), spinAcquired_(0), parked_(0) {}
+		~Mutex() = default;
+
+		Mutex(const Mutex&) = delete;
+
+		Mutex& operator=(const Mutex&) = delete;
+
+		void lock() EXCLUSIVE_LOCK_FUNCTION() {
+			if (mu_.try_lock()) {
+				return;
+			}
+			contended_.fetch_add(1, std::memory_order_relaxed);
+			if (adaptive_ && spin()) {
+				spinAcquired_.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			parked_.fetch_add(1, std::memory_order_relaxed);
+			mu_.lock();
+		}
+
+		bool tryLock() EXCLUSIVE_TRYLOCK_FUNCTION(true) { return mu_.try_lock(); }
+
+		void unlock() UNLOCK_FUNCTION() { mu_.unlock(); }
+
+		void assrtHeld() ASSERT_EXCLUSIVE_LOCK() {}
+
+		bool adaptive() const { return adaptive_; }
+
+		Stats stats() const {
+			Stats s;
+			s.contended = contended_.load(std::memory_order_relaxed);
+			s.spinAcquired = spinAcquired_.load(std::memory_order_relaxed);
+			s.parked = parked_.load(std::memory_order_relaxed);
+			return s;
+		}
+
+	private:
+		friend class CondVar;
+
+		/// true if the mutex was taken within the spin budget
+		bool spin() NO_THREAD_SAFETY_ANALYSIS {
+			int backoff = 1;
+			for (int i = 0; i < KMaxSpins; ++i) {
+				for (int j = 0; j < backoff; ++j) {
+					port::cpuRelax();
+				}
+				if (backoff < KMaxBackoff) {
+					backoff <<= 1;
+				}
+				if (mu_.try_lock()) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		std::mutex mu_;
+		const bool adaptive_;
+		std::atomic<uint64_t> contended_;
+		std::atomic<uint64_t> spinAcquired_;
+		std::atomic<uint64_t> parked_;
+	};
+
+	class CondVar{
+	public:
+		explicit CondVar(Mutex * mu)
+			:mu_(mu)
+		{
+			assert(mu_ != nullptr);
+		}
+
+		~CondVar() = default;
+
+		CondVar(const CondVar&) = delete;
+
+		CondVar& operator=(const CondVar&) = delete;
+
+		void wait(){
+			///adopt lock mutex,
+			///ǻĽ
+			std::unique_lock<std::mutex> lock(mu_->mu_,std::adopt_lock);
+			cv_.wait(lock);
+			lock.release();
+		}
+
+		void signal(){
+			cv_.notify_one();
+		}
+		void signalAll(){
+			cv_.notify_all();
+		}
+
+	private:
+		Mutex* const mu_;
+		std::condition_variable cv_;
+	};
+
+
+	class SCOPED_LOCKABLE MutexLock {
+	public:
+		explicit MutexLock(Mutex* mu) EXCLUSIVE_LOCK_FUNCTION(mu) : mu_(mu) {
+			this->mu_->lock();
+		}
+		~MutexLock() UNLOCK_FUNCTION() { this->mu_->unlock(); }
+
+		MutexLock(const MutexLock&) = delete;
+		MutexLock& operator=(const MutexLock&) = delete;
+
+	private:
+		Mutex* const mu_;
+	};
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "Util/MutexLock.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace CDB{
+
+	static void hammer(Mutex* mu, int* counter, int threads, int iterations)
+	{
+		std::vector<std::thread> workers;
+		for (int t = 0; t < threads; ++t) {
+			workers.emplace_back([=] {
+				for (int i = 0; i < iterations; ++i) {
+					MutexLock l(mu);
+					++*counter;
+				}
+			});
+		}
+		for (auto& worker : workers) {
+			worker.join();
+		}
+	}
+
+	TEST(Mutex, Adaptive) {
+		Mutex mu(true);
+		ASSERT_TRUE(mu.adaptive());
+		int counter = 0;
+		hammer(&mu, &counter, 4, 100000);
+		ASSERT_EQ(400000, counter);
+
+		Mutex::Stats s = mu.stats();
+		ASSERT_EQ(s.contended, s.spinAcquired + s.parked);
+	}
+
+	TEST(Mutex, Blocking) {
+		Mutex mu;
+		int counter = 0;
+		hammer(&mu, &counter, 4, 100000);
+		ASSERT_EQ(400000, counter);
+
+		// a blocking mutex never spins
+		Mutex::Stats s = mu.stats();
+		ASSERT_EQ(0u, s.spinAcquired);
+		ASSERT_EQ(s.contended, s.parked);
+	}
+
+	TEST(Mutex, TryLock) {
+		Mutex mu(true);
+		ASSERT_TRUE(mu.tryLock());
+		std::thread other([&mu] { ASSERT_FALSE(mu.tryLock()); });
+		other.join();
+		mu.unlock();
+
+		// the holder lets go while the waiter spins
+		mu.lock();
+		std::thread waiter([&mu] {
+			mu.lock();
+			mu.unlock();
+		});
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		mu.unlock();
+		waiter.join();
+		ASSERT_EQ(1u, mu.stats().contended);
+		ASSERT_NE(std::string::npos, mu.stats().toString().find("contended=1"));
+	}
+
+	TEST(Mutex, CondVarWithAdaptive) {
+		Mutex mu(true);
+		CondVar cv(&mu);
+		bool ready = false;
+		std::thread signaller([&] {
+			MutexLock l(&mu);
+			ready = true;
+			cv.signal();
+		});
+		{
+			MutexLock l(&mu);
+			while (!ready) {
+				cv.wait();
+			}
+		}
+		signaller.join();
+		ASSERT_TRUE(ready);
+	}
+
+}
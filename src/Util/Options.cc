@@ -0,0 +1,20 @@
+/*!
+ * \file Options.cc
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ * 
+ */
+#include "CDataBase/Options.h"
+#include "CDataBase/Comprator.h"
+#include "CDataBase/Env.h"
+
+namespace CDB{
+
+	Options::Options()
+		:comparator(byteWiseComparator()),env(Env::Default())
+	{
+	}
+
+}
@@ -0,0 +1,529 @@
+/*!
+ * \file PersistentCache.cc
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#include "CDataBase/SecondaryCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "CDataBase/Env.h"
+#include "Util/Coding.h"
+#include "Util/Crc32.h"
+#include "Util/MutexLock.h"
+
+namespace CDB{
+
+	namespace {
+
+		// a record is crc (4) + type (1) + key length (4) + value length (4)
+		// followed by the key and the value, the crc covers everything after it
+		const size_t KRecordHeaderSize = 4 + 1 + 4 + 4;
+
+		enum RecordType : char {
+			KValueRecord = 1,
+			// written by erase so a rescan of the segment drops the key again
+			KEraseRecord = 2
+		};
+
+		// appends are gathered in memory and written in chunks of this size
+		const size_t KWriteBufferSize = 1 << 20;
+
+		const uint64_t KMinSegmentSize = 1 << 20;
+		const uint64_t KMaxSegmentSize = 64 << 20;
+
+		void encodeRecord(std::string* dst, RecordType type, const Slice& key, const Slice& value) {
+			const size_t start = dst->size();
+			dst->append(4, '\0');
+			dst->push_back(static_cast<char>(type));
+			PutFixed32(dst, static_cast<uint32_t>(key.size()));
+			PutFixed32(dst, static_cast<uint32_t>(value.size()));
+			dst->append(key.data(), key.size());
+			dst->append(value.data(), value.size());
+			const uint32_t crc = crc32::Value(dst->data() + start + 4, dst->size() - start - 4);
+			EncodeFixed32(&(*dst)[start], crc32::Mask(crc));
+		}
+
+		// parse the record at the front of input, false if it is torn or corrupt
+		bool decodeRecord(const Slice& input, RecordType* type, Slice* key, Slice* value, size_t* size) {
+			if (input.size() < KRecordHeaderSize) {
+				return false;
+			}
+			const char* p = input.data();
+			const uint64_t keySize = DecodeFixed32(p + 5);
+			const uint64_t valueSize = DecodeFixed32(p + 9);
+			const uint64_t n = KRecordHeaderSize + keySize + valueSize;
+			if (n > input.size()) {
+				return false;
+			}
+			if (crc32::Unmask(DecodeFixed32(p)) != crc32::Value(p + 4, n - 4)) {
+				return false;
+			}
+			*type = static_cast<RecordType>(p[4]);
+			if (*type != KValueRecord && *type != KEraseRecord) {
+				return false;
+			}
+			*key = Slice(p + KRecordHeaderSize, keySize);
+			*value = Slice(p + KRecordHeaderSize + keySize, valueSize);
+			*size = n;
+			return true;
+		}
+
+		/*!
+		 * \class PersistentCache
+		 *
+		 * \brief a secondary cache kept in segment files under a directory.
+		 *  records are appended to the newest segment through a write buffer,
+		 *  an in memory index maps each key to its record. when the segments
+		 *  outgrow the capacity the oldest one is deleted with its keys. the
+		 *  index is checkpointed when a segment fills up and on close, open
+		 *  loads the checkpoint and rescans the segment bytes written after it
+		 *
+		 * \author czy
+		 * \date 2026.10.19
+		 */
+		class PersistentCache : public SecondaryCache {
+		public:
+			PersistentCache(Env* env, const std::string& dir, uint64_t capacity)
+				: env_(env), dir_(dir), capacity_(capacity),
+				segmentSize_(std::clamp(capacity / 8, KMinSegmentSize, KMaxSegmentSize)),
+				lock_(nullptr), totalSize_(0), writer_(nullptr), activeNumber_(0), flushed_(0) {}
+
+			~PersistentCache() override {
+				{
+					MutexLock l(&mu_);
+					if (writer_ != nullptr) {
+						Status s = error_.ok() ? flushBuffer() : error_;
+						if (s.ok()) {
+							s = writer_->sync();
+						}
+						if (s.ok()) {
+							checkpoint();
+						}
+						writer_->close();
+						delete writer_;
+					}
+				}
+				if (lock_ != nullptr) {
+					env_->unlockFile(lock_);
+				}
+			}
+
+			Status open();
+
+			const char* name() const override { return "CDB.PersistentCache"; }
+
+			// the contents under a key do not change, a key that is kept
+			// already is not written again
+			void insert(const Slice& key, const Slice& contents) override {
+				MutexLock l(&mu_);
+				if (!error_.ok() || index_.find(std::string(key)) != index_.end()) {
+					return;
+				}
+				append(KValueRecord, key, contents);
+			}
+
+			bool lookUp(const Slice& key, std::string* contents) override;
+
+			// erasing a promoted entry costs an erase record now and the
+			// whole entry again when the cache evicts it
+			bool keepsPromotedEntries() const override { return true; }
+
+			void erase(const Slice& key) override {
+				MutexLock l(&mu_);
+				if (!error_.ok() || index_.find(std::string(key)) == index_.end()) {
+					return;
+				}
+				append(KEraseRecord, key, Slice());
+			}
+
+			size_t totalCharge() const override {
+				MutexLock l(&mu_);
+				return totalSize_;
+			}
+
+		private:
+			struct Location {
+				uint64_t segment;
+				uint64_t offset;
+				uint64_t size;
+			};
+
+			struct Segment {
+				// bytes of the segment, the active one counts its write buffer
+				uint64_t size = 0;
+				// reads the bytes that reached the file
+				std::shared_ptr<RandomAccessFile> file;
+			};
+
+			std::string segmentFileName(uint64_t number) const {
+				char buf[100];
+				std::snprintf(buf, sizeof(buf), "/%06llu.cache", static_cast<unsigned long long>(number));
+				return dir_ + buf;
+			}
+
+			std::string indexFileName() const { return dir_ + "/INDEX"; }
+
+			void append(RecordType type, const Slice& key, const Slice& value) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+			Status newSegment() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+			Status flushBuffer() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+			Status checkpoint() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+			Status loadCheckpoint(std::map<uint64_t, uint64_t>* checkpointed) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+			void scanSegment(uint64_t number, uint64_t from) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+			void dropSegment(uint64_t number) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+			Env* const env_;
+			const std::string dir_;
+			const uint64_t capacity_;
+			const uint64_t segmentSize_;
+			FileLock* lock_;
+
+			mutable Mutex mu_;
+			// segments by number, the last one is written
+			std::map<uint64_t, Segment> segments_ GUARDED_BY(mu_);
+			std::unordered_map<std::string, Location> index_ GUARDED_BY(mu_);
+			uint64_t totalSize_ GUARDED_BY(mu_);
+			WritableFile* writer_ GUARDED_BY(mu_);
+			uint64_t activeNumber_ GUARDED_BY(mu_);
+			// bytes of the active segment already in its file
+			uint64_t flushed_ GUARDED_BY(mu_);
+			std::string buffer_ GUARDED_BY(mu_);
+			// the first write error, the cache stops taking entries after it
+			Status error_ GUARDED_BY(mu_);
+		};
+
+		Status PersistentCache::open() {
+			MutexLock l(&mu_);
+			env_->createDir(dir_);
+			Status s = env_->lockFile(dir_ + "/LOCK", &lock_);
+			if (!s.ok()) {
+				return s;
+			}
+
+			std::vector<std::string> children;
+			s = env_->getChildren(dir_, &children);
+			if (!s.ok()) {
+				return s;
+			}
+			std::vector<uint64_t> onDisk;
+			for (const std::string& child : children) {
+				const size_t dot = child.find(".cache");
+				if (dot == std::string::npos || dot == 0 || dot + 6 != child.size() ||
+					child.find_first_not_of("0123456789") != dot) {
+					continue;
+				}
+				onDisk.push_back(std::stoull(child.substr(0, dot)));
+			}
+
+			// number to the length of the segment the checkpoint covers, a
+			// missing or corrupt checkpoint leaves it empty and every segment
+			// is scanned from the start
+			std::map<uint64_t, uint64_t> checkpointed;
+			if (!loadCheckpoint(&checkpointed).ok()) {
+				checkpointed.clear();
+				index_.clear();
+			}
+			for (uint64_t number : onDisk) {
+				segments_[number];
+			}
+			// the entries of a segment that is gone are dropped
+			for (const auto& [number, length] : checkpointed) {
+				if (segments_.find(number) == segments_.end()) {
+					segments_[number];
+					dropSegment(number);
+				}
+			}
+			for (auto it = segments_.begin(); it != segments_.end();) {
+				const uint64_t number = it->first;
+				++it;
+				auto cp = checkpointed.find(number);
+				scanSegment(number, cp == checkpointed.end() ? 0 : cp->second);
+			}
+
+			activeNumber_ = segments_.empty() ? 1 : segments_.rbegin()->first + 1;
+			s = newSegment();
+			if (s.ok()) {
+				// a capacity smaller than the last run drops the oldest data now
+				while (totalSize_ > capacity_ && segments_.size() > 1) {
+					dropSegment(segments_.begin()->first);
+				}
+			}
+			return s;
+		}
+
+		Status PersistentCache::loadCheckpoint(std::map<uint64_t, uint64_t>* checkpointed) {
+			std::string data;
+			Status s = ReadFileToString(env_, indexFileName(), &data);
+			if (!s.ok()) {
+				return s;
+			}
+			if (data.size() < 4) {
+				return Status::Corruption("persistent cache index too short");
+			}
+			const size_t n = data.size() - 4;
+			if (crc32::Unmask(DecodeFixed32(data.data() + n)) != crc32::Value(data.data(), n)) {
+				return Status::Corruption("persistent cache index checksum mismatch");
+			}
+			Slice input(data.data(), n);
+			uint64_t count;
+			if (!GetVarint64(&input, &count)) {
+				return Status::Corruption("bad persistent cache index");
+			}
+			for (uint64_t i = 0; i < count; ++i) {
+				uint64_t number, length;
+				if (!GetVarint64(&input, &number) || !GetVarint64(&input, &length)) {
+					return Status::Corruption("bad persistent cache index");
+				}
+				(*checkpointed)[number] = length;
+			}
+			while (!input.empty()) {
+				Slice key;
+				Location loc;
+				if (!GetLengthPrefixedSlice(&input, &key) || !GetVarint64(&input, &loc.segment) ||
+					!GetVarint64(&input, &loc.offset) || !GetVarint64(&input, &loc.size)) {
+					return Status::Corruption("bad persistent cache index");
+				}
+				index_[std::string(key)] = loc;
+			}
+			return Status::OK();
+		}
+
+		void PersistentCache::scanSegment(uint64_t number, uint64_t from) {
+			const std::string fname = segmentFileName(number);
+			uint64_t fileSize = 0;
+			RandomAccessFile* file = nullptr;
+			Status s = env_->getFileSize(fname, &fileSize);
+			if (s.ok() && fileSize < from) {
+				s = Status::Corruption(fname, "shorter than its checkpoint");
+			}
+			if (s.ok()) {
+				s = env_->newRandomAccessFile(fname, &file);
+			}
+			if (!s.ok()) {
+				dropSegment(number);
+				return;
+			}
+			Segment& segment = segments_[number];
+			segment.file.reset(file);
+			segment.size = from;
+
+			std::string scratch(fileSize - from, '\0');
+			Slice tail;
+			if (!file->read(from, scratch.size(), &tail, scratch.data()).ok()) {
+				tail = Slice();
+			}
+			uint64_t offset = from;
+			RecordType type;
+			Slice key, value;
+			size_t size;
+			// a torn record ends the segment, new records go to a new one
+			while (decodeRecord(tail, &type, &key, &value, &size)) {
+				if (type == KValueRecord) {
+					index_[std::string(key)] = Location{ number, offset, size };
+				}
+				else {
+					index_.erase(std::string(key));
+				}
+				tail.remove_prefix(size);
+				offset += size;
+			}
+			segment.size = offset;
+			totalSize_ += offset;
+		}
+
+		void PersistentCache::dropSegment(uint64_t number) {
+			for (auto it = index_.begin(); it != index_.end();) {
+				if (it->second.segment == number) {
+					it = index_.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+			auto it = segments_.find(number);
+			if (it != segments_.end()) {
+				totalSize_ -= it->second.size;
+				segments_.erase(it);
+			}
+			env_->removeFile(segmentFileName(number));
+		}
+
+		Status PersistentCache::newSegment() {
+			WritableFile* file;
+			Status s = env_->newWritableFile(segmentFileName(activeNumber_), &file);
+			if (!s.ok()) {
+				return s;
+			}
+			writer_ = file;
+			flushed_ = 0;
+			segments_[activeNumber_];
+			return s;
+		}
+
+		Status PersistentCache::flushBuffer() {
+			if (buffer_.empty()) {
+				return Status::OK();
+			}
+			Status s = writer_->append(buffer_);
+			if (s.ok()) {
+				s = writer_->flush();
+			}
+			if (!s.ok()) {
+				return s;
+			}
+			flushed_ += buffer_.size();
+			buffer_.clear();
+			// a reader maps the file as it is when it opens, reopen it so the
+			// flushed records are readable, older readers stay valid
+			RandomAccessFile* file;
+			s = env_->newRandomAccessFile(segmentFileName(activeNumber_), &file);
+			if (s.ok()) {
+				segments_[activeNumber_].file.reset(file);
+			}
+			return s;
+		}
+
+		Status PersistentCache::checkpoint() {
+			std::string data;
+			PutVarint64(&data, segments_.size());
+			for (const auto& [number, segment] : segments_) {
+				PutVarint64(&data, number);
+				PutVarint64(&data, number == activeNumber_ ? flushed_ : segment.size);
+			}
+			for (const auto& [key, loc] : index_) {
+				// records still in the write buffer are found by the rescan
+				if (loc.segment == activeNumber_ && loc.offset + loc.size > flushed_) {
+					continue;
+				}
+				PutLengthPrefixedSlice(&data, key);
+				PutVarint64(&data, loc.segment);
+				PutVarint64(&data, loc.offset);
+				PutVarint64(&data, loc.size);
+			}
+			PutFixed32(&data, crc32::Mask(crc32::Value(data.data(), data.size())));
+			const std::string tmp = indexFileName() + ".tmp";
+			Status s = WriteStringToFile(env_, data, tmp);
+			if (s.ok()) {
+				s = env_->renameFile(tmp, indexFileName());
+			}
+			if (!s.ok()) {
+				env_->removeFile(tmp);
+			}
+			return s;
+		}
+
+		void PersistentCache::append(RecordType type, const Slice& key, const Slice& value) {
+			const uint64_t size = KRecordHeaderSize + key.size() + value.size();
+			Segment* active = &segments_[activeNumber_];
+			Status s;
+			if (active->size > 0 && active->size + size > segmentSize_) {
+				// seal the full segment, checkpoint and start the next one
+				s = flushBuffer();
+				if (s.ok()) {
+					s = writer_->sync();
+				}
+				if (s.ok()) {
+					s = writer_->close();
+				}
+				delete writer_;
+				writer_ = nullptr;
+				if (s.ok()) {
+					activeNumber_++;
+					s = newSegment();
+				}
+				if (s.ok()) {
+					while (totalSize_ > capacity_ && segments_.size() > 1) {
+						dropSegment(segments_.begin()->first);
+					}
+					// a failed checkpoint only costs a longer rescan on open
+					checkpoint();
+				}
+				if (!s.ok()) {
+					error_ = s;
+					return;
+				}
+				active = &segments_[activeNumber_];
+			}
+
+			const uint64_t offset = flushed_ + buffer_.size();
+			encodeRecord(&buffer_, type, key, value);
+			active->size += size;
+			totalSize_ += size;
+			if (type == KValueRecord) {
+				index_[std::string(key)] = Location{ activeNumber_, offset, size };
+			}
+			else {
+				index_.erase(std::string(key));
+			}
+			if (buffer_.size() >= KWriteBufferSize) {
+				s = flushBuffer();
+				if (!s.ok()) {
+					error_ = s;
+				}
+			}
+		}
+
+		bool PersistentCache::lookUp(const Slice& key, std::string* contents) {
+			std::string record;
+			std::shared_ptr<RandomAccessFile> file;
+			Location loc;
+			{
+				MutexLock l(&mu_);
+				auto it = index_.find(std::string(key));
+				if (it == index_.end()) {
+					return false;
+				}
+				loc = it->second;
+				if (loc.segment == activeNumber_ && loc.offset >= flushed_) {
+					record.assign(buffer_, loc.offset - flushed_, loc.size);
+				}
+				else {
+					file = segments_[loc.segment].file;
+					if (file == nullptr) {
+						return false;
+					}
+				}
+			}
+
+			Slice input = record;
+			if (file != nullptr) {
+				// the read runs unlocked, the reader outlives a dropped segment
+				record.resize(loc.size);
+				if (!file->read(loc.offset, loc.size, &input, record.data()).ok()) {
+					return false;
+				}
+			}
+			RecordType type;
+			Slice foundKey, value;
+			size_t size;
+			if (!decodeRecord(input, &type, &foundKey, &value, &size) ||
+				type != KValueRecord || foundKey != key) {
+				return false;
+			}
+			contents->assign(value.data(), value.size());
+			return true;
+		}
+
+	}
+
+	Status newPersistentCache(Env* env, const std::string& dir, uint64_t capacity,
+		SecondaryCache** result) {
+		*result = nullptr;
+		PersistentCache* cache = new PersistentCache(env, dir, capacity);
+		Status s = cache->open();
+		if (!s.ok()) {
+			delete cache;
+			return s;
+		}
+		*result = cache;
+		return s;
+	}
+
+}
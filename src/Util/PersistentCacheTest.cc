@@ -0,0 +1,182 @@
+#include "CDataBase/SecondaryCache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "CDataBase/Cache.h"
+#include "CDataBase/Env.h"
+#include "gtest/gtest.h"
+
+namespace CDB{
+
+	class PersistentCacheTest : public testing::Test {
+	protected:
+		void SetUp() override {
+			env_ = Env::Default();
+			ASSERT_TRUE(env_->getTestDir(&dir_).ok());
+			dir_ += "/persistent_cache_test";
+			destroy();
+		}
+
+		void TearDown() override {
+			cache_.reset();
+			destroy();
+		}
+
+		void destroy() {
+			std::vector<std::string> children;
+			env_->getChildren(dir_, &children);
+			for (const std::string& child : children) {
+				env_->removeFile(dir_ + "/" + child);
+			}
+			env_->removeDir(dir_);
+		}
+
+		void open(uint64_t capacity = 64 << 20) {
+			cache_.reset();
+			SecondaryCache* cache;
+			ASSERT_TRUE(newPersistentCache(env_, dir_, capacity, &cache).ok());
+			cache_.reset(cache);
+		}
+
+		std::string value(int i, size_t size = 1000) {
+			std::string v = std::to_string(i);
+			v.resize(size, 'v');
+			return v;
+		}
+
+		std::string get(int i) {
+			std::string contents;
+			if (!cache_->lookUp("key" + std::to_string(i), &contents)) {
+				return "NOT_FOUND";
+			}
+			return contents;
+		}
+
+		void put(int i, size_t size = 1000) {
+			cache_->insert("key" + std::to_string(i), value(i, size));
+		}
+
+		Env* env_;
+		std::string dir_;
+		std::unique_ptr<SecondaryCache> cache_;
+	};
+
+	TEST_F(PersistentCacheTest, InsertLookUpErase) {
+		open();
+		ASSERT_EQ("NOT_FOUND", get(1));
+		// enough records to flush the write buffer a few times
+		for (int i = 0; i < 5000; ++i) {
+			put(i);
+		}
+		for (int i = 0; i < 5000; ++i) {
+			ASSERT_EQ(value(i), get(i)) << i;
+		}
+		// a kept key is not written again
+		const size_t charge = cache_->totalCharge();
+		put(7, 10);
+		ASSERT_EQ(value(7), get(7));
+		ASSERT_EQ(charge, cache_->totalCharge());
+		cache_->erase("key8");
+		ASSERT_EQ("NOT_FOUND", get(8));
+		put(8, 10);
+		ASSERT_EQ(value(8, 10), get(8));
+	}
+
+	TEST_F(PersistentCacheTest, DropsOldestSegmentPastCapacity) {
+		const uint64_t capacity = 8 << 20;
+		open(capacity);
+		for (int i = 0; i < 20000; ++i) {
+			put(i);
+		}
+		ASSERT_LE(cache_->totalCharge(), capacity + (1 << 20));
+		ASSERT_EQ("NOT_FOUND", get(0));
+		ASSERT_EQ(value(19999), get(19999));
+	}
+
+	TEST_F(PersistentCacheTest, ReopenRestoresEntries) {
+		open();
+		for (int i = 0; i < 3000; ++i) {
+			put(i);
+		}
+		cache_->erase("key5");
+		const size_t charge = cache_->totalCharge();
+		open();
+		ASSERT_EQ(charge, cache_->totalCharge());
+		ASSERT_EQ(value(0), get(0));
+		ASSERT_EQ(value(2999), get(2999));
+		ASSERT_EQ("NOT_FOUND", get(5));
+	}
+
+	TEST_F(PersistentCacheTest, RescansWithoutCheckpoint) {
+		open();
+		for (int i = 0; i < 3000; ++i) {
+			put(i);
+		}
+		cache_->erase("key5");
+		cache_.reset();
+		ASSERT_TRUE(env_->removeFile(dir_ + "/INDEX").ok());
+		open();
+		ASSERT_EQ(value(0), get(0));
+		ASSERT_EQ(value(2999), get(2999));
+		ASSERT_EQ("NOT_FOUND", get(5));
+	}
+
+	TEST_F(PersistentCacheTest, ServesMissesOfBlockCache) {
+		open();
+		static int deleted = 0;
+		static const Cache::CacheItemHelper helper = {
+			[](const Slice&, void* v) { ++deleted; delete reinterpret_cast<std::string*>(v); },
+			[](void* v, std::string* dst) { *dst = *reinterpret_cast<std::string*>(v); },
+			[](const Slice& contents, size_t* charge) -> void* {
+				*charge = contents.size();
+				return new std::string(contents);
+			}
+		};
+		std::unique_ptr<Cache> cache(newLRUCache(16 * 4096, cache_.get()));
+		for (int i = 0; i < 200; ++i) {
+			std::string* v = new std::string(value(i));
+			cache->release(cache->insert("key" + std::to_string(i), v, v->size(), &helper));
+		}
+		ASSERT_GT(cache_->totalCharge(), 0u);
+		for (int i = 0; i < 200; ++i) {
+			Cache::Handle* h = cache->lookUp("key" + std::to_string(i), &helper);
+			ASSERT_TRUE(h != nullptr) << i;
+			ASSERT_EQ(value(i), *reinterpret_cast<std::string*>(cache->value(h)));
+			cache->release(h);
+		}
+	}
+
+	TEST_F(PersistentCacheTest, KeepsPromotedEntries) {
+		open();
+		static const Cache::CacheItemHelper helper = {
+			[](const Slice&, void* v) { delete reinterpret_cast<std::string*>(v); },
+			[](void* v, std::string* dst) { *dst = *reinterpret_cast<std::string*>(v); },
+			[](const Slice& contents, size_t* charge) -> void* {
+				*charge = contents.size();
+				return new std::string(contents);
+			}
+		};
+		std::unique_ptr<Cache> cache(newLRUCache(16 * 4096, cache_.get()));
+		for (int i = 0; i < 200; ++i) {
+			std::string* v = new std::string(value(i));
+			cache->release(cache->insert("key" + std::to_string(i), v, v->size(), &helper));
+		}
+		// every pass promotes the entries and evicts them again, after the
+		// first one each entry is kept and none is written again
+		size_t charge = 0;
+		for (int pass = 0; pass < 3; ++pass) {
+			for (int i = 0; i < 200; ++i) {
+				Cache::Handle* h = cache->lookUp("key" + std::to_string(i), &helper);
+				ASSERT_TRUE(h != nullptr) << i;
+				ASSERT_EQ(value(i), *reinterpret_cast<std::string*>(cache->value(h)));
+				cache->release(h);
+			}
+			if (pass == 0) {
+				charge = cache_->totalCharge();
+			}
+		}
+		ASSERT_EQ(charge, cache_->totalCharge());
+	}
+
+}
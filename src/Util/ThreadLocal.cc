@@ -0,0 +1,196 @@
+#include "Util/ThreadLocal.h"
+
+#include <atomic>
+#include <cassert>
+#include <mutex>
+#include "Util/NoDestructor.h"
+
+namespace CDB{
+
+	namespace {
+
+		// the values of one thread, indexed by ThreadLocalPtr id
+		struct ThreadData {
+			// only resized while Meta::mu is held, scrape() reads
+			// the entries of other threads under the same lock
+			std::vector<std::atomic<void*>> entries;
+			ThreadData* prev = nullptr;
+			ThreadData* next = nullptr;
+		};
+
+		// bookkeeping shared by all ThreadLocalPtr instances
+		struct Meta {
+			std::mutex mu;
+			// circular list of the ThreadData of all live threads
+			ThreadData head;
+			std::vector<ThreadLocalPtr::UnrefHandler> handlers;
+			std::vector<uint32_t> freeIds;
+			uint32_t nextId = 0;
+
+			Meta()
+			{
+				head.prev = &head;
+				head.next = &head;
+			}
+		};
+
+		Meta* meta()
+		{
+			static NoDestructor<Meta> instance;
+			return instance.get();
+		}
+
+		// unlinks the thread from the list and releases its values on thread exit
+		struct ThreadGuard {
+			ThreadData* data = nullptr;
+
+			~ThreadGuard()
+			{
+				if (data == nullptr) {
+					return;
+				}
+				Meta* m = meta();
+				std::vector<std::pair<ThreadLocalPtr::UnrefHandler, void*>> release;
+				{
+					std::lock_guard<std::mutex> l(m->mu);
+					data->prev->next = data->next;
+					data->next->prev = data->prev;
+					for (uint32_t id = 0; id < data->entries.size(); ++id) {
+						void* ptr = data->entries[id].exchange(nullptr, std::memory_order_acquire);
+						if (ptr != nullptr && m->handlers[id] != nullptr) {
+							release.emplace_back(m->handlers[id], ptr);
+						}
+					}
+				}
+				// handlers may need other locks, call them outside of ours
+				for (auto& [handler, ptr] : release) {
+					handler(ptr);
+				}
+				delete data;
+			}
+		};
+
+		thread_local ThreadGuard tlsGuard;
+
+		ThreadData* threadData()
+		{
+			if (tlsGuard.data == nullptr) {
+				ThreadData* data = new ThreadData;
+				Meta* m = meta();
+				std::lock_guard<std::mutex> l(m->mu);
+				data->next = &m->head;
+				data->prev = m->head.prev;
+				m->head.prev->next = data;
+				m->head.prev = data;
+				tlsGuard.data = data;
+			}
+			return tlsGuard.data;
+		}
+
+		std::atomic<void*>* entry(uint32_t id)
+		{
+			ThreadData* data = threadData();
+			if (id >= data->entries.size()) {
+				Meta* m = meta();
+				std::lock_guard<std::mutex> l(m->mu);
+				// atomics can not be moved, build the larger vector by hand
+				std::vector<std::atomic<void*>> grown(id + 1);
+				for (size_t i = 0; i < data->entries.size(); ++i) {
+					grown[i].store(data->entries[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+				}
+				data->entries.swap(grown);
+			}
+			return &data->entries[id];
+		}
+
+		uint32_t acquireId(ThreadLocalPtr::UnrefHandler handler)
+		{
+			Meta* m = meta();
+			std::lock_guard<std::mutex> l(m->mu);
+			uint32_t id;
+			if (!m->freeIds.empty()) {
+				id = m->freeIds.back();
+				m->freeIds.pop_back();
+			}
+			else {
+				id = m->nextId++;
+				m->handlers.resize(m->nextId);
+			}
+			m->handlers[id] = handler;
+			return id;
+		}
+
+	}
+
+	ThreadLocalPtr::ThreadLocalPtr(UnrefHandler handler)
+		:id_(acquireId(handler))
+	{
+	}
+
+	ThreadLocalPtr::~ThreadLocalPtr()
+	{
+		// release the values left in every thread before the id is reused
+		Meta* m = meta();
+		std::vector<void*> release;
+		UnrefHandler handler;
+		{
+			std::lock_guard<std::mutex> l(m->mu);
+			handler = m->handlers[id_];
+			for (ThreadData* t = m->head.next; t != &m->head; t = t->next) {
+				if (id_ < t->entries.size()) {
+					void* ptr = t->entries[id_].exchange(nullptr, std::memory_order_acquire);
+					if (ptr != nullptr) {
+						release.push_back(ptr);
+					}
+				}
+			}
+			m->handlers[id_] = nullptr;
+			m->freeIds.push_back(id_);
+		}
+		if (handler != nullptr) {
+			for (void* ptr : release) {
+				handler(ptr);
+			}
+		}
+	}
+
+	void* ThreadLocalPtr::get() const
+	{
+		ThreadData* data = threadData();
+		if (id_ >= data->entries.size()) {
+			return nullptr;
+		}
+		return data->entries[id_].load(std::memory_order_acquire);
+	}
+
+	void ThreadLocalPtr::reset(void* ptr)
+	{
+		entry(id_)->store(ptr, std::memory_order_release);
+	}
+
+	void* ThreadLocalPtr::swap(void* ptr)
+	{
+		return entry(id_)->exchange(ptr, std::memory_order_acquire);
+	}
+
+	bool ThreadLocalPtr::compareAndSwap(void* ptr, void*& expected)
+	{
+		return entry(id_)->compare_exchange_strong(expected, ptr,
+			std::memory_order_release, std::memory_order_relaxed);
+	}
+
+	void ThreadLocalPtr::scrape(std::vector<void*>* ptrs, void* replacement)
+	{
+		Meta* m = meta();
+		std::lock_guard<std::mutex> l(m->mu);
+		for (ThreadData* t = m->head.next; t != &m->head; t = t->next) {
+			if (id_ < t->entries.size()) {
+				void* ptr = t->entries[id_].exchange(replacement, std::memory_order_acquire);
+				if (ptr != nullptr) {
+					ptrs->push_back(ptr);
+				}
+			}
+		}
+	}
+
+}
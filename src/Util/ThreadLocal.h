@@ -0,0 +1,57 @@
+/*!
+ * \file ThreadLocal.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace CDB{
+
+	/*!
+	 * \class ThreadLocalPtr
+	 *
+	 * \brief a pointer with a separate value per thread, unlike thread_local
+	 *  it can live in an object and the values of all threads can be
+	 *  collected at once with scrape(), the unref handler is called for the
+	 *  value of a thread when the thread exits or the ThreadLocalPtr dies
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class ThreadLocalPtr{
+	public:
+		using UnrefHandler = void (*)(void* ptr);
+
+		explicit ThreadLocalPtr(UnrefHandler handler = nullptr);
+
+		ThreadLocalPtr(const ThreadLocalPtr&) = delete;
+
+		ThreadLocalPtr& operator=(const ThreadLocalPtr&) = delete;
+
+		~ThreadLocalPtr();
+
+		/// the value of the calling thread, nullptr if it was never set
+		void* get() const;
+
+		void reset(void* ptr);
+
+		/// set a new value and return the old one
+		void* swap(void* ptr);
+
+		/// set ptr if the value is expected, otherwise store the value in expected
+		bool compareAndSwap(void* ptr, void*& expected);
+
+		/// replace the values of all threads with replacement and append the
+		/// non-null old values to ptrs
+		void scrape(std::vector<void*>* ptrs, void* replacement);
+
+	private:
+		const uint32_t id_;
+	};
+
+}
@@ -0,0 +1,58 @@
+#include "Util/ThreadLocal.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace CDB{
+
+	static std::atomic<int> gUnrefCount(0);
+
+	static void countUnref(void* ptr) { gUnrefCount.fetch_add(1); }
+
+	TEST(ThreadLocalPtr, PerThreadValues) {
+		ThreadLocalPtr tls;
+		int a = 1, b = 2;
+		ASSERT_EQ(nullptr, tls.get());
+		tls.reset(&a);
+		std::thread other([&] {
+			ASSERT_EQ(nullptr, tls.get());
+			tls.reset(&b);
+			ASSERT_EQ(&b, tls.get());
+		});
+		other.join();
+		ASSERT_EQ(&a, tls.get());
+
+		ASSERT_EQ(&a, tls.swap(&b));
+		void* expected = &a;
+		ASSERT_FALSE(tls.compareAndSwap(&a, expected));
+		ASSERT_EQ(&b, expected);
+		ASSERT_TRUE(tls.compareAndSwap(&a, expected));
+		ASSERT_EQ(&a, tls.get());
+	}
+
+	TEST(ThreadLocalPtr, ScrapeAndUnref) {
+		gUnrefCount = 0;
+		int values[3];
+		{
+			ThreadLocalPtr tls(&countUnref);
+			tls.reset(&values[0]);
+			// the value of an exited thread goes to the handler
+			std::thread exited([&] { tls.reset(&values[1]); });
+			exited.join();
+			ASSERT_EQ(1, gUnrefCount.load());
+
+			std::vector<void*> scraped;
+			tls.scrape(&scraped, nullptr);
+			ASSERT_EQ(1u, scraped.size());
+			ASSERT_EQ(&values[0], scraped[0]);
+			ASSERT_EQ(nullptr, tls.get());
+
+			tls.reset(&values[2]);
+		}
+		// the values left behind are released with the ThreadLocalPtr
+		ASSERT_EQ(2, gUnrefCount.load());
+	}
+
+}
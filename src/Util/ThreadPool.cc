@@ -0,0 +1,69 @@
+#include "Util/ThreadPool.h"
+
+#include <cassert>
+
+namespace CDB{
+
+	ThreadPool::ThreadPool(int threads)
+		:workCv_(&mu_), idleCv_(&mu_), active_(0), shutdown_(false)
+	{
+		assert(threads > 0);
+		threads_.reserve(threads);
+		for (int i = 0; i < threads; ++i) {
+			threads_.emplace_back(&ThreadPool::workerLoop, this);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			MutexLock l(&mu_);
+			shutdown_ = true;
+			workCv_.signalAll();
+		}
+		for (auto& thread : threads_) {
+			thread.join();
+		}
+	}
+
+	void ThreadPool::schedule(std::function<void()> work)
+	{
+		MutexLock l(&mu_);
+		assert(!shutdown_);
+		queue_.push_back(std::move(work));
+		workCv_.signal();
+	}
+
+	void ThreadPool::waitForIdle()
+	{
+		MutexLock l(&mu_);
+		while (!queue_.empty() || active_ > 0) {
+			idleCv_.wait();
+		}
+	}
+
+	void ThreadPool::workerLoop()
+	{
+		MutexLock l(&mu_);
+		while (true) {
+			while (queue_.empty() && !shutdown_) {
+				workCv_.wait();
+			}
+			if (queue_.empty()) {
+				// shutdown_ is set and the queue is drained
+				return;
+			}
+			std::function<void()> work = std::move(queue_.front());
+			queue_.pop_front();
+			++active_;
+			mu_.unlock();
+			work();
+			mu_.lock();
+			--active_;
+			if (queue_.empty() && active_ == 0) {
+				idleCv_.signalAll();
+			}
+		}
+	}
+
+}
@@ -0,0 +1,59 @@
+/*!
+ * \file ThreadPool.h
+ *
+ * \author czy
+ * \date 2026.10.19
+ *
+ *
+ */
+#pragma once
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "Util/MutexLock.h"
+#include "Util/ThreadAnnotations.h"
+
+namespace CDB{
+
+	/*!
+	 * \class ThreadPool
+	 *
+	 * \brief a fixed set of threads running work in the order it was scheduled,
+	 *  for jobs that are split across threads and waited for, unlike
+	 *  Env::schedule which runs background work on a single thread
+	 *
+	 * \author czy
+	 * \date 2026.10.19
+	 */
+	class ThreadPool{
+	public:
+		explicit ThreadPool(int threads);
+
+		ThreadPool(const ThreadPool&) = delete;
+
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/// runs the work still queued, then joins the threads
+		~ThreadPool();
+
+		void schedule(std::function<void()> work);
+
+		/// block until the queue is empty and no work is running
+		void waitForIdle();
+
+		int size() const { return static_cast<int>(threads_.size()); }
+
+	private:
+		void workerLoop();
+
+		Mutex mu_;
+		CondVar workCv_;
+		CondVar idleCv_;
+		std::deque<std::function<void()>> queue_ GUARDED_BY(mu_);
+		int active_ GUARDED_BY(mu_);
+		bool shutdown_ GUARDED_BY(mu_);
+		std::vector<std::thread> threads_;
+	};
+
+}